@@ -27,6 +27,40 @@ namespace ai{
 
 namespace inference{
 
+/**
+ * @brief length of the padded base64 encoding of len bytes
+*/
+inline size_t base64EncodedSize(size_t len){
+    return 4 * ((len + 2) / 3);
+}
+
+/**
+ * @brief upper bound of the decoded length of len base64 chars, the actual length may be up to 2 bytes shorter due to padding
+*/
+inline size_t base64DecodedMaxSize(size_t len){
+    return 3 * ((len + 3) / 4);
+}
+
+/**
+ * @brief encode len bytes at src into dst with padding. AVX2 or SSSE3 is used when supported by the running cpu
+ * @param dst output buffer of at least base64EncodedSize(len) chars, not null-terminated
+ * @return number of chars written
+*/
+size_t base64Encode(char* dst, void const* src, size_t len);
+
+/**
+ * @brief decode len base64 chars at src into dst, without any intermediate copy. AVX2 or SSSE3 is used when supported
+ * by the running cpu. Trailing padding is optional, whitespace is not accepted
+ * @param dst output buffer of at least base64DecodedMaxSize(len) bytes
+ * @param decodedLen number of bytes written on success
+ * @return false if src contains any char out of the base64 char set or has an invalid length
+*/
+bool base64Decode(void* dst, const char* src, size_t len, size_t& decodedLen);
+
+/**
+ * @brief decode val to a string
+ * @exception std::invalid_argument if val is not valid base64
+*/
 std::string base64DecodeStrToStr(const std::string &val);
 
 std::string base64EncodeStrToStr(const std::string &val);
@@ -35,6 +69,11 @@ size_t base64EncodeBufferToString(std::string& dst, void const* src, size_t len)
 
 size_t base64DecodeStringToBuffer(std::string& src, void* dst);
 
+/**
+ * @brief name of the codec implementation selected on the running cpu, i.e. avx2, ssse3 or scalar
+*/
+const char* base64CodecName();
+
 }
 
 }
@@ -0,0 +1,697 @@
+/*
+ * INTEL CONFIDENTIAL
+ *
+ * Copyright (C) 2024 Intel Corporation.
+ *
+ * This software and the related documents are Intel copyrighted materials, and your use of
+ * them is governed by the express license under which they were provided to you (License).
+ * Unless the License provides otherwise, you may not use, modify, copy, publish, distribute,
+ * disclose or transmit this software or the related documents without Intel's prior written permission.
+ *
+ * This software and the related documents are provided as is, with no express or implied warranties,
+ * other than those that are expressly stated in the License.
+*/
+
+#ifndef HCE_AI_INF_LATENCY_TRACER_HPP
+#define HCE_AI_INF_LATENCY_TRACER_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace hce{
+
+namespace ai{
+
+namespace inference{
+
+/**
+ * @brief log-linear latency histogram (HDR-style), values are in nanoseconds
+ *  > values below SUB_BUCKET_COUNT are recorded exactly, each following power of two is split
+ *    into SUB_BUCKET_COUNT linear sub-buckets, i.e. relative error is below 1 / SUB_BUCKET_COUNT
+ *  > record() is wait-free (relaxed atomic increments), so it can be called from any worker thread
+*/
+class LatencyHistogram {
+public:
+    static constexpr unsigned SUB_BUCKET_BITS = 5;
+    static constexpr unsigned SUB_BUCKET_COUNT = 1u << SUB_BUCKET_BITS;
+    static constexpr unsigned MAX_VALUE_BITS = 40;                     // ~18 minutes in ns, larger values are clamped
+    static constexpr unsigned BUCKET_COUNT = (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+    static constexpr uint64_t MAX_VALUE = (1ull << MAX_VALUE_BITS) - 1;
+
+    struct Summary {
+        uint64_t count = 0;
+        double mean = 0.0;
+        uint64_t min = 0;
+        uint64_t p50 = 0;
+        uint64_t p90 = 0;
+        uint64_t p99 = 0;
+        uint64_t p999 = 0;
+        uint64_t max = 0;
+    };
+
+    LatencyHistogram() {
+        reset();
+    }
+
+    void record(uint64_t value) {
+        value = std::min(value, MAX_VALUE);
+        m_counts[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+        m_sum.fetch_add(value, std::memory_order_relaxed);
+
+        uint64_t cur = m_max.load(std::memory_order_relaxed);
+        while (value > cur && !m_max.compare_exchange_weak(cur, value, std::memory_order_relaxed)) {
+        }
+        cur = m_min.load(std::memory_order_relaxed);
+        while (value < cur && !m_min.compare_exchange_weak(cur, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    /**
+     * @brief percentiles are reported as the highest value equivalent to the bucket, clamped to max
+    */
+    Summary summarize() const {
+        Summary summary;
+        std::vector<uint64_t> counts(BUCKET_COUNT);
+        uint64_t total = 0;
+        for (unsigned i = 0; i < BUCKET_COUNT; i ++) {
+            counts[i] = m_counts[i].load(std::memory_order_relaxed);
+            total += counts[i];
+        }
+        if (total == 0) {
+            return summary;
+        }
+        summary.count = total;
+        summary.mean = (double)m_sum.load(std::memory_order_relaxed) / (double)m_count.load(std::memory_order_relaxed);
+        summary.min = m_min.load(std::memory_order_relaxed);
+        summary.max = m_max.load(std::memory_order_relaxed);
+
+        const double quantiles[4] = {0.5, 0.9, 0.99, 0.999};
+        uint64_t* outputs[4] = {&summary.p50, &summary.p90, &summary.p99, &summary.p999};
+        unsigned q = 0;
+        uint64_t seen = 0;
+        for (unsigned i = 0; i < BUCKET_COUNT && q < 4; i ++) {
+            seen += counts[i];
+            while (q < 4 && (double)seen >= quantiles[q] * (double)total) {
+                *outputs[q] = std::min(bucketUpperBound(i), summary.max);
+                q ++;
+            }
+        }
+        return summary;
+    }
+
+    void reset() {
+        for (auto& count : m_counts) {
+            count.store(0, std::memory_order_relaxed);
+        }
+        m_count.store(0, std::memory_order_relaxed);
+        m_sum.store(0, std::memory_order_relaxed);
+        m_max.store(0, std::memory_order_relaxed);
+        m_min.store(UINT64_MAX, std::memory_order_relaxed);
+    }
+
+    static unsigned bucketIndex(uint64_t value) {
+        if (value < SUB_BUCKET_COUNT) {
+            return (unsigned)value;
+        }
+        const unsigned msb = 63 - (unsigned)__builtin_clzll(value);
+        const unsigned sub = (unsigned)(value >> (msb - SUB_BUCKET_BITS)) & (SUB_BUCKET_COUNT - 1);
+        return (msb - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT + sub;
+    }
+
+    static uint64_t bucketUpperBound(unsigned index) {
+        if (index < SUB_BUCKET_COUNT) {
+            return index;
+        }
+        const unsigned magnitude = index / SUB_BUCKET_COUNT;
+        const uint64_t sub = index % SUB_BUCKET_COUNT;
+        const uint64_t lower = (SUB_BUCKET_COUNT + sub) << (magnitude - 1);
+        return lower + (1ull << (magnitude - 1)) - 1;
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> m_counts;
+    std::atomic<uint64_t> m_count;
+    std::atomic<uint64_t> m_sum;
+    std::atomic<uint64_t> m_max;
+    std::atomic<uint64_t> m_min;
+};
+
+/**
+ * @brief one trace record, names point to strings interned by LatencyTracer
+*/
+struct TraceEvent {
+    enum Phase : uint8_t {
+        COMPLETE = 0,           // duration event, chrome trace phase "X"
+        COUNTER                 // gauge sample, chrome trace phase "C"
+    };
+
+    const char* name;
+    uint64_t timestamp;         // ns, steady clock
+    uint64_t value;             // duration in ns for COMPLETE, gauge value for COUNTER
+    uint32_t pipelineId;        // job handle, 0 if not recorded within a registered pipeline, see LatencyTracer::registerNode()
+    uint32_t streamId;
+    uint32_t frameId;
+    Phase phase;
+};
+
+/**
+ * @brief single-producer ring owned by one thread, the latest CAPACITY events are kept
+ *  > the owner thread writes without any lock, readers copy the ring and discard slots that
+ *    may have been overwritten during the copy (seqlock-like validation on the head counter)
+ *  > only the owner thread writes the head, clear() from other threads moves the start sequence
+ *    instead and readers ignore the events before it
+*/
+class TraceRing {
+public:
+    static constexpr size_t CAPACITY = 4096;
+
+    explicit TraceRing(uint32_t tid): m_head(0), m_start(0), m_tid(tid) { }
+
+    void push(const TraceEvent& event) {
+        const uint64_t head = m_head.load(std::memory_order_relaxed);
+        m_events[head & (CAPACITY - 1)] = event;
+        m_head.store(head + 1, std::memory_order_release);
+    }
+
+    void snapshot(std::vector<TraceEvent>& out) const {
+        const uint64_t start = m_start.load(std::memory_order_acquire);
+        const uint64_t head = m_head.load(std::memory_order_acquire);
+        const uint64_t begin = std::max(start, head > CAPACITY ? head - CAPACITY : 0);
+        std::vector<TraceEvent> copied(m_events.begin(), m_events.end());
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        // the slot of sequence `s` is being reused once the writer starts sequence `s + CAPACITY`
+        const uint64_t headAfter = m_head.load(std::memory_order_relaxed);
+        const uint64_t validBegin = std::max(begin, headAfter >= CAPACITY ? headAfter - CAPACITY + 1 : 0);
+        for (uint64_t seq = validBegin; seq < head; seq ++) {
+            out.push_back(copied[seq & (CAPACITY - 1)]);
+        }
+    }
+
+    void clear() {
+        m_start.store(m_head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    uint32_t tid() const {
+        return m_tid;
+    }
+
+private:
+    std::array<TraceEvent, CAPACITY> m_events;
+    std::atomic<uint64_t> m_head;
+    std::atomic<uint64_t> m_start;      // sequence of the first event since the latest clear()
+    uint32_t m_tid;
+};
+
+/**
+ * @brief process wide instrumentation registry: latency histograms per stage and per stream of each pipeline,
+ * queue depth gauges, and per-thread trace rings
+ *  > stages and gauges are registered once (e.g. in node worker init) and recorded lock-free
+ *  > pipelines are identified by a bounded index, reused once the pipeline is unregistered, so that the
+ *    per-stream histograms stay bounded however many pipelines the process goes through
+ *  > trace rings of exited threads are reused by new threads
+ *  > the instance is a function-local static in an inline function, so node libraries and the
+ *    server executable share one instance as long as the executable exports its symbols
+ *  > tracing is disabled by default, recording returns immediately in that case
+*/
+class LatencyTracer {
+public:
+    static constexpr unsigned MAX_STREAM_NUM = 256;         // streams of all pipelines, the others are only counted in the total
+    static constexpr unsigned MAX_PIPELINE_NUM = 64;        // pipelines traced at the same time, index 0 for the others
+    static constexpr uint64_t EMPTY_STREAM_KEY = UINT64_MAX;
+
+    /**
+     * @brief stream ids restart from 0 in each pipeline, so streams are keyed by pipeline index and stream id
+     * in an open-addressing table: a slot is claimed once by CAS on its key and never released, the keys are
+     * bounded as pipeline indices are reused, see registerNode()
+    */
+    struct Stage {
+        std::string name;
+        LatencyHistogram total;
+        std::array<std::atomic<uint64_t>, MAX_STREAM_NUM> streamKeys;
+        std::array<std::atomic<LatencyHistogram*>, MAX_STREAM_NUM> streams;
+
+        explicit Stage(const std::string& stageName): name(stageName) {
+            for (unsigned i = 0; i < MAX_STREAM_NUM; i ++) {
+                streamKeys[i].store(EMPTY_STREAM_KEY, std::memory_order_relaxed);
+                streams[i].store(nullptr, std::memory_order_relaxed);
+            }
+        }
+
+        ~Stage() {
+            for (auto& stream : streams) {
+                delete stream.load(std::memory_order_relaxed);
+            }
+        }
+
+        static uint64_t streamKey(uint32_t pipelineIndex, unsigned streamId) {
+            return ((uint64_t)pipelineIndex << 32) | streamId;
+        }
+
+        /**
+         * @return nullptr if the table is full, or on the first records of a stream while its slot is being claimed
+        */
+        LatencyHistogram* stream(uint32_t pipelineIndex, unsigned streamId) {
+            const uint64_t key = streamKey(pipelineIndex, streamId);
+            const unsigned hash = (unsigned)((key * 0x9E3779B97F4A7C15ull) >> 32);
+            for (unsigned probe = 0; probe < MAX_STREAM_NUM; probe ++) {
+                const unsigned slot = (hash + probe) % MAX_STREAM_NUM;
+                uint64_t slotKey = streamKeys[slot].load(std::memory_order_acquire);
+                if (slotKey == EMPTY_STREAM_KEY &&
+                        streamKeys[slot].compare_exchange_strong(slotKey, key, std::memory_order_acq_rel)) {
+                    LatencyHistogram* created = new LatencyHistogram();
+                    streams[slot].store(created, std::memory_order_release);
+                    return created;
+                }
+                if (slotKey == key) {
+                    return streams[slot].load(std::memory_order_acquire);
+                }
+            }
+            return nullptr;
+        }
+    };
+
+    struct Gauge {
+        std::string name;
+        std::atomic<int64_t> value;
+        std::atomic<int64_t> peak;
+
+        explicit Gauge(const std::string& gaugeName): name(gaugeName), value(0), peak(0) { }
+    };
+
+    static LatencyTracer& getInstance() {
+        static LatencyTracer inst;
+        return inst;
+    }
+
+    static uint64_t now() {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void setEnabled(bool enabled) {
+        m_enabled.store(enabled, std::memory_order_release);
+    }
+
+    bool enabled() const {
+        return m_enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief get or create a stage, the same name always returns the same stage
+    */
+    Stage* getStage(const std::string& name) {
+        std::lock_guard<std::mutex> lg(m_registryMutex);
+        auto iter = m_stageIndex.find(name);
+        if (iter != m_stageIndex.end()) {
+            return iter->second;
+        }
+        m_stages.emplace_back(new Stage(name));
+        Stage* stage = m_stages.back().get();
+        m_stageIndex.emplace(name, stage);
+        return stage;
+    }
+
+    /**
+     * @brief get or create a gauge, the same name always returns the same gauge
+    */
+    Gauge* getGauge(const std::string& name) {
+        std::lock_guard<std::mutex> lg(m_registryMutex);
+        auto iter = m_gaugeIndex.find(name);
+        if (iter != m_gaugeIndex.end()) {
+            return iter->second;
+        }
+        m_gauges.emplace_back(new Gauge(name));
+        Gauge* gauge = m_gauges.back().get();
+        m_gaugeIndex.emplace(name, gauge);
+        return gauge;
+    }
+
+    /**
+     * @brief bind a node of a pipeline to the pipeline id, e.g. the job handle, so that the stages recorded by
+     * the node are keyed by pipeline as well as by stream. Should be called before the pipeline is prepared.
+     * The pipeline is given a free index below MAX_PIPELINE_NUM on its first node, index 0 if none is left
+     * @param node the hva::hvaNode_t, passed to pipelineOf() by its workers
+    */
+    void registerNode(const void* node, uint32_t pipelineId) {
+        std::lock_guard<std::mutex> lg(m_pipelineMutex);
+        auto iter = m_pipelineIndex.find(pipelineId);
+        if (iter == m_pipelineIndex.end()) {
+            uint32_t index = 0;
+            if (!m_freePipelineIndex.empty()) {
+                index = m_freePipelineIndex.back();
+                m_freePipelineIndex.pop_back();
+                m_pipelineHandles[index].store(pipelineId, std::memory_order_relaxed);
+            }
+            m_pipelineIndex.emplace(pipelineId, index);
+        }
+        m_nodePipelines[node] = pipelineId;
+    }
+
+    /**
+     * @brief unbind all nodes of a pipeline, called when the pipeline is stopped. Its per-stream histograms
+     * are cleared and its index is released for the next pipeline
+    */
+    void unregisterPipeline(uint32_t pipelineId) {
+        std::lock_guard<std::mutex> lg(m_pipelineMutex);
+        for (auto node = m_nodePipelines.begin(); node != m_nodePipelines.end(); ) {
+            if (node->second == pipelineId) {
+                node = m_nodePipelines.erase(node);
+            }
+            else {
+                ++node;
+            }
+        }
+        auto iter = m_pipelineIndex.find(pipelineId);
+        if (iter == m_pipelineIndex.end()) {
+            return;
+        }
+        const uint32_t index = iter->second;
+        m_pipelineIndex.erase(iter);
+        if (index == 0) {
+            // pipelines beyond MAX_PIPELINE_NUM share index 0
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lk(m_registryMutex);
+            for (auto& stage : m_stages) {
+                for (unsigned slot = 0; slot < MAX_STREAM_NUM; slot ++) {
+                    LatencyHistogram* hist = stage->streams[slot].load(std::memory_order_acquire);
+                    if (hist && (stage->streamKeys[slot].load(std::memory_order_acquire) >> 32) == index) {
+                        hist->reset();
+                    }
+                }
+            }
+        }
+        m_pipelineHandles[index].store(0, std::memory_order_relaxed);
+        m_freePipelineIndex.push_back(index);
+    }
+
+    /**
+     * @return pipeline index of a node, passed to LatencyScope and record(). 0 if not registered.
+     * Takes a lock, so node workers should look it up once, e.g. in init(), rather than per frame
+    */
+    uint32_t pipelineOf(const void* node) {
+        if (!node) {
+            return 0;
+        }
+        std::lock_guard<std::mutex> lg(m_pipelineMutex);
+        auto iter = m_nodePipelines.find(node);
+        return iter == m_nodePipelines.end() ? 0 : m_pipelineIndex[iter->second];
+    }
+
+    /**
+     * @brief record one stage execution of [begin, end) on frame `frameId` of stream `streamId` in the pipeline
+     * of index `pipelineIndex`, see pipelineOf()
+    */
+    void record(Stage* stage, unsigned streamId, unsigned frameId, uint64_t begin, uint64_t end, uint32_t pipelineIndex = 0) {
+        if (!stage || !enabled()) {
+            return;
+        }
+        pipelineIndex = pipelineIndex < MAX_PIPELINE_NUM ? pipelineIndex : 0;
+        const uint64_t duration = end > begin ? end - begin : 0;
+        stage->total.record(duration);
+        LatencyHistogram* hist = stage->stream(pipelineIndex, streamId);
+        if (hist) {
+            hist->record(duration);
+        }
+        localRing().push({stage->name.c_str(), begin, duration, m_pipelineHandles[pipelineIndex].load(std::memory_order_relaxed),
+                          streamId, frameId, TraceEvent::COMPLETE});
+    }
+
+    /**
+     * @brief add `delta` to gauge, e.g. +1 when a frame is queued and -1 when it leaves
+    */
+    void addGauge(Gauge* gauge, int64_t delta, unsigned streamId = 0) {
+        if (!gauge) {
+            return;
+        }
+        // gauges are always maintained so that the value stays consistent if tracing is enabled later
+        const int64_t value = gauge->value.fetch_add(delta, std::memory_order_relaxed) + delta;
+        int64_t peak = gauge->peak.load(std::memory_order_relaxed);
+        while (value > peak && !gauge->peak.compare_exchange_weak(peak, value, std::memory_order_relaxed)) {
+        }
+        if (enabled()) {
+            localRing().push({gauge->name.c_str(), now(), (uint64_t)std::max<int64_t>(value, 0), 0, streamId, 0, TraceEvent::COUNTER});
+        }
+    }
+
+    /**
+     * @brief export histograms and gauges as json:
+     * {"enabled":true,"stages":[{"name":...,"total":{...},"streams":[{"pipelineId":0,"streamId":0,...}]}],"gauges":[...]}
+     * latency values are in microseconds, pipelineId is the job handle of a pipeline still registered, 0 for the others
+    */
+    std::string exportStats() {
+        std::vector<Stage*> stages;
+        std::vector<Gauge*> gauges;
+        {
+            std::lock_guard<std::mutex> lg(m_registryMutex);
+            for (auto& stage : m_stages) {
+                stages.push_back(stage.get());
+            }
+            for (auto& gauge : m_gauges) {
+                gauges.push_back(gauge.get());
+            }
+        }
+
+        std::ostringstream ss;
+        ss << "{\"enabled\":" << (enabled() ? "true" : "false") << ",\"stages\":[";
+        for (size_t i = 0; i < stages.size(); i ++) {
+            ss << (i ? "," : "") << "{\"name\":\"" << escape(stages[i]->name) << "\",\"total\":";
+            writeSummary(ss, stages[i]->total.summarize());
+            ss << ",\"streams\":[";
+            bool first = true;
+            for (unsigned slot = 0; slot < MAX_STREAM_NUM; slot ++) {
+                LatencyHistogram* hist = stages[i]->streams[slot].load(std::memory_order_acquire);
+                if (!hist) {
+                    continue;
+                }
+                // slots of unregistered pipelines are kept for the next pipeline of the same index
+                const LatencyHistogram::Summary summary = hist->summarize();
+                if (summary.count == 0) {
+                    continue;
+                }
+                const uint64_t key = stages[i]->streamKeys[slot].load(std::memory_order_acquire);
+                ss << (first ? "" : ",") << "{\"pipelineId\":" << m_pipelineHandles[key >> 32].load(std::memory_order_relaxed)
+                   << ",\"streamId\":" << (key & 0xFFFFFFFFu) << ",\"latency\":";
+                writeSummary(ss, summary);
+                ss << "}";
+                first = false;
+            }
+            ss << "]}";
+        }
+        ss << "],\"gauges\":[";
+        for (size_t i = 0; i < gauges.size(); i ++) {
+            ss << (i ? "," : "") << "{\"name\":\"" << escape(gauges[i]->name) << "\",\"value\":"
+               << gauges[i]->value.load(std::memory_order_relaxed) << ",\"peak\":"
+               << gauges[i]->peak.load(std::memory_order_relaxed) << "}";
+        }
+        ss << "]}";
+        return ss.str();
+    }
+
+    /**
+     * @brief export recent events of all threads in chrome trace event format,
+     * which can be loaded by chrome://tracing or https://ui.perfetto.dev
+    */
+    std::string exportChromeTrace() {
+        std::vector<std::shared_ptr<TraceRing>> rings;
+        {
+            std::lock_guard<std::mutex> lg(m_registryMutex);
+            rings = m_rings;
+        }
+
+        std::ostringstream ss;
+        ss << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        bool first = true;
+        std::vector<TraceEvent> events;
+        for (const auto& ring : rings) {
+            events.clear();
+            ring->snapshot(events);
+            for (const auto& event : events) {
+                ss << (first ? "" : ",");
+                first = false;
+                char ts[32];
+                std::snprintf(ts, sizeof(ts), "%.3f", (double)event.timestamp / 1000.0);
+                if (event.phase == TraceEvent::COMPLETE) {
+                    char dur[32];
+                    std::snprintf(dur, sizeof(dur), "%.3f", (double)event.value / 1000.0);
+                    ss << "{\"name\":\"" << escape(event.name) << "\",\"cat\":\"node\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+                       << ring->tid() << ",\"ts\":" << ts << ",\"dur\":" << dur
+                       << ",\"args\":{\"pipelineId\":" << event.pipelineId << ",\"streamId\":" << event.streamId
+                       << ",\"frameId\":" << event.frameId << "}}";
+                }
+                else {
+                    ss << "{\"name\":\"" << escape(event.name) << "\",\"cat\":\"gauge\",\"ph\":\"C\",\"pid\":1,\"tid\":"
+                       << ring->tid() << ",\"ts\":" << ts << ",\"args\":{\"value\":" << event.value << "}}";
+                }
+            }
+        }
+        ss << "]}";
+        return ss.str();
+    }
+
+    /**
+     * @brief clear all histograms and trace rings, gauges are kept as they reflect current state
+    */
+    void reset() {
+        std::lock_guard<std::mutex> lg(m_registryMutex);
+        for (auto& stage : m_stages) {
+            stage->total.reset();
+            for (auto& stream : stage->streams) {
+                LatencyHistogram* hist = stream.load(std::memory_order_acquire);
+                if (hist) {
+                    hist->reset();
+                }
+            }
+        }
+        for (auto& ring : m_rings) {
+            ring->clear();
+        }
+    }
+
+private:
+    LatencyTracer(): m_enabled(false), m_nextTid(0) {
+        for (auto& handle : m_pipelineHandles) {
+            handle.store(0, std::memory_order_relaxed);
+        }
+        for (uint32_t index = MAX_PIPELINE_NUM - 1; index > 0; index --) {
+            m_freePipelineIndex.push_back(index);
+        }
+    }
+
+    ~LatencyTracer() = default;
+
+    LatencyTracer(const LatencyTracer&) = delete;
+    LatencyTracer& operator=(const LatencyTracer&) = delete;
+
+    /**
+     * @brief returns the ring of an exiting thread, so that its events can still be exported and the ring is
+     * reused by the next thread instead of allocating another one
+    */
+    struct LocalRing {
+        std::shared_ptr<TraceRing> ring;
+
+        ~LocalRing() {
+            if (ring) {
+                LatencyTracer::getInstance().releaseRing(std::move(ring));
+            }
+        }
+    };
+
+    /**
+     * @brief ring of the calling thread, taken on first use from the rings released by exited threads,
+     * or registered if there is none
+    */
+    TraceRing& localRing() {
+        thread_local LocalRing local;
+        if (!local.ring) {
+            std::lock_guard<std::mutex> lg(m_registryMutex);
+            if (!m_freeRings.empty()) {
+                local.ring = std::move(m_freeRings.back());
+                m_freeRings.pop_back();
+            }
+            else {
+                local.ring = std::make_shared<TraceRing>(m_nextTid ++);
+                m_rings.push_back(local.ring);
+            }
+        }
+        return *local.ring;
+    }
+
+    void releaseRing(std::shared_ptr<TraceRing> ring) {
+        std::lock_guard<std::mutex> lg(m_registryMutex);
+        m_freeRings.push_back(std::move(ring));
+    }
+
+    static void writeSummary(std::ostringstream& ss, const LatencyHistogram::Summary& summary) {
+        char buf[256];
+        std::snprintf(buf, sizeof(buf),
+                      "{\"count\":%lu,\"mean\":%.3f,\"min\":%.3f,\"p50\":%.3f,\"p90\":%.3f,\"p99\":%.3f,\"p999\":%.3f,\"max\":%.3f}",
+                      (unsigned long)summary.count, summary.mean / 1000.0, summary.min / 1000.0, summary.p50 / 1000.0,
+                      summary.p90 / 1000.0, summary.p99 / 1000.0, summary.p999 / 1000.0, summary.max / 1000.0);
+        ss << buf;
+    }
+
+    static std::string escape(const std::string& str) {
+        std::string out;
+        out.reserve(str.size());
+        for (char c : str) {
+            if (c == '"' || c == '\\') {
+                out.push_back('\\');
+                out.push_back(c);
+            }
+            else if ((unsigned char)c < 0x20) {
+                out.push_back(' ');
+            }
+            else {
+                out.push_back(c);
+            }
+        }
+        return out;
+    }
+
+    std::atomic<bool> m_enabled;
+
+    std::mutex m_registryMutex;
+    std::deque<std::unique_ptr<Stage>> m_stages;
+    std::unordered_map<std::string, Stage*> m_stageIndex;
+    std::deque<std::unique_ptr<Gauge>> m_gauges;
+    std::unordered_map<std::string, Gauge*> m_gaugeIndex;
+    std::vector<std::shared_ptr<TraceRing>> m_rings;
+    std::vector<std::shared_ptr<TraceRing>> m_freeRings;            // rings of exited threads, all in m_rings as well
+    uint32_t m_nextTid;
+
+    std::mutex m_pipelineMutex;                                     // taken on registration, never on recording
+    std::unordered_map<const void*, uint32_t> m_nodePipelines;     // node to pipeline id, see registerNode()
+    std::unordered_map<uint32_t, uint32_t> m_pipelineIndex;        // pipeline id to pipeline index
+    std::vector<uint32_t> m_freePipelineIndex;
+    std::array<std::atomic<uint32_t>, MAX_PIPELINE_NUM> m_pipelineHandles;  // pipeline index to pipeline id
+};
+
+/**
+ * @brief records the enclosing scope as one execution of `stage`
+ * @param pipelineIndex index of the pipeline recording, cached from LatencyTracer::pipelineOf() by the node worker
+*/
+class LatencyScope {
+public:
+    LatencyScope(LatencyTracer::Stage* stage, unsigned streamId, unsigned frameId, uint32_t pipelineIndex = 0)
+        : m_stage(LatencyTracer::getInstance().enabled() ? stage : nullptr), m_streamId(streamId), m_frameId(frameId),
+          m_pipelineIndex(pipelineIndex), m_begin(m_stage ? LatencyTracer::now() : 0) { }
+
+    ~LatencyScope() {
+        if (m_stage) {
+            LatencyTracer::getInstance().record(m_stage, m_streamId, m_frameId, m_begin, LatencyTracer::now(), m_pipelineIndex);
+        }
+    }
+
+    LatencyScope(const LatencyScope&) = delete;
+    LatencyScope& operator=(const LatencyScope&) = delete;
+
+private:
+    LatencyTracer::Stage* m_stage;
+    unsigned m_streamId;
+    unsigned m_frameId;
+    uint32_t m_pipelineIndex;
+    uint64_t m_begin;
+};
+
+}   // namespace inference
+
+}   // namespace ai
+
+}   // namespace hce
+
+#endif //#ifndef HCE_AI_INF_LATENCY_TRACER_HPP
@@ -30,6 +30,7 @@
 #include <inc/buffer/hvaVideoFrameWithROIBuf.hpp>
 
 #include "common/context.h"
+#include "common/latency_tracer.hpp"
 #include "nodes/databaseMeta.hpp"
 #include "inference_nodes/base/image_inference_instance.hpp"
 
@@ -48,6 +49,7 @@
 #define DEFAULT_BATCH_SIZE 0
 #define DEFAULT_RESHAPE_WIDTH 0
 #define DEFAULT_RESHAPE_HEIGHT 0
+#define DEFAULT_ROI_BATCHING false
 
 namespace hce{
 
@@ -241,9 +243,29 @@ protected:
     */
     bool validateInput(hva::hvaBlob_t::Ptr& blob);
 
+    /**
+     * @brief should be called by the derived class nodes workers once all inferences on a frame
+     * are completed and the frame is sent, right before releasing `depleting` status
+     * @param input the completed input
+    */
+    void onFrameCompleted(const hva::hvaBlob_t::Ptr& input);
+
 private:
     std::unordered_map<unsigned, std::pair<int, int>> m_streamEndFlags;
 
+    // latency tracing, see common/latency_tracer.hpp
+    LatencyTracer::Stage* m_submitStage;            // submission of one frame
+    LatencyTracer::Stage* m_inferenceStage;         // one inference request, from submission to completion
+    LatencyTracer::Gauge* m_pendingFramesGauge;     // frames waiting for inference results
+    uint32_t m_pipelineIndex;                       // workers are created on prepare, after nodes are registered
+
+    /**
+     * @brief inference completion callback, records latency and calls processOutput()
+    */
+    void onInferenceCompleted(
+        std::map<std::string, InferenceBackend::OutputBlob::Ptr> blobs,
+        std::vector<std::shared_ptr<InferenceBackend::ImageInference::IFrameBase>> frames);
+
     /**
      * @brief should be implemented in the derived class nodes workers. 
      *        it would be called at the end of each process() to send outputs to the downstream nodes.
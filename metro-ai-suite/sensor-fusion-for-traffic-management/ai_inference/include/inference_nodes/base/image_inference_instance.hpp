@@ -23,6 +23,7 @@
 #include "utils.h"
 #include "common/context.h"
 #include "common/common.hpp"
+#include "common/latency_tracer.hpp"
 
 #include "nodes/databaseMeta.hpp"
 #include "inference_backend/buffer_mapper.h"
@@ -102,6 +103,9 @@ typedef struct _InferenceProperty {
     unsigned int image_width;
     unsigned int image_height;
 
+    bool roi_batching;                              // submit all rois of one frame as batched requests, and share
+                                                        // crop + resize among models with the same input size
+
 } InferenceProperty;
 
 struct InferenceFrame {
@@ -154,6 +158,12 @@ public:
 
     InferenceStatus SubmitInference(const InferenceProperty& inference_property, hva::hvaBlob_t::Ptr& input);
 
+    /**
+     * @brief start the pending partially filled batch request in roi batching mode, so that
+     * rois of the submitted inputs do not wait for rois of following inputs
+    */
+    void SubmitPendingBatch();
+
     struct InferenceResult : public InferenceBackend::ImageInference::IFrameBase {
         void SetImage(InferenceBackend::ImagePtr image_) override {
             image = image_;
@@ -166,6 +176,7 @@ public:
         std::shared_ptr<InferenceBackend::Image> image;
         hva::hvaBlob_t::Ptr input;
         size_t region_count;
+        uint64_t submit_timestamp;          // ns, LatencyTracer::now() when the request is made
     };
 
 private:
@@ -179,12 +190,33 @@ private:
     InferenceBackend::ImageInference::CallbackFunc m_callback_func;
     InferenceBackend::ImageInference::ErrorHandlingFunc m_callback_func_error_handle;
 
+    // roi batching: crops are resized once per frame and shared among models with the same input size
+    bool m_roi_batching = false;
+    bool m_share_roi_preproc = false;
+    size_t m_model_input_width = 0;
+    size_t m_model_input_height = 0;
+
     InferenceStatus SubmitImages(const InferenceProperty& inference_property,
                       const std::vector<VideoRegionOfInterestMeta>& metas,
                       hva::hvaBlob_t::Ptr& input);
 
     inline std::shared_ptr<Allocator> CreateAllocator(const std::string allocator_name);
 
+    /**
+     * @brief check whether the roi crop + resize of this model can be shared with other models,
+     * i.e. default opencv pre-processing on system memory without custom image pre-processing
+    */
+    bool IsRoiPreprocShareable(const InferenceProperty& inference_property);
+
+    /**
+     * @brief get the roi image cropped and resized to model input size, the resized crop is cached in
+     * frame meta so that following models with the same input size reuse it
+     * @return image covering the whole resized crop, nullptr if the roi can not be cropped
+    */
+    std::shared_ptr<InferenceBackend::Image> GetSharedRoiImage(hva::hvaVideoFrameWithROIBuf_t::Ptr& buffer,
+                                                               const std::shared_ptr<InferenceBackend::Image>& image,
+                                                               const VideoRegionOfInterestMeta& meta);
+
     unsigned int GetOptimalBatchSize(std::string device);
 
     void UpdateModelReshapeInfo(InferenceProperty& inference_property);
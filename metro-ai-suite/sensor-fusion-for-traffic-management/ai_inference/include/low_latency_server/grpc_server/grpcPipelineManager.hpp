@@ -16,13 +16,22 @@
 #define HCE_AI_INF_LL_GRPC_PIPELINE_MANAGER_HPP
 
 #include <vector>
+#include <list>
 #include <unordered_map>
+#include <atomic>
+#include <mutex>
 
 #include "common/common.hpp"
 #include "nodes/base/baseResponseNode.hpp"
 #include "low_latency_server/pipelineManager.hpp"
 #include "low_latency_server/grpc_server/grpcServer.hpp"
 
+// run cost estimate of a config not measured yet, per unit of suggested weight, in milliseconds
+#define RUN_COST_DEFAULT_MS 100.0
+// weight of the latest measurement in the smoothed run cost
+#define RUN_COST_SMOOTHING_FACTOR 0.2
+#define RUN_COST_TABLE_MAX_SIZE 1024
+
 namespace hce{
 
 namespace ai{
@@ -80,18 +89,24 @@ public:
     *     set to equal to number of input files
     * @param streamNum: An unsigned integer value to enable cross-stream inference on the workload of the pipeline submitted. 
     *                  default as 1, this would degrade to the default configuration: one pipeline for one stream.
+    * @param priority admission priority, runs on a best-effort pipeline may be preempted by real-time tasks
+    * @param clientId client identity for fair-share admission
     * @return hceAiSuccess upon success
     * 
     */
-    hceAiStatus_t submitLoadPipeline(const std::string& pipelineConfig, GrpcServer::Handle commHandle, Handle& jobHandle, unsigned suggestedWeight = 0, unsigned streamNum = 1);
+    hceAiStatus_t submitLoadPipeline(const std::string& pipelineConfig, GrpcServer::Handle commHandle, Handle& jobHandle, unsigned suggestedWeight = 0, unsigned streamNum = 1,
+            Priority priority = PRIORITY_NORMAL, const std::string& clientId = "");
 
     /**
      * @brief register coming task as Task::TASK_RUN, an existing pipeline is expected
      * @param mediaUris inputs to process
      * @param jobHandle jobHandle to identify an existing pipeline
      * @param commHandle coming tcp connection handle
+     * @param priority admission priority
+     * @param clientId client identity for fair-share admission
     */
-    hceAiStatus_t submitRun(const std::vector<std::string>& mediaUris, Handle jobHandle, GrpcServer::Handle commHandle);
+    hceAiStatus_t submitRun(const std::vector<std::string>& mediaUris, Handle jobHandle, GrpcServer::Handle commHandle,
+            Priority priority = PRIORITY_NORMAL, const std::string& clientId = "");
 
     /**
      * @brief register coming task as Task::TASK_UNLOAD, to destroy an existing pipeline
@@ -100,7 +115,8 @@ public:
      * @param streamNum: An unsigned integer value to enable cross-stream inference on the workload of the pipeline submitted. 
      *                  default as 1, this would degrade to the default configuration: one pipeline for one stream.
     */
-    hceAiStatus_t submitAutoRun(const std::vector<std::string>& mediaUris, const std::string& pipelineConfig, GrpcServer::Handle commHandle, unsigned suggestedWeight = 0, unsigned streamNum = 1);
+    hceAiStatus_t submitAutoRun(const std::vector<std::string>& mediaUris, const std::string& pipelineConfig, GrpcServer::Handle commHandle, unsigned suggestedWeight = 0, unsigned streamNum = 1,
+            Priority priority = PRIORITY_NORMAL, const std::string& clientId = "");
 
     /**
      * @brief register coming task as Task::TASK_AUTO_RUN
@@ -111,6 +127,15 @@ public:
      * @param suggestedWeight task weight
     */
     hceAiStatus_t submitUnloadPipeline(Handle jobHandle, GrpcServer::Handle commHandle);
+
+    /**
+     * @brief set the number of idle pipelines kept warm per pipeline config. Pipelines loaded by auto run
+     * requests stay in the pool once idle, the most recently used ones of each config are exempted from
+     * lifetime expiry up to this number, idle pipelines are still evicted whenever another request needs
+     * their resources. Should be called before start()
+     * @param warmPipelinesPerConfig number of idle pipelines per config, 0 to let all idle pipelines expire
+    */
+    void setWarmPipelinesPerConfig(unsigned warmPipelinesPerConfig);
     
 private:
     
@@ -122,11 +147,29 @@ private:
     public:
         using Ptr = std::shared_ptr<PipelineInfo>;
         using WeakPtr = std::weak_ptr<PipelineInfo>;
-        PipelineInfo() = default;
+        PipelineInfo():autoLoaded(false), pendingRuns(0u), lastFinish(0u){ };
 
         ~PipelineInfo() = default;
 
         std::list<GrpcServer::Handle> commHandle;
+
+        // fair-share accounting and priority of a run, in the same order as commHandle
+        struct RunRecord{
+            std::string clientId;
+            uint64_t submitTime;    // using std::chrono::milliseconds
+            double chargedCost;     // estimated service charged to the client at admission
+            Priority priority;
+        };
+
+        std::string configKey;                  // canonical pipeline config, see canonicalizeConfig()
+        std::list<Handle>::iterator configIter; // position in m_configIndex[configKey]
+        bool autoLoaded;                        // loaded by an auto run request, i.e. no client holds its handle
+        std::atomic<unsigned> pendingRuns;      // runs submitted and not finished yet, 0 means idle
+
+        std::mutex runMutex;                    // guards runRecords, priorities and lastFinish
+        std::list<RunRecord> runRecords;
+        RunPriorities priorities;               // best-effort pipelines may be preempted
+        uint64_t lastFinish;                    // finish time of the previous run, using std::chrono::milliseconds
     };
 
     class LoadTaskInfo: public Task{
@@ -141,6 +184,7 @@ private:
         };
 
         std::string pipelineConfig;
+        std::string configKey;
         Handle jobHandle;
         unsigned suggestedWeight;
         unsigned streamNum;
@@ -194,6 +238,7 @@ private:
 
         std::vector<std::string> mediaUris;
         std::string pipelineConfig;
+        std::string configKey;
         unsigned suggestedWeight;
         unsigned streamNum;
         
@@ -262,6 +307,16 @@ private:
 
                 GrpcServer::getInstance().replyFinish(sp->commHandle.back());
                 sp->commHandle.pop_back();
+
+                // the next queued run on this pipeline is served from now on
+                applyResultFormat(*sp);
+
+                GrpcPipelineManager::getInstance().onRunFinished(*sp);
+
+                if(sp->pendingRuns.fetch_sub(1) == 1){
+                    // pipeline turns idle, tasks deferred for lack of resources may take it
+                    GrpcPipelineManager::getInstance().notifyResourceEvent();
+                }
             }
             else{
                 _WRN("Pipeline no longer exists at response finish");
@@ -291,6 +346,79 @@ private:
     */
     hvaPipelinePtr run(PipelineInfo::Ptr plInfo, const std::string& pipelionConfig);
 
+    /**
+     * @brief apply the result format requested by the run currently served on this pipeline,
+     * i.e. commHandle.back(), to its output node
+     * @param plInfo pipeline info
+    */
+    static void applyResultFormat(PipelineInfo& plInfo);
+
+    /**
+     * @brief normalize a pipeline config so that configs differing only in json formatting or
+     * object key order share the same pool key
+     * @param pipelineConfig ai inference pipeline description
+     * @param streamNum stream number the pipeline is built for
+     * @return the key used in m_configIndex
+    */
+    static std::string canonicalizeConfig(const std::string& pipelineConfig, unsigned streamNum);
+
+    /**
+     * @brief queue a run on a pipeline: register the client and send the media inputs split by stream
+     * m_workListMutex should be held by caller
+    */
+    void dispatchRun(PipelineInfo& plInfo, const std::vector<std::string>& mediaUris, GrpcServer::Handle commHandle, const Task& task);
+
+    /**
+     * @brief calibrate the run cost of the pipeline config by the measured service time of the finished run,
+     * and correct the estimate charged to its client
+    */
+    void onRunFinished(PipelineInfo& plInfo);
+
+    /**
+     * @brief estimated service time of a run in milliseconds, smoothed over finished runs of the same config
+    */
+    double estimateRunCost(const PipelineInfo& plInfo);
+
+    /**
+     * @brief add a pipeline to m_workList and m_configIndex. m_workListMutex should be held by caller
+    */
+    void addToWorkList(const PipelineInfo::Ptr& plInfo);
+
+    /**
+     * @brief stop a pipeline, remove it from m_workList and m_configIndex and release its resources
+     * m_workListMutex should be held by caller
+    */
+    void removeFromWorkList(Handle jobHandle);
+
+    /**
+     * @brief find an idle auto-loaded pipeline built from the config, the least recently used first
+     * m_workListMutex should be held by caller
+     * @return nullptr if there is none
+    */
+    PipelineInfo::Ptr findIdlePipeline(const std::string& configKey);
+
+    /**
+     * @brief find the least recently used pipeline built from the config, idle or not
+     * m_workListMutex should be held by caller
+     * @return nullptr if there is none
+    */
+    PipelineInfo::Ptr findEldestPipeline(const std::string& configKey);
+
+    /**
+     * @brief evict idle auto-loaded pipelines of other configs until the weight can be acquired, nothing is
+     * evicted if the weight can not be acquired even with all of them evicted. m_workListMutex should be held by caller
+     * @return true if the weight is acquired
+    */
+    bool acquireResourceByEviction(unsigned weightToAcquire, const std::string& configKey);
+
+    /**
+     * @brief stop best-effort pipelines, idle ones and the least recently used first, until the weight can be acquired.
+     * runs pending on them are replied with error. nothing is stopped if the weight can not be acquired even with all
+     * of them stopped. m_workListMutex should be held by caller
+     * @return true if the weight is acquired
+    */
+    bool acquireResourceByPreemption(unsigned weightToAcquire);
+
     /**
      * @brief reply for request: load_pipeline
      * @param client coming tcp connection handle
@@ -329,6 +457,15 @@ private:
     std::unordered_map<Handle, PipelineInfo::Ptr, std::hash<Handle>, std::equal_to<Handle>, 
             boost::fast_pool_allocator<std::pair<Handle, PipelineInfo::Ptr>>> m_workList;
 
+    // handles of pipelines in m_workList grouped by config key, least recently used first
+    std::unordered_map<std::string, std::list<Handle>> m_configIndex;
+
+    unsigned m_warmPipelinesPerConfig;
+
+    // smoothed service time of a run in milliseconds by config key
+    std::mutex m_runCostMutex;
+    std::unordered_map<std::string, double> m_runCost;
+
 };
 
 }
@@ -33,7 +33,8 @@ public:
 
     struct CommConfig{
         std::string serverAddr;
-        unsigned threadPoolSize = 1;
+        unsigned threadPoolSize = 1;        // polling threads, each with its own completion queue
+        std::size_t replyQueueDepth = 0;    // max replies cached per connection while the client falls behind, 0 means unbounded
     };
 
     ~GrpcServer();
@@ -56,6 +57,11 @@ public:
 
     hceAiStatus_t replyFinish(Handle handle);
 
+    /**
+     * @brief result format requested by the client of this connection
+    */
+    baseResponseNode::ResultFormat_t getResultFormat(Handle handle);
+
     void stop();
 
 private:
@@ -0,0 +1,84 @@
+/*
+ * INTEL CONFIDENTIAL
+ *
+ * Copyright (C) 2024 Intel Corporation.
+ *
+ * This software and the related documents are Intel copyrighted materials, and your use of
+ * them is governed by the express license under which they were provided to you (License).
+ * Unless the License provides otherwise, you may not use, modify, copy, publish, distribute,
+ * disclose or transmit this software or the related documents without Intel's prior written permission.
+ *
+ * This software and the related documents are provided as is, with no express or implied warranties,
+ * other than those that are expressly stated in the License.
+*/
+
+#ifndef HCE_AI_INF_GRPC_REPLY_BACKPRESSURE_HPP
+#define HCE_AI_INF_GRPC_REPLY_BACKPRESSURE_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+
+namespace hce{
+
+namespace ai{
+
+namespace inference{
+
+/**
+ * @brief backpressure of a lossless reply stream: a producer is held while the reply queue is full, for a bounded
+ * time at most. Nothing is dropped here, a producer timing out reports the stream exhausted and the caller ends it
+*/
+class ReplyBackpressure{
+public:
+    enum Result_t{
+        REPLY_READY = 0,        // the queue has room for the reply
+        REPLY_EXHAUSTED,        // the queue stayed full for the max wait, the client stalled
+        REPLY_CLOSED            // the stream is no longer writable
+    };
+
+    /**
+     * @param maxWait max time a producer is held on a full queue
+     * @param recheckInterval interval the producer rechecks the stream state while waiting
+    */
+    ReplyBackpressure(std::chrono::milliseconds maxWait, std::chrono::milliseconds recheckInterval):
+            m_maxWait(maxWait), m_recheckInterval(recheckInterval){ };
+
+    /**
+     * @brief hold the producer until the queue has room
+     *
+     * @param lk lock on the mutex guarding the queue, held on return
+     * @param cv signaled whenever a queued reply is sent
+     * @param full returns true while the queue is full, called with lk held
+     * @param active returns false once the stream is no longer writable, called with lk held
+     * @return REPLY_READY, REPLY_EXHAUSTED or REPLY_CLOSED
+    */
+    template<typename Full, typename Active>
+    Result_t wait(std::unique_lock<std::mutex>& lk, std::condition_variable& cv, Full full, Active active) const{
+        auto deadline = std::chrono::steady_clock::now() + m_maxWait;
+        while(full()){
+            if(!active()){
+                return REPLY_CLOSED;
+            }
+            auto now = std::chrono::steady_clock::now();
+            if(now >= deadline){
+                return REPLY_EXHAUSTED;
+            }
+            cv.wait_for(lk, std::min<std::chrono::steady_clock::duration>(m_recheckInterval, deadline - now));
+        }
+        return REPLY_READY;
+    };
+
+private:
+    std::chrono::milliseconds m_maxWait;
+    std::chrono::milliseconds m_recheckInterval;
+};
+
+}
+
+}
+
+}
+
+#endif //#ifndef HCE_AI_INF_GRPC_REPLY_BACKPRESSURE_HPP
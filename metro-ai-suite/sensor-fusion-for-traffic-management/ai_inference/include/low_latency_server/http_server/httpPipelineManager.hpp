@@ -209,7 +209,7 @@ private:
     class _restReplyListener: public baseResponseNode::EmitListener{
     public:
         _restReplyListener(PipelineInfo::WeakPtr plInfo)
-                :baseResponseNode::EmitListener(), m_plInfo(plInfo){ };
+                :baseResponseNode::EmitListener(), m_plInfo(plInfo), m_frameFailed(false){ };
 
         virtual ~_restReplyListener() override{
             if(auto sp = m_plInfo.lock()){
@@ -241,8 +241,12 @@ private:
             if(auto sp = m_plInfo.lock()){
                 sp->heartbeat = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
                 boost::property_tree::ptree res_frame;
-                std::stringstream ss(res.message); 
+                std::stringstream ss(res.getMessage()); 
                 boost::property_tree::read_json(ss, res_frame);
+                // negative status codes are failures, e.g. -2 on a frame failed to decode
+                if(res_frame.get<int>("status_code", 0) < 0){
+                    m_frameFailed = true;
+                }
                 m_frames.push_back(std::make_pair("", res_frame));
             }
             else{
@@ -269,7 +273,8 @@ private:
                 if(sp->commHandle.empty()){
                     _ERR("Pipeline with handle {} has no comm handle!", sp->jobHandle);
                 }
-                HttpServerLowLatency::getInstance().reply(sp->commHandle.back(), 200, ss.str());
+                // failures may be transient, only replies with all frames succeeded are cached
+                HttpServerLowLatency::getInstance().reply(sp->commHandle.back(), 200, ss.str(), !m_frameFailed);
                 sp->commHandle.pop_back();
             }
             else{
@@ -277,6 +282,7 @@ private:
             }
             m_frames.clear();
             m_jsonTree.clear();
+            m_frameFailed = false;
         };
 
     private:
@@ -284,6 +290,7 @@ private:
         boost::property_tree::ptree m_jsonTree;
         boost::property_tree::ptree m_frames;
         std::mutex m_mutex;                         // thread-safe
+        bool m_frameFailed;                         // any frame of the current request failed
     };
     
     /**
@@ -335,10 +342,22 @@ private:
     boost::object_pool<PipelineInfo> m_plInfoPool;
     boost::object_pool<_restReplyListener> m_rrlPool;
     
+    /**
+     * @brief allocate a task from one of the task pools below
+     * tasks are submitted concurrently by every http server loop and released by pipeline manager threads
+    */
+    template<typename T>
+    std::shared_ptr<T> makeTask(boost::object_pool<T>& pool){
+        std::lock_guard<std::mutex> lg(m_taskPoolMutex);
+        return std::shared_ptr<T>(pool.construct(),
+                [this, &pool](T* ptr){ std::lock_guard<std::mutex> lg(m_taskPoolMutex); pool.destroy(ptr); });
+    }
+
     boost::object_pool<LoadTaskInfo> m_ltiPool;
     boost::object_pool<RunTaskInfo> m_rtiPool;
     boost::object_pool<UnloadTaskInfo> m_utiPool;
     boost::object_pool<AutoRunTaskInfo> m_artiPool;
+    std::mutex m_taskPoolMutex;
     
     std::unordered_map<Handle, PipelineInfo::Ptr, std::hash<Handle>, std::equal_to<Handle>, 
             boost::fast_pool_allocator<std::pair<Handle, PipelineInfo::Ptr>>> m_workList;
@@ -17,6 +17,8 @@
 
 #include "common/common.hpp"
 
+#define HCE_AI_HTTP_DEFAULT_MAX_BODY_SIZE (64u * 1024u * 1024u)
+
 namespace hce{
 
 namespace ai{
@@ -42,11 +44,24 @@ public:
 
     static HttpServerLowLatency& getInstance();
 
-    hceAiStatus_t init(const std::string& address, unsigned port);
+    /**
+     * @brief initialize the server
+     * @param address listening address
+     * @param port listening port
+     * @param maxBodySize max size in bytes of a request body, larger requests are rejected
+     * @param loopCount number of event loops, each on its own thread. With more than one loop,
+     *                  every loop listens on the same address and port through SO_REUSEPORT
+    */
+    hceAiStatus_t init(const std::string& address, unsigned port, std::size_t maxBodySize = HCE_AI_HTTP_DEFAULT_MAX_BODY_SIZE,
+                       unsigned loopCount = 1);
 
     hceAiStatus_t run();
 
-    hceAiStatus_t reply(ClientDes client, unsigned code, const std::string& reply);
+    /**
+     * @brief reply to a client, a 200 reply to a cacheable request is stored in ResultCache
+     * @param cacheable false if the reply should not be cached, e.g. it carries failed frames
+    */
+    hceAiStatus_t reply(ClientDes client, unsigned code, const std::string& reply, bool cacheable = true);
 
     void stop();
 
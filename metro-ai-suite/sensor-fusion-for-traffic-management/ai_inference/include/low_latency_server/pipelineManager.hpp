@@ -42,6 +42,9 @@
 #define PIPELINE_INFO_POOL_INIT_COUNT 32
 #define PIPELINE_POOL_INIT_COUNT 24
 
+// clients at the virtual clock or behind are dropped from the table beyond this size, see chargeClient()
+#define CLIENT_VIRTUAL_TIME_PRUNE_SIZE 1024
+
 namespace hce{
 
 namespace ai{
@@ -52,6 +55,60 @@ class HCE_AI_DECLSPEC PipelineManager{
 public:
     using Handle = uint32_t;
 
+    /**
+     * @brief admission priority of a task, tasks of a higher priority are always admitted first
+    */
+    enum Priority{
+        PRIORITY_REALTIME = 0,      // latency sensitive, may preempt best-effort pipelines
+        PRIORITY_NORMAL,
+        PRIORITY_BEST_EFFORT        // batch analytics, may be preempted by real-time tasks
+    };
+
+    /**
+     * @brief priorities of the runs pending on a shared pipeline. The pipeline takes the highest priority among
+     * its pending runs, so that a run of a lower priority never lowers the priority of a busy pipeline, and the
+     * pipeline is preemptible only when all its pending runs are best-effort. An idle pipeline keeps the priority
+     * of its latest run. Not thread-safe, guarded by the owner
+    */
+    class RunPriorities{
+    public:
+        RunPriorities(Priority initial = PRIORITY_NORMAL):m_pending{0u, 0u, 0u}, m_latest(initial){ };
+
+        /**
+         * @brief a run of `priority` is queued on the pipeline
+        */
+        void add(Priority priority){
+            ++m_pending[priority];
+            m_latest = priority;
+        };
+
+        /**
+         * @brief a run of `priority` is finished
+        */
+        void remove(Priority priority){
+            if(m_pending[priority] > 0){
+                --m_pending[priority];
+            }
+        };
+
+        Priority current() const{
+            for(unsigned i = PRIORITY_REALTIME; i <= PRIORITY_BEST_EFFORT; ++i){
+                if(m_pending[i] > 0){
+                    return (Priority)i;
+                }
+            }
+            return m_latest;
+        };
+
+        bool preemptible() const{
+            return current() == PRIORITY_BEST_EFFORT;
+        };
+
+    private:
+        unsigned m_pending[PRIORITY_BEST_EFFORT + 1];   // pending runs by priority
+        Priority m_latest;                              // priority of the latest run
+    };
+
     ~PipelineManager();
 
     PipelineManager();
@@ -93,6 +150,14 @@ public:
 
     uint64_t healthCheck() const;
 
+    /**
+     * @brief set the relative shares of clients for fair-share admission within the same priority.
+     * each client receives service in proportion to its share, clients not listed have share 1.
+     * Should be called before start()
+     * @param clientShares client id to share, shares should be positive
+    */
+    void setClientShares(const std::unordered_map<std::string, double>& clientShares);
+
 protected:
 
     #define _HCE_AI_PIPE_MA_CALLBACK_WRAPPER_NAME(func) func##_wrapper
@@ -135,7 +200,7 @@ protected:
             TASK_AUTO_RUN
         };
 
-        Task(){
+        Task():priority(PRIORITY_NORMAL){
 
         };
 
@@ -144,6 +209,8 @@ protected:
         };
 
         TaskType taskType;
+        Priority priority;
+        std::string clientId;   // fair-share accounting key, empty for anonymous clients
     };
     
     // std::thread m_thread;
@@ -160,6 +227,16 @@ protected:
 
     boost::object_pool<hva::hvaPipeline_t> m_pipelinePool;
     std::list<Task::Ptr, boost::fast_pool_allocator<Task::Ptr>> m_waitingQueue;
+    // tasks that can not proceed for lack of resources, moved back to m_waitingQueue by notifyResourceEvent()
+    std::list<Task::Ptr, boost::fast_pool_allocator<Task::Ptr>> m_deferredQueue;
+    // incremented on each resource event, guarded by m_waitingQueueMutex
+    uint64_t m_resourceEpoch;
+
+    // fair-share admission: service received by each client in milliseconds divided by its share,
+    // guarded by m_waitingQueueMutex
+    std::unordered_map<std::string, double> m_clientShares;
+    std::unordered_map<std::string, double> m_clientVirtualTime;
+    double m_virtualClock;  // virtual time of the latest admitted client, newly active clients start from here
 
     // std::unordered_map<Handle, PipelineInfoHolderBase_t::Ptr, std::hash<Handle>, std::equal_to<Handle>, 
     //         boost::fast_pool_allocator<std::pair<Handle, PipelineInfoHolderBase_t::Ptr>>> m_workList;
@@ -199,12 +276,44 @@ protected:
     */
     void releaseResourceByWorkloadWeight(unsigned weightToAcquire);
 
+    /**
+     * @brief wake up tasks in m_deferredQueue, called whenever resources are released or a pipeline turns idle
+    */
+    void notifyResourceEvent();
+
     /**
      * @brief acquire resources for constructing pipeline
      * if reources (existing workload <m_mMaxConcurrentWorkload) enough, return true
     */
     bool acquireResourceByWorkloadWeight(unsigned weightToAcquire);
 
+    /**
+     * @brief register the nodes listed in "Nodes" of the pipeline config to LatencyTracer under the job handle,
+     * should be called before the pipeline is prepared. Nothing is registered if tracing is disabled
+    */
+    void registerTracedNodes(hva::hvaPipeline_t& pipeline, const std::string& pipelineConfig, Handle jobHandle);
+
+    /**
+     * @brief release the nodes of a stopped pipeline from LatencyTracer
+    */
+    void unregisterTracedNodes(Handle jobHandle);
+
+    /**
+     * @brief pick the task to be processed next in m_waitingQueue: the highest priority first, then the
+     * client with the least virtual time, i.e. the least service received relative to its share,
+     * tasks of the same client in arrival order.
+     * m_waitingQueueMutex should be held by caller
+     * @return m_waitingQueue.end() if m_waitingQueue is empty
+    */
+    std::list<Task::Ptr, boost::fast_pool_allocator<Task::Ptr>>::iterator selectNextTask();
+
+    /**
+     * @brief account the service given to a client. m_waitingQueueMutex should be held by caller
+     * @param clientId client to be charged
+     * @param cost service in milliseconds, may be negative to correct a previous estimate
+    */
+    void chargeClient(const std::string& clientId, double cost);
+
 };
 
 
@@ -0,0 +1,171 @@
+/*
+ * INTEL CONFIDENTIAL
+ *
+ * Copyright (C) 2024 Intel Corporation.
+ *
+ * This software and the related documents are Intel copyrighted materials, and your use of
+ * them is governed by the express license under which they were provided to you (License).
+ * Unless the License provides otherwise, you may not use, modify, copy, publish, distribute,
+ * disclose or transmit this software or the related documents without Intel's prior written permission.
+ *
+ * This software and the related documents are provided as is, with no express or implied warranties,
+ * other than those that are expressly stated in the License.
+*/
+
+#ifndef HCE_AI_INF_LL_RESULT_CACHE_HPP
+#define HCE_AI_INF_LL_RESULT_CACHE_HPP
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "common/common.hpp"
+#include "lru_cache.h"
+
+// per entry bookkeeping accounted on top of the result size
+#define RESULT_CACHE_ENTRY_OVERHEAD 128
+#define RESULT_CACHE_SHARD_COUNT 16
+// local files up to this size are verified by their content on a cache hit, larger ones only by size, inode and
+// modification time
+#define RESULT_CACHE_CONTENT_HASH_MAX_SIZE (64u << 20)
+
+namespace hce{
+
+namespace ai{
+
+namespace inference{
+
+/**
+ * @brief request level cache of pipeline results, keyed by pipeline config and media content.
+ * Repeated requests for the same media on the same pipeline config are replied from here without running
+ * a pipeline. Bounded by the total size in bytes of cached results, least recently used results are evicted
+ * first within each shard of the cache, results older than the ttl are treated as misses. Disabled until init() with a non-zero capacity
+*/
+class HCE_AI_DECLSPEC ResultCache final{
+public:
+    struct Key{
+        uint64_t configHash;
+        uint64_t mediaHash;     // FNV-1a over media uris, and size, inode and modification time of local files
+        uint64_t mediaCheck;    // independently seeded hash over the same, guards against collisions
+
+        bool operator==(const Key& other) const{
+            return configHash == other.configHash && mediaHash == other.mediaHash && mediaCheck == other.mediaCheck;
+        }
+    };
+
+    struct KeyHash{
+        std::size_t operator()(const Key& key) const{
+            return key.mediaHash ^ (key.configHash * 0x9E3779B97F4A7C15ull);
+        }
+    };
+
+    struct Stats{
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t insertions;
+        uint64_t evictions;
+        uint64_t expirations;
+        uint64_t entries;
+        uint64_t bytes;
+        uint64_t capacity;
+    };
+
+    ~ResultCache();
+
+    ResultCache(const ResultCache&) = delete;
+
+    ResultCache(ResultCache&&) = delete;
+
+    ResultCache& operator=(const ResultCache&) = delete;
+
+    ResultCache& operator=(ResultCache&&) = delete;
+
+    static ResultCache& getInstance();
+
+    /**
+     * @brief configure the cache, existing entries are dropped. Not thread-safe against the other calls, should be
+     * called before the server starts
+     * @param capacityBytes max total size of cached results, 0 to disable the cache
+     * @param ttlSeconds lifetime of a cached result, 0 as never expire
+    */
+    void init(std::size_t capacityBytes, unsigned ttlSeconds);
+
+    bool enabled() const{
+        return m_capacity > 0;
+    };
+
+    /**
+     * @brief build the cache key of a request, cheap enough for the http event loop. Media uris carrying the media
+     * inline, e.g. base64 images, are hashed as is. Uris naming a local file are hashed together with the file size,
+     * inode and modification time, files up to RESULT_CACHE_CONTENT_HASH_MAX_SIZE are also returned in contentFiles,
+     * whose content is verified on a cache hit, so that a file rewritten within the modification time granularity
+     * is not served from the cache
+     * @param contentFiles set to the local files to be verified by content
+    */
+    static Key makeKey(const std::string& pipelineConfig, const std::vector<std::string>& mediaUris,
+                       std::vector<std::string>& contentFiles);
+
+    /**
+     * @brief look up a cached result, hit and miss are counted. On a hit the content of contentFiles is read
+     * and compared with the content the result is cached with
+     * @param contentFiles as returned by makeKey()
+     * @param result set to the cached result on hit
+     * @return true on hit
+    */
+    bool lookup(const Key& key, const std::vector<std::string>& contentFiles, std::string& result);
+
+    /**
+     * @brief cache the result of a request, evicting least recently used results until it fits. The content of
+     * contentFiles is hashed along, so it should be called off the http event loop.
+     * Results larger than the capacity of a cache shard are not cached
+     * @param contentFiles as returned by makeKey()
+    */
+    void insert(const Key& key, const std::vector<std::string>& contentFiles, const std::string& result);
+
+    /**
+     * @brief drop all cached results and reset counters
+    */
+    void clear();
+
+    Stats getStats();
+
+    /**
+     * @brief export counters in json
+    */
+    std::string exportStats();
+
+private:
+    ResultCache();
+
+    /**
+     * @brief hash over the content of files
+     * @return false if any file can not be read
+    */
+    static bool hashContent(const std::vector<std::string>& files, uint64_t& hash);
+
+    struct Entry{
+        std::shared_ptr<const std::string> result;
+        uint64_t insertTime;    // in milliseconds
+        uint64_t contentHash;   // over the content of local files of the request
+    };
+
+    std::unique_ptr<ShardedLRUCache<Key, Entry, KeyHash>> m_cache;
+    std::size_t m_capacity;
+    uint64_t m_ttlMs;
+
+    std::atomic<uint64_t> m_hits;
+    std::atomic<uint64_t> m_misses;
+    std::atomic<uint64_t> m_insertions;
+    std::atomic<uint64_t> m_expirations;
+    std::atomic<uint64_t> m_evictionsBase;  // evictions of m_cache at the last clear()
+};
+
+}
+
+}
+
+}
+
+#endif //#ifndef HCE_AI_INF_LL_RESULT_CACHE_HPP
@@ -0,0 +1,238 @@
+/*
+ * INTEL CONFIDENTIAL
+ *
+ * Copyright (C) 2024 Intel Corporation.
+ *
+ * This software and the related documents are Intel copyrighted materials, and your use of
+ * them is governed by the express license under which they were provided to you (License).
+ * Unless the License provides otherwise, you may not use, modify, copy, publish, distribute,
+ * disclose or transmit this software or the related documents without Intel's prior written permission.
+ *
+ * This software and the related documents are provided as is, with no express or implied warranties,
+ * other than those that are expressly stated in the License.
+*/
+
+#ifndef HCE_AI_INF_DECODED_FRAME_POOL_HPP
+#define HCE_AI_INF_DECODED_FRAME_POOL_HPP
+
+#include <map>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <sys/mman.h>
+
+namespace hce{
+
+namespace ai{
+
+namespace inference{
+
+#define DECODED_FRAME_POOL_MAX_FREE_BYTES (512ul << 20)     // free frames kept for reuse, frames released beyond are unmapped
+#define DECODED_FRAME_POOL_PAGE_SIZE 4096ul
+#define DECODED_FRAME_POOL_HUGEPAGE_SIZE (2ul << 20)        // frames of at least this size may be backed by huge pages
+#define DECODED_FRAME_POOL_CLASS_STEPS 8                    // size classes in each power of two, wasting at most 1/8
+#define DECODED_FRAME_POOL_HUGEPAGES_ENV "HCE_FRAME_POOL_HUGEPAGES"
+
+/**
+ * @brief statistics of a frame pool, bytes are counted in size classes
+*/
+struct DecodedFramePoolStatistics {
+    uint64_t acquired = 0;          // frames acquired
+    uint64_t hits = 0;              // frames acquired from the free ones
+    std::size_t inUseBytes = 0;     // frames held by hva buffers
+    std::size_t freeBytes = 0;      // frames kept for reuse
+    std::size_t highWaterBytes = 0; // the most bytes mapped by the pool at once, in use and free
+
+    double hitRate() const {
+        return acquired ? (double)hits / acquired : 0.0;
+    }
+};
+
+/**
+ * @brief recycling pool of decoded frames, shared by the decoders of the CPU backend
+ *
+ * Frames are page-aligned anonymous mappings, grouped in size classes so that frames of slightly different sizes
+ * are reused for each other. With huge pages enabled, frames of 2 MB and more are advised to be backed by
+ * transparent huge pages, which cuts the page faults of touching a fresh frame.
+ * The storage of an acquired frame goes back to the pool through the deleter of the hva buffer holding it, i.e.
+ * once the last downstream node drops the buffer. The pool may be destroyed before its frames, which are then
+ * unmapped on release.
+*/
+class DecodedFramePool : public std::enable_shared_from_this<DecodedFramePool> {
+public:
+    using Ptr = std::shared_ptr<DecodedFramePool>;
+
+    /**
+     * @param name name in the statistics report
+     * @param maxFreeBytes bytes of free frames kept for reuse
+     * @param hugePages back frames of 2 MB and more by transparent huge pages
+    */
+    static Ptr create(const std::string& name, std::size_t maxFreeBytes = DECODED_FRAME_POOL_MAX_FREE_BYTES,
+                      bool hugePages = false) {
+        return Ptr(new DecodedFramePool(name, maxFreeBytes, hugePages));
+    }
+
+    /**
+     * @brief the pool shared by the decoder nodes of the CPU backend
+     * huge pages are enabled by setting environment variable HCE_FRAME_POOL_HUGEPAGES=1
+    */
+    static Ptr getInstance() {
+        static Ptr instance = create("cpu-decoded-frames", DECODED_FRAME_POOL_MAX_FREE_BYTES, hugePagesByEnv());
+        return instance;
+    }
+
+    ~DecodedFramePool() {
+        for (auto& item : m_free) {
+            for (auto data : item.second) {
+                unmap(data, item.first);
+            }
+        }
+    }
+
+    DecodedFramePool(const DecodedFramePool&) = delete;
+    DecodedFramePool& operator=(const DecodedFramePool&) = delete;
+
+    /**
+     * @brief size class serving a frame of `size` bytes, page-aligned
+    */
+    static std::size_t classSize(std::size_t size) {
+        size = (size + DECODED_FRAME_POOL_PAGE_SIZE - 1) & ~(DECODED_FRAME_POOL_PAGE_SIZE - 1);
+        std::size_t step = DECODED_FRAME_POOL_PAGE_SIZE;
+        while (step * DECODED_FRAME_POOL_CLASS_STEPS * 2 <= size) {
+            step *= 2;
+        }
+        return (size + step - 1) & ~(step - 1);
+    }
+
+    /**
+     * @brief take a frame of at least `size` bytes from the pool, contents are left from the previous use
+     * @return frame, nullptr if allocation fails
+    */
+    uint8_t* acquire(std::size_t size) {
+        std::size_t cls = classSize(size);
+        {
+            std::lock_guard<std::mutex> lg(m_mutex);
+            m_stats.acquired ++;
+            m_stats.inUseBytes += cls;
+            auto it = m_free.find(cls);
+            if (it != m_free.end() && !it->second.empty()) {
+                uint8_t* data = it->second.back();
+                it->second.pop_back();
+                m_stats.hits ++;
+                m_stats.freeBytes -= cls;
+                return data;
+            }
+            std::size_t mapped = m_stats.inUseBytes + m_stats.freeBytes;
+            if (mapped > m_stats.highWaterBytes) {
+                m_stats.highWaterBytes = mapped;
+            }
+        }
+        uint8_t* data = map(cls);
+        if (!data) {
+            std::lock_guard<std::mutex> lg(m_mutex);
+            m_stats.inUseBytes -= cls;
+        }
+        return data;
+    }
+
+    /**
+     * @brief deleter for the hva buffer holding a frame acquired with `size`, gives the frame back to the pool
+    */
+    std::function<void(uint8_t*)> recycler(std::size_t size) {
+        std::weak_ptr<DecodedFramePool> weakPool = shared_from_this();
+        std::size_t cls = classSize(size);
+        return [weakPool, cls](uint8_t* p) {
+            if (auto pool = weakPool.lock()) {
+                pool->recycle(p, cls);
+            }
+            else {
+                unmap(p, cls);
+            }
+        };
+    }
+
+    /**
+     * @brief give back a frame acquired with `size` but not handed to any hva buffer
+    */
+    void release(uint8_t* data, std::size_t size) {
+        recycle(data, classSize(size));
+    }
+
+    DecodedFramePoolStatistics statistics() const {
+        std::lock_guard<std::mutex> lg(m_mutex);
+        return m_stats;
+    }
+
+    /**
+     * @brief one line statistics for logging
+    */
+    std::string report() const {
+        DecodedFramePoolStatistics stats = statistics();
+        char tmp[256];
+        snprintf(tmp, sizeof(tmp), "frame pool %s: acquired %lu, hit rate %.1f%%, in use %.1f MB, free %.1f MB, "
+                 "high water %.1f MB", m_name.c_str(), (unsigned long)stats.acquired, stats.hitRate() * 100.0,
+                 stats.inUseBytes / 1048576.0, stats.freeBytes / 1048576.0, stats.highWaterBytes / 1048576.0);
+        return tmp;
+    }
+
+private:
+    DecodedFramePool(const std::string& name, std::size_t maxFreeBytes, bool hugePages)
+        : m_name(name), m_maxFreeBytes(maxFreeBytes), m_hugePages(hugePages) {}
+
+    static bool hugePagesByEnv() {
+        const char* env = std::getenv(DECODED_FRAME_POOL_HUGEPAGES_ENV);
+        return env && std::strcmp(env, "1") == 0;
+    }
+
+    uint8_t* map(std::size_t cls) {
+        void* data = mmap(NULL, cls, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (data == MAP_FAILED) {
+            return nullptr;
+        }
+#ifdef MADV_HUGEPAGE
+        if (m_hugePages && cls >= DECODED_FRAME_POOL_HUGEPAGE_SIZE) {
+            // best effort, regular pages if transparent huge pages are not available
+            madvise(data, cls, MADV_HUGEPAGE);
+        }
+#endif
+        return (uint8_t*)data;
+    }
+
+    static void unmap(uint8_t* data, std::size_t cls) {
+        munmap(data, cls);
+    }
+
+    void recycle(uint8_t* data, std::size_t cls) {
+        {
+            std::lock_guard<std::mutex> lg(m_mutex);
+            m_stats.inUseBytes -= cls;
+            if (m_stats.freeBytes + cls <= m_maxFreeBytes) {
+                m_free[cls].push_back(data);
+                m_stats.freeBytes += cls;
+                return;
+            }
+        }
+        unmap(data, cls);
+    }
+
+    const std::string m_name;
+    const std::size_t m_maxFreeBytes;
+    const bool m_hugePages;
+    std::map<std::size_t, std::vector<uint8_t*>> m_free;     // free frames of each size class
+    DecodedFramePoolStatistics m_stats;
+    mutable std::mutex m_mutex;
+};
+
+}
+
+}
+
+}
+
+#endif //#ifndef HCE_AI_INF_DECODED_FRAME_POOL_HPP
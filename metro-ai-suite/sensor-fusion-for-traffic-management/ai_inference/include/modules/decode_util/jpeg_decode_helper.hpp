@@ -0,0 +1,232 @@
+/*
+ * INTEL CONFIDENTIAL
+ *
+ * Copyright (C) 2024 Intel Corporation.
+ *
+ * This software and the related documents are Intel copyrighted materials, and your use of
+ * them is governed by the express license under which they were provided to you (License).
+ * Unless the License provides otherwise, you may not use, modify, copy, publish, distribute,
+ * disclose or transmit this software or the related documents without Intel's prior written permission.
+ *
+ * This software and the related documents are provided as is, with no express or implied warranties,
+ * other than those that are expressly stated in the License.
+*/
+
+#ifndef HCE_AI_INF_JPEG_DECODE_HELPER_HPP
+#define HCE_AI_INF_JPEG_DECODE_HELPER_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstring>
+
+#include <inc/api/hvaLogger.hpp>
+#include <inc/buffer/hvaVideoFrameWithROIBuf.hpp>
+
+#include "modules/decode_util/decoded_frame_pool.hpp"
+
+extern "C"
+{
+#include <libavutil/opt.h>
+#include "libavutil/imgutils.h"
+#include <libavcodec/avcodec.h>
+#include <libswscale/swscale.h>
+};
+
+namespace hce{
+
+namespace ai{
+
+namespace inference{
+
+/**
+ * @brief jpeg decoder keeping its FFmpeg MJPEG decoder opened across images
+ *
+ * Each image is sent to the decoder as one packet, no demuxer involved. The codec context, frame, packet and the
+ * color conversion context are created once and reused, the conversion context is rebuilt only when the size or
+ * pixel format of the decoded images changes. Decoded BGR frames come from the shared `DecodedFramePool`.
+ * Not thread-safe, use one decoder for each worker.
+*/
+class FFmpegJpegDecoder {
+public:
+
+    FFmpegJpegDecoder() : m_pCodecCtx(NULL), m_pFrame(NULL), m_packet(NULL), m_swsCtx(NULL),
+            m_swsWidth(0), m_swsHeight(0), m_swsFormat(AV_PIX_FMT_NONE) {
+        m_framePool = DecodedFramePool::getInstance();
+    }
+
+    ~FFmpegJpegDecoder() {
+        deinit();
+    }
+
+    FFmpegJpegDecoder(const FFmpegJpegDecoder&) = delete;
+    FFmpegJpegDecoder& operator=(const FFmpegJpegDecoder&) = delete;
+
+    /**
+     * @brief open the MJPEG decoder, allocate frame and packet
+    */
+    bool init() {
+        HVA_DEBUG("init FFmpeg jpeg decoder.");
+        if (m_pCodecCtx) {
+            return true;
+        }
+
+        //Lower versions require manual registration of all FFmpeg codecs
+#if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(58, 9, 100)
+        avcodec_register_all();
+#endif
+        // Find a registered decoder with a matching codec ID
+        const AVCodec* pCodec = avcodec_find_decoder(AV_CODEC_ID_MJPEG);
+        if (pCodec == NULL) {
+            HVA_ERROR("MJPEG codec not found");
+            return false;
+        }
+        // Allocate an AVCodecContext
+        m_pCodecCtx = avcodec_alloc_context3(pCodec);
+        if (m_pCodecCtx == NULL) {
+            HVA_ERROR("Could not allocate jpeg codec context");
+            return false;
+        }
+        // Initialize the AVCodecContext to use the given AVCodec
+        if (avcodec_open2(m_pCodecCtx, pCodec, NULL) < 0) {
+            HVA_ERROR("Could not open MJPEG codec");
+            deinit();
+            return false;
+        }
+        m_pFrame = av_frame_alloc();
+        m_packet = av_packet_alloc();
+        if (!m_pFrame || !m_packet) {
+            HVA_ERROR("Can't allocate memory for AVFrame or AVPacket");
+            deinit();
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief close the decoder and release contexts, corresponding to init()
+    */
+    void deinit() {
+        if (m_packet) {
+            av_packet_free(&m_packet);
+        }
+        if (m_pFrame) {
+            av_frame_free(&m_pFrame);
+        }
+        if (m_pCodecCtx) {
+            avcodec_free_context(&m_pCodecCtx);
+        }
+        if (m_swsCtx) {
+            sws_freeContext(m_swsCtx);
+            m_swsCtx = NULL;
+        }
+        m_swsWidth = 0;
+        m_swsHeight = 0;
+        m_swsFormat = AV_PIX_FMT_NONE;
+    }
+
+    /**
+     * @brief decode one jpeg image to a BGR frame
+     * width of the decoded frame is aligned to a multiple of 64
+     * @param imageData jpeg bitstream
+     * @param hvabuf buffer holding the decoded frame, released back to the frame pool
+    */
+    bool decode(const std::string& imageData, hva::hvaVideoFrameWithROIBuf_t::Ptr& hvabuf) {
+        if (!m_pCodecCtx && !init()) {
+            return false;
+        }
+
+        // the decoder reads ahead of the bitstream, which needs zeroed padding
+        m_bitstream.resize(imageData.size() + AV_INPUT_BUFFER_PADDING_SIZE);
+        std::memcpy(m_bitstream.data(), imageData.data(), imageData.size());
+        std::memset(m_bitstream.data() + imageData.size(), 0, AV_INPUT_BUFFER_PADDING_SIZE);
+        m_packet->data = m_bitstream.data();
+        m_packet->size = (int)imageData.size();
+
+        // Supply raw packet data as input to a decoder
+        int ret = avcodec_send_packet(m_pCodecCtx, m_packet);
+        m_packet->data = NULL;
+        m_packet->size = 0;
+        if (ret < 0) {
+            HVA_DEBUG("Failed to send jpeg image to the decoder: %d", ret);
+            avcodec_flush_buffers(m_pCodecCtx);
+            return false;
+        }
+
+        // Get the decoded output data from a decoder.
+        ret = avcodec_receive_frame(m_pCodecCtx, m_pFrame);
+        if (ret != 0) {
+            HVA_DEBUG("Failed to decode jpeg image: %d", ret);
+            avcodec_flush_buffers(m_pCodecCtx);
+            return false;
+        }
+
+        // align buffer to a multiple of 64
+        int width = (m_pFrame->width + 63) & ~63;
+        int height = m_pFrame->height;
+        AVPixelFormat format = (AVPixelFormat)m_pFrame->format;
+
+        // conversion context is kept for images of the same size and pixel format
+        if (!m_swsCtx || width != m_swsWidth || height != m_swsHeight || format != m_swsFormat) {
+            HVA_DEBUG("Jpeg decoder creates color conversion context for %dx%d, format %d", width, height, (int)format);
+            if (m_swsCtx) {
+                sws_freeContext(m_swsCtx);
+            }
+            m_swsCtx = sws_getContext(width, height, format, width, height, AV_PIX_FMT_BGR24,
+                                      SWS_BICUBIC, NULL, NULL, NULL);
+            m_swsWidth = width;
+            m_swsHeight = height;
+            m_swsFormat = format;
+            if (!m_swsCtx) {
+                HVA_ERROR("Failed to create color conversion context for jpeg format %d", (int)format);
+                av_frame_unref(m_pFrame);
+                return false;
+            }
+        }
+
+        uint8_t* dst[4];
+        int dstLinesize[4];
+        int dstBufsize = av_image_get_buffer_size(AV_PIX_FMT_BGR24, width, height, 1);
+        uint8_t* data = dstBufsize > 0 ? m_framePool->acquire(dstBufsize) : NULL;
+        if (!data) {
+            HVA_ERROR("Failed to allocate %d bytes for decoded jpeg image", dstBufsize);
+            av_frame_unref(m_pFrame);
+            return false;
+        }
+        av_image_fill_arrays(dst, dstLinesize, data, AV_PIX_FMT_BGR24, width, height, 1);
+
+        // color conversion for decoded image, covers the whole destination frame
+        sws_scale(m_swsCtx, (const uint8_t* const*)m_pFrame->data, m_pFrame->linesize, 0,
+                  height, dst, dstLinesize);
+        av_frame_unref(m_pFrame);
+
+        hvabuf = hva::hvaVideoFrameWithROIBuf_t::make_buffer<uint8_t*>(
+                data, dstBufsize, m_framePool->recycler(dstBufsize));
+        hvabuf->width = width;
+        hvabuf->height = height;
+        hvabuf->stride[0] = (unsigned)dstLinesize[0];       // channels * width
+        hvabuf->drop = false;
+        return true;
+    }
+
+private:
+    AVCodecContext* m_pCodecCtx;
+    AVFrame* m_pFrame;
+    AVPacket* m_packet;
+    std::vector<uint8_t> m_bitstream;       // padded copy of the current image
+
+    struct SwsContext* m_swsCtx;
+    int m_swsWidth;
+    int m_swsHeight;
+    AVPixelFormat m_swsFormat;
+
+    DecodedFramePool::Ptr m_framePool;
+};
+
+}
+
+}
+
+}
+
+#endif //#ifndef HCE_AI_INF_JPEG_DECODE_HELPER_HPP
@@ -0,0 +1,306 @@
+/*
+ * INTEL CONFIDENTIAL
+ *
+ * Copyright (C) 2024 Intel Corporation.
+ *
+ * This software and the related documents are Intel copyrighted materials, and your use of
+ * them is governed by the express license under which they were provided to you (License).
+ * Unless the License provides otherwise, you may not use, modify, copy, publish, distribute,
+ * disclose or transmit this software or the related documents without Intel's prior written permission.
+ *
+ * This software and the related documents are provided as is, with no express or implied warranties,
+ * other than those that are expressly stated in the License.
+*/
+
+#ifndef HCE_AI_INF_SCALED_JPEG_DECODE_HELPER_HPP
+#define HCE_AI_INF_SCALED_JPEG_DECODE_HELPER_HPP
+
+#include <string>
+#include <cstring>
+
+#include <inc/api/hvaLogger.hpp>
+#include <inc/buffer/hvaVideoFrameWithROIBuf.hpp>
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+
+#ifdef HAVE_TURBOJPEG
+#include <turbojpeg.h>
+#endif
+
+#include "modules/decode_util/decoded_frame_pool.hpp"
+
+namespace hce{
+
+namespace ai{
+
+namespace inference{
+
+#define JPEG_DECODE_MAX_SCALE_DENOM 8       // libjpeg scales the idct by 1/2, 1/4 or 1/8
+
+/**
+ * @brief jpeg decoder to BGR frames, downscaling in the DCT domain when the consumer needs a much smaller image
+ *
+ * With a target size set, jpeg images are decoded at the smallest of 1, 1/2, 1/4 and 1/8 of their size that is
+ * still no smaller than the target, e.g. a 3840x2160 image for a 416x416 detector is decoded at 960x540. Only
+ * the IDCT, upsampling and color conversion run at the reduced size, entropy decoding still covers the whole
+ * bitstream, so the saving depends on the image and is partial.
+ * libjpeg-turbo is used when built with HAVE_TURBOJPEG, OpenCV's reduced decoding otherwise. Both write
+ * straight into frames of the shared `DecodedFramePool`. Images other than jpeg are decoded by OpenCV at full size.
+ * Not thread-safe, use one decoder for each worker.
+*/
+class ScaledJpegDecoder {
+public:
+
+    /**
+     * @param targetWidth target width, 0 to decode at full size
+     * @param targetHeight target height, 0 to decode at full size
+    */
+    ScaledJpegDecoder(unsigned targetWidth = 0, unsigned targetHeight = 0)
+            : m_targetWidth(targetWidth), m_targetHeight(targetHeight) {
+        m_framePool = DecodedFramePool::getInstance();
+    }
+
+    ~ScaledJpegDecoder() {
+#ifdef HAVE_TURBOJPEG
+        if (m_handle) {
+            tjDestroy(m_handle);
+        }
+#endif
+    }
+
+    ScaledJpegDecoder(const ScaledJpegDecoder&) = delete;
+    ScaledJpegDecoder& operator=(const ScaledJpegDecoder&) = delete;
+
+    void setTargetSize(unsigned targetWidth, unsigned targetHeight) {
+        m_targetWidth = targetWidth;
+        m_targetHeight = targetHeight;
+    }
+
+    /**
+     * @brief size of an image dimension decoded at 1/denom, rounded up as libjpeg does
+    */
+    static int scaledSize(int size, int denom) {
+        return (size + denom - 1) / denom;
+    }
+
+    /**
+     * @brief largest denom in 1, 2, 4, 8 decoding an image of width x height no smaller than the target
+    */
+    static int selectScaleDenom(int width, int height, unsigned targetWidth, unsigned targetHeight) {
+        int denom = 1;
+        if (targetWidth == 0 || targetHeight == 0) {
+            return denom;
+        }
+        while (denom < JPEG_DECODE_MAX_SCALE_DENOM &&
+               scaledSize(width, denom * 2) >= (int)targetWidth && scaledSize(height, denom * 2) >= (int)targetHeight) {
+            denom *= 2;
+        }
+        return denom;
+    }
+
+    /**
+     * @brief read image size from the frame header of a jpeg bitstream
+     * @return false if `data` is not a jpeg image or the frame header is not found
+    */
+    static bool readJpegSize(const uint8_t* data, std::size_t size, int& width, int& height) {
+        if (size < 4 || data[0] != 0xFF || data[1] != 0xD8) {
+            return false;
+        }
+        std::size_t pos = 2;
+        while (pos + 1 < size) {
+            if (data[pos] != 0xFF) {
+                return false;
+            }
+            uint8_t marker = data[pos + 1];
+            if (marker == 0xFF) {
+                // fill byte
+                pos ++;
+                continue;
+            }
+            pos += 2;
+            if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD8)) {
+                // markers without payload
+                continue;
+            }
+            if (marker == 0xDA || marker == 0xD9 || pos + 2 > size) {
+                // scan reached before any frame header
+                return false;
+            }
+            std::size_t length = ((std::size_t)data[pos] << 8) | data[pos + 1];
+            // SOF0 - SOF15, except DHT, JPG and DAC
+            if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+                if (length < 7 || pos + 7 > size) {
+                    return false;
+                }
+                height = (data[pos + 3] << 8) | data[pos + 4];
+                width = (data[pos + 5] << 8) | data[pos + 6];
+                return width > 0 && height > 0;
+            }
+            if (length < 2) {
+                return false;
+            }
+            pos += length;
+        }
+        return false;
+    }
+
+    /**
+     * @brief decode one image to a BGR frame, jpeg images are downscaled towards the target size
+     * @param imageData encoded image
+     * @param hvabuf buffer holding the decoded frame, released back to the frame pool
+     * @param scaleDenom if not null, set to the denom the image is decoded at, i.e. 1 at full size. Coordinates on
+     * the full-size image are divided by it to fit the decoded frame
+    */
+    bool decode(const std::string& imageData, hva::hvaVideoFrameWithROIBuf_t::Ptr& hvabuf, int* scaleDenom = nullptr) {
+        const uint8_t* src = (const uint8_t*)imageData.data();
+        int width = 0, height = 0;
+        if (scaleDenom) {
+            *scaleDenom = 1;
+        }
+        if (readJpegSize(src, imageData.size(), width, height)) {
+            int denom = selectScaleDenom(width, height, m_targetWidth, m_targetHeight);
+            int dstWidth = scaledSize(width, denom);
+            int dstHeight = scaledSize(height, denom);
+            HVA_DEBUG("Decode jpeg image of %dx%d at 1/%d: %dx%d", width, height, denom, dstWidth, dstHeight);
+#ifdef HAVE_TURBOJPEG
+            if (decodeTurbo(imageData, dstWidth, dstHeight, hvabuf)) {
+                if (scaleDenom) {
+                    *scaleDenom = denom;
+                }
+                return true;
+            }
+#else
+            if (decodeOpenCV(imageData, denom, dstWidth, dstHeight, hvabuf)) {
+                if (scaleDenom) {
+                    *scaleDenom = denom;
+                }
+                return true;
+            }
+#endif
+        }
+        return decodeAny(imageData, hvabuf);
+    }
+
+private:
+
+#ifdef HAVE_TURBOJPEG
+    /**
+     * @brief decode by libjpeg-turbo, scaled to dstWidth x dstHeight
+    */
+    bool decodeTurbo(const std::string& imageData, int dstWidth, int dstHeight, hva::hvaVideoFrameWithROIBuf_t::Ptr& hvabuf) {
+        if (!m_handle) {
+            m_handle = tjInitDecompress();
+            if (!m_handle) {
+                HVA_ERROR("Failed to init libjpeg-turbo decompressor");
+                return false;
+            }
+        }
+
+        std::size_t bufSize = (std::size_t)dstWidth * dstHeight * 3;
+        uint8_t* data = m_framePool->acquire(bufSize);
+        if (!data) {
+            HVA_ERROR("Failed to allocate %lu bytes for decoded jpeg image", bufSize);
+            return false;
+        }
+        if (tjDecompress2(m_handle, (unsigned char*)imageData.data(), (unsigned long)imageData.size(), data,
+                          dstWidth, dstWidth * 3, dstHeight, TJPF_BGR, 0) != 0
+                && tjGetErrorCode(m_handle) != TJERR_WARNING) {
+            // warnings such as a truncated bitstream still give an image
+            HVA_DEBUG("libjpeg-turbo failed to decode: %s", tjGetErrorStr2(m_handle));
+            m_framePool->release(data, bufSize);
+            return false;
+        }
+        hvabuf = makeBuffer(data, bufSize, dstWidth, dstHeight);
+        return true;
+    }
+#else
+    /**
+     * @brief decode by OpenCV's reduced decoding of 1/denom, written in place as long as the size is as expected
+    */
+    bool decodeOpenCV(const std::string& imageData, int denom, int dstWidth, int dstHeight, hva::hvaVideoFrameWithROIBuf_t::Ptr& hvabuf) {
+        int flags = cv::IMREAD_COLOR;
+        switch (denom) {
+            case 2: flags = cv::IMREAD_REDUCED_COLOR_2; break;
+            case 4: flags = cv::IMREAD_REDUCED_COLOR_4; break;
+            case 8: flags = cv::IMREAD_REDUCED_COLOR_8; break;
+            default: break;
+        }
+
+        std::size_t bufSize = (std::size_t)dstWidth * dstHeight * 3;
+        uint8_t* data = m_framePool->acquire(bufSize);
+        if (!data) {
+            HVA_ERROR("Failed to allocate %lu bytes for decoded jpeg image", bufSize);
+            return false;
+        }
+        cv::Mat rawData(1, (int)imageData.size(), CV_8UC1, (void*)imageData.data());
+        cv::Mat decodedImage(dstHeight, dstWidth, CV_8UC3, data);
+        cv::imdecode(rawData, flags, &decodedImage);
+        if (decodedImage.data != data) {
+            // reallocated by OpenCV, e.g. rotated by exif orientation
+            m_framePool->release(data, bufSize);
+            if (decodedImage.empty()) {
+                return false;
+            }
+            hvabuf = copyBuffer(decodedImage);
+            return (bool)hvabuf;
+        }
+        hvabuf = makeBuffer(data, bufSize, dstWidth, dstHeight);
+        return true;
+    }
+#endif
+
+    /**
+     * @brief decode any image format supported by OpenCV at full size
+    */
+    bool decodeAny(const std::string& imageData, hva::hvaVideoFrameWithROIBuf_t::Ptr& hvabuf) {
+        cv::Mat rawData(1, (int)imageData.size(), CV_8UC1, (void*)imageData.data());
+        cv::Mat decodedImage = cv::imdecode(rawData, cv::IMREAD_COLOR);
+        if (decodedImage.empty()) {
+            return false;
+        }
+        hvabuf = copyBuffer(decodedImage);
+        return (bool)hvabuf;
+    }
+
+    /**
+     * @brief copy a decoded image into a frame of the pool
+    */
+    hva::hvaVideoFrameWithROIBuf_t::Ptr copyBuffer(const cv::Mat& image) {
+        std::size_t rowSize = (std::size_t)image.cols * image.elemSize();
+        std::size_t bufSize = rowSize * image.rows;
+        uint8_t* data = m_framePool->acquire(bufSize);
+        if (!data) {
+            HVA_ERROR("Failed to allocate %lu bytes for decoded image", bufSize);
+            return nullptr;
+        }
+        for (int row = 0; row < image.rows; ++row) {
+            std::memcpy(data + row * rowSize, image.ptr(row), rowSize);
+        }
+        return makeBuffer(data, bufSize, image.cols, image.rows);
+    }
+
+    hva::hvaVideoFrameWithROIBuf_t::Ptr makeBuffer(uint8_t* data, std::size_t bufSize, int width, int height) {
+        hva::hvaVideoFrameWithROIBuf_t::Ptr hvabuf = hva::hvaVideoFrameWithROIBuf_t::make_buffer<uint8_t*>(
+                data, bufSize, m_framePool->recycler(bufSize));
+        hvabuf->width = width;
+        hvabuf->height = height;
+        hvabuf->stride[0] = 3 * width;      // channels * width
+        hvabuf->drop = false;
+        return hvabuf;
+    }
+
+    unsigned m_targetWidth;
+    unsigned m_targetHeight;
+    DecodedFramePool::Ptr m_framePool;
+#ifdef HAVE_TURBOJPEG
+    tjhandle m_handle = nullptr;
+#endif
+};
+
+}
+
+}
+
+}
+
+#endif //#ifndef HCE_AI_INF_SCALED_JPEG_DECODE_HELPER_HPP
@@ -16,6 +16,9 @@
 #define HCE_AI_INF_VIDEO_DECODE_HELPER_HPP
 
 #include <inc/api/hvaLogger.hpp>
+#include <inc/buffer/hvaVideoFrameWithROIBuf.hpp>
+
+#include "modules/decode_util/decoded_frame_pool.hpp"
 
 extern "C"
 {
@@ -32,8 +35,10 @@ namespace ai{
 
 namespace inference{
 
+#define VIDEO_DECODER_DEFAULT_THREAD_NUM 1    // decoding threads of each decoder, 0 to let FFmpeg decide
+
 // Read buffer in block
-int feedVideoDecoder(void* opaque, std::uint8_t* buf, int buf_size) {
+inline int feedVideoDecoder(void* opaque, std::uint8_t* buf, int buf_size) {
     std::stringstream* ss = reinterpret_cast<std::stringstream*>(opaque);
     auto actualSize = ss->readsome((char*)buf, buf_size);
     if (!actualSize)
@@ -52,10 +57,30 @@ enum decodeStatus_t {
 class FFmpegDecoderManager {
 public:
 
-    FFmpegDecoderManager() : m_frameOrder(0u), m_state(decodeStatus_t::DECODER_NONE) {
+    FFmpegDecoderManager() : m_frameOrder(0u), m_state(decodeStatus_t::DECODER_NONE),
+            m_pFormatCtx(NULL), m_pCodecCtx(NULL), m_packet(NULL), m_pFrame(NULL),
+            m_packetPending(false), m_endOfVideo(false), m_draining(false),
+            m_threadCount(VIDEO_DECODER_DEFAULT_THREAD_NUM), m_threadType(FF_THREAD_FRAME | FF_THREAD_SLICE),
+            m_img_convert_ctx(NULL) {
+        m_framePool = DecodedFramePool::getInstance();
     }
 
     ~FFmpegDecoderManager() {
+        if (m_img_convert_ctx) {
+            sws_freeContext(m_img_convert_ctx);
+        }
+    }
+
+    /**
+     * @brief decoder threading, applies to decoders initialized afterwards
+     * frame threading decodes several frames at once and delays the output by threadCount - 1 frames, slice
+     * threading splits a frame and only helps on streams encoded with multiple slices
+     * @param threadCount decoding threads, 0 to let FFmpeg decide from the cores available
+     * @param threadType FF_THREAD_FRAME and / or FF_THREAD_SLICE
+    */
+    void setThreading(int threadCount, int threadType) {
+        m_threadCount = threadCount;
+        m_threadType = threadType;
     }
 
     /**
@@ -80,6 +105,10 @@ public:
 
         // release bitstream and contexts
         m_bitstream.str("");
+        if (m_img_convert_ctx) {
+            sws_freeContext(m_img_convert_ctx);
+            m_img_convert_ctx = NULL;
+        }
     }
     
     /**
@@ -90,6 +119,8 @@ public:
         m_streamIndex = -1;
         m_frameOrder = 0;
         m_state = decodeStatus_t::DECODER_NONE;
+        m_packetPending = false;
+        m_draining = false;
         
         //Lower versions require manual registration of all FFmpeg codecs
 #if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(58, 9, 100)
@@ -142,12 +173,18 @@ public:
           HVA_DEBUG("Failed to copy codec parameters to decoder context.\n");
           return false;
         }
+
+        // decoding threads, to be set before opening the codec
+        m_pCodecCtx->thread_count = m_threadCount;
+        m_pCodecCtx->thread_type = m_threadType;
         
         // Initialize the AVCodecContext to use the given AVCodec
         if (avcodec_open2(m_pCodecCtx, pCodec, NULL) < 0) {
           HVA_DEBUG("Could not open codec\n");
           return false;
         }
+        HVA_DEBUG("FFmpeg decoder opened with %d threads, active thread type: %d",
+                  m_pCodecCtx->thread_count, m_pCodecCtx->active_thread_type);
         
         // allocate pFrame and packet
         m_pFrame = av_frame_alloc();
@@ -201,6 +238,8 @@ public:
 
         m_streamIndex = -1;
         m_frameOrder = 0;
+        m_packetPending = false;
+        m_draining = false;
         
         // Free the requested memory space
         av_packet_unref(m_packet);
@@ -213,11 +252,14 @@ public:
 
     /**
      * @brief start a decoder, handle different decode status
+     * @param buffer next part of the video bitstream
+     * @param endOfVideo the last part of the video, frames held by the decoder are drained at its end
      */
-    bool startDecode(std::string& buffer) {
+    bool startDecode(std::string& buffer, bool endOfVideo = false) {
 
         // append buffer to decoder stream buffer
         m_bitstream << buffer;
+        m_endOfVideo = endOfVideo;
 
         switch (m_state) {
             case decodeStatus_t::DECODER_NONE:
@@ -259,95 +301,69 @@ public:
             HVA_ERROR("ERR - At least one frame should be fetched, try to enlarge buffer size\n");
             return false;
         }
+        m_packetPending = true;
         
         return true;
     }
 
     /**
      * @brief decode to get next frame data
-     * @param hvabuf save decoded frame data in hvabuf
+     * frames come out as soon as the decoder completes them, which lags behind the packets with frame threading
+     * @param hvabuf save decoded frame data in hvabuf, NULL if no frame is completed by this call
      * @return status int: 
-     *          > 1 stands for eof
+     *          > 1 stands for the end of the current buffer, no frame is returned
      *          > 0 stands for still going
      */
     int decodeNext(hva::hvaVideoFrameWithROIBuf_t::Ptr& hvabuf) {
 
-        int status = 0;
+        hvabuf = NULL;
 
-        if (m_packet->stream_index != m_streamIndex) {
-            av_packet_unref(m_packet);
-            // read next frame
-            status = av_read_frame(m_pFormatCtx, m_packet);
-            return status;
+        // Get the decoded output data from a decoder.
+        int ret = avcodec_receive_frame(m_pCodecCtx, m_pFrame);
+        if (ret == 0) {
+            hvabuf = convertFrame();
+            av_frame_unref(m_pFrame);
+            // Increase frame order
+            m_frameOrder ++;
+            setState(decodeStatus_t::DECODER_GOING);
+            return 0;
+        }
+        if (ret == AVERROR_EOF) {
+            // all the frames are drained at the end of the video
+            setState(decodeStatus_t::DECODER_BUFFER_EOS);
+            return 1;
         }
 
-        // Supply raw packet data as input to a decoder
-        int ret = avcodec_send_packet(m_pCodecCtx, m_packet);
-        if (ret < 0) {
+        // the decoder needs more input
+        if (m_packetPending) {
+            if (m_packet->stream_index == m_streamIndex) {
+                // Supply raw packet data as input to a decoder, packets failed to decode are skipped
+                ret = avcodec_send_packet(m_pCodecCtx, m_packet);
+                if (ret == AVERROR(EAGAIN)) {
+                    // output to be received first
+                    return 0;
+                }
+            }
             av_packet_unref(m_packet);
-            // read next frame
-            status = av_read_frame(m_pFormatCtx, m_packet);
-            return status;
+            m_packetPending = false;
         }
 
-        // Get the decoded output data from a decoder.
-        ret = avcodec_receive_frame(m_pCodecCtx, m_pFrame);
-        if (ret != 0) {
-            return status;
+        // read next frame
+        if (!m_draining && av_read_frame(m_pFormatCtx, m_packet) >= 0) {
+            m_packetPending = true;
+            return 0;
         }
 
-        // Get the decoded output data from a decoder.
-        // color convert
-        unsigned dstBufsize;
-        uint8_t* dst[4];
-        int dst_linesize[4];
-        struct SwsContext* img_convert_ctx;
-
-        // align buffer to a multiple of 64
-        m_pCodecCtx->width = (m_pCodecCtx->width + 63) & ~63;
-        m_pFrame->width = (m_pFrame->width + 63) & ~63;
-        
-        dstBufsize = av_image_alloc(dst, dst_linesize, m_pCodecCtx->width,
-                                    m_pCodecCtx->height, AV_PIX_FMT_BGR24, 1);
-        memset(dst[0], 0, dstBufsize);
-        img_convert_ctx = sws_getContext(
-            m_pFrame->width, m_pFrame->height, m_pCodecCtx->pix_fmt,
-            m_pCodecCtx->width, m_pCodecCtx->height, AV_PIX_FMT_BGR24,
-            SWS_BICUBIC, NULL, NULL, NULL);
-        sws_scale(img_convert_ctx, (const uint8_t* const*)m_pFrame->data,
-                    m_pFrame->linesize, 0, m_pFrame->height, dst, dst_linesize);
-        
-        // decode success
-        m_dstWidth = m_pCodecCtx->width;
-        m_dstHeight = m_pCodecCtx->height;
-
-        HVA_DEBUG("This frame is decoded done");
-        hvabuf =
-            hva::hvaVideoFrameWithROIBuf_t::make_buffer<uint8_t*>(
-                dst[0], dstBufsize, [](uint8_t* p) { av_freep(&p); });
-        hvabuf->frameId = getFrameOrder();
-        hvabuf->width = getFrameWidth();
-        hvabuf->height = getFrameHeight();
-        hvabuf->stride[0] = (unsigned)dst_linesize[0];
-        hvabuf->drop = false;
-
-        // Free the requested memory space for each frame
-        sws_freeContext(img_convert_ctx);
-
-        // release resources per frame
-        av_frame_unref(m_pFrame);
-        av_packet_unref(m_packet);
-        
-        // If it is the last frame, it is marked as 1
-        if (av_read_frame(m_pFormatCtx, m_packet) != 0) {
-            setState(decodeStatus_t::DECODER_BUFFER_EOS);
-            status = 1;
+        if (m_endOfVideo && !m_draining) {
+            // flush the frames still held by the decoder
+            avcodec_send_packet(m_pCodecCtx, NULL);
+            m_draining = true;
+            return 0;
         }
 
-        // Increase frame order
-        m_frameOrder ++;
-        setState(decodeStatus_t::DECODER_GOING);
-        return status;
+        // the rest comes with the next buffer, or nothing left to drain
+        setState(decodeStatus_t::DECODER_BUFFER_EOS);
+        return 1;
     }
 
     /**
@@ -415,6 +431,53 @@ private:
         return ret;
     }
 
+    /**
+     * @brief color convert the decoded frame to a BGR frame of the pool
+     */
+    hva::hvaVideoFrameWithROIBuf_t::Ptr convertFrame() {
+        // align buffer to a multiple of 64
+        int width = (m_pFrame->width + 63) & ~63;
+        int height = m_pFrame->height;
+
+        // the conversion context is kept as long as the size and format of frames stay
+        m_img_convert_ctx = sws_getCachedContext(m_img_convert_ctx,
+            width, height, (AVPixelFormat)m_pFrame->format,
+            width, height, AV_PIX_FMT_BGR24,
+            SWS_BICUBIC, NULL, NULL, NULL);
+        if (!m_img_convert_ctx) {
+            HVA_ERROR("Failed to create color conversion context for format %d", m_pFrame->format);
+            return NULL;
+        }
+
+        uint8_t* dst[4];
+        int dst_linesize[4];
+        int dstBufsize = av_image_get_buffer_size(AV_PIX_FMT_BGR24, width, height, 1);
+        uint8_t* data = dstBufsize > 0 ? m_framePool->acquire(dstBufsize) : NULL;
+        if (!data) {
+            HVA_ERROR("Failed to allocate %d bytes for decoded frame", dstBufsize);
+            return NULL;
+        }
+        av_image_fill_arrays(dst, dst_linesize, data, AV_PIX_FMT_BGR24, width, height, 1);
+        // converts all the aligned columns, no need to clear the pooled frame
+        sws_scale(m_img_convert_ctx, (const uint8_t* const*)m_pFrame->data,
+                    m_pFrame->linesize, 0, height, dst, dst_linesize);
+        
+        // decode success
+        m_dstWidth = width;
+        m_dstHeight = height;
+
+        HVA_DEBUG("This frame is decoded done");
+        hva::hvaVideoFrameWithROIBuf_t::Ptr hvabuf =
+            hva::hvaVideoFrameWithROIBuf_t::make_buffer<uint8_t*>(
+                data, dstBufsize, m_framePool->recycler(dstBufsize));
+        hvabuf->frameId = getFrameOrder();
+        hvabuf->width = getFrameWidth();
+        hvabuf->height = getFrameHeight();
+        hvabuf->stride[0] = (unsigned)dst_linesize[0];
+        hvabuf->drop = false;
+        return hvabuf;
+    }
+
     unsigned m_frameOrder;
     decodeStatus_t m_state;
     
@@ -424,10 +487,17 @@ private:
     AVPacket* m_packet;
     AVFrame* m_pFrame;
     int m_streamIndex = -1;
+    bool m_packetPending;       // m_packet read but not yet sent to the decoder
+    bool m_endOfVideo;          // the current buffer ends the video
+    bool m_draining;
+
+    int m_threadCount;
+    int m_threadType;
 
     std::stringstream m_bitstream;
 
     struct SwsContext* m_img_convert_ctx;
+    DecodedFramePool::Ptr m_framePool;      // BGR frames, back to the pool once released downstream
 };
 
 
@@ -19,6 +19,7 @@
 
 #include "modules/inference_util/model_proc/json_reader.h"
 #include "modules/inference_util/detection/detection_helper.hpp"
+#include "modules/inference_util/detection/nms_engine.hpp"
 
 namespace hce{
 
@@ -203,22 +204,47 @@ private:
      */
     TransfromFunction_t checkFunctions(std::string func_name);
     
+    /**
+     * @brief decode kernel specialized for one (layout, activation, transform) combination
+     * @param data output blob of one layer
+     * @param decoded output, decoded detection_outputs are appended, detection_output.size floats each
+    */
+    using DecodeFunc = void (AnchorTransformProcessor::*)(const float* data, std::vector<float>& decoded);
+    DecodeFunc m_decode = nullptr;
+    float m_raw_conf_thresh;                                // rejection threshold applied on raw outputs
+
+    /**
+     * @brief select the decode kernel according to model_proc, called once at construction
+    */
+    DecodeFunc selectDecodeKernel();
+
+    /**
+     * @brief scan the objectness (or class-max) plane first, then decode and class-reduce
+     *  only the surviving cells. Survivors are emitted in the order of (anchor, cell_x, cell_y)
+     *  so that outputs are identical to the per-cell reference implementation.
+    */
+    template <DetOutputDimsLayout_t Layout, bool Sigmoid, TransfromFunction_t Transform>
+    void decode(const float* data, std::vector<float>& decoded);
+
     /**
      * @brief get output index in blob data
      * @param index  index of detection output field, such as: [x, y, w, h, class_0, class_1, ...]
-     *
+     * @param cell_index  cell_index_y * feature_w + cell_index_x
     */
-    size_t getIndex(size_t index, size_t anchor_index, size_t cell_index_x, size_t cell_index_y);
+    template <DetOutputDimsLayout_t Layout>
+    size_t getIndex(size_t index, size_t anchor_index, size_t cell_index) const;
 
     /**
-     * @brief sigmoid(x) if m_output_sigmoid_activation = true
+     * @brief sigmoid(x) if Sigmoid = true
     */
-    float trySigmoid(float x);
+    template <bool Sigmoid>
+    static float trySigmoid(float x);
 
     /**
      * @brief transform function apply on x according to the function type
     */
-    float tryTransform(float x);
+    template <TransfromFunction_t Transform>
+    static float tryTransform(float x);
 
     // /**
     //  * @brief convert DetOutputDimsLayout_t::BCxCy to DetOutputDimsLayout_t::CxCyB
@@ -270,22 +296,12 @@ public:
     }
 
 private:
-    struct NMSRect {
-        float x;                        // Left of bounding box
-        float y;                        // Up of bounding box
-        float w;                        // Width of bounding box
-        float h;                        // Height of bounding box
-        float confidence = 1.0;         // Detection confidence
-        int origin_index;               // origin proposal index in model_output
-    };
-
     /**
-    * @brief Do Non Maximum Suppression on a set of proposals wirh pre-defined iou_threshold
-    * @param candidates a set of detected objects
-    * @return objects after NMS
+     * @brief write soft-NMS decayed scores back to the confidence fields of detection_output
     */
-    void runNMS(std::vector<NMSRect>& objects);
+    void applySoftScores(std::vector<float*>& inputs, const NMSEngine::Workspace& ws);
 
+    NMSEngine m_engine;
     float m_iou_threshold;
     bool m_class_agnostic;
     DetectionModelOutput_t m_model_output_cfg;
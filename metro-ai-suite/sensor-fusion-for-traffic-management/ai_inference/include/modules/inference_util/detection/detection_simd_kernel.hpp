@@ -0,0 +1,186 @@
+/*
+ * INTEL CONFIDENTIAL
+ *
+ * Copyright (C) 2024 Intel Corporation.
+ *
+ * This software and the related documents are Intel copyrighted materials, and your use of
+ * them is governed by the express license under which they were provided to you (License).
+ * Unless the License provides otherwise, you may not use, modify, copy, publish, distribute,
+ * disclose or transmit this software or the related documents without Intel's prior written permission.
+ *
+ * This software and the related documents are provided as is, with no express or implied warranties,
+ * other than those that are expressly stated in the License.
+*/
+
+#ifndef HCE_AI_INF_DETECTION_SIMD_KERNEL_HPP
+#define HCE_AI_INF_DETECTION_SIMD_KERNEL_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace hce{
+
+namespace ai{
+
+namespace inference{
+
+namespace detection_simd{
+
+/**
+ * @brief convert a threshold on sigmoid(x) to a conservative threshold on raw x
+ *  > x < inverseSigmoidThreshold(t)  ==>  sigmoid(x) < t, so the raw value can be rejected
+ *    without evaluating exp(); values passing this test must still be checked exactly.
+ *  > a small margin in logit space absorbs the rounding error of the float sigmoid
+ * @return -inf if the threshold can not be inverted safely, i.e. nothing is rejected
+*/
+inline float inverseSigmoidThreshold(float thresh) {
+    if (!(thresh > 0.0f) || !(thresh < 0.9999f)) {
+        return -std::numeric_limits<float>::infinity();
+    }
+    double logit = std::log((double)thresh / (1.0 - (double)thresh));
+    return (float)(logit - 1e-3);
+}
+
+/**
+ * @brief collect indices of elements which are NOT less than threshold
+ *  > semantics matches `if (x < threshold) continue;`, i.e. NaN is kept
+ * @param data contiguous values
+ * @param count number of values
+ * @param threshold rejection threshold
+ * @param indices output, indices are appended in memory order
+*/
+inline void collectCandidates(const float* data, size_t count, float threshold, std::vector<uint32_t>& indices) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    const __m256 vthresh = _mm256_set1_ps(threshold);
+    for (; i + 8 <= count; i += 8) {
+        // _CMP_NLT_UQ: !(x < threshold), true for unordered
+        int mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(data + i), vthresh, _CMP_NLT_UQ));
+        while (mask) {
+            int lane = __builtin_ctz(mask);
+            indices.push_back((uint32_t)(i + lane));
+            mask &= mask - 1;
+        }
+    }
+#elif defined(__SSE2__)
+    const __m128 vthresh = _mm_set1_ps(threshold);
+    for (; i + 4 <= count; i += 4) {
+        int mask = _mm_movemask_ps(_mm_cmpnlt_ps(_mm_loadu_ps(data + i), vthresh));
+        while (mask) {
+            int lane = __builtin_ctz(mask);
+            indices.push_back((uint32_t)(i + lane));
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; i < count; i ++) {
+        if (!(data[i] < threshold)) {
+            indices.push_back((uint32_t)i);
+        }
+    }
+}
+
+/**
+ * @brief collect indices of strided elements which are NOT less than threshold
+ *  > used by interleaved layouts, e.g. CxCyB, where no contiguous plane exists
+*/
+inline void collectCandidatesStrided(const float* data, size_t count, size_t stride, float threshold, std::vector<uint32_t>& indices) {
+    if (stride == 1) {
+        collectCandidates(data, count, threshold, indices);
+        return;
+    }
+    for (size_t i = 0; i < count; i ++) {
+        if (!(data[i * stride] < threshold)) {
+            indices.push_back((uint32_t)i);
+        }
+    }
+}
+
+/**
+ * @brief element-wise running max over `num_planes` planes: out[i] = max_k planes[k][i]
+ *  > planes are visited in order and compared with `x > cur ? x : cur`, which is exactly
+ *    what _mm_max_ps(x, cur) does, so the result is identical to the scalar reduction
+ * @param data first plane
+ * @param plane_stride distance between two planes
+ * @param num_planes number of planes, should be >= 1
+ * @param count number of elements in one plane
+ * @param out output, `count` elements
+*/
+inline void planeMax(const float* data, size_t plane_stride, size_t num_planes, size_t count, float* out) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 8 <= count; i += 8) {
+        __m256 cur = _mm256_loadu_ps(data + i);
+        for (size_t k = 1; k < num_planes; k ++) {
+            cur = _mm256_max_ps(_mm256_loadu_ps(data + k * plane_stride + i), cur);
+        }
+        _mm256_storeu_ps(out + i, cur);
+    }
+#elif defined(__SSE2__)
+    for (; i + 4 <= count; i += 4) {
+        __m128 cur = _mm_loadu_ps(data + i);
+        for (size_t k = 1; k < num_planes; k ++) {
+            cur = _mm_max_ps(_mm_loadu_ps(data + k * plane_stride + i), cur);
+        }
+        _mm_storeu_ps(out + i, cur);
+    }
+#endif
+    for (; i < count; i ++) {
+        float cur = data[i];
+        for (size_t k = 1; k < num_planes; k ++) {
+            const float val = data[k * plane_stride + i];
+            cur = val > cur ? val : cur;
+        }
+        out[i] = cur;
+    }
+}
+
+/**
+ * @brief max over `num` strided values, same semantics as the scalar running max
+*/
+inline float stridedMax(const float* data, size_t stride, size_t num) {
+    float cur = data[0];
+    if (stride == 1 && !std::isnan(cur)) {
+        // lanes start from data[0], NaN candidates are skipped by max(x, cur) as in the scalar loop,
+        // the lane order does not matter since the maximum of non-NaN values is unique up to +-0
+        size_t i = 1;
+#if defined(__SSE2__) || defined(__AVX2__)
+        if (num >= 5) {
+            __m128 vcur = _mm_set1_ps(cur);
+            for (; i + 4 <= num; i += 4) {
+                vcur = _mm_max_ps(_mm_loadu_ps(data + i), vcur);
+            }
+            float lanes[4];
+            _mm_storeu_ps(lanes, vcur);
+            for (size_t l = 0; l < 4; l ++) {
+                cur = lanes[l] > cur ? lanes[l] : cur;
+            }
+        }
+#endif
+        for (; i < num; i ++) {
+            cur = data[i] > cur ? data[i] : cur;
+        }
+        return cur;
+    }
+    for (size_t i = 1; i < num; i ++) {
+        const float val = data[i * stride];
+        cur = val > cur ? val : cur;
+    }
+    return cur;
+}
+
+}   // namespace detection_simd
+
+}   // namespace inference
+
+}   // namespace ai
+
+}   // namespace hce
+
+#endif //#ifndef HCE_AI_INF_DETECTION_SIMD_KERNEL_HPP
@@ -0,0 +1,159 @@
+/*
+ * INTEL CONFIDENTIAL
+ *
+ * Copyright (C) 2024 Intel Corporation.
+ *
+ * This software and the related documents are Intel copyrighted materials, and your use of
+ * them is governed by the express license under which they were provided to you (License).
+ * Unless the License provides otherwise, you may not use, modify, copy, publish, distribute,
+ * disclose or transmit this software or the related documents without Intel's prior written permission.
+ *
+ * This software and the related documents are provided as is, with no express or implied warranties,
+ * other than those that are expressly stated in the License.
+*/
+
+#ifndef HCE_AI_INF_NMS_ENGINE_HPP
+#define HCE_AI_INF_NMS_ENGINE_HPP
+
+#include <cstdint>
+#include <vector>
+
+namespace hce{
+
+namespace ai{
+
+namespace inference{
+
+/**
+ * @brief Non-Maximum-Suppression engine working on preallocated index arrays
+ *  > candidates are stored as SoA, grouped by class with a stable counting sort into one
+ *    index array, then each class segment is sorted by confidence
+ *  > hard NMS sweeps one box against all following boxes with SIMD intersection tests,
+ *    a uniform grid is used to visit only nearby boxes for large candidate counts
+ *  > hard NMS keeps exactly the same boxes, in the same order within each class, as the
+ *    sort + erase reference implementation
+ *  > optional soft-NMS (linear / gaussian) decays scores instead of dropping boxes
+*/
+class NMSEngine {
+public:
+    enum class SoftNMSMethod_t {
+        NONE = 0,
+        LINEAR,
+        GAUSSIAN
+    };
+
+    struct Config {
+        float iou_threshold = 0.5f;
+        SoftNMSMethod_t soft_nms_method = SoftNMSMethod_t::NONE;
+        float soft_nms_sigma = 0.5f;                    // gaussian: score *= exp(-iou^2 / sigma)
+        float soft_nms_score_threshold = 0.001f;        // boxes with decayed score below it are dropped
+        size_t grid_min_candidates = 256;               // use spatial grid when a class has more candidates
+    };
+
+    /**
+     * @brief per-thread reusable buffers, grow to the high-water mark and are never shrunk
+    */
+    struct Workspace {
+        // candidates, in input order
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> x2;                          // x + w
+        std::vector<float> y2;                          // y + h
+        std::vector<float> area;                        // w * h
+        std::vector<float> score;
+        std::vector<int> label;
+
+        // candidate indices grouped by class, [segment_begin[k], segment_begin[k + 1]) for class slot k
+        std::vector<int> order;
+        std::vector<int> segment_begin;
+        std::vector<int> label_slot;                    // label -> class slot, -1 if unused in this frame
+        std::vector<int> slot_label;                    // class slot -> label
+        std::vector<int> slot_of;                       // candidate -> class slot
+        std::vector<int> cursor;                        // scatter cursors
+
+        // per-segment SoA in sorted order
+        std::vector<float> sx, sy, sx2, sy2, sarea, sscore;
+        std::vector<uint8_t> removed;
+
+        // spatial grid: items of cell c are cell_items[cell_begin[c], cell_begin[c + 1])
+        std::vector<int> cell_begin;
+        std::vector<int> cell_items;
+        std::vector<int> box_cells;                     // [cx0, cx1, cy0, cy1] per box
+
+        // soft-NMS: decayed scores, in input order
+        std::vector<float> soft_score;
+
+        // indices (in input order) of kept candidates, in output order
+        std::vector<int> kept;
+
+        void clear();
+
+        /**
+         * @brief append one candidate in (x, y, w, h) format
+        */
+        void push(float bx, float by, float bw, float bh, float confidence, int class_label);
+
+        size_t size() const {
+            return x.size();
+        }
+    };
+
+    NMSEngine() = default;
+    explicit NMSEngine(const Config& config);
+
+    /**
+     * @brief run NMS on all candidates in workspace
+     * @param ws workspace filled by Workspace::push()
+     * @param class_agnostic if false, boxes only suppress boxes with the same label.
+     *  Classes are emitted in the order of their first appearance in input.
+     *  Indices (in input order) of kept candidates are written to ws.kept in output order.
+     *  For soft-NMS, ws.soft_score holds the decayed scores of kept candidates.
+    */
+    void run(Workspace& ws, bool class_agnostic) const;
+
+    const Config& config() const {
+        return m_config;
+    }
+
+private:
+    Config m_config;
+
+    /**
+     * @brief group candidates by label with a stable counting sort
+    */
+    void groupByClass(Workspace& ws, bool class_agnostic) const;
+
+    /**
+     * @brief hard NMS over one sorted segment, brute-force sweep
+    */
+    void sweep(Workspace& ws, int begin, int end, std::vector<int>& kept) const;
+
+    /**
+     * @brief hard NMS over one sorted segment, candidates are visited through a uniform grid
+     * @return false if the grid can not be built (e.g, non-finite coordinates)
+    */
+    bool sweepWithGrid(Workspace& ws, int begin, int end, std::vector<int>& kept) const;
+
+    /**
+     * @brief soft-NMS over one segment
+    */
+    void softSweep(Workspace& ws, int begin, int end, std::vector<int>& kept) const;
+
+    /**
+     * @brief exact IoU test between sorted positions i and j, matches the reference implementation
+    */
+    bool overlapped(const Workspace& ws, int i, int j) const;
+
+    /**
+     * @brief IoU between sorted positions i and j
+    */
+    static double iou(const Workspace& ws, int i, int j);
+};
+
+}   // namespace inference
+
+}   // namespace ai
+
+}   // namespace hce
+
+#endif //#ifndef HCE_AI_INF_NMS_ENGINE_HPP
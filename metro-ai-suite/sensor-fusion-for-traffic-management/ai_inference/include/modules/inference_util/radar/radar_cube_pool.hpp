@@ -0,0 +1,127 @@
+/*
+ * INTEL CONFIDENTIAL
+ *
+ * Copyright (C) 2024 Intel Corporation.
+ *
+ * This software and the related documents are Intel copyrighted materials, and your use of
+ * them is governed by the express license under which they were provided to you (License).
+ * Unless the License provides otherwise, you may not use, modify, copy, publish, distribute,
+ * disclose or transmit this software or the related documents without Intel's prior written permission.
+ *
+ * This software and the related documents are provided as is, with no express or implied warranties,
+ * other than those that are expressly stated in the License.
+*/
+
+#ifndef HCE_AI_INF_RADAR_CUBE_POOL_HPP
+#define HCE_AI_INF_RADAR_CUBE_POOL_HPP
+
+#include <mutex>
+#include <memory>
+#include <vector>
+
+#include "modules/inference_util/radar/radar_detection_helper.hpp"
+
+namespace hce{
+
+namespace ai{
+
+namespace inference{
+
+#define RADAR_CUBE_POOL_MAX_FREE 16     // cubes kept for reuse, cubes released beyond are freed
+
+/**
+ * @brief recycling pool of radar cubes of adcSamples x numChirps x numRx*numTx, one pool for each stream
+ *
+ * The storage of an acquired cube goes back to the pool once the last copy of the cube is released, i.e. when
+ * the downstream buffers holding it are destroyed. The pool may be destroyed before its cubes, which are then
+ * freed on release.
+*/
+class RadarCubePool : public std::enable_shared_from_this<RadarCubePool> {
+public:
+    using Ptr = std::shared_ptr<RadarCubePool>;
+
+    static Ptr create(const RadarBasicConfig& radar_conf, std::size_t maxFree = RADAR_CUBE_POOL_MAX_FREE) {
+        return Ptr(new RadarCubePool(radar_conf.adcSamples, radar_conf.numChirps, radar_conf.numRx * radar_conf.numTx, maxFree));
+    }
+
+    ~RadarCubePool() {
+        for (auto data : m_free) {
+            delete[] data;
+        }
+    }
+
+    RadarCubePool(const RadarCubePool&) = delete;
+    RadarCubePool& operator=(const RadarCubePool&) = delete;
+
+    /**
+     * @brief take a cube from the pool, values are left from the previous use
+    */
+    ThreeDimArray<ComplexFloat> acquire() {
+        ComplexFloat* data = nullptr;
+        {
+            std::lock_guard<std::mutex> lg(m_mutex);
+            if (!m_free.empty()) {
+                data = m_free.back();
+                m_free.pop_back();
+            }
+            else {
+                m_allocated ++;
+            }
+        }
+        if (!data) {
+            data = new ComplexFloat[elements()];
+        }
+        std::weak_ptr<RadarCubePool> weakPool = shared_from_this();
+        std::shared_ptr<ComplexFloat[]> array(data, [weakPool](ComplexFloat* p) {
+            if (auto pool = weakPool.lock()) {
+                pool->release(p);
+            }
+            else {
+                delete[] p;
+            }
+        });
+        return ThreeDimArray<ComplexFloat>(m_samples, m_chirps, m_vrx, array);
+    }
+
+    std::size_t elements() const { return (std::size_t)m_samples * m_chirps * m_vrx; }
+
+    /**
+     * @brief cubes allocated by the pool so far
+    */
+    std::size_t allocated() const {
+        std::lock_guard<std::mutex> lg(m_mutex);
+        return m_allocated;
+    }
+
+private:
+    RadarCubePool(int samples, int chirps, int vrx, std::size_t maxFree)
+        : m_samples(samples), m_chirps(chirps), m_vrx(vrx), m_maxFree(maxFree), m_allocated(0) {}
+
+    void release(ComplexFloat* data) {
+        {
+            std::lock_guard<std::mutex> lg(m_mutex);
+            if (m_free.size() < m_maxFree) {
+                m_free.push_back(data);
+                return;
+            }
+            m_allocated --;
+        }
+        delete[] data;
+    }
+
+    const int m_samples;
+    const int m_chirps;
+    const int m_vrx;
+    const std::size_t m_maxFree;
+    std::size_t m_allocated;
+    std::vector<ComplexFloat*> m_free;
+    mutable std::mutex m_mutex;
+};
+
+}
+
+}
+
+}
+
+#endif //#ifndef HCE_AI_INF_RADAR_CUBE_POOL_HPP
@@ -100,6 +100,10 @@ class ThreeDimArray{
         array =std::shared_ptr<T[]>(new T[w*h*d]());
     }
 
+    // wrap the storage of w*h*d elements, e.g. taken from a pool, values are not initialized
+    ThreeDimArray(int w, int h, int d, std::shared_ptr<T[]> data):  array(data), m_width(w), m_height(h),m_depth(d){
+    }
+
     ~ThreeDimArray(){};
 
     ThreeDimArray(const ThreeDimArray& obj){
@@ -127,6 +131,37 @@ class ThreeDimArray{
     }
 };
 
+/**
+ * @brief format one radar frame into the radar cube and remove static clutter
+ * frame layout: [chirp][virtual rx][sample], cube: (sample, chirp, virtual rx) of adcSamples x numChirps x numRx*numTx
+ * @param frame input frame of at least adcSamples*numChirps*numRx*numTx values
+ * @param radar_conf radar basic config
+ * @param cube destination, every element is written
+*/
+inline void radarCubeFormat(const ComplexFloat* frame, const RadarBasicConfig& radar_conf, ThreeDimArray<ComplexFloat>& cube){
+    const int n_samples = radar_conf.adcSamples;
+    const int n_chirps = radar_conf.numChirps;
+    const int n_vrx = radar_conf.numRx * radar_conf.numTx;
+    ComplexFloat* dst = cube.array.get();
+
+    for (int k = 0; k < n_vrx; k++) {
+        for (int j = 0; j < n_chirps; j++) {
+            const ComplexFloat* src = frame + (j * n_vrx + k) * n_samples;
+            ComplexFloat* line = dst + j + k * n_samples * n_chirps;
+
+            // remove static clutter: the average over samples of each chirp and virtual rx
+            ComplexFloat avg(0, 0);
+            for (int i = 0; i < n_samples; i++) {
+                avg = avg + src[i];
+            }
+            avg = avg / n_samples;
+            for (int i = 0; i < n_samples; i++) {
+                line[i * n_chirps] = src[i] - avg;
+            }
+        }
+    }
+}
+
 class RadarCube {
 public:
     using Ptr = std::shared_ptr<RadarCube>;
@@ -137,61 +172,9 @@ public:
     };
     ~RadarCube(){}
     void  radarCube_format(ComplexFloat* frame){
-        TwoDimArray<ComplexFloat> cdata(m_n_vrx_, m_n_samples_* m_n_chirps_);
         HVA_DEBUG("Debug frame[0] data: real%d, imag%d", (int)frame[0].real(), (int)frame[0].imag());
-        for(int k=0;k<m_n_samples_* m_n_vrx_*m_n_chirps_;k++){
-            int temp_chirp = k/(m_n_samples_* m_n_vrx_);
-            int temp_sample = k%(m_n_samples_* m_n_vrx_);
-
-            int line_rx = temp_sample/m_n_samples_;
-            int sample_number = temp_sample%m_n_samples_;
-          
-
-            cdata.setValue(line_rx,temp_chirp*m_n_samples_+sample_number, frame[temp_chirp*m_n_vrx_*m_n_samples_+line_rx*m_n_samples_+sample_number] );
-        }
-       
-        for(int k=0;k<m_n_vrx_; k++){
-            for(int i=0;i<m_n_samples_; i++){
-                for(int j=0;j<m_n_chirps_; j++){
-                    radarCube_.setValue(i,j,k, cdata.at(k, j*m_n_samples_+i));
-                
-                }
-            }
-        }
-        // for radical, other dataset need to verify the correctness
-      
-        // for (int k = 0; k < m_n_vrx_; k++) {
-        //   for (int i = 0; i < m_n_samples_; i++) {
-        //     for (int j = 0; j < m_n_chirps_; j++) {
-        //       //nTX=2
-        //      int vx = (k%m_n_rx_)*m_n_tx_ +k/m_n_rx_;
-        //      radarCube_->setValue(i,j, vx, data_radar.at(i,j,k));
-
-        //     }
-        //   }
-        // }
-        
-        // remove static clutter 
-        TwoDimArray<ComplexFloat> avg(m_n_chirps_, m_n_vrx_);
-
-        for (int j = 0; j < m_n_chirps_; j++)
-        {
-            for (int m = 0; m < m_n_vrx_; m++)
-            {
-                for (int i = 0; i < m_n_samples_; i++)
-                {
-                    avg.setValue(j, m, avg.at(j, m) + radarCube_.at(i, j, m));
-                }
-                avg.setValue(j, m, avg.at(j, m) / m_n_samples_); // need operater/
-                for (int i = 0; i < m_n_samples_; i++)
-                {
-                    radarCube_.setValue(i, j, m, radarCube_.at(i, j, m) - avg.at(j, m));
-                }
-            }
-        }
-
+        radarCubeFormat(frame, radar_basic_conf_, radarCube_);
         HVA_DEBUG("radarCube_[0,31,7] data: real%d, imag%d", (int)radarCube_.at(0,31,7).real(), (int)radarCube_.at(0,31,7).imag());
-
     }
 
     std::shared_ptr<ComplexFloat[]> get_radar_cube_data(){
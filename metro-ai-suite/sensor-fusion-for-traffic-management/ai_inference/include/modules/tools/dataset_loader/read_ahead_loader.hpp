@@ -0,0 +1,251 @@
+/*
+ * INTEL CONFIDENTIAL
+ *
+ * Copyright (C) 2024 Intel Corporation.
+ *
+ * This software and the related documents are Intel copyrighted materials, and your use of
+ * them is governed by the express license under which they were provided to you (License).
+ * Unless the License provides otherwise, you may not use, modify, copy, publish, distribute,
+ * disclose or transmit this software or the related documents without Intel's prior written permission.
+ *
+ * This software and the related documents are provided as is, with no express or implied warranties,
+ * other than those that are expressly stated in the License.
+*/
+
+#pragma once
+
+#include <mutex>
+#include <deque>
+#include <cerrno>
+#include <string>
+#include <thread>
+#include <vector>
+#include <utility>
+#include <functional>
+#include <condition_variable>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace hce{
+
+namespace ai{
+
+namespace inference{
+
+namespace tools{
+
+#define READ_AHEAD_DEFAULT_DEPTH 4          // samples read ahead of the consumer
+#define READ_AHEAD_DEFAULT_THREAD_NUM 2     // I/O threads per loader
+
+/**
+ * @brief read a whole file into a contiguous container, e.g. std::string or std::vector<std::complex<float>>,
+ * reusing the capacity of `dst`. A trailing partial element is ignored.
+ * @return false if the file can not be read, `dst` is left empty
+*/
+template <typename Container>
+bool readFileInto(const std::string& path, Container& dst) {
+    using T = typename Container::value_type;
+    dst.clear();
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (0 != fstat(fd, &st)) {
+        ::close(fd);
+        return false;
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    dst.resize((size_t)st.st_size / sizeof(T));
+    if (dst.empty()) {
+        ::close(fd);
+        return true;
+    }
+    char* data = reinterpret_cast<char*>(&dst[0]);
+    size_t len = dst.size() * sizeof(T);
+    size_t got = 0;
+    while (got < len) {
+        ssize_t ret = ::read(fd, data + got, len - got);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            break;
+        }
+        got += (size_t)ret;
+    }
+    ::close(fd);
+    dst.resize(got / sizeof(T));
+    return got == len;
+}
+
+/**
+ * @brief read-ahead loader over a sequence of samples
+ *
+ * Samples [0, count) of a sequence are read by a small pool of I/O threads, at most `depth` samples ahead of
+ * the consumer. Each sample is read into one of `depth` pooled slots, next() swaps the slot with the sample
+ * of the consumer, so that the buffers of the previous sample go back to the pool and are reused by a later
+ * read instead of being reallocated. With a depth of 0 samples are read on the consumer thread.
+ *
+ *  ReadAheadLoader<Frame> loader(depth, threadNum, [&](size_t idx, Frame& frame) { read(paths[idx], frame); });
+ *  loader.start(paths.size());
+ *  Frame frame;
+ *  while (loader.next(frame)) { ... }
+*/
+template <typename Sample>
+class ReadAheadLoader {
+public:
+    using ReadFunc = std::function<void(size_t index, Sample& sample)>;
+
+    ReadAheadLoader(size_t depth, size_t threadNum, ReadFunc readFunc)
+        : m_depth(depth), m_readFunc(readFunc), m_slots(depth), m_count(0), m_next(0), m_inFlight(0), m_stop(false) {
+        if (m_depth > 0) {
+            threadNum = threadNum > 0 ? threadNum : 1;
+            for (size_t i = 0; i < threadNum; i ++) {
+                m_threads.emplace_back(&ReadAheadLoader::run, this);
+            }
+        }
+    };
+
+    ~ReadAheadLoader() {
+        {
+            std::lock_guard<std::mutex> lg(m_mutex);
+            m_stop = true;
+        }
+        m_taskCond.notify_all();
+        m_readyCond.notify_all();
+        for (auto& thread : m_threads) {
+            thread.join();
+        }
+    };
+
+    ReadAheadLoader(const ReadAheadLoader&) = delete;
+    ReadAheadLoader& operator=(const ReadAheadLoader&) = delete;
+
+    /**
+     * @brief start a sequence of `count` samples, samples of the previous sequence not taken yet are discarded
+    */
+    void start(size_t count) {
+        std::unique_lock<std::mutex> lk(m_mutex);
+        cancelLocked(lk);
+        m_count = count;
+        m_next = 0;
+        for (size_t i = 0; i < m_depth && i < m_count; i ++) {
+            m_slots[i].index = i;
+            m_tasks.push_back(i);
+        }
+        lk.unlock();
+        m_taskCond.notify_all();
+    };
+
+    /**
+     * @brief drop the pending reads and wait for the ones in flight, inputs of the read function may be changed after
+    */
+    void cancel() {
+        std::unique_lock<std::mutex> lk(m_mutex);
+        cancelLocked(lk);
+        m_count = 0;
+        m_next = 0;
+    };
+
+    /**
+     * @brief take the next sample of the sequence, blocking until it is read
+     * @param sample receives the sample, its previous buffers are handed back to the pool
+     * @return false once all samples of the sequence are taken
+    */
+    bool next(Sample& sample) {
+        if (0 == m_depth) {
+            if (m_next >= m_count) {
+                return false;
+            }
+            m_readFunc(m_next ++, sample);
+            return true;
+        }
+
+        std::unique_lock<std::mutex> lk(m_mutex);
+        if (m_next >= m_count) {
+            return false;
+        }
+        Slot& slot = m_slots[m_next % m_depth];
+        m_readyCond.wait(lk, [&]() { return slot.ready || m_stop; });
+        if (m_stop) {
+            return false;
+        }
+        std::swap(slot.sample, sample);
+        slot.ready = false;
+
+        // refill the slot with the sample `depth` ahead
+        size_t upcoming = m_next + m_depth;
+        m_next ++;
+        if (upcoming < m_count) {
+            slot.index = upcoming;
+            m_tasks.push_back(upcoming % m_depth);
+            lk.unlock();
+            m_taskCond.notify_one();
+        }
+        return true;
+    };
+
+    size_t depth() const { return m_depth; };
+
+private:
+    struct Slot {
+        Sample sample;
+        size_t index = 0;
+        bool ready = false;
+    };
+
+    void cancelLocked(std::unique_lock<std::mutex>& lk) {
+        m_tasks.clear();
+        m_readyCond.wait(lk, [&]() { return 0 == m_inFlight || m_stop; });
+        for (auto& slot : m_slots) {
+            slot.ready = false;
+        }
+    };
+
+    void run() {
+        std::unique_lock<std::mutex> lk(m_mutex);
+        while (true) {
+            m_taskCond.wait(lk, [&]() { return !m_tasks.empty() || m_stop; });
+            if (m_stop) {
+                return;
+            }
+            size_t slotIdx = m_tasks.front();
+            m_tasks.pop_front();
+            Slot& slot = m_slots[slotIdx];
+            m_inFlight ++;
+            lk.unlock();
+
+            m_readFunc(slot.index, slot.sample);
+
+            lk.lock();
+            m_inFlight --;
+            slot.ready = true;
+            m_readyCond.notify_all();
+        }
+    };
+
+    size_t m_depth;
+    ReadFunc m_readFunc;
+    std::vector<Slot> m_slots;
+    std::deque<size_t> m_tasks;         // slots to be read
+    size_t m_count;                     // samples in the current sequence
+    size_t m_next;                      // next sample to be taken
+    size_t m_inFlight;                  // reads running on the I/O threads
+    bool m_stop;
+    std::mutex m_mutex;
+    std::condition_variable m_taskCond;
+    std::condition_variable m_readyCond;
+    std::vector<std::thread> m_threads;
+};
+
+} // namespace tools
+
+} // namespace inference
+
+} // namespace ai
+
+} // namespace hce
@@ -0,0 +1,372 @@
+/*
+ * INTEL CONFIDENTIAL
+ *
+ * Copyright (C) 2024 Intel Corporation.
+ *
+ * This software and the related documents are Intel copyrighted materials, and your use of
+ * them is governed by the express license under which they were provided to you (License).
+ * Unless the License provides otherwise, you may not use, modify, copy, publish, distribute,
+ * disclose or transmit this software or the related documents without Intel's prior written permission.
+ *
+ * This software and the related documents are provided as is, with no express or implied warranties,
+ * other than those that are expressly stated in the License.
+*/
+
+#pragma once
+
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <type_traits>
+#include <condition_variable>
+
+namespace hce{
+
+namespace ai{
+
+namespace inference{
+
+namespace tools{
+
+#define RESULT_FILE_MAGIC "HCERSLT"             // 8 bytes including the terminating null
+#define RESULT_FILE_VERSION 1u
+#define RESULT_WRITER_QUEUE_SIZE 4096           // max records pending in the writer queue
+#define RESULT_WRITER_FILE_BUFFER_SIZE (1 << 16)
+
+/**
+ * Binary result file, append-only, integers in native (little endian) byte order:
+ *
+ *  header:  magic[8] | u32 version | u32 columnCount | columnCount * column
+ *  column:  u8 type | u8 flags | u16 groupSize | u16 nameLength | name
+ *  record:  u32 payloadLength | payload
+ *  payload: for each column in order, u32 count | count * value
+ *  value:   fixed size for numbers, u32 length | bytes for strings
+ *
+ * Each record is one line of the csv converted by `ResultFileConverter`. The header is written once when the
+ * file is created and never patched, columns of varying names are stored as key-value pairs and expanded to
+ * csv columns by the converter.
+*/
+enum ResultColumnType : uint8_t {
+    RESULT_COLUMN_INT32 = 0,
+    RESULT_COLUMN_UINT32,
+    RESULT_COLUMN_INT64,
+    RESULT_COLUMN_UINT64,
+    RESULT_COLUMN_FLOAT32,
+    RESULT_COLUMN_FLOAT64,
+    RESULT_COLUMN_STRING,
+    RESULT_COLUMN_KEY_VALUE     // string pairs {name, value}, each name becomes a csv column
+};
+
+enum ResultColumnFlag : uint8_t {
+    RESULT_COLUMN_FLAG_NONE = 0,
+    RESULT_COLUMN_FLAG_LIST = 1     // csv cell lists values followed by a space each, otherwise values are the cell
+};
+
+struct ResultColumn {
+    ResultColumn(const std::string& n, ResultColumnType t, uint8_t f = RESULT_COLUMN_FLAG_NONE, uint16_t g = 0)
+        : name(n), type(t), flags(f), groupSize(g) {};
+
+    std::string name;
+    ResultColumnType type;
+    uint8_t flags;
+    uint16_t groupSize;     // list values are closed by a blank in csv every `groupSize` values, 0 for none
+};
+
+/**
+ * @brief one record serialized on the pipeline thread, columns are put in the order of the file columns
+ *
+ *  record.put(frameId).beginList();
+ *  for (auto& item : items) record.add(item.value);
+ *  record.endList();
+*/
+class ResultRecord {
+public:
+    ResultRecord() : m_listAt(0), m_listCount(0) {
+        m_data.reserve(256);
+        m_data.resize(sizeof(uint32_t));    // payload length, set by finish()
+    };
+
+    template<typename T>
+    ResultRecord& put(const T& value) {
+        return beginList().add(value).endList();
+    }
+
+    template<typename T>
+    ResultRecord& putList(const std::vector<T>& values) {
+        beginList();
+        for (const auto& value : values) {
+            add(value);
+        }
+        return endList();
+    }
+
+    /**
+     * @brief open a column of any number of values, closed by endList()
+    */
+    ResultRecord& beginList() {
+        m_listAt = m_data.size();
+        m_listCount = 0;
+        m_data.resize(m_data.size() + sizeof(uint32_t));
+        return *this;
+    }
+
+    template<typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value, ResultRecord&>::type add(T value) {
+        append(&value, sizeof(T));
+        m_listCount ++;
+        return *this;
+    }
+
+    ResultRecord& add(const std::string& value) {
+        uint32_t len = (uint32_t)value.size();
+        append(&len, sizeof(len));
+        append(value.data(), value.size());
+        m_listCount ++;
+        return *this;
+    }
+
+    ResultRecord& add(const char* value) {
+        return add(std::string(value));
+    }
+
+    ResultRecord& endList() {
+        std::memcpy(&m_data[m_listAt], &m_listCount, sizeof(m_listCount));
+        return *this;
+    }
+
+    /**
+     * @brief write the payload length, called by the writer
+     * @return the framed record
+    */
+    std::string& finish() {
+        uint32_t len = (uint32_t)(m_data.size() - sizeof(uint32_t));
+        std::memcpy(&m_data[0], &len, sizeof(len));
+        return m_data;
+    }
+
+private:
+    void append(const void* src, size_t len) {
+        size_t at = m_data.size();
+        m_data.resize(at + len);
+        std::memcpy(&m_data[at], src, len);
+    }
+
+    std::string m_data;
+    size_t m_listAt;
+    uint32_t m_listCount;
+};
+
+/**
+ * @brief handle of a result file, the file itself is only touched by the writer thread
+*/
+class ResultFile {
+public:
+    using Ptr = std::shared_ptr<ResultFile>;
+
+    ResultFile(const std::string& path, const std::vector<ResultColumn>& columns)
+        : m_path(path), m_columns(columns), m_fp(nullptr), m_failed(false), m_queued(0), m_written(0) {};
+
+    ~ResultFile();
+
+    const std::string& path() const { return m_path; };
+
+    /**
+     * @brief whether the file failed to be created or written, records appended after are discarded
+    */
+    bool failed() const { return m_failed.load(); };
+
+private:
+    friend class AsyncResultWriter;
+
+    std::string m_path;
+    std::vector<ResultColumn> m_columns;
+    FILE* m_fp;
+    std::atomic<bool> m_failed;
+    uint64_t m_queued;      // tasks queued to the file, guarded by the writer mutex
+    uint64_t m_written;     // tasks written and flushed, guarded by the writer mutex
+};
+
+/**
+ * @brief background writer shared by the result sink nodes
+ *
+ * Nodes serialize a ResultRecord on their own thread and hand it over with append(), the writer thread writes the
+ * queued records in batches and flushes once per batch, so that the pipeline never waits for the disk unless
+ * RESULT_WRITER_QUEUE_SIZE records are pending, in which case append() blocks rather than losing results.
+*/
+class AsyncResultWriter {
+public:
+    static AsyncResultWriter& getInstance();
+
+    ~AsyncResultWriter();
+
+    AsyncResultWriter(const AsyncResultWriter&) = delete;
+    AsyncResultWriter& operator=(const AsyncResultWriter&) = delete;
+
+    /**
+     * @brief declare a result file, created with its header by the writer thread along with the first record
+     * @param path file path, parent folders are created as needed
+     * @param columns columns of each record
+    */
+    ResultFile::Ptr open(const std::string& path, const std::vector<ResultColumn>& columns);
+
+    /**
+     * @brief queue a record to the file
+     * @return false if the file failed
+    */
+    bool append(const ResultFile::Ptr& file, ResultRecord&& record);
+
+    /**
+     * @brief close the file once its queued records are written
+    */
+    void close(const ResultFile::Ptr& file);
+
+    /**
+     * @brief wait until all queued records are written and flushed
+    */
+    void flush();
+
+    /**
+     * @brief wait until the records queued to the file so far are written and flushed, records of other files
+     * and records queued later are not waited for
+    */
+    void flush(const ResultFile::Ptr& file);
+
+private:
+    AsyncResultWriter();
+
+    struct Task {
+        ResultFile::Ptr file;
+        std::string data;
+        bool close;
+        uint64_t seq;       // position of the task among the tasks of its file
+    };
+
+    void push(Task&& task);
+    void run();
+    bool write(ResultFile& file, const std::string& data);
+    bool createFile(ResultFile& file);
+
+    std::deque<Task> m_queue;
+    std::mutex m_mutex;
+    std::condition_variable m_notEmpty;
+    std::condition_variable m_notFull;
+    std::condition_variable m_drained;
+    bool m_busy;
+    bool m_stop;
+    std::thread m_thread;
+};
+
+/**
+ * @brief cursor over the values of one record payload, columns are read in the order of the file columns
+*/
+class ResultPayloadCursor {
+public:
+    ResultPayloadCursor(const char* data = nullptr, size_t len = 0) : m_data(data), m_left(len) {};
+
+    template<typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value, bool>::type get(T& value) {
+        return read(&value, sizeof(T));
+    }
+
+    bool get(std::string& value) {
+        uint32_t len = 0;
+        if (!get(len) || m_left < len) {
+            return false;
+        }
+        value.assign(m_data, len);
+        m_data += len;
+        m_left -= len;
+        return true;
+    }
+
+    bool read(void* dst, size_t len) {
+        if (m_left < len) {
+            return false;
+        }
+        std::memcpy(dst, m_data, len);
+        m_data += len;
+        m_left -= len;
+        return true;
+    }
+
+    /**
+     * @brief skip one value of the column type
+    */
+    bool skip(ResultColumnType type);
+
+    size_t left() const { return m_left; };
+
+private:
+    const char* m_data;
+    size_t m_left;
+};
+
+/**
+ * @brief read-only view of a binary result file mapped into memory, records are read in place
+*/
+class MappedResultFile {
+public:
+    MappedResultFile() : m_data(nullptr), m_size(0), m_dataOffset(0), m_offset(0) {};
+
+    ~MappedResultFile();
+
+    MappedResultFile(const MappedResultFile&) = delete;
+    MappedResultFile& operator=(const MappedResultFile&) = delete;
+
+    /**
+     * @brief whether the file starts with the result file magic
+    */
+    static bool isResultFile(const std::string& path);
+
+    /**
+     * @brief map the file and parse its header
+     * @param error description on failure
+    */
+    bool open(const std::string& path, std::string& error);
+
+    const std::vector<ResultColumn>& columns() const { return m_columns; };
+
+    /**
+     * @brief move to the next record
+     * @param payload cursor over the record payload
+     * @return false at the end of file, error is set on a truncated record
+    */
+    bool next(ResultPayloadCursor& payload, std::string& error);
+
+    /**
+     * @brief move back to the first record
+    */
+    void rewind() { m_offset = m_dataOffset; };
+
+private:
+    const char* m_data;
+    size_t m_size;
+    size_t m_dataOffset;
+    size_t m_offset;
+    std::vector<ResultColumn> m_columns;
+};
+
+/**
+ * @brief read a binary result file and write it as csv, the same layout as written by the sink nodes before
+ * @param srcPath binary result file
+ * @param dst csv output
+ * @param error description on failure
+ * @return false on a malformed or truncated file, the records before the failure are written
+*/
+bool convertResultFileToCsv(const std::string& srcPath, std::ostream& dst, std::string& error);
+
+} // namespace tools
+
+} // namespace inference
+
+} // namespace ai
+
+} // namespace hce
@@ -0,0 +1,324 @@
+/*
+ * INTEL CONFIDENTIAL
+ *
+ * Copyright (C) 2024 Intel Corporation.
+ *
+ * This software and the related documents are Intel copyrighted materials, and your use of
+ * them is governed by the express license under which they were provided to you (License).
+ * Unless the License provides otherwise, you may not use, modify, copy, publish, distribute,
+ * disclose or transmit this software or the related documents without Intel's prior written permission.
+ *
+ * This software and the related documents are provided as is, with no express or implied warranties,
+ * other than those that are expressly stated in the License.
+*/
+
+#pragma once
+
+#include <mutex>
+#include <deque>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <condition_variable>
+
+#include "modules/tools/uploader/object_store.hpp"
+
+namespace hce{
+
+namespace ai{
+
+namespace inference{
+
+namespace tools{
+
+#define UPLOAD_DEFAULT_QUEUE_SIZE 16            // uploads in flight, submitted and not done yet
+#define UPLOAD_DEFAULT_ENCODE_THREAD_NUM 2
+#define UPLOAD_DEFAULT_UPLOAD_THREAD_NUM 2
+#define UPLOAD_DEFAULT_BATCH_SIZE 4             // objects put in one batch
+#define UPLOAD_DEFAULT_MAX_RETRIES 3
+#define UPLOAD_DEFAULT_RETRY_BACKOFF_MS 100     // backoff before the first retry, doubled for each further one
+#define UPLOAD_MAX_RETRY_BACKOFF_MS 5000
+
+enum class QueueFullPolicy {
+    Block = 0,      // block the submitter until there is room
+    Drop,           // drop new uploads while the queue is full
+};
+
+struct AsyncUploaderConfig {
+    size_t queueSize = UPLOAD_DEFAULT_QUEUE_SIZE;
+    size_t encodeThreadNum = UPLOAD_DEFAULT_ENCODE_THREAD_NUM;
+    size_t uploadThreadNum = UPLOAD_DEFAULT_UPLOAD_THREAD_NUM;
+    size_t batchSize = UPLOAD_DEFAULT_BATCH_SIZE;
+    unsigned maxRetries = UPLOAD_DEFAULT_MAX_RETRIES;
+    unsigned retryBackoffMs = UPLOAD_DEFAULT_RETRY_BACKOFF_MS;
+    QueueFullPolicy policy = QueueFullPolicy::Block;
+};
+
+struct AsyncUploaderStatistics {
+    uint64_t submitted = 0;
+    uint64_t dropped = 0;       // dropped as the queue is full
+    uint64_t uploaded = 0;
+    uint64_t failed = 0;        // failed to encode, or to put after all retries
+    uint64_t retries = 0;       // objects put again
+    uint64_t batches = 0;       // batches put, retries included
+};
+
+/**
+ * @brief an upload: the object to store, with its content encoded on an encode thread
+ * @param encode fills the object content, e.g. jpeg encoding of a frame it holds
+ * @param done optional, called on an upload thread once the object is stored or given up
+*/
+struct UploadJob {
+    UploadObject object;
+    std::function<bool(std::string& content)> encode;
+    std::function<void(const UploadObject& object, bool stored)> done;
+};
+
+/**
+ * @brief asynchronous uploader, moving encoding and storage latency off the pipeline thread
+ *
+ * Submitted jobs are encoded by a pool of encode threads, then put in batches of up to `batchSize` by the upload
+ * threads, each owning a store made by the store factory. Stores are all made on the thread constructing the
+ * uploader, so the factory needs not be thread safe. Failed puts are retried with exponential backoff.
+ * At most `queueSize` jobs are in flight, beyond which new jobs are dropped or the submitter is blocked
+ * according to the policy, so that a slow store costs uploads or latency but never unbounded memory.
+ *
+ *  AsyncUploader uploader(config, [&]() { return std::make_shared<FileObjectStore>(directory); });
+ *  uploader.submit(std::move(job));
+ *  ...
+ *  uploader.stop();
+*/
+class AsyncUploader {
+public:
+    using StoreFactory = std::function<ObjectStore::Ptr()>;
+
+    AsyncUploader(const AsyncUploaderConfig& config, StoreFactory storeFactory)
+        : m_config(config), m_storeFactory(storeFactory), m_inFlight(0), m_encoding(0), m_stop(false) {
+        m_config.queueSize = std::max<size_t>(m_config.queueSize, 1);
+        m_config.batchSize = std::max<size_t>(m_config.batchSize, 1);
+        m_config.encodeThreadNum = std::max<size_t>(m_config.encodeThreadNum, 1);
+        m_config.uploadThreadNum = std::max<size_t>(m_config.uploadThreadNum, 1);
+        for (size_t i = 0; i < m_config.encodeThreadNum; i ++) {
+            m_threads.emplace_back(&AsyncUploader::encodeLoop, this);
+        }
+        for (size_t i = 0; i < m_config.uploadThreadNum; i ++) {
+            m_threads.emplace_back(&AsyncUploader::uploadLoop, this, m_storeFactory());
+        }
+    };
+
+    ~AsyncUploader() {
+        stop();
+    };
+
+    AsyncUploader(const AsyncUploader&) = delete;
+    AsyncUploader& operator=(const AsyncUploader&) = delete;
+
+    /**
+     * @brief queue a job, dropping it or blocking while the queue is full according to the policy
+     * @return false if the job is dropped, or the uploader is stopped
+    */
+    bool submit(UploadJob&& job) {
+        std::unique_lock<std::mutex> lk(m_mutex);
+        if (m_config.policy == QueueFullPolicy::Block) {
+            m_spaceCond.wait(lk, [&]() { return m_inFlight < m_config.queueSize || m_stop; });
+        }
+        if (m_stop || m_inFlight >= m_config.queueSize) {
+            m_stats.dropped ++;
+            return false;
+        }
+        m_stats.submitted ++;
+        m_inFlight ++;
+        m_encodeQueue.push_back(std::move(job));
+        lk.unlock();
+        m_encodeCond.notify_one();
+        return true;
+    };
+
+    /**
+     * @brief finish the jobs in flight and stop the threads, later jobs are dropped
+    */
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lg(m_mutex);
+            if (m_stop) {
+                return;
+            }
+            m_stop = true;
+        }
+        m_encodeCond.notify_all();
+        m_uploadCond.notify_all();
+        m_spaceCond.notify_all();
+        for (auto& thread : m_threads) {
+            thread.join();
+        }
+        m_threads.clear();
+    };
+
+    AsyncUploaderStatistics statistics() const {
+        std::lock_guard<std::mutex> lg(m_mutex);
+        return m_stats;
+    };
+
+    /**
+     * @brief one line statistics for logging
+    */
+    std::string report() const {
+        AsyncUploaderStatistics stats = statistics();
+        char tmp[256];
+        snprintf(tmp, sizeof(tmp), "uploads submitted %lu, uploaded %lu, failed %lu, dropped %lu, retried %lu, "
+                 "in %lu batches", (unsigned long)stats.submitted, (unsigned long)stats.uploaded,
+                 (unsigned long)stats.failed, (unsigned long)stats.dropped, (unsigned long)stats.retries,
+                 (unsigned long)stats.batches);
+        return tmp;
+    };
+
+private:
+    void encodeLoop() {
+        std::unique_lock<std::mutex> lk(m_mutex);
+        while (true) {
+            m_encodeCond.wait(lk, [&]() { return !m_encodeQueue.empty() || m_stop; });
+            if (m_encodeQueue.empty()) {
+                // stopped with nothing left to encode
+                return;
+            }
+            UploadJob job = std::move(m_encodeQueue.front());
+            m_encodeQueue.pop_front();
+            m_encoding ++;
+            lk.unlock();
+
+            bool encoded = !job.encode || job.encode(job.object.content);
+            // release what the encoder holds, e.g. the frame, before waiting for the upload
+            job.encode = nullptr;
+
+            lk.lock();
+            m_encoding --;
+            if (encoded) {
+                m_uploadQueue.push_back(std::move(job));
+            }
+            else {
+                m_stats.failed ++;
+                m_inFlight --;
+            }
+            lk.unlock();
+            if (!encoded) {
+                if (job.done) {
+                    job.done(job.object, false);
+                }
+                m_spaceCond.notify_one();
+            }
+            // upload threads may be waiting for the last encoding to stop
+            m_uploadCond.notify_all();
+            lk.lock();
+        }
+    };
+
+    void uploadLoop(ObjectStore::Ptr store) {
+        std::vector<UploadJob> batch;
+        std::unique_lock<std::mutex> lk(m_mutex);
+        while (true) {
+            m_uploadCond.wait(lk, [&]() {
+                return !m_uploadQueue.empty() || (m_stop && m_encodeQueue.empty() && 0 == m_encoding);
+            });
+            if (m_uploadQueue.empty()) {
+                // stopped with nothing left to upload
+                return;
+            }
+            batch.clear();
+            while (!m_uploadQueue.empty() && batch.size() < m_config.batchSize) {
+                batch.push_back(std::move(m_uploadQueue.front()));
+                m_uploadQueue.pop_front();
+            }
+            lk.unlock();
+
+            std::vector<bool> stored = putWithRetries(store, batch);
+
+            size_t uploaded = std::count(stored.begin(), stored.end(), true);
+            lk.lock();
+            m_stats.uploaded += uploaded;
+            m_stats.failed += batch.size() - uploaded;
+            m_inFlight -= batch.size();
+            lk.unlock();
+            m_spaceCond.notify_all();
+            for (size_t i = 0; i < batch.size(); i ++) {
+                if (batch[i].done) {
+                    batch[i].done(batch[i].object, stored[i]);
+                }
+            }
+            lk.lock();
+        }
+    };
+
+    /**
+     * @brief put a batch, putting its failed objects again after a backoff, up to maxRetries times
+    */
+    std::vector<bool> putWithRetries(const ObjectStore::Ptr& store, const std::vector<UploadJob>& batch) {
+        std::vector<bool> stored(batch.size(), false);
+        if (!store) {
+            return stored;
+        }
+        std::vector<size_t> pending(batch.size());
+        for (size_t i = 0; i < batch.size(); i ++) {
+            pending[i] = i;
+        }
+        std::vector<const UploadObject*> objects;
+        std::vector<bool> results;
+        unsigned backoffMs = m_config.retryBackoffMs;
+        for (unsigned attempt = 0; attempt <= m_config.maxRetries && !pending.empty(); attempt ++) {
+            if (attempt > 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(backoffMs));
+                backoffMs = std::min(backoffMs * 2, (unsigned)UPLOAD_MAX_RETRY_BACKOFF_MS);
+                std::lock_guard<std::mutex> lg(m_mutex);
+                m_stats.retries += pending.size();
+            }
+            objects.clear();
+            for (size_t idx : pending) {
+                objects.push_back(&batch[idx].object);
+            }
+            results.clear();
+            store->putBatch(objects, results);
+            {
+                std::lock_guard<std::mutex> lg(m_mutex);
+                m_stats.batches ++;
+            }
+
+            std::vector<size_t> failed;
+            for (size_t i = 0; i < pending.size(); i ++) {
+                if (i < results.size() && results[i]) {
+                    stored[pending[i]] = true;
+                }
+                else {
+                    failed.push_back(pending[i]);
+                }
+            }
+            pending.swap(failed);
+        }
+        return stored;
+    };
+
+    AsyncUploaderConfig m_config;
+    StoreFactory m_storeFactory;
+    std::deque<UploadJob> m_encodeQueue;    // jobs to be encoded
+    std::deque<UploadJob> m_uploadQueue;    // encoded jobs to be put
+    size_t m_inFlight;                      // jobs submitted and not done yet
+    size_t m_encoding;                      // jobs being encoded
+    bool m_stop;
+    AsyncUploaderStatistics m_stats;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_encodeCond;
+    std::condition_variable m_uploadCond;
+    std::condition_variable m_spaceCond;
+    std::vector<std::thread> m_threads;
+};
+
+} // namespace tools
+
+} // namespace inference
+
+} // namespace ai
+
+} // namespace hce
@@ -0,0 +1,172 @@
+/*
+ * INTEL CONFIDENTIAL
+ *
+ * Copyright (C) 2024 Intel Corporation.
+ *
+ * This software and the related documents are Intel copyrighted materials, and your use of
+ * them is governed by the express license under which they were provided to you (License).
+ * Unless the License provides otherwise, you may not use, modify, copy, publish, distribute,
+ * disclose or transmit this software or the related documents without Intel's prior written permission.
+ *
+ * This software and the related documents are provided as is, with no express or implied warranties,
+ * other than those that are expressly stated in the License.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cerrno>
+#include <cstdio>
+#include <cstdint>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace hce{
+
+namespace ai{
+
+namespace inference{
+
+namespace tools{
+
+/**
+ * @brief an object to be stored: encoded content and its media attributes, addressed by uri
+*/
+struct UploadObject {
+    std::string uri;
+    std::string attributes;
+    std::string content;
+};
+
+/**
+ * @brief storage backend of uploads
+ *
+ * A store is used by one thread at a time. Backends able to put several objects in one request override putBatch(),
+ * the default puts the objects one by one.
+*/
+class ObjectStore {
+public:
+    using Ptr = std::shared_ptr<ObjectStore>;
+
+    virtual ~ObjectStore() {};
+
+    /**
+     * @brief generate a new media uri
+    */
+    virtual bool generateURI(const std::string& mediaType, const std::string& dataSource, std::string& uri) = 0;
+
+    /**
+     * @brief store one object
+    */
+    virtual bool put(const UploadObject& object) = 0;
+
+    /**
+     * @brief store a batch of objects
+     * @param results results[i] is set to whether batch[i] is stored
+    */
+    virtual void putBatch(const std::vector<const UploadObject*>& batch, std::vector<bool>& results) {
+        results.resize(batch.size());
+        for (size_t i = 0; i < batch.size(); i ++) {
+            results[i] = put(*batch[i]);
+        }
+    };
+};
+
+/**
+ * @brief stand-in store on the local file system, for testing without the media storage service
+ *
+ * Object `uri` is written to <directory>/<uri>.jpg along with its attributes in <directory>/<uri>.json. A request
+ * latency can be set to mimic a remote store, a batch costs one request. Every `failEvery`-th request fails
+ * without writing anything, for testing retries.
+*/
+class FileObjectStore : public ObjectStore {
+public:
+    FileObjectStore(const std::string& directory, unsigned latencyMs = 0, unsigned failEvery = 0)
+        : m_directory(directory), m_latencyMs(latencyMs), m_failEvery(failEvery), m_requests(0) {
+        ::mkdir(m_directory.c_str(), 0755);
+    };
+
+    virtual bool generateURI(const std::string& mediaType, const std::string& dataSource, std::string& uri) override {
+        static std::atomic<uint64_t> counter(0);
+        char tmp[64];
+        snprintf(tmp, sizeof(tmp), "%016llx%08x%08llx",
+                 (unsigned long long)std::chrono::system_clock::now().time_since_epoch().count(), (unsigned)getpid(),
+                 (unsigned long long)counter ++);
+        uri = mediaType + "_" + dataSource + "_" + tmp;
+        return true;
+    };
+
+    virtual bool put(const UploadObject& object) override {
+        if (!request()) {
+            return false;
+        }
+        return write(object);
+    };
+
+    virtual void putBatch(const std::vector<const UploadObject*>& batch, std::vector<bool>& results) override {
+        bool ok = request();
+        results.resize(batch.size());
+        for (size_t i = 0; i < batch.size(); i ++) {
+            results[i] = ok && write(*batch[i]);
+        }
+    };
+
+    /**
+     * @brief requests served, including the failed ones
+    */
+    uint64_t requests() const { return m_requests; };
+
+private:
+    bool request() {
+        if (m_latencyMs > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(m_latencyMs));
+        }
+        uint64_t count = ++ m_requests;
+        return m_failEvery == 0 || count % m_failEvery != 0;
+    };
+
+    bool write(const UploadObject& object) {
+        std::string path = m_directory + "/" + object.uri;
+        return writeFile(path + ".jpg", object.content) && writeFile(path + ".json", object.attributes);
+    };
+
+    static bool writeFile(const std::string& path, const std::string& content) {
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            return false;
+        }
+        size_t written = 0;
+        while (written < content.size()) {
+            ssize_t ret = ::write(fd, content.data() + written, content.size() - written);
+            if (ret < 0 && errno == EINTR) {
+                continue;
+            }
+            if (ret <= 0) {
+                break;
+            }
+            written += (size_t)ret;
+        }
+        ::close(fd);
+        return written == content.size();
+    };
+
+    std::string m_directory;
+    unsigned m_latencyMs;
+    unsigned m_failEvery;
+    std::atomic<uint64_t> m_requests;
+};
+
+} // namespace tools
+
+} // namespace inference
+
+} // namespace ai
+
+} // namespace hce
@@ -20,6 +20,9 @@
 #include <thread>
 #include <inc/api/hvaPipeline.hpp>
 #include <inc/util/hvaUtil.hpp>
+#include <inc/buffer/hvaVideoFrameWithROIBuf.hpp>
+
+#include "modules/decode_util/jpeg_decode_helper.hpp"
 
 extern "C"
 {
@@ -70,13 +73,9 @@ public:
     /**
      * @brief to decode images from string buffer
      * @param imageData string buffer
-     * @param dst decoded image
-     * @param dstWidth decoded image width
-     * @param dstHeight decoded image height
-     * @param dstBufsize buffer size for decoded image 
+     * @param hvabuf buffer holding the decoded BGR image
      */
-    bool decodeImage(std::string& imageData, uint8_t* (&dst)[4], unsigned& dstWidth, unsigned& dstHeight, 
-                     int dstLinesize[4], unsigned& dstBufsize);
+    bool decodeImage(const std::string& imageData, hva::hvaVideoFrameWithROIBuf_t::Ptr& hvabuf);
     
     /**
      * @brief encode BGR image from AVFrame data
@@ -110,6 +109,7 @@ private:
     bool m_StartFlag;
     encodeType m_EncodeType;
     int m_workStreamId;
+    FFmpegJpegDecoder m_decoder;
 };
 
 }
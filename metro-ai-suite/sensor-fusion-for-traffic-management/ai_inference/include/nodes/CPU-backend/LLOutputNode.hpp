@@ -20,8 +20,10 @@
 #include <boost/property_tree/json_parser.hpp>
 
 #include <inc/util/hvaConfigStringParser.hpp>
+#include <inc/buffer/hvaVideoFrameWithROIBuf.hpp>
 
 #include "nodes/base/baseResponseNode.hpp"
+#include "nodes/databaseMeta.hpp"
 
 namespace hce{
 
@@ -35,6 +37,17 @@ public:
 
     virtual void process(std::size_t batchIdx) override;
 private:
+    /**
+     * @brief format rois and attributes as json message
+    */
+    std::string makeJsonMessage(const hva::hvaVideoFrameWithROIBuf_t::Ptr& buf, HceDatabaseMeta& videoMeta, double latency);
+
+    /**
+     * @brief fill rois and attributes into typed result, same content as json message
+    */
+    std::shared_ptr<baseResponseNode::Result> makeResult(const hva::hvaBlob_t::Ptr& inBlob, const hva::hvaVideoFrameWithROIBuf_t::Ptr& buf,
+                                                         HceDatabaseMeta& videoMeta, double latency);
+
     boost::property_tree::ptree m_jsonTree;
     boost::property_tree::ptree m_roi, m_rois;
     boost::property_tree::ptree m_roiData;
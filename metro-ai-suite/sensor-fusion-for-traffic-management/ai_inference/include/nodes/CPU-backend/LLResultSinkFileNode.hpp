@@ -31,6 +31,7 @@
 
 #include "nodes/databaseMeta.hpp"
 #include "modules/tools/dumper/buffer_dumper.hpp"
+#include "modules/tools/result_writer/result_writer.hpp"
 #include "common/base64.hpp"
 #include "nodes/base/baseResponseNode.hpp"
 
@@ -43,7 +44,7 @@ namespace inference{
 
 
 //
-// save results as local file:  {timestamp}.csv, 
+// save results as local file:  {timestamp}.bin, 
 // if media_type == `video`, snapshots will be also saved to folder ./snapshot
 //
 class LocalFileManager{
@@ -55,8 +56,8 @@ public:
     void init(std::size_t batchIdx);
 
     /**
-     * save results as local file:  {timestamp}.csv
-     * each column name should be consist with hvaROI_t
+     * save results as local binary file: results.bin, one record for each roi, written by the shared result writer,
+     * converted to csv offline by `ResultFileConverter`
     */
     bool saveResultsToFile(const unsigned frameId, const unsigned streamId, 
                            const std::vector<hva::hvaROI_t>& rois, HceDatabaseMeta& meta,
@@ -72,6 +73,11 @@ public:
     */
     void reset();
 
+    /**
+     * wait until the results saved so far are written to the result file
+    */
+    void flush();
+
     std::string getSaveFolder();
 
 private:
@@ -81,32 +87,12 @@ private:
     //
     void constructSavePath();
 
-    /**
-     * @brief check filepath
-     * if filepath not exist, check the folder
-     * if folder not exist, make the dir
-    */
-    void checkPath(const std::string& path);
-
     /**
      * @brief check folder
      * if folder not exist, make the dir
     */
     void checkFolder(const std::string& path);
 
-    /**
-     * @brief add new colum data
-     */
-    std::pair<std::string, std::string> addColumnData(std::string key, std::string val);
-
-    /**
-     * @brief replace a specific line, default as the first line
-     * @param filepath the file to be modified
-     * @param content the dst line content
-     * @param lineIndex index for the line to be replaced
-     */
-    void replaceLineInFile(std::string filepath, std::string content, int lineIndex);
-
     std::string m_saveFolder = "/opt/hce-core/output_logs/resultsink";
 
     // to-do: make it configurable
@@ -125,10 +111,9 @@ private:
 
     std::string m_mediaType;
 
-    bool m_firstLine = true;                    // is this first line
     std::mutex m_fileMutex;
 
-    std::unordered_map<std::string, int> m_headers;       // header mapper: {key, column_idx}
+    tools::ResultFile::Ptr m_resultFile;        // opened along with the first results of a request
 };
 
 class HCE_AI_DECLSPEC LLResultSinkFileNodeWorker : public baseResponseNodeWorker{
@@ -150,6 +135,11 @@ public:
     hva::hvaStatus_t rearm() override;
 
     hva::hvaStatus_t reset() override;
+
+    /**
+     * @brief close the result file and wait until its results are written
+    */
+    virtual void deinit() override;
 private:
 
     boost::property_tree::ptree m_jsonTree;
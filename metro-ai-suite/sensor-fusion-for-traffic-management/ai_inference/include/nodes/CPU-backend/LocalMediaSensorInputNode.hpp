@@ -70,12 +70,14 @@ private:
     size_t m_stride;
     float m_frameRate;
     std::string m_controlType;
+    BackpressureController::Policy m_policy;
 };
 
 class LocalMediaSensorInputNodeWorker : public hva::hvaNodeWorker_t{
 public:
     LocalMediaSensorInputNodeWorker(hva::hvaNode_t* parentNode, const LocalMediaSensorInputNode::InpustSensorIndices_t &sensorIndices,
-                                    const size_t &inputCapacity, const size_t &stride, const float &frameRate, const std::string &controlType);
+                                    const size_t &inputCapacity, const size_t &stride, const float &frameRate, const std::string &controlType,
+                                    const BackpressureController::Policy &policy);
 
     virtual void process(std::size_t batchIdx) override;
     
@@ -98,9 +100,10 @@ private:
     size_t m_inputCapacity;
     size_t m_stride;
     std::atomic<unsigned> m_ctr;
-    std::unordered_map<int, SendController::Ptr> m_controllerMap;
+    std::unordered_map<int, BackpressureController::Ptr> m_controllerMap;
     float m_frameRate;
     std::string m_controlType;
+    BackpressureController::Policy m_policy;
     int m_workStreamId;
 };
 
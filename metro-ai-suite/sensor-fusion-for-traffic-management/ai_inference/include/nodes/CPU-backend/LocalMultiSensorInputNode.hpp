@@ -26,6 +26,7 @@
 
 #include "nodes/databaseMeta.hpp"
 #include "nodes/radarDatabaseMeta.hpp"
+#include "modules/tools/dataset_loader/read_ahead_loader.hpp"
 
 #define MULTI_SENSOR_INPUT_NUM 2
 
@@ -75,12 +76,16 @@ private:
     size_t m_stride;
     float m_frameRate;
     std::string m_controlType;
+    BackpressureController::Policy m_policy;
+    size_t m_readAhead;
+    size_t m_readThreads;
 };
 
 class LocalMultiInputNodeWorker : public hva::hvaNodeWorker_t{
 public:
     LocalMultiInputNodeWorker(hva::hvaNode_t* parentNode, const LocalMultiSensorInputNode::InpustSensorIndices_t &sensorIndices, 
-                                const size_t &inputCapacity, const size_t &stride, const float &frameRate, const std::string &controlType);
+                                const size_t &inputCapacity, const size_t &stride, const float &frameRate, const std::string &controlType,
+                                const BackpressureController::Policy &policy, const size_t &readAhead, const size_t &readThreads);
 
     virtual void process(std::size_t batchIdx) override;
     
@@ -98,15 +103,26 @@ public:
      */
     void sendEmptyBlob(hva::hvaBlob_t::Ptr blob, bool isEnd, const HceDatabaseMeta& meta);
 
+    /**
+     * @brief read the sensor files of one frame, called by the loader I/O threads
+     * @param frameIdx frame index in the coming inputs
+     * @param content receives the file contents, buffers are reused
+     */
+    void readFrame(size_t frameIdx, MultiDatasetField_t& content);
+
 private:
     LocalMultiSensorInputNode::InpustSensorIndices_t m_sensorIndices;
     size_t m_inputCapacity;
     size_t m_stride;
     std::atomic<unsigned> m_ctr;
-    std::unordered_map<int, SendController::Ptr> m_controllerMap;
+    std::unordered_map<int, BackpressureController::Ptr> m_controllerMap;
     float m_frameRate;
     std::string m_controlType;
+    BackpressureController::Policy m_policy;
     int m_workStreamId;
+
+    std::vector<std::string> m_comingInputs;        // sensor files of the request being loaded
+    std::unique_ptr<tools::ReadAheadLoader<MultiDatasetField_t>> m_loader;
 };
 
 }
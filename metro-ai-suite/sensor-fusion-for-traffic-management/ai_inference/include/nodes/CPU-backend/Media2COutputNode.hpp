@@ -44,15 +44,6 @@ class HCE_AI_DECLSPEC Media2COutputNodeWorker : public hva::hvaNodeWorker_t {
 
   private:
     std::string m_bufType;
-
-    template <typename T> void putVectorToJson(boost::property_tree::ptree &jsonTree, std::vector<T> content)
-    {
-        for (const T val : content) {
-            boost::property_tree::ptree valTree;
-            valTree.put("", val);
-            jsonTree.push_back(std::make_pair("", valTree));
-        }
-    };
 };
 
 class HCE_AI_DECLSPEC Media2COutputNode : public baseResponseNode {
@@ -49,14 +49,13 @@ public:
 
 private:
     inPortsInfo_t m_inPortsInfo;
-    template <typename T>
-    void putVectorToJson(boost::property_tree::ptree& jsonTree, std::vector<T> content) {
-        for (const T val : content) {
-            boost::property_tree::ptree valTree;
-            valTree.put("", val);
-            jsonTree.push_back(std::make_pair("", valTree));
-        }
-    };
+
+    /**
+     * @brief fill results of media and radar pipelines into typed result, serialized into json message on demand
+    */
+    std::shared_ptr<baseResponseNode::Result> makeResult(const hva::hvaBlob_t::Ptr& mediaBlob,
+                                                         const hva::hvaVideoFrameWithROIBuf_t::Ptr& mediaBuf,
+                                                         const hva::hvaVideoFrameWithMetaROIBuf_t::Ptr& radarBuf);
 };
 
 class HCE_AI_DECLSPEC MediaRadarOutputNode : public baseResponseNode{
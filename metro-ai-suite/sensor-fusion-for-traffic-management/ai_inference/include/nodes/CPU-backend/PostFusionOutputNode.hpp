@@ -24,6 +24,7 @@
 #include "inc/api/hvaPipeline.hpp"
 #include "inc/util/hvaConfigStringParser.hpp"
 #include "inc/util/hvaUtil.hpp"
+#include "inc/buffer/hvaVideoFrameWithROIBuf.hpp"
 #include "nodes/base/baseResponseNode.hpp"
 #include "modules/inference_util/fusion/data_fusion_helper.hpp"
 #include "modules/tracklet_wrap.hpp"
@@ -72,6 +73,22 @@ class HCE_AI_DECLSPEC PostFusionOutputNodeWorker : public baseResponseNodeWorker
     virtual void processByLastRun(std::size_t batchIdx) override;
 
   private:
+    /**
+     * @brief format fusion results as json message
+     * @param fusionOutput fusion results, nullptr if not available
+     */
+    std::string makeJsonMessage(const hva::hvaBlob_t::Ptr &inBlob, const hva::hvaVideoFrameWithROIBuf_t::Ptr &inBuf,
+                                const FusionOutput *fusionOutput, double latency, double inferenceLatency,
+                                const std::chrono::time_point<std::chrono::high_resolution_clock> &endTime);
+
+    /**
+     * @brief fill fusion results into typed result, same content as json message
+     * @param fusionOutput fusion results, nullptr if not available
+     */
+    std::shared_ptr<baseResponseNode::Result> makeResult(const hva::hvaBlob_t::Ptr &inBlob, const hva::hvaVideoFrameWithROIBuf_t::Ptr &inBuf,
+                                                         const FusionOutput *fusionOutput, double latency, double inferenceLatency,
+                                                         const std::chrono::time_point<std::chrono::high_resolution_clock> &endTime);
+
     template <typename T>
     void putVectorToJson(boost::property_tree::ptree& jsonTree, std::vector<T> content) {
         for (const T val : content) {
@@ -20,6 +20,7 @@
 #include <boost/property_tree/json_parser.hpp>
 
 #include <inc/util/hvaConfigStringParser.hpp>
+#include <inc/buffer/hvaVideoFrameWithMetaROIBuf.hpp>
 
 #include "nodes/base/baseResponseNode.hpp"
 #include "modules/inference_util/radar/radar_detection_helper.hpp"
@@ -38,6 +39,14 @@ public:
 
     virtual void processByLastRun(std::size_t batchIdx) override;
 private:
+    std::string makeJsonMessage(const hva::hvaVideoFrameWithMetaROIBuf_t::Ptr& buf, double latency);
+
+    /**
+     * @brief fill point clouds into typed result, same content as json message
+    */
+    std::shared_ptr<baseResponseNode::Result> makeResult(const hva::hvaBlob_t::Ptr& inBlob, const hva::hvaVideoFrameWithMetaROIBuf_t::Ptr& buf,
+                                                         double latency);
+
     boost::property_tree::ptree m_jsonTree;
     boost::property_tree::ptree m_roi, m_rois;
     boost::property_tree::ptree m_roiData;
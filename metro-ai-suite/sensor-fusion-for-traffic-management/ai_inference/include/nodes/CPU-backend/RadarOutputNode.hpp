@@ -20,6 +20,7 @@
 #include <boost/property_tree/json_parser.hpp>
 
 #include <inc/util/hvaConfigStringParser.hpp>
+#include <inc/buffer/hvaVideoFrameWithMetaROIBuf.hpp>
 
 #include "nodes/base/baseResponseNode.hpp"
 #include "modules/inference_util/radar/radar_detection_helper.hpp"
@@ -41,6 +42,15 @@ class HCE_AI_DECLSPEC RadarOutputNodeWorker : public hva::hvaNodeWorker_t {
   private:
     std::string m_bufType;
 
+    std::string makeJsonMessage(const trackerOutput &output, double latency);
+
+    /**
+     * @brief fill tracks, as rois of json message and with their tracker ids and states, and the clusters they are
+     * updated from into typed result
+     */
+    std::shared_ptr<baseResponseNode::Result> makeResult(const hva::hvaBlob_t::Ptr &inBlob, const hva::hvaVideoFrameWithMetaROIBuf_t::Ptr &buf,
+                                                         const trackerOutput &output, double latency);
+
     template <typename T> void putVectorToJson(boost::property_tree::ptree &jsonTree, std::vector<T> content)
     {
         for (const T val : content) {
@@ -37,6 +37,7 @@ namespace inference{
 
 // };
 struct RadarConfigParam;
+struct RadarResultTable;
 class RadarResultReadFileNode : public hva::hvaNode_t{
 public:
 
@@ -77,7 +78,8 @@ private:
 
 class RadarResultReadFileNodeWorker : public hva::hvaNodeWorker_t{
 public:
-    RadarResultReadFileNodeWorker(hva::hvaNode_t* parentNode, RadarConfigParam m_radar_config);
+    RadarResultReadFileNodeWorker(hva::hvaNode_t* parentNode, RadarConfigParam m_radar_config,
+                                  std::shared_ptr<const RadarResultTable> table);
 
     virtual ~RadarResultReadFileNodeWorker() override;
 
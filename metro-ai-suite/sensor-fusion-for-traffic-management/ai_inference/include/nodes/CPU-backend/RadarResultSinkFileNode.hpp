@@ -38,6 +38,7 @@
 
 #include "nodes/base/baseResponseNode.hpp"
 #include "modules/inference_util/radar/radar_detection_helper.hpp"
+#include "modules/tools/result_writer/result_writer.hpp"
 
 namespace hce{
 
@@ -54,8 +55,8 @@ public:
     void init(std::size_t batchIdx);
 
     /**
-     * save results as local file:  {timestamp}.csv
-     * each column name should be consist with hvaROI_t
+     * save results as local binary file: radarResults.bin, written by the shared result writer,
+     * converted to csv offline by `ResultFileConverter`
     */
     bool saveResultsToFile(const unsigned frameId, const trackerOutput& pcl);
 
@@ -64,6 +65,11 @@ public:
     */
     void reset();
 
+    /**
+     * wait until the results saved so far are written to the result file
+    */
+    void flush();
+
     std::string getSaveFolder();
 
 private:
@@ -73,32 +79,12 @@ private:
     //
     void constructSavePath();
 
-    /**
-     * @brief check filepath
-     * if filepath not exist, check the folder
-     * if folder not exist, make the dir
-    */
-    void checkPath(const std::string& path);
-
     /**
      * @brief check folder
      * if folder not exist, make the dir
     */
     void checkFolder(const std::string& path);
 
-    /**
-     * @brief add new colum data
-     */
-    std::pair<std::string, std::string> addColumnData(std::string key, std::string val);
-    std::pair<std::string, std::vector<std::string>> addColumnDataVec(std::string key, std::vector<std::string> valVec);
-    /**
-     * @brief replace a specific line, default as the first line
-     * @param filepath the file to be modified
-     * @param content the dst line content
-     * @param lineIndex index for the line to be replaced
-     */
-    void replaceLineInFile(std::string filepath, std::string content, int lineIndex);
-
     std::string m_saveFolder = "/opt/hce-core/output_logs/resultsink";
 
     // to-do: make it configurable
@@ -117,10 +103,9 @@ private:
 
     std::string m_mediaType;
 
-    bool m_firstLine = true;                    // is this first line
     std::mutex m_fileMutex;
 
-    std::unordered_map<std::string, int> m_headers;       // header mapper: {key, column_idx}
+    tools::ResultFile::Ptr m_resultFile;        // opened along with the first results of a request
 };
 
 class HCE_AI_DECLSPEC RadarResultSinkFileNodeWorker : public hva::hvaNodeWorker_t{
@@ -132,6 +117,11 @@ public:
     virtual void processByFirstRun(std::size_t batchIdx) override;
 
     virtual void processByLastRun(std::size_t batchIdx) override;
+
+    /**
+     * @brief close the result file and wait until its results are written
+    */
+    virtual void deinit() override;
 private:
     boost::property_tree::ptree m_jsonTree;
     boost::property_tree::ptree m_roi, m_rois;
@@ -20,6 +20,10 @@
 #include <thread>
 #include <inc/api/hvaPipeline.hpp>
 #include <inc/util/hvaUtil.hpp>
+#include <inc/util/hvaConfigStringParser.hpp>
+
+#include "modules/decode_util/scaled_jpeg_decode_helper.hpp"
+
 namespace hce{
 
 namespace ai{
@@ -32,12 +36,23 @@ public:
 
     virtual std::shared_ptr<hva::hvaNodeWorker_t> createNodeWorker() const override;
 
+    /**
+    * @brief Parse params, called by hva framework right after node instantiate.
+    * TargetWidth, TargetHeight: input size of the downstream model, jpeg images are decoded at the smallest of
+    * 1, 1/2, 1/4 and 1/8 of their size no smaller than it. Full size if not set.
+    * @param config Configure string required by this node.
+    */
+    virtual hva::hvaStatus_t configureByString(const std::string& config) override;
+
 private:
+    hva::hvaConfigStringParser_t m_configParser;
+    unsigned m_targetWidth;
+    unsigned m_targetHeight;
 };
 
 class SimpleJpegDecOpenCVWorker : public hva::hvaNodeWorker_t{
 public:
-    SimpleJpegDecOpenCVWorker(hva::hvaNode_t* parentNode);
+    SimpleJpegDecOpenCVWorker(hva::hvaNode_t* parentNode, unsigned targetWidth, unsigned targetHeight);
     ~SimpleJpegDecOpenCVWorker();
 
     void process(std::size_t batchIdx) override;
@@ -51,7 +66,7 @@ public:
     void deinit() override;
 
 private:
-
+    ScaledJpegDecoder m_decoder;
 };
 
 }
@@ -21,6 +21,7 @@
 #include <opencv2/opencv.hpp>
 
 #include "nodes/base/baseMediaInputNode.hpp"
+#include "modules/tools/uploader/async_uploader.hpp"
 
 namespace hce{
 
@@ -37,7 +38,9 @@ public:
 
     /**
     * @brief Parse params, called by hva framework right after node instantiate.
-    * @param config Configure string required by this node.
+    * @param config Configure string required by this node. Uploads are tuned by UploadQueueSize, EncodeThreads,
+    *        UploadThreads, UploadBatchSize, UploadRetries, UploadRetryBackoffMs and QueueFullPolicy: `block`
+    *        (default) holds the pipeline while the upload queue is full, `drop` skips uploading the frame
     */
     virtual hva::hvaStatus_t configureByString(const std::string& config) override;
 
@@ -53,6 +56,10 @@ private:
     std::string m_mediaType;
     std::string m_dataSource;
     bool m_requireROI;
+    int m_jpegQuality;
+    std::string m_storageBackend;
+    std::string m_storageDirectory;
+    tools::AsyncUploaderConfig m_uploaderConfig;
 };
 
 class StorageImageUploadNodeWorker : public hva::hvaNodeWorker_t{
@@ -60,10 +67,19 @@ public:
  StorageImageUploadNodeWorker(hva::hvaNode_t* parentNode,
                               const std::string& mediaType,
                               const std::string& dataSource,
-                              bool requireROI);
+                              bool requireROI,
+                              int jpegQuality,
+                              const std::string& storageBackend,
+                              const std::string& storageDirectory,
+                              const tools::AsyncUploaderConfig& uploaderConfig);
 
  void init() override;
 
+ /**
+  * @brief finish the uploads in flight
+  */
+ void deinit() override;
+
  /**
   * @brief Called by hva framework for each video frame, Run inference and pass
   * output to following node
@@ -81,10 +97,21 @@ private:
     std::string m_dataSource;
     bool m_requireROI;
 
+    int m_jpegQuality;
+    std::string m_storageBackend;
+    std::string m_storageDirectory;
+    tools::AsyncUploaderConfig m_uploaderConfig;
+
     std::string m_configmapFile;
-    std::unique_ptr<hce::storage::Media_Storage> m_storageClient;
+    tools::ObjectStore::Ptr m_uriStore;     // generates media uris on the pipeline thread
+    std::unique_ptr<tools::AsyncUploader> m_uploader;
     boost::property_tree::ptree m_mediaAttribTree;
 
+    /**
+     * @brief create a store of the configured backend, one for each thread using it, called on the node thread
+    */
+    tools::ObjectStore::Ptr createStore() const;
+
     /**
      * @brief generate media attrib
      * for example:
@@ -39,6 +39,9 @@ public:
 
     /**
     * @brief Parse params, called by hva framework right after node instantiate.
+    * WaitTime: seconds to wait after sending each frame
+    * DecodeThreads: decoding threads of each stream, 0 to let FFmpeg decide, default 1
+    * DecodeThreadType: frame, slice or auto (both), default auto
     * @param config Configure string required by this node.
     */
     virtual hva::hvaStatus_t configureByString(const std::string& config) override;
@@ -55,12 +58,15 @@ private:
     hva::hvaConfigStringParser_t m_configParser;
     std::string m_name;
     float m_waitTime;
+    int m_decodeThreads;
+    int m_decodeThreadType;
 };
 
 class VideoDecoderNodeWorker : public hva::hvaNodeWorker_t{
 public:
 
-    VideoDecoderNodeWorker(hva::hvaNode_t* parentNode, std::string name, float waitTime);
+    VideoDecoderNodeWorker(hva::hvaNode_t* parentNode, std::string name, float waitTime,
+                           int decodeThreads, int decodeThreadType);
     ~VideoDecoderNodeWorker();
 
     /**
@@ -87,6 +93,12 @@ public:
     void sendBlob(const hva::hvaVideoFrameWithROIBuf_t::Ptr hvabuf, 
                   const hce::ai::inference::HceDatabaseMeta meta, unsigned streamId);
 
+    /**
+     * @brief tag a decoded frame and send it downstream, waits for m_waitTime afterwards
+    */
+    void sendFrame(const hva::hvaVideoFrameWithROIBuf_t::Ptr hvabuf, unsigned tag,
+                   const hce::ai::inference::HceDatabaseMeta& meta, unsigned streamId);
+
 private:
     std::atomic<unsigned> m_ctr;
     std::string m_name;
@@ -244,7 +244,7 @@ private:
     // mfxSession CreateVPLSession(mfxLoader *loader);
     VPLDecoderManager m_vplDecoderManager;
 
-    void sendEmptyBlob(unsigned tag, unsigned frameId, unsigned streamId);
+    void sendEmptyBlob(unsigned tag, unsigned frameId, unsigned streamId, BackpressureController::Ptr controller = nullptr);
 
 };
 
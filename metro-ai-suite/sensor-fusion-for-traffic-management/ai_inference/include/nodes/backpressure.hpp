@@ -0,0 +1,232 @@
+/*
+ * INTEL CONFIDENTIAL
+ *
+ * Copyright (C) 2024 Intel Corporation.
+ *
+ * This software and the related documents are Intel copyrighted materials, and your use of
+ * them is governed by the express license under which they were provided to you (License).
+ * Unless the License provides otherwise, you may not use, modify, copy, publish, distribute,
+ * disclose or transmit this software or the related documents without Intel's prior written permission.
+ *
+ * This software and the related documents are provided as is, with no express or implied warranties,
+ * other than those that are expressly stated in the License.
+*/
+
+#ifndef HCE_AI_INF_BACKPRESSURE_HPP
+#define HCE_AI_INF_BACKPRESSURE_HPP
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <chrono>
+#include <condition_variable>
+
+#include "common/latency_tracer.hpp"
+
+namespace hce{
+
+namespace ai{
+
+namespace inference{
+
+/**
+ * @brief per-stream credit based backpressure between a source node and the nodes finishing a frame.
+ *
+ * The source takes `stride` credits for each frame it sends, one for each pipeline branch the frame goes through,
+ * and each branch gives one back with release() when done with the frame, e.g. the tracker for video and the radar
+ * detection for radar. At most `capacity` frames are in flight. What happens to a frame arriving without credits
+ * is decided by the policy, declared in the source node config as `BackpressurePolicy=(STRING)<policy>`:
+ *  > block: the source waits for credits, latency grows with the load, nothing is lost. The default
+ *  > drop_newest: the arriving frame is dropped, the frames in flight complete
+ *  > drop_oldest: the arriving frame is admitted anyway, the oldest frames in flight turn stale and are dropped at
+ *    the next checkpoint, see isStale(). The pipeline keeps working on the most recent frames
+ *  > skip_to_keyframe: as drop_newest, after a drop the frames up to the next key frame are dropped too, as they
+ *    can not be decoded without the dropped reference
+ *
+ * The controller travels with the frame as buffer meta. Dropped frames are sent on as empty buffers marked `drop`
+ * without the controller, so that sinks still account for them. Credits are kept in an atomic counter, the
+ * mutex is only taken by a blocked source and by releases waking it up.
+ * The number of frames in flight and of dropped frames are exported as gauges `backpressure.<type>.inflight`
+ * and `backpressure.<type>.dropped` at /latency.
+*/
+class BackpressureController {
+  public:
+    using Ptr = std::shared_ptr<BackpressureController>;
+
+    enum Policy {
+        POLICY_BLOCK = 0,
+        POLICY_DROP_NEWEST,
+        POLICY_DROP_OLDEST,
+        POLICY_SKIP_TO_KEYFRAME
+    };
+
+    BackpressureController(size_t c, size_t s, const std::string& type, Policy p = POLICY_BLOCK, unsigned streamId = 0)
+            : capacity(c), stride(s > 0 ? s : 1), controlType(type), policy(p), m_count(0), m_waiters(0u),
+              m_skipping(false), m_staleBefore(0), m_streamId(streamId) {
+        m_inflightGauge = LatencyTracer::getInstance().getGauge("backpressure." + controlType + ".inflight");
+        m_droppedGauge = LatencyTracer::getInstance().getGauge("backpressure." + controlType + ".dropped");
+    };
+
+    ~BackpressureController() {};
+
+    /**
+     * @brief parse policy name used in node config, i.e. block, drop_newest, drop_oldest or skip_to_keyframe
+     * @return false if name is unknown
+    */
+    static bool parsePolicy(const std::string& name, Policy& p) {
+        if ("block" == name) {
+            p = POLICY_BLOCK;
+        } else if ("drop_newest" == name) {
+            p = POLICY_DROP_NEWEST;
+        } else if ("drop_oldest" == name) {
+            p = POLICY_DROP_OLDEST;
+        } else if ("skip_to_keyframe" == name) {
+            p = POLICY_SKIP_TO_KEYFRAME;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief called by the source on each frame before reading it, takes credits by the policy
+     * @param frameId increasing frame index on this stream, used to track stale frames under drop_oldest
+     * @param isKeyFrame whether the frame decodes on its own, every frame of an image stream is a key frame
+     * @return true if the frame is to be sent with the controller attached,
+     *         false if it is dropped and to be sent on as an empty buffer marked `drop`
+    */
+    bool admit(unsigned frameId, bool isKeyFrame = true) {
+        switch (policy) {
+            case POLICY_DROP_NEWEST:
+                if (tryAcquire()) {
+                    return true;
+                }
+                break;
+            case POLICY_SKIP_TO_KEYFRAME:
+                if ((isKeyFrame || !m_skipping.load(std::memory_order_relaxed)) && tryAcquire()) {
+                    m_skipping.store(false, std::memory_order_relaxed);
+                    return true;
+                }
+                m_skipping.store(true, std::memory_order_relaxed);
+                break;
+            case POLICY_DROP_OLDEST: {
+                bool hasCredits = tryAcquire();
+                if (!hasCredits) {
+                    // over-commit, the frames beyond capacity behind this one are given up
+                    take();
+                }
+                if (!hasCredits && frameId + 1 > capacity) {
+                    int64_t staleBefore = (int64_t)frameId + 1 - (int64_t)capacity;
+                    int64_t prev = m_staleBefore.load(std::memory_order_relaxed);
+                    while (prev < staleBefore && !m_staleBefore.compare_exchange_weak(prev, staleBefore, std::memory_order_relaxed)) {
+                    }
+                }
+                return true;
+            }
+            case POLICY_BLOCK:
+            default:
+                acquire();
+                return true;
+        }
+        recordDrop();
+        return false;
+    }
+
+    /**
+     * @brief under drop_oldest, whether the frame was given up for newer ones. Checked by the node before the
+     * expensive work on a frame, i.e. the decoders. A stale frame is sent on marked `drop` keeping the controller,
+     * the drop is accounted there with recordDrop() and the credit is given back by the branch end as for any frame
+    */
+    bool isStale(unsigned frameId) const {
+        return POLICY_DROP_OLDEST == policy && (int64_t)frameId < m_staleBefore.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief whether a frame is sent now would wait for or lack credits
+    */
+    bool full() const {
+        return m_count.load(std::memory_order_relaxed) + (int64_t)stride > (int64_t)(capacity * stride);
+    }
+
+    /**
+     * @brief whether this controller paces the branch of the given type, e.g. "Video" or "Radar"
+    */
+    bool controls(const std::string& type) const {
+        return 0 < capacity && type == controlType;
+    }
+
+    /**
+     * @brief give back one credit, called by each branch when done with a frame, dropped or not
+    */
+    void release() {
+        int64_t count = m_count.fetch_sub(1) - 1;
+        if (0 == count % (int64_t)stride) {
+            // the last branch of a frame
+            LatencyTracer::getInstance().addGauge(m_inflightGauge, -1, m_streamId);
+        }
+        // a source registers as waiter before checking the credits, so either it sees the credit returned
+        // above or it is seen here
+        if (m_waiters.load() > 0) {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            m_notFull.notify_all();
+        }
+    }
+
+    void recordDrop() {
+        LatencyTracer::getInstance().addGauge(m_droppedGauge, 1, m_streamId);
+    }
+
+  public:
+    size_t capacity;            // max frames in flight
+    size_t stride;              // credits taken for each frame, one for each branch giving back credits
+    std::string controlType;    // decide to control radar pipeline or video pipeline
+    Policy policy;
+
+  private:
+    bool tryAcquire() {
+        int64_t count = m_count.load(std::memory_order_relaxed);
+        while (count + (int64_t)stride <= (int64_t)(capacity * stride)) {
+            if (m_count.compare_exchange_weak(count, count + (int64_t)stride)) {
+                LatencyTracer::getInstance().addGauge(m_inflightGauge, 1, m_streamId);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void take() {
+        m_count.fetch_add((int64_t)stride);
+        LatencyTracer::getInstance().addGauge(m_inflightGauge, 1, m_streamId);
+    }
+
+    void acquire() {
+        if (tryAcquire()) {
+            return;
+        }
+        m_waiters.fetch_add(1u);
+        std::unique_lock<std::mutex> lock(m_mtx);
+        m_notFull.wait(lock, [this]() { return tryAcquire(); });
+        lock.unlock();
+        m_waiters.fetch_sub(1u);
+    }
+
+    std::atomic<int64_t> m_count;       // credits taken
+    std::atomic<unsigned> m_waiters;
+    std::atomic<bool> m_skipping;
+    std::atomic<int64_t> m_staleBefore;
+    std::mutex m_mtx;
+    std::condition_variable m_notFull;
+
+    unsigned m_streamId;
+    LatencyTracer::Gauge* m_inflightGauge;
+    LatencyTracer::Gauge* m_droppedGauge;
+};
+
+}
+
+}
+
+}
+
+#endif //#ifndef HCE_AI_INF_BACKPRESSURE_HPP
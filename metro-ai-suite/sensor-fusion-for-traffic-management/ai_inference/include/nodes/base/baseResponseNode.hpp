@@ -15,7 +15,13 @@
 #ifndef HCE_AI_BASE_RESPONSE_NODE_HPP
 #define HCE_AI_BASE_RESPONSE_NODE_HPP
 
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include <inc/api/hvaPipeline.hpp>
+#include <inc/buffer/hvaVideoFrameWithROIBuf.hpp>
 
 #include "common/common.hpp"
 
@@ -27,6 +33,124 @@ namespace inference{
 
 class HCE_AI_DECLSPEC baseResponseNode : public hva::hvaNode_t{
 public:
+    /**
+     * @brief result encoding requested by client
+     *  > RESULT_FORMAT_JSON: results are formatted as json string in Response::message
+     *  > RESULT_FORMAT_TYPED: results are filled into Response::result, and encoded
+     *    by the server without going through json, e.g. AI_Response.result in ai_v1.proto
+    */
+    enum ResultFormat_t{
+        RESULT_FORMAT_JSON = 0,
+        RESULT_FORMAT_TYPED = 1
+    };
+
+    struct ResultAttribute{
+        std::string label;
+        float score;
+    };
+
+    /**
+     * @brief one object in typed result, fields not applicable to the output node are left as default
+    */
+    struct ResultROI{
+        int roi[4] = {0, 0, 0, 0};                      // media roi in pixel: x, y, width, height
+        std::string roiClass;
+        double roiScore = 0.0;                          // double as in hvaROI_t, json messages keep the precision
+        int trackId = 0;
+        std::string trackStatus;
+        std::string featureVector;
+        std::vector<std::pair<std::string, ResultAttribute>> attributes;
+        float mediaBirdviewRoi[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        float fusionRoiState[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        float fusionRoiSize[2] = {0.0f, 0.0f};
+        int sensorSource = 0;
+    };
+
+    /**
+     * @brief one radar detection point, see pointClouds
+    */
+    struct ResultPointCloud{
+        int rangeIdx = 0;
+        float range = 0.0f;
+        int speedIdx = 0;
+        float speed = 0.0f;
+        float snr = 0.0f;
+        float aoaVar = 0.0f;
+    };
+
+    /**
+     * @brief one radar cluster, see clusteringDBscanReport
+    */
+    struct ResultCluster{
+        int numPoints = 0;
+        float center[2] = {0.0f, 0.0f};                 // x, y
+        float size[2] = {0.0f, 0.0f};                   // xSize, ySize
+        float avgVel = 0.0f;
+        float centerRangeVar = 0.0f;
+        float centerAngleVar = 0.0f;
+        float centerDopplerVar = 0.0f;
+    };
+
+    /**
+     * @brief one radar track, see trackerOutputDataType
+    */
+    struct ResultTrack{
+        int trackId = 0;
+        int state = 0;
+        float trackState[4] = {0.0f, 0.0f, 0.0f, 0.0f}; // x, y, vx, vy
+        float size[2] = {0.0f, 0.0f};                   // xSize, ySize
+    };
+
+    /**
+     * @brief typed result of one frame, carries the same content as the json message of output nodes,
+     * radar output nodes fill in their point clouds, clusters and tracks besides the rois
+    */
+    struct Result{
+        int statusCode = 0;
+        std::string description;
+        unsigned streamId = 0;
+        unsigned frameId = 0;
+        double latency = 0.0;
+        double inferenceLatency = 0.0;
+        std::vector<std::pair<std::string, double>> latencies;   // additional named latencies, e.g. latency1
+        std::vector<ResultROI> rois;
+        std::vector<ResultPointCloud> pointClouds;
+        std::vector<ResultCluster> clusters;
+        std::vector<ResultTrack> tracks;
+    };
+
+    /**
+     * @brief optional fields of the json message serialized from a typed result, besides status, description and
+     * roi, class, score and tracking of each roi
+    */
+    enum ResultJsonField_t{
+        RESULT_JSON_SENSOR_SOURCE = 1 << 0,         // roi_info[].sensor_source
+        RESULT_JSON_MEDIA_BIRDVIEW_ROI = 1 << 1,    // roi_info[].media_birdview_roi
+        RESULT_JSON_FUSION_ROI = 1 << 2,            // roi_info[].fusion_roi_state, roi_info[].fusion_roi_size
+        RESULT_JSON_INFERENCE_LATENCY = 1 << 3,     // inference_latency
+        RESULT_JSON_LATENCY = 1 << 4,               // latency, followed by the named latencies
+    };
+
+    /**
+     * @brief json message of a typed result, serialized on first use and shared by all copies of a response,
+     * so that listeners not reading json cost nothing and the others share one serialization
+    */
+    class HCE_AI_DECLSPEC LazyJsonMessage{
+    public:
+        LazyJsonMessage(std::shared_ptr<const Result> result, unsigned fields);
+
+        /**
+         * @brief the json message, thread-safe
+        */
+        const std::string& get() const;
+
+    private:
+        std::shared_ptr<const Result> m_result;
+        unsigned m_fields;
+        mutable std::once_flag m_once;
+        mutable std::string m_message;
+    };
+
     struct ResponseData{
         std::string stringData;
         size_t length;
@@ -37,6 +161,15 @@ public:
         int status;
         std::unordered_map<std::string, ResponseData> responses;
         std::string message; 
+        std::shared_ptr<Result> result;                 // set instead of message under RESULT_FORMAT_TYPED
+        std::shared_ptr<LazyJsonMessage> lazyMessage;   // set instead of message to share serialization among listeners
+
+        /**
+         * @brief json message, either set directly or serialized lazily
+        */
+        const std::string& getMessage() const{
+            return lazyMessage ? lazyMessage->get() : message;
+        };
     };
 
     class HCE_AI_DECLSPEC EmitListener{
@@ -64,6 +197,29 @@ public:
 
     virtual bool emitFinish(const baseResponseNode* node, void* data);
 
+    /**
+     * @brief serialize a typed result into the json message of output nodes
+     * 
+     * @param result typed result
+     * @param fields optional fields to include, bitwise or of ResultJsonField_t
+     * @return json message
+    */
+    static std::string makeJsonMessage(const Result& result, unsigned fields);
+
+    /**
+     * @brief set the result encoding, takes effect from the next frame
+     * 
+     * @param format result format
+    */
+    void setResultFormat(ResultFormat_t format);
+
+    /**
+     * @brief get the result encoding, output nodes should emit either json message or typed result accordingly
+     * 
+     * @return result format, default as RESULT_FORMAT_JSON
+    */
+    ResultFormat_t getResultFormat() const;
+
     /**
     * @brief return the human-readable name of this node class
     * 
@@ -103,6 +259,14 @@ public:
     */
     bool validateStreamInput(const hva::hvaBlob_t::Ptr& blob);
 
+    /**
+     * @brief map rois on a downscaled frame back to the source image, e.g. a jpeg decoded at 1/2, 1/4 or 1/8
+     * @param rois rois on the decoded frame, mapped in place
+     * @param scaleWidth scaleWidth of HceDatabaseMeta, i.e. oriWidth / width
+     * @param scaleHeight scaleHeight of HceDatabaseMeta, i.e. oriHeight / height
+    */
+    static void mapToSourceScale(std::vector<hva::hvaROI_t>& rois, float scaleWidth, float scaleHeight);
+
 protected:
     std::string m_nodeName;
 
@@ -18,6 +18,7 @@
 #include <unordered_map>
 #include "common/common.hpp"
 #include "nodes/radarDatabaseMeta.hpp"
+#include "nodes/backpressure.hpp"
 
 #include <mutex>
 #include <condition_variable>
@@ -149,44 +150,6 @@ public:
     }
 };
 
-class SendController {
-  public:
-    using Ptr = std::shared_ptr<SendController>;
-
-    SendController() : capacity(1u), stride(1u), count(0u), controlType("Video") {};
-
-    SendController(size_t c) : capacity(c), stride(1u), count(0u), controlType("Video") {};
-
-    SendController(size_t c, std::string type) : capacity(c), stride(1u), count(0u), controlType(type) {};
-
-    SendController(size_t c, size_t s, std::string type) : capacity(c), stride(s), count(0u), controlType(type) {};
-    
-    ~SendController() {};
-
-    void setCapacity(size_t c)
-    {
-        capacity = c;
-    }
-
-    void setControlType(std::string type)
-    {
-        controlType = type;
-    }
-
-    void setStride(size_t s)
-    {
-        stride = s;
-    }
-
-  public:
-    size_t capacity;  // The capacity bound
-    size_t stride;    // The stride for count
-    size_t count;     // Current number of elements
-    std::string controlType; // decide to control radar pipeline or video pipeline
-    std::mutex mtx;
-    std::condition_variable notFull;
-};
-
 }
 
 }
@@ -1813,18 +1813,7 @@ void OpenVINOImageInference::Flush() {
 
         if (request->buffers.size() > 0) {
             try {
-                // WA: Fill non-complete batch with last element. Can be removed once supported in OV
-                if (batch_size > 1 && !DoNeedImagePreProcessing()) {
-                    size_t input_idx = 0;
-                    for (auto &input_vec : request->in_tensors) {
-                        for (int i = input_vec.size(); i < batch_size; i++)
-                            input_vec.push_back(input_vec.back());
-                        // FIXME: move?
-                        request->infer_request_new.set_input_tensors(input_idx, input_vec);
-                        input_idx++;
-                    }
-                }
-
+                FillIncompleteBatch(request);
                 request->start_async();
             } catch (const std::exception &e) {
                 GVA_ERROR("Couldn't start inferece on flush: %s", e.what());
@@ -1841,6 +1830,45 @@ void OpenVINOImageInference::Flush() {
     }
 }
 
+void OpenVINOImageInference::FillIncompleteBatch(std::shared_ptr<BatchRequest> &request) {
+    // WA: Fill non-complete batch with last element. Can be removed once supported in OV
+    if (batch_size > 1 && !DoNeedImagePreProcessing()) {
+        size_t input_idx = 0;
+        for (auto &input_vec : request->in_tensors) {
+            for (int i = input_vec.size(); i < batch_size; i++)
+                input_vec.push_back(input_vec.back());
+            // FIXME: move?
+            request->infer_request_new.set_input_tensors(input_idx, input_vec);
+            input_idx++;
+        }
+    }
+}
+
+void OpenVINOImageInference::SubmitPendingBatch() {
+    ITT_TASK(__FUNCTION__);
+
+    std::unique_lock<std::mutex> lk(requests_mutex_);
+    // a partially filled request is always pushed back to the front of free requests,
+    // if no request is free there is nothing pending
+    if (batch_size <= 1 || freeRequests.empty())
+        return;
+
+    auto request = freeRequests.pop();
+    if (request->buffers.empty()) {
+        freeRequests.push_front(request);
+        return;
+    }
+
+    try {
+        FillIncompleteBatch(request);
+        request->start_async();
+    } catch (const std::exception &e) {
+        GVA_ERROR("Couldn't start pending batch: %s", e.what());
+        this->handleError(request->buffers);
+        FreeRequest(request);
+    }
+}
+
 void OpenVINOImageInference::Close() {
     Flush();
     while (!freeRequests.empty()) {
@@ -47,6 +47,8 @@ class OpenVINOImageInference : public InferenceBackend::ImageInference {
 
     bool IsQueueFull() override;
 
+    void SubmitPendingBatch() override;
+
     void Flush() override;
 
     void Close() override;
@@ -97,6 +99,7 @@ class OpenVINOImageInference : public InferenceBackend::ImageInference {
     void BypassImageProcessing(const std::string &input_name, std::shared_ptr<BatchRequest> request,
                                const InferenceBackend::Image &src_img, size_t batch_size);
     void SetCompletionCallback(std::shared_ptr<BatchRequest> &batch_request);
+    void FillIncompleteBatch(std::shared_ptr<BatchRequest> &request);
     void
     ApplyInputPreprocessors(std::shared_ptr<BatchRequest> &request,
                             const std::map<std::string, InferenceBackend::InputLayerDesc::Ptr> &input_preprocessors);
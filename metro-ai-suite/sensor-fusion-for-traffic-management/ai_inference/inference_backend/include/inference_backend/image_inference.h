@@ -72,6 +72,9 @@ class ImageInference {
     // static std::map<std::string, GstStructure *> GetModelInfoPreproc(const std::string model_file);
 
     virtual bool IsQueueFull() = 0;
+    // start the pending partially filled batch request (if any) without waiting for it to complete
+    virtual void SubmitPendingBatch() {
+    }
     virtual void Flush() = 0;
     virtual void Close() = 0;
 
@@ -15,44 +15,340 @@
 #include "common/base64.hpp"
 #include "common/common.hpp"
 
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HCE_AI_BASE64_X86
+#endif
+
 namespace hce{
 
 namespace ai{
 
 namespace inference{
 
+namespace{
+
+const char s_encodeTable[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+struct DecodeTable{
+    uint8_t value[256];
+    DecodeTable(){
+        std::memset(value, 0xFF, sizeof(value));
+        for(unsigned i = 0; i < 64; ++i){
+            value[(uint8_t)s_encodeTable[i]] = (uint8_t)i;
+        }
+    }
+};
+const DecodeTable s_decodeTable;
+
+/**
+ * @brief bulk codecs process the leading part of the input that fits their block size and report how much
+ * was consumed, the remaining tail is always handled by the scalar code
+*/
+using EncodeBulkFunc = size_t (*)(char* dst, const uint8_t* src, size_t len);
+using DecodeBulkFunc = bool (*)(uint8_t* dst, const char* src, size_t len, size_t& consumed);
+
+size_t encodeBulkScalar(char* dst, const uint8_t* src, size_t len){
+    size_t i = 0;
+    for(; i + 3 <= len; i += 3){
+        uint32_t v = (uint32_t(src[i]) << 16) | (uint32_t(src[i + 1]) << 8) | src[i + 2];
+        *dst++ = s_encodeTable[(v >> 18) & 0x3F];
+        *dst++ = s_encodeTable[(v >> 12) & 0x3F];
+        *dst++ = s_encodeTable[(v >> 6) & 0x3F];
+        *dst++ = s_encodeTable[v & 0x3F];
+    }
+    return i;
+}
+
+bool decodeBulkScalar(uint8_t* dst, const char* src, size_t len, size_t& consumed){
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(src);
+    size_t i = 0;
+    for(; i + 4 <= len; i += 4){
+        uint32_t a = s_decodeTable.value[in[i]];
+        uint32_t b = s_decodeTable.value[in[i + 1]];
+        uint32_t c = s_decodeTable.value[in[i + 2]];
+        uint32_t d = s_decodeTable.value[in[i + 3]];
+        if((a | b | c | d) & 0x80){
+            return false;
+        }
+        uint32_t v = (a << 18) | (b << 12) | (c << 6) | d;
+        *dst++ = uint8_t(v >> 16);
+        *dst++ = uint8_t(v >> 8);
+        *dst++ = uint8_t(v);
+    }
+    consumed = i;
+    return true;
+}
+
+#ifdef HCE_AI_BASE64_X86
+
+/**
+ * @brief vectorized codecs after W. Mula and D. Lemire, "Faster Base64 Encoding and Decoding using AVX2
+ * Instructions". Compiled per function with the target attribute so that the binary still runs on cpus
+ * without those extensions, the implementation is selected at runtime in selectCodec()
+*/
+__attribute__((target("ssse3")))
+inline __m128i encodeLookupSsse3(__m128i indices){
+    __m128i result = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    const __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+    result = _mm_or_si128(result, _mm_and_si128(less, _mm_set1_epi8(13)));
+    const __m128i shiftLut = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+            '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    return _mm_add_epi8(_mm_shuffle_epi8(shiftLut, result), indices);
+}
+
+__attribute__((target("ssse3")))
+size_t encodeBulkSsse3(char* dst, const uint8_t* src, size_t len){
+    const __m128i shuf = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    size_t i = 0;
+    // 16 bytes are loaded for each 12 bytes consumed
+    for(; i + 16 <= len; i += 12){
+        __m128i in = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), shuf);
+        const __m128i t0 = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+        const __m128i t1 = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), encodeLookupSsse3(_mm_or_si128(t0, t1)));
+        dst += 16;
+    }
+    return i;
+}
+
+__attribute__((target("ssse3")))
+bool decodeBulkSsse3(uint8_t* dst, const char* src, size_t len, size_t& consumed){
+    const __m128i lutLo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+            0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m128i lutHi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+            0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m128i lutRoll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i mask2F = _mm_set1_epi8(0x2F);
+    const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    size_t i = 0;
+    // 16 bytes are stored for each 12 bytes produced, keep at least 24 chars ahead so that it never
+    // writes beyond the decoded length
+    for(; i + 24 <= len; i += 16){
+        __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i hiNibbles = _mm_and_si128(_mm_srli_epi32(in, 4), mask2F);
+        const __m128i lo = _mm_shuffle_epi8(lutLo, _mm_and_si128(in, mask2F));
+        const __m128i hi = _mm_shuffle_epi8(lutHi, hiNibbles);
+        if(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128()))){
+            return false;
+        }
+        const __m128i eq2F = _mm_cmpeq_epi8(in, mask2F);
+        in = _mm_add_epi8(in, _mm_shuffle_epi8(lutRoll, _mm_add_epi8(eq2F, hiNibbles)));
+
+        const __m128i mergedAbBc = _mm_maddubs_epi16(in, _mm_set1_epi32(0x01400140));
+        const __m128i merged = _mm_madd_epi16(mergedAbBc, _mm_set1_epi32(0x00011000));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_shuffle_epi8(merged, pack));
+        dst += 12;
+    }
+    consumed = i;
+    return true;
+}
+
+__attribute__((target("avx2")))
+size_t encodeBulkAvx2(char* dst, const uint8_t* src, size_t len){
+    const __m256i shuf = _mm256_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+            10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    const __m256i shiftLut = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+            '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+            'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+            '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    size_t i = 0;
+    // two 12 bytes blocks per iteration, one in each lane, 28 bytes are touched for each 24 bytes consumed
+    for(; i + 28 <= len; i += 24){
+        const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 12));
+        __m256i in = _mm256_shuffle_epi8(_mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1), shuf);
+        const __m256i t0 = _mm256_mulhi_epu16(_mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00)), _mm256_set1_epi32(0x04000040));
+        const __m256i t1 = _mm256_mullo_epi16(_mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0)), _mm256_set1_epi32(0x01000010));
+        const __m256i indices = _mm256_or_si256(t0, t1);
+
+        __m256i result = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+        const __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+        result = _mm256_or_si256(result, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+        result = _mm256_add_epi8(_mm256_shuffle_epi8(shiftLut, result), indices);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), result);
+        dst += 32;
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+bool decodeBulkAvx2(uint8_t* dst, const char* src, size_t len, size_t& consumed){
+    const __m256i lutLo = _mm256_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+            0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+            0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+            0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m256i lutHi = _mm256_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+            0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+            0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+            0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m256i lutRoll = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+            0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i mask2F = _mm256_set1_epi8(0x2F);
+    const __m256i pack = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    size_t i = 0;
+    // 28 bytes are stored for each 24 bytes produced, keep at least 44 chars ahead so that it never
+    // writes beyond the decoded length
+    for(; i + 44 <= len; i += 32){
+        __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        const __m256i hiNibbles = _mm256_and_si256(_mm256_srli_epi32(in, 4), mask2F);
+        const __m256i lo = _mm256_shuffle_epi8(lutLo, _mm256_and_si256(in, mask2F));
+        const __m256i hi = _mm256_shuffle_epi8(lutHi, hiNibbles);
+        if(!_mm256_testz_si256(lo, hi)){
+            return false;
+        }
+        const __m256i eq2F = _mm256_cmpeq_epi8(in, mask2F);
+        in = _mm256_add_epi8(in, _mm256_shuffle_epi8(lutRoll, _mm256_add_epi8(eq2F, hiNibbles)));
+
+        const __m256i mergedAbBc = _mm256_maddubs_epi16(in, _mm256_set1_epi32(0x01400140));
+        const __m256i merged = _mm256_shuffle_epi8(_mm256_madd_epi16(mergedAbBc, _mm256_set1_epi32(0x00011000)), pack);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm256_castsi256_si128(merged));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 12), _mm256_extracti128_si256(merged, 1));
+        dst += 24;
+    }
+    consumed = i;
+    return true;
+}
+
+#endif //#ifdef HCE_AI_BASE64_X86
+
+struct Codec{
+    const char* name;
+    EncodeBulkFunc encodeBulk;
+    DecodeBulkFunc decodeBulk;
+};
+
+Codec selectCodec(){
+#ifdef HCE_AI_BASE64_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")){
+        return {"avx2", encodeBulkAvx2, decodeBulkAvx2};
+    }
+    if(__builtin_cpu_supports("ssse3")){
+        return {"ssse3", encodeBulkSsse3, decodeBulkSsse3};
+    }
+#endif
+    return {"scalar", encodeBulkScalar, decodeBulkScalar};
+}
+
+const Codec& codec(){
+    static const Codec s_codec = selectCodec();
+    return s_codec;
+}
+
+}
+
+size_t base64Encode(char* dst, void const* src, size_t len){
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(src);
+    char* out = dst;
+
+    size_t done = codec().encodeBulk(out, in, len);
+    out += done / 3 * 4;
+    size_t tail = encodeBulkScalar(out, in + done, len - done);
+    out += tail / 3 * 4;
+    done += tail;
+
+    // the last 1 or 2 bytes, padded
+    if(len - done == 1){
+        uint32_t v = uint32_t(in[done]) << 16;
+        *out++ = s_encodeTable[(v >> 18) & 0x3F];
+        *out++ = s_encodeTable[(v >> 12) & 0x3F];
+        *out++ = '=';
+        *out++ = '=';
+    }
+    else if(len - done == 2){
+        uint32_t v = (uint32_t(in[done]) << 16) | (uint32_t(in[done + 1]) << 8);
+        *out++ = s_encodeTable[(v >> 18) & 0x3F];
+        *out++ = s_encodeTable[(v >> 12) & 0x3F];
+        *out++ = s_encodeTable[(v >> 6) & 0x3F];
+        *out++ = '=';
+    }
+    return out - dst;
+}
+
+bool base64Decode(void* dst, const char* src, size_t len, size_t& decodedLen){
+    if(len > 0 && len % 4 == 0 && src[len - 1] == '='){
+        --len;
+        if(src[len - 1] == '='){
+            --len;
+        }
+    }
+    if(len % 4 == 1){
+        return false;
+    }
+
+    uint8_t* out = reinterpret_cast<uint8_t*>(dst);
+    size_t done = 0;
+    size_t consumed = 0;
+    if(!codec().decodeBulk(out, src, len, consumed)){
+        return false;
+    }
+    out += consumed / 4 * 3;
+    done += consumed;
+    if(!decodeBulkScalar(out, src + done, len - done, consumed)){
+        return false;
+    }
+    out += consumed / 4 * 3;
+    done += consumed;
+
+    // the last 2 or 3 chars without padding
+    if(len - done >= 2){
+        const uint8_t* in = reinterpret_cast<const uint8_t*>(src + done);
+        uint32_t a = s_decodeTable.value[in[0]];
+        uint32_t b = s_decodeTable.value[in[1]];
+        uint32_t c = len - done == 3 ? s_decodeTable.value[in[2]] : 0;
+        if((a | b | c) & 0x80){
+            return false;
+        }
+        uint32_t v = (a << 18) | (b << 12) | (c << 6);
+        *out++ = uint8_t(v >> 16);
+        if(len - done == 3){
+            *out++ = uint8_t(v >> 8);
+        }
+    }
+    decodedLen = out - reinterpret_cast<uint8_t*>(dst);
+    return true;
+}
+
+const char* base64CodecName(){
+    return codec().name;
+}
+
 std::string base64DecodeStrToStr(const std::string &val)
 {
-    using namespace boost::archive::iterators;
-    using It = transform_width<binary_from_base64<std::string::const_iterator>, 8, 6>;
-    return boost::algorithm::trim_right_copy_if(std::string(It(std::begin(val)), It(std::end(val))), [](char c) {
-        return c == '\0';
-    });
+    std::string ret(base64DecodedMaxSize(val.size()), '\0');
+    size_t decodedLen = 0;
+    if(!base64Decode(&ret[0], val.data(), val.size(), decodedLen)){
+        throw std::invalid_argument("Attempt to decode a value not in base64 char set");
+    }
+    ret.resize(decodedLen);
+    return ret;
 }
 
 std::string base64EncodeStrToStr(const std::string &val)
 {
-    using namespace boost::archive::iterators;
-    using It = base64_from_binary<transform_width<std::string::const_iterator, 6, 8>>;
-    auto tmp = std::string(It(std::begin(val)), It(std::end(val)));
-    return tmp.append((3 - val.size() % 3) % 3, '=');
+    std::string ret(base64EncodedSize(val.size()), '\0');
+    base64Encode(&ret[0], val.data(), val.size());
+    return ret;
 }
 
 size_t base64EncodeBufferToString(std::string& dst, void const* src, size_t len)
 {
-  using namespace boost::beast::detail::base64;
-  void * destEncodeBuffer = malloc(encoded_size(len));
-  HCE_AI_ASSERT(destEncodeBuffer);
-  encode(destEncodeBuffer, src, len);
-  dst.assign((char*)destEncodeBuffer, (char*)destEncodeBuffer + encoded_size(len));
-  free(destEncodeBuffer);
+  dst.resize(base64EncodedSize(len));
+  base64Encode(&dst[0], src, len);
   return hceAiSuccess;
 }
 
 size_t base64DecodeStringToBuffer(std::string& src, void* dst)
 {
-  using namespace boost::beast::detail::base64;
-  decode(dst, src.data(), src.length());
+  size_t decodedLen = 0;
+  if(!base64Decode(dst, src.data(), src.length(), decodedLen)){
+    return hceAiBadArgument;
+  }
   return hceAiSuccess;
 }
 
@@ -60,4 +356,4 @@ size_t base64DecodeStringToBuffer(std::string& src, void* dst)
 
 }
 
-}
\ No newline at end of file
+}
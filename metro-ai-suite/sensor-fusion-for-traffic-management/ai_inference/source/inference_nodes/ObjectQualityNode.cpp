@@ -332,6 +332,7 @@ void ObjectQualityNodeWorker::processOutput(
 
             // release `depleting` status in hva pipeline
             HVA_DEBUG("%s release depleting on frameid %u and streamid %u", m_nodeName.c_str(), curInput->frameId, curInput->streamId);
+            onFrameCompleted(curInput);
             getParentPtr()->releaseDepleting();
 
             // remove this input from records
@@ -53,6 +53,7 @@ baseImageInferenceNode::baseImageInferenceNode(std::size_t totalThreadNum) : hva
     m_inferenceProperties.batch_size = DEFAULT_BATCH_SIZE;
     m_inferenceProperties.reshape_width = DEFAULT_RESHAPE_WIDTH;
     m_inferenceProperties.reshape_height = DEFAULT_RESHAPE_HEIGHT;
+    m_inferenceProperties.roi_batching = DEFAULT_ROI_BATCHING;
 
     // reset config parser
     m_configParser.reset();
@@ -178,6 +179,16 @@ hva::hvaStatus_t baseImageInferenceNode::configureByString(const std::string& co
     m_configParser.getVal<std::string>("PreProcessType", preProcType);
     m_inferenceProperties.pre_proc_type = preProcType;
 
+    // roi batching: all rois of one frame are submitted as batched requests, only valid on roi inference
+    bool roiBatching = DEFAULT_ROI_BATCHING;
+    m_configParser.getVal<bool>("ROIBatching", roiBatching);
+    if (roiBatching && m_inferenceProperties.inference_region_type != InferenceRegionType::ROI_LIST) {
+        HVA_WARNING("%s ROIBatching only works on roi inference, ignore it!", nodeClassName().c_str());
+        roiBatching = false;
+    }
+    m_inferenceProperties.roi_batching = roiBatching;
+    HVA_INFO("roiBatching: %d", m_inferenceProperties.roi_batching);
+
     return hva::hvaStatus_t::hvaSuccess;
 }
 
@@ -220,6 +231,23 @@ hva::hvaStatus_t baseImageInferenceNode::prepare() {
             "%s inference batch size: %d (> 1), change preprocess type from ie to opencv!",
             nodeClassName().c_str(), m_inferenceProperties.batch_size);
     }
+
+    // roi batching only pays off when rois are gathered into batched requests, keep the
+    // single-frame path on its original pre-processing. Batch size 0 is resolved by the
+    // inference instance, which applies the same check once the batch size is known
+    if (m_inferenceProperties.roi_batching && m_inferenceProperties.batch_size == 1) {
+        m_inferenceProperties.roi_batching = false;
+        HVA_INFO("%s inference batch size: %d, roi batching disabled!",
+            nodeClassName().c_str(), m_inferenceProperties.batch_size);
+    }
+
+    // roi batching crops and resizes rois on host, so that crops can be shared between models
+    if (m_inferenceProperties.roi_batching &&
+        m_inferenceProperties.pre_proc_type == "ie") {
+
+        m_inferenceProperties.pre_proc_type = "opencv";
+        HVA_DEBUG("%s roi batching enabled, change preprocess type from ie to opencv!", nodeClassName().c_str());
+    }
     return hva::hvaStatus_t::hvaSuccess;
 }
 
@@ -259,11 +287,17 @@ hva::hvaStatus_t baseImageInferenceNode::releaseInferenceInstance() {
 baseImageInferenceNodeWorker::baseImageInferenceNodeWorker(hva::hvaNode_t* parentNode, InferenceProperty inferenceProperty, 
                                                  ImageInferenceInstance::Ptr instance)
     : hva::hvaNodeWorker_t(parentNode), m_inferenceProperties(inferenceProperty), m_inferenceInstance(instance) {
+
+    const std::string nodeClassName = ((baseImageInferenceNode*)parentNode)->nodeClassName();
+    m_submitStage = LatencyTracer::getInstance().getStage(nodeClassName + ".submit");
+    m_inferenceStage = LatencyTracer::getInstance().getStage(nodeClassName + ".inference");
+    m_pendingFramesGauge = LatencyTracer::getInstance().getGauge(nodeClassName + ".pendingFrames");
+    m_pipelineIndex = LatencyTracer::getInstance().pipelineOf(parentNode);
         
     if (m_inferenceProperties.inference_type != InferenceType::HVA_NONE_TYPE) {
         // set callback for inference
         m_inferenceInstance->SetCallbackFunc(
-            std::bind(&baseImageInferenceNodeWorker::processOutput, this, std::placeholders::_1,
+            std::bind(&baseImageInferenceNodeWorker::onInferenceCompleted, this, std::placeholders::_1,
                     std::placeholders::_2),
             std::bind(&baseImageInferenceNodeWorker::processOutputFailed, this, std::placeholders::_1));
         m_inferenceInstance->CreateModel(m_inferenceProperties);
@@ -297,6 +331,8 @@ void baseImageInferenceNodeWorker::process(std::size_t batchIdx) {
             getParentPtr()->emitEvent(hvaEvent_PipelineTimeStampRecord, &detectionIn);
             getLatencyMonitor().startRecording(blob->frameId,"inference");        
 
+            LatencyScope submitScope(m_submitStage, blob->streamId, blob->frameId, m_pipelineIndex);
+
             HVA_DEBUG("%s %d on frameId %d and streamid %u", m_nodeName.c_str(), batchIdx, blob->frameId, blob->streamId);
             hva::hvaVideoFrameWithROIBuf_t::Ptr ptrFrameBuf = std::dynamic_pointer_cast<hva::hvaVideoFrameWithROIBuf_t>(blob->get(0));
 
@@ -334,6 +370,7 @@ void baseImageInferenceNodeWorker::process(std::size_t batchIdx) {
                     // mark `depleting` status in hva pipeline
                     HVA_DEBUG("%s hold depleting on frameid %u and streamid %u", m_nodeName.c_str(), blob->frameId, blob->streamId);
                     getParentPtr()->holdDepleting();
+                    LatencyTracer::getInstance().addGauge(m_pendingFramesGauge, 1, blob->streamId);
                     // 
                     // InferenceStatus::INFERENCE_EXECUTED == status
                     // 
@@ -349,6 +386,11 @@ void baseImageInferenceNodeWorker::process(std::size_t batchIdx) {
             }
         }
 
+        // rois of all inputs are gathered into batched requests, start the last incomplete one
+        if (m_inferenceProperties.roi_batching) {
+            m_inferenceInstance->SubmitPendingBatch();
+        }
+
     } catch (const std::exception &e) {
         HVA_ERROR("%s failed on frame processing, error: %s", m_nodeName.c_str(), e.what());
     }
@@ -357,6 +399,35 @@ void baseImageInferenceNodeWorker::process(std::size_t batchIdx) {
     }
 }
 
+/**
+ * @brief inference completion callback, records latency of each request and
+ * hands the results to processOutput() of the derived class nodes workers
+ */
+void baseImageInferenceNodeWorker::onInferenceCompleted(
+    std::map<std::string, InferenceBackend::OutputBlob::Ptr> blobs,
+    std::vector<std::shared_ptr<InferenceBackend::ImageInference::IFrameBase>> frames) {
+
+    if (LatencyTracer::getInstance().enabled()) {
+        uint64_t now = LatencyTracer::now();
+        for (const auto& frame : frames) {
+            auto inference_result = std::dynamic_pointer_cast<ImageInferenceInstance::InferenceResult>(frame);
+            if (inference_result && inference_result->input) {
+                LatencyTracer::getInstance().record(m_inferenceStage, inference_result->input->streamId,
+                                                    inference_result->input->frameId, inference_result->submit_timestamp, now,
+                                                    m_pipelineIndex);
+            }
+        }
+    }
+    processOutput(std::move(blobs), std::move(frames));
+}
+
+/**
+ * @brief update pending frames once all inferences on a frame are completed
+ */
+void baseImageInferenceNodeWorker::onFrameCompleted(const hva::hvaBlob_t::Ptr& input) {
+    LatencyTracer::getInstance().addGauge(m_pendingFramesGauge, -1, input->streamId);
+}
+
 hva::hvaStatus_t baseImageInferenceNodeWorker::reset() {
     m_inputBlobs.clear();
     return hva::hvaStatus_t::hvaSuccess;
@@ -402,6 +473,7 @@ void baseImageInferenceNodeWorker::processOutputFailed(
 
             // release `depleting` status in hva pipeline
             HVA_DEBUG("%s release depleting on frameid %u and streamid %u", m_nodeName.c_str(), curInput->frameId, curInput->streamId);
+            onFrameCompleted(curInput);
             getParentPtr()->releaseDepleting();
         }
     }
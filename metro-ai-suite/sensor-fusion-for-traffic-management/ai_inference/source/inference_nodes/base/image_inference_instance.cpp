@@ -18,7 +18,9 @@
 
 #include <algorithm>
 #include <map>
+#include <mutex>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include <opencv2/imgproc.hpp>
@@ -39,6 +41,26 @@ namespace ai{
 
 namespace inference{
 
+namespace {
+
+/**
+ * @brief rois cropped and resized to model input size, attached to the frame buffer as meta
+ * and shared by all models running on this frame
+*/
+struct SharedRoiPreprocCache {
+    // roi_id, x, y, width, height, model input width, model input height
+    using Key = std::tuple<int, uint32_t, uint32_t, uint32_t, uint32_t, size_t, size_t>;
+
+    std::mutex mutex;
+    std::map<Key, cv::Mat> crops;
+};
+
+struct SharedRoiPreprocMeta {
+    std::shared_ptr<SharedRoiPreprocCache> cache;
+};
+
+} // namespace
+
 ImageInferenceInstance::ImageInferenceInstance(InferenceProperty& inference_property) {
 
     // check model path
@@ -72,6 +94,16 @@ void ImageInferenceInstance::SetCallbackFunc(
     m_callback_func_error_handle = func1;
 }
 
+/**
+ * @brief start the pending partially filled batch request, called once all rois of the
+ * current inputs are submitted in roi batching mode
+*/
+void ImageInferenceInstance::SubmitPendingBatch() {
+    if (m_roi_batching && m_model.inference) {
+        m_model.inference->SubmitPendingBatch();
+    }
+}
+
 /**
  * @brief submit inference to specific InferenceBackend (OpenVINO, etc.)
  * @param inference_property
@@ -329,8 +361,15 @@ InferenceStatus ImageInferenceInstance::SubmitImages(const InferenceProperty& in
             
             ApplyImageBoundaries(image, meta, inference_property.inference_region_type);
 
+            // reuse the crop resized by previous models with the same input size
+            std::shared_ptr<InferenceBackend::Image> roi_image = nullptr;
+            if (m_share_roi_preproc) {
+                roi_image = GetSharedRoiImage(buffer, image, meta);
+            }
+            std::shared_ptr<InferenceBackend::Image>& submit_image = roi_image ? roi_image : image;
+
             // prepare the variable to save results: ImageInferenceInstance::InferenceResult
-            auto result = MakeInferenceResult(inference_property, m_model, meta, image, input);
+            auto result = MakeInferenceResult(inference_property, m_model, meta, submit_image, input);
             result->region_count = metas.size();
             // HVA_INFO("img width: %s", image->width);
             // HVA_INFO("img height: %s", image->height);
@@ -440,6 +479,11 @@ void ImageInferenceInstance::CreateModel(InferenceProperty& inference_property)
         throw std::runtime_error("Failed to create image inference");
     m_model.inference = image_inference;
     m_model.name = image_inference->GetModelName();
+
+    // a single-frame request is started as soon as its roi is submitted, nothing to gather
+    m_roi_batching = inference_property.roi_batching && inference_property.batch_size > 1;
+    m_share_roi_preproc = m_roi_batching && IsRoiPreprocShareable(inference_property);
+    HVA_DEBUG("roi batching: %d, share roi pre-processing: %d", m_roi_batching, m_share_roi_preproc);
     
     // return model;
 }
@@ -459,6 +503,103 @@ inline std::shared_ptr<Allocator> ImageInferenceInstance::CreateAllocator(const
     return allocator;
 }
 
+bool ImageInferenceInstance::IsRoiPreprocShareable(const InferenceProperty& inference_property) {
+    if (m_memory_type != MemoryType::SYSTEM) {
+        return false;
+    }
+    if (ImagePreprocessorTypeFromString(inference_property.pre_proc_type) != ImagePreprocessorType::OPENCV) {
+        return false;
+    }
+    // custom image pre-processing (resize type, crop, color space, etc.) differs from model to model
+    for (const ModelInputInfo::Ptr &preproc : m_model.input_processor_info) {
+        if (preproc->format == "image") {
+            auto pre_proc_info = PreProcParamsParser(preproc->params).parse();
+            if (pre_proc_info && pre_proc_info->isDefined()) {
+                return false;
+            }
+        }
+    }
+
+    size_t batch = 0;
+    int format = 0;
+    int memory_type = 0;
+    m_model.inference->GetModelImageInputInfo(m_model_input_width, m_model_input_height, batch, format, memory_type);
+    return m_model_input_width > 0 && m_model_input_height > 0;
+}
+
+std::shared_ptr<InferenceBackend::Image>
+ImageInferenceInstance::GetSharedRoiImage(hva::hvaVideoFrameWithROIBuf_t::Ptr& buffer,
+                                          const std::shared_ptr<InferenceBackend::Image>& image,
+                                          const VideoRegionOfInterestMeta& meta) {
+    if (!image || image->format != InferenceBackend::FourCC::FOURCC_BGR) {
+        return nullptr;
+    }
+
+    // same crop region as the one applied by pre-processor
+    const InferenceBackend::Rectangle<uint32_t>& rect = image->rect;
+    if (image->width <= rect.x || image->height <= rect.y) {
+        return nullptr;
+    }
+    const uint32_t width = std::min(rect.width, image->width - rect.x);
+    const uint32_t height = std::min(rect.height, image->height - rect.y);
+    if (width == 0 || height == 0) {
+        return nullptr;
+    }
+
+    SharedRoiPreprocMeta cacheMeta;
+    if (buffer->containMeta<SharedRoiPreprocMeta>()) {
+        buffer->getMeta(cacheMeta);
+    }
+    if (!cacheMeta.cache) {
+        cacheMeta.cache = std::make_shared<SharedRoiPreprocCache>();
+        buffer->setMeta(cacheMeta);
+    }
+
+    const SharedRoiPreprocCache::Key key(meta.roi_id, rect.x, rect.y, width, height,
+                                         m_model_input_width, m_model_input_height);
+    cv::Mat resized;
+    {
+        std::lock_guard<std::mutex> lock(cacheMeta.cache->mutex);
+        auto it = cacheMeta.cache->crops.find(key);
+        if (it != cacheMeta.cache->crops.end()) {
+            resized = it->second;
+        }
+    }
+
+    if (resized.empty()) {
+        cv::Mat crop(height, width, CV_8UC3, image->planes[0] + rect.y * image->stride[0] + rect.x * 3,
+                     image->stride[0]);
+        const int dst_width = (int)m_model_input_width;
+        const int dst_height = (int)m_model_input_height;
+        // matches the default opencv pre-processing: downscale if larger, otherwise pad to model input size
+        if ((int)width > dst_width || (int)height > dst_height) {
+            cv::resize(crop, resized, cv::Size(dst_width, dst_height));
+        } else {
+            int top = (dst_height - (int)height) / 2;
+            int left = (dst_width - (int)width) / 2;
+            cv::copyMakeBorder(crop, resized, top, dst_height - (int)height - top, left,
+                               dst_width - (int)width - left, cv::BORDER_CONSTANT, cv::Scalar(0, 0, 0));
+        }
+
+        std::lock_guard<std::mutex> lock(cacheMeta.cache->mutex);
+        cacheMeta.cache->crops.emplace(key, resized);
+    }
+
+    // the resized crop already has the model input size, pre-processor only converts the layout
+    std::shared_ptr<InferenceBackend::Image> roi_image(new InferenceBackend::Image(),
+                                                       [resized](InferenceBackend::Image *img) mutable {
+                                                           resized.release();
+                                                           delete img;
+                                                       });
+    roi_image->type = MemoryType::SYSTEM;
+    roi_image->format = InferenceBackend::FourCC::FOURCC_BGR;
+    roi_image->width = (uint32_t)resized.cols;
+    roi_image->height = (uint32_t)resized.rows;
+    roi_image->planes[0] = resized.data;
+    roi_image->stride[0] = (uint32_t)resized.step[0];
+    return roi_image;
+}
+
 unsigned int ImageInferenceInstance::GetOptimalBatchSize(std::string device) {
     unsigned int batch_size = 1;
     // if the device has the format GPU.x we assume that these are discrete graphics and choose larger batch
@@ -655,6 +796,7 @@ ImageInferenceInstance::MakeInferenceResult(const InferenceProperty& inference_p
     result->model = &model;
     result->image = image;
     result->input = input;
+    result->submit_timestamp = LatencyTracer::now();
     return result;
 }
 
@@ -23,7 +23,8 @@ namespace inference{
 
 GrpcPipelineManager::GrpcPipelineManager(): PipelineManager(), m_plInfoPool(PIPELINE_INFO_POOL_INIT_COUNT, 0),
         m_grlPool(PIPELINE_POOL_INIT_COUNT, 0), m_ltiPool(PIPELINE_POOL_INIT_COUNT, 0u), 
-        m_utiPool(PIPELINE_POOL_INIT_COUNT, 0u), m_rtiPool(PIPELINE_POOL_INIT_COUNT, 0u), m_artiPool(PIPELINE_POOL_INIT_COUNT, 0u){
+        m_utiPool(PIPELINE_POOL_INIT_COUNT, 0u), m_rtiPool(PIPELINE_POOL_INIT_COUNT, 0u), m_artiPool(PIPELINE_POOL_INIT_COUNT, 0u),
+        m_warmPipelinesPerConfig(0u){
 
 }
 
@@ -66,10 +67,12 @@ hceAiStatus_t GrpcPipelineManager::start(unsigned pipelineManagerPoolSize){
 hceAiStatus_t GrpcPipelineManager::stop(){
     m_state = Stopped;
     m_waitingQueue.clear();
+    m_deferredQueue.clear();
     for(auto& item: m_workList){
         item.second->pipeline->stop();
     }
     m_workList.clear();
+    m_configIndex.clear();
 
     m_waitingQueueCv.notify_all(); // wakeup the thread
     // m_thread.join();
@@ -92,20 +95,33 @@ void GrpcPipelineManager::watch(){
     // heartbeat use milliseconds to get more accurate value
     uint64_t heartbeatThresh = 1000 * (std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count() - m_maxPipelineLifetime);
     std::lock_guard<std::mutex> lg(m_workListMutex);
-    auto iter = m_workList.begin();
-    while(iter != m_workList.end()){
-        if(iter->second->heartbeat <= heartbeatThresh){
-            _TRC("Pipeline with handle {} exceeds max pipeline lifetime ({}s). stopping", iter->second->jobHandle, m_maxPipelineLifetime);
-            iter->second->pipeline->stop();
-            // to-do: if we need a wait here?
-            releaseResourceByWorkloadWeight(iter->second->suggestedWeight);
-            iter = m_workList.erase(iter);
-            _TRC("Pipeline removed");
+
+    // the most recently used idle auto-loaded pipelines of each config are kept warm
+    std::unordered_map<Handle, bool> warmPipelines;
+    if(m_warmPipelinesPerConfig > 0){
+        for(const auto& bucket: m_configIndex){
+            unsigned warmCnt = 0;
+            for(auto iter = bucket.second.rbegin(); iter != bucket.second.rend() && warmCnt < m_warmPipelinesPerConfig; ++iter){
+                const PipelineInfo::Ptr& plInfo = m_workList[*iter];
+                if(plInfo->autoLoaded && plInfo->pendingRuns == 0){
+                    warmPipelines[*iter] = true;
+                    ++warmCnt;
+                }
+            }
         }
-        else{
-            ++iter;
+    }
+
+    std::vector<Handle> expired;
+    for(const auto& item: m_workList){
+        if(item.second->heartbeat <= heartbeatThresh && warmPipelines.find(item.first) == warmPipelines.end()){
+            expired.push_back(item.first);
         }
     }
+    for(const auto& handle: expired){
+        _TRC("Pipeline with handle {} exceeds max pipeline lifetime ({}s). stopping", handle, m_maxPipelineLifetime);
+        removeFromWorkList(handle);
+        _TRC("Pipeline removed");
+    }
 }
 
 /**
@@ -120,8 +136,8 @@ hceAiStatus_t GrpcPipelineManager::loop(){
             m_waitingQueueCv.wait(lk, [&](){return m_waitingQueue.size() != 0 || m_state == Stopped;});
         }
         
-        // loop through items in waiting queue to run the first that have enough resource
-        for(auto iter = m_waitingQueue.begin(); iter != m_waitingQueue.end(); ){
+        // loop through items in waiting queue in the order of priority and fair share
+        for(auto iter = selectNextTask(); iter != m_waitingQueue.end(); ){
             
             // current task
             auto curTask = *iter;
@@ -132,6 +148,9 @@ hceAiStatus_t GrpcPipelineManager::loop(){
             */
             m_waitingQueue.erase(iter);
 
+            // resource events from now on would have to be seen by this task before it is deferred
+            uint64_t resourceEpoch = m_resourceEpoch;
+
             /*
             We should unlock the conditional_varialble: m_waitingQueueMutex, because:
                 - [1]. Creating new workload takes too long, so that it won't block the insertion of incoming tasks in onRead()
@@ -152,8 +171,16 @@ hceAiStatus_t GrpcPipelineManager::loop(){
                 LoadTaskInfo::Ptr ptr = std::dynamic_pointer_cast<LoadTaskInfo>(curTask);
                 _TRC("Pipeline manager starts to process on a load task with handle {}", ptr->jobHandle);
 
+                bool acquired = acquireResourceByWorkloadWeight(ptr->suggestedWeight);
+                if(!acquired){
+                    // idle warm pipelines give way to explicit loads
+                    std::lock_guard<std::mutex> lg(m_workListMutex);
+                    acquired = acquireResourceByEviction(ptr->suggestedWeight, ptr->configKey) ||
+                            (ptr->priority == PRIORITY_REALTIME && acquireResourceByPreemption(ptr->suggestedWeight));
+                }
+
                 // to-do: check release
-                if(acquireResourceByWorkloadWeight(ptr->suggestedWeight)){
+                if(acquired){
                     PipelineInfo::Ptr plInfo = PipelineInfo::Ptr(m_plInfoPool.construct(), [this](PipelineInfo* ptr){
                             m_plInfoPool.destroy(ptr);});
                     HCE_AI_ASSERT(plInfo);
@@ -162,6 +189,8 @@ hceAiStatus_t GrpcPipelineManager::loop(){
                     plInfo->streamNum = ptr->streamNum;
                     plInfo->heartbeat = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
                     plInfo->pipelineConfig = ptr->pipelineConfig;
+                    plInfo->configKey = ptr->configKey;
+                    plInfo->priorities = RunPriorities(ptr->priority);
                     plInfo->pipeline = run(plInfo, ptr->pipelineConfig);
                     if(!plInfo->pipeline){
                         _WRN("Pipeline manager unable to constuct the pipeline with handle {}", plInfo->jobHandle);
@@ -169,25 +198,19 @@ hceAiStatus_t GrpcPipelineManager::loop(){
                         replyRunError(ptr->commHandle, 500, "Unable to construct the specified pipeline", ptr->jobHandle);
 
                         // erase the element in waiting queue
-                        // iter = m_waitingQueue.erase(iter);
                         erase_flag = true;
                     }
                     else{
                         _TRC("Pipeline manager constucted the pipeline with handle {}", plInfo->jobHandle);
                         {
                             std::lock_guard<std::mutex> lg(m_workListMutex);
-                            m_workList.emplace(plInfo->jobHandle, plInfo);
+                            addToWorkList(plInfo);
                         }
                         m_workListCv.notify_all();
 
                         replyLoadPipeline(ptr->commHandle, 200, "Success", ptr->jobHandle);
 
                         // erase the element in waiting queue
-                        // iter = m_waitingQueue.erase(iter);
-                        
-                        // we break here to release the mutex, as pipeline construction might takes long
-                        // break;
-
                         erase_flag = true;
 
                     }
@@ -196,7 +219,6 @@ hceAiStatus_t GrpcPipelineManager::loop(){
                     replyRunError(ptr->commHandle, 400, "Task canceled due to workload constrains", ptr->jobHandle);
                     
                     // erase the element in waiting queue
-                    // iter = m_waitingQueue.erase(iter);
                     erase_flag = true;
                 }
             }
@@ -215,33 +237,12 @@ hceAiStatus_t GrpcPipelineManager::loop(){
                     replyRunError(ptr->commHandle, 400, "Handle does not exist", ptr->jobHandle);
                     
                     // erase the element in waiting queue
-                    // iter = m_waitingQueue.erase(iter);
                     erase_flag = true;
                 }
                 else{
-                    item->second->heartbeat = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-                    item->second->commHandle.push_front(ptr->commHandle);
-                    
-                    // support cross-stream style pipeline config
-                    unsigned streamNum = item->second->streamNum;
-                    int segNum = std::floor(ptr->mediaUris.size() / streamNum);
-                    for (unsigned streamId = 0; streamId < streamNum; ++streamId) {
-                        
-                        // get piece for cur streamId
-                        int beginIndex = (int)streamId * segNum;
-                        int endIndex = streamId == (streamNum - 1) ? (int)ptr->mediaUris.size() : beginIndex + segNum;
-                        std::vector<std::string> mediaUris(ptr->mediaUris.begin() + beginIndex, ptr->mediaUris.begin() + endIndex);
-
-                        auto blob = hva::hvaBlob_t::make_blob();
-                        blob->streamId = streamId;
-                        blob->emplace<hva::hvaBuf_t>(mediaUris, sizeof(mediaUris));
-                        item->second->pipeline->sendToPort(blob, "Input", 0, std::chrono::milliseconds(0));
-                        if (item->second->pipelineConfig.find("RadarDataReader") != std::string::npos){
-                            item->second->pipeline->sendToPort(blob, "RadarDataReader", 0, std::chrono::milliseconds(0));
-                        }
-                    }
+                    dispatchRun(*item->second, ptr->mediaUris, ptr->commHandle, *ptr);
+
                     // erase the element in waiting queue
-                    // iter = m_waitingQueue.erase(iter);
                     erase_flag = true;
                 }
             }
@@ -260,32 +261,57 @@ hceAiStatus_t GrpcPipelineManager::loop(){
                     replyUnloadPipeline(ptr->commHandle, 200, "handle no longer exists", ptr->jobHandle);
                     
                     // erase the element in waiting queue
-                    // iter = m_waitingQueue.erase(iter);
                     erase_flag = true;
                 }
                 else{
-                    item->second->pipeline->stop();
                     // to-do: if we need a wait here?
-                    m_workList.erase(ptr->jobHandle);
+                    removeFromWorkList(ptr->jobHandle);
                     replyUnloadPipeline(ptr->commHandle, 200, "Success", ptr->jobHandle);
-                    releaseResourceByWorkloadWeight(item->second->suggestedWeight);
                     
                     // erase the element in waiting queue
-                    // iter = m_waitingQueue.erase(iter);
                     erase_flag = true;
                 }
                 
             }
             //
-            // processing TASK_AUTO_RUN: auto load new pipeline when resources enough (< MaxConcurrentWorkload), 
-            // or else reuse an existing pipeline with same pipelineConfig
+            // processing TASK_AUTO_RUN: reuse an idle pipeline with same pipelineConfig if any,
+            // or else auto load new pipeline when resources enough (< MaxConcurrentWorkload),
+            // or else queue on the least recently used pipeline with same pipelineConfig
             //
             else if((curTask)->taskType == Task::TASK_AUTO_RUN){
                 AutoRunTaskInfo::Ptr ptr = std::dynamic_pointer_cast<AutoRunTaskInfo>(curTask);
                 _TRC("Pipeline manager starts to process on a auto run task");
 
+                bool acquired = false;
+                {
+                    std::lock_guard<std::mutex> lg(m_workListMutex);
+                    PipelineInfo::Ptr plInfo = findIdlePipeline(ptr->configKey);
+                    if(plInfo){
+                        _TRC("auto run task schedules to use idle pipeline with handle {}", plInfo->jobHandle);
+                        dispatchRun(*plInfo, ptr->mediaUris, ptr->commHandle, *ptr);
+                        erase_flag = true;
+                    }
+                    else{
+                        acquired = acquireResourceByWorkloadWeight(ptr->suggestedWeight) ||
+                                acquireResourceByEviction(ptr->suggestedWeight, ptr->configKey) ||
+                                (ptr->priority == PRIORITY_REALTIME && acquireResourceByPreemption(ptr->suggestedWeight));
+                        if(!acquired){
+                            plInfo = findEldestPipeline(ptr->configKey);
+                            if(plInfo){
+                                _TRC("auto run task schedules to use existing pipeline with handle {}", plInfo->jobHandle);
+                                dispatchRun(*plInfo, ptr->mediaUris, ptr->commHandle, *ptr);
+                                erase_flag = true;
+                            }
+                            else{
+                                _TRC("auto run task delays as no resource nor similar pipeline");
+                                erase_flag = false;
+                            }
+                        }
+                    }
+                }
+
                 // to-do: check release
-                if(acquireResourceByWorkloadWeight(ptr->suggestedWeight)){
+                if(acquired){
                     // in case we have resource to create workload
                     PipelineInfo::Ptr plInfo = PipelineInfo::Ptr(m_plInfoPool.construct(), [this](PipelineInfo* ptr){
                             m_plInfoPool.destroy(ptr);});
@@ -295,6 +321,9 @@ hceAiStatus_t GrpcPipelineManager::loop(){
                     plInfo->streamNum = ptr->streamNum;
                     plInfo->heartbeat = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
                     plInfo->pipelineConfig = ptr->pipelineConfig;
+                    plInfo->configKey = ptr->configKey;
+                    plInfo->priorities = RunPriorities(ptr->priority);
+                    plInfo->autoLoaded = true;
                     plInfo->pipeline = run(plInfo, ptr->pipelineConfig);
                     if(!plInfo->pipeline){
                         _WRN("Pipeline manager unable to constuct the pipeline with handle {}", plInfo->jobHandle);
@@ -302,94 +331,21 @@ hceAiStatus_t GrpcPipelineManager::loop(){
                         replyRunError(ptr->commHandle, 500, "Unable to construct the specified pipeline", 0);
                         
                         // erase the element in waiting queue
-                        // iter = m_waitingQueue.erase(iter);
                         erase_flag = true;
                     }
                     else{
-                        plInfo->commHandle.push_front(ptr->commHandle);
-                        
-                        // support cross-stream style pipeline config
-                        int segNum = std::floor(ptr->mediaUris.size() / ptr->streamNum);
-                        for (unsigned streamId = 0; streamId < ptr->streamNum; ++streamId) {
-                            
-                            // get piece for cur streamId
-                            int beginIndex = (int)streamId * segNum;
-                            int endIndex = streamId == (ptr->streamNum - 1) ? (int)ptr->mediaUris.size() : beginIndex + segNum;
-                            std::vector<std::string> mediaUris(ptr->mediaUris.begin() + beginIndex, ptr->mediaUris.begin() + endIndex);
-
-                            auto blob = hva::hvaBlob_t::make_blob();
-                            blob->streamId = streamId;
-                            blob->emplace<hva::hvaBuf_t>(mediaUris, sizeof(mediaUris));
-                            plInfo->pipeline->sendToPort(blob, "Input", 0, std::chrono::milliseconds(0));
-                            if (plInfo->pipelineConfig.find("RadarDataReader") != std::string::npos){
-                                plInfo->pipeline->sendToPort(blob, "RadarDataReader", 0, std::chrono::milliseconds(0));
-                            }
-                        }
-
                         _TRC("Pipeline manager constucted the pipeline with handle {}", plInfo->jobHandle);
                         {
                             std::lock_guard<std::mutex> lg(m_workListMutex);
-                            m_workList.emplace(plInfo->jobHandle, plInfo);
+                            addToWorkList(plInfo);
+                            dispatchRun(*plInfo, ptr->mediaUris, ptr->commHandle, *ptr);
                         }
                         m_workListCv.notify_all();
 
-                        // erase the element in waiting queue
-                        // iter = m_waitingQueue.erase(iter);
-
-                        // we break here to release the mutex, as pipeline construction might takes long
-                        // break;
-
                         erase_flag = true;
 
                     }
                 }
-                else{
-                    std::lock_guard<std::mutex> lg(m_workListMutex);
-                    Handle eldestHandle;
-                    volatile uint64_t eldestHb = UINT64_MAX;
-                    for(const auto& item: m_workList){
-                        if(item.second->pipelineConfig == ptr->pipelineConfig){
-                            if(item.second->heartbeat < eldestHb){
-                                eldestHb = item.second->heartbeat;
-                                eldestHandle = item.first;
-                            }
-                        }
-                    }
-                    if(eldestHb == UINT64_MAX){
-                        _TRC("auto run task delays as no resource nor similar pipeline");
-                        
-                        // ++iter;
-                        erase_flag = false;
-                    }
-                    else{
-                        _TRC("auto run task schedules to use existing pipeline with handle {}", eldestHandle);
-
-                        m_workList[eldestHandle]->heartbeat = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-                        m_workList[eldestHandle]->commHandle.push_front(ptr->commHandle);
-                        
-                        // support cross-stream style pipeline config
-                        int segNum = std::floor(ptr->mediaUris.size() / ptr->streamNum);
-                        for (unsigned streamId = 0; streamId < ptr->streamNum; ++streamId) {
-                            
-                            // get piece for cur streamId
-                            int beginIndex = (int)streamId * segNum;
-                            int endIndex = streamId == (ptr->streamNum - 1) ? (int)ptr->mediaUris.size() : beginIndex + segNum;
-                            std::vector<std::string> mediaUris(ptr->mediaUris.begin() + beginIndex, ptr->mediaUris.begin() + endIndex);
-
-                            auto blob = hva::hvaBlob_t::make_blob();
-                            blob->streamId = streamId;
-                            blob->emplace<hva::hvaBuf_t>(mediaUris, sizeof(mediaUris));
-                            m_workList[eldestHandle]->pipeline->sendToPort(blob, "Input", 0, std::chrono::milliseconds(0));
-                            if (m_workList[eldestHandle]->pipelineConfig.find("RadarDataReader") != std::string::npos){
-                                m_workList[eldestHandle]->pipeline->sendToPort(blob, "RadarDataReader", 0, std::chrono::milliseconds(0));
-                            }
-                        }
-                        
-                        // erase the element in waiting queue
-                        // iter = m_waitingQueue.erase(iter);
-                        erase_flag = true;
-                    }
-                }
             }
             else{
                 // should not happen
@@ -399,14 +355,19 @@ hceAiStatus_t GrpcPipelineManager::loop(){
             
             lk.lock();
             if (!erase_flag) {
-                // push curTask to waitingQueue again, wait for next polling
-                m_waitingQueue.push_back(curTask);
-                m_waitingQueueCv.notify_all(); // wakeup the thread
+                if (resourceEpoch != m_resourceEpoch) {
+                    // resources changed while processing this task, try again
+                    m_waitingQueue.push_back(curTask);
+                }
+                else {
+                    // wait for resources release or pipelines turning idle, see notifyResourceEvent()
+                    m_deferredQueue.push_back(curTask);
+                }
             }
-            if (iter == m_waitingQueue.end()) {
+            if (m_waitingQueue.empty()) {
                 break;
             }
-            iter = m_waitingQueue.begin();
+            iter = selectNextTask();
 
         }
 
@@ -418,6 +379,7 @@ hceAiStatus_t GrpcPipelineManager::loop(){
     // discard all elements in waiting queue
     lk.lock();
     m_waitingQueue.clear();
+    m_deferredQueue.clear();
     lk.unlock();
 
     // stop all working items in working list
@@ -429,6 +391,7 @@ hceAiStatus_t GrpcPipelineManager::loop(){
             }
         }
         m_workList.clear();
+        m_configIndex.clear();
     }
     return hceAiSuccess;
 }
@@ -442,7 +405,8 @@ hceAiStatus_t GrpcPipelineManager::loop(){
 */
 hceAiStatus_t GrpcPipelineManager::submitLoadPipeline(
     const std::string& pipelineConfig, GrpcServer::Handle commHandle,
-    Handle& jobHandle, unsigned suggestedWeight, unsigned streamNum) {
+    Handle& jobHandle, unsigned suggestedWeight, unsigned streamNum,
+    Priority priority, const std::string& clientId) {
     HCE_AI_ASSERT(commHandle);
     HCE_AI_ASSERT(!pipelineConfig.empty());
 
@@ -460,9 +424,12 @@ hceAiStatus_t GrpcPipelineManager::submitLoadPipeline(
         pendingTask->taskType = Task::TASK_LOAD;
         pendingTask->commHandle = commHandle;
         pendingTask->pipelineConfig = pipelineConfig;
+        pendingTask->configKey = canonicalizeConfig(pipelineConfig, streamNum);
         pendingTask->jobHandle = jobHandle;
         pendingTask->suggestedWeight = suggestedWeight;
         pendingTask->streamNum = streamNum;
+        pendingTask->priority = priority;
+        pendingTask->clientId = clientId;
 
         std::lock_guard<std::mutex> lg(m_waitingQueueMutex);
 
@@ -480,7 +447,7 @@ hceAiStatus_t GrpcPipelineManager::submitLoadPipeline(
 */
 hceAiStatus_t GrpcPipelineManager::submitRun(
     const std::vector<std::string>& mediaUris, Handle jobHandle,
-    GrpcServer::Handle commHandle) {
+    GrpcServer::Handle commHandle, Priority priority, const std::string& clientId) {
     HCE_AI_ASSERT(commHandle);
     HCE_AI_ASSERT(mediaUris.size() != 0);
 
@@ -493,6 +460,8 @@ hceAiStatus_t GrpcPipelineManager::submitRun(
         pendingTask->commHandle = commHandle;
         pendingTask->mediaUris = mediaUris;
         pendingTask->jobHandle = jobHandle;
+        pendingTask->priority = priority;
+        pendingTask->clientId = clientId;
 
         std::lock_guard<std::mutex> lg(m_waitingQueueMutex);
 
@@ -513,7 +482,7 @@ hceAiStatus_t GrpcPipelineManager::submitRun(
 hceAiStatus_t GrpcPipelineManager::submitAutoRun(
     const std::vector<std::string>& mediaUris,
     const std::string& pipelineConfig, GrpcServer::Handle commHandle,
-    unsigned suggestedWeight, unsigned streamNum) {
+    unsigned suggestedWeight, unsigned streamNum, Priority priority, const std::string& clientId) {
     HCE_AI_ASSERT(commHandle);
     HCE_AI_ASSERT(mediaUris.size() != 0);
 
@@ -529,8 +498,11 @@ hceAiStatus_t GrpcPipelineManager::submitAutoRun(
         pendingTask->commHandle = commHandle;
         pendingTask->mediaUris = mediaUris;
         pendingTask->pipelineConfig = pipelineConfig;
+        pendingTask->configKey = canonicalizeConfig(pipelineConfig, streamNum);
         pendingTask->suggestedWeight = suggestedWeight;
         pendingTask->streamNum = streamNum;
+        pendingTask->priority = priority;
+        pendingTask->clientId = clientId;
 
         std::lock_guard<std::mutex> lg(m_waitingQueueMutex);
 
@@ -580,6 +552,8 @@ GrpcPipelineManager::hvaPipelinePtr GrpcPipelineManager::run(PipelineInfo::Ptr p
         return hvaPipelinePtr();
     }
 
+    registerTracedNodes(*pl, pipelionConfig, plInfo->jobHandle);
+
     // std::shared_ptr<_restReplyListener> listener(m_rrlPool.construct(plInfo), 
     //         [this](_restReplyListener* ptr){m_rrlPool.destroy(ptr);});
 
@@ -597,6 +571,290 @@ GrpcPipelineManager::hvaPipelinePtr GrpcPipelineManager::run(PipelineInfo::Ptr p
     return pl;
 }
 
+void GrpcPipelineManager::setWarmPipelinesPerConfig(unsigned warmPipelinesPerConfig){
+    m_warmPipelinesPerConfig = warmPipelinesPerConfig;
+    _INF("Warm pipelines per config sets to {}", m_warmPipelinesPerConfig);
+}
+
+/**
+ * @brief sort object members recursively, array elements keep their order
+*/
+static void sortConfigTree(boost::property_tree::ptree& tree){
+    bool isObject = true;
+    for(auto& child: tree){
+        if(child.first.empty()){
+            isObject = false;
+        }
+        sortConfigTree(child.second);
+    }
+    if(isObject){
+        tree.sort([](const boost::property_tree::ptree::value_type& a, const boost::property_tree::ptree::value_type& b){
+            return a.first < b.first;
+        });
+    }
+}
+
+std::string GrpcPipelineManager::canonicalizeConfig(const std::string& pipelineConfig, unsigned streamNum){
+    std::string configKey;
+    try{
+        boost::property_tree::ptree tree;
+        std::stringstream iss(pipelineConfig);
+        boost::property_tree::read_json(iss, tree);
+        sortConfigTree(tree);
+        std::stringstream oss;
+        boost::property_tree::write_json(oss, tree, false);
+        configKey = oss.str();
+    }
+    catch(const boost::property_tree::ptree_error& e){
+        // not a json config, leave it to the pipeline parser, only identical configs share pipelines
+        configKey = pipelineConfig;
+    }
+    return configKey + "#" + std::to_string(streamNum);
+}
+
+void GrpcPipelineManager::dispatchRun(PipelineInfo& plInfo, const std::vector<std::string>& mediaUris, GrpcServer::Handle commHandle, const Task& task){
+    plInfo.heartbeat = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+    // charge the client by estimate at admission, corrected in onRunFinished()
+    double cost = estimateRunCost(plInfo);
+    {
+        std::lock_guard<std::mutex> lg(plInfo.runMutex);
+        plInfo.runRecords.push_front({task.clientId, plInfo.heartbeat, cost, task.priority});
+        plInfo.priorities.add(task.priority);
+    }
+    {
+        std::lock_guard<std::mutex> lg(m_waitingQueueMutex);
+        chargeClient(task.clientId, cost);
+    }
+
+    ++plInfo.pendingRuns;
+    plInfo.commHandle.push_front(commHandle);
+    applyResultFormat(plInfo);
+
+    // most recently used at the back
+    auto bucket = m_configIndex.find(plInfo.configKey);
+    if(bucket != m_configIndex.end()){
+        bucket->second.splice(bucket->second.end(), bucket->second, plInfo.configIter);
+    }
+
+    // support cross-stream style pipeline config
+    unsigned streamNum = plInfo.streamNum;
+    int segNum = std::floor(mediaUris.size() / streamNum);
+    for (unsigned streamId = 0; streamId < streamNum; ++streamId) {
+        
+        // get piece for cur streamId
+        int beginIndex = (int)streamId * segNum;
+        int endIndex = streamId == (streamNum - 1) ? (int)mediaUris.size() : beginIndex + segNum;
+        std::vector<std::string> streamMediaUris(mediaUris.begin() + beginIndex, mediaUris.begin() + endIndex);
+
+        auto blob = hva::hvaBlob_t::make_blob();
+        blob->streamId = streamId;
+        blob->emplace<hva::hvaBuf_t>(streamMediaUris, sizeof(streamMediaUris));
+        plInfo.pipeline->sendToPort(blob, "Input", 0, std::chrono::milliseconds(0));
+        if (plInfo.pipelineConfig.find("RadarDataReader") != std::string::npos){
+            plInfo.pipeline->sendToPort(blob, "RadarDataReader", 0, std::chrono::milliseconds(0));
+        }
+    }
+}
+
+void GrpcPipelineManager::addToWorkList(const PipelineInfo::Ptr& plInfo){
+    m_workList.emplace(plInfo->jobHandle, plInfo);
+    auto& bucket = m_configIndex[plInfo->configKey];
+    plInfo->configIter = bucket.insert(bucket.end(), plInfo->jobHandle);
+}
+
+void GrpcPipelineManager::removeFromWorkList(Handle jobHandle){
+    auto item = m_workList.find(jobHandle);
+    if(item == m_workList.end()){
+        return;
+    }
+    PipelineInfo::Ptr plInfo = item->second;
+    plInfo->pipeline->stop();
+    unregisterTracedNodes(jobHandle);
+    m_workList.erase(item);
+
+    auto bucket = m_configIndex.find(plInfo->configKey);
+    if(bucket != m_configIndex.end()){
+        bucket->second.erase(plInfo->configIter);
+        if(bucket->second.empty()){
+            m_configIndex.erase(bucket);
+        }
+    }
+    releaseResourceByWorkloadWeight(plInfo->suggestedWeight);
+}
+
+GrpcPipelineManager::PipelineInfo::Ptr GrpcPipelineManager::findIdlePipeline(const std::string& configKey){
+    auto bucket = m_configIndex.find(configKey);
+    if(bucket == m_configIndex.end()){
+        return nullptr;
+    }
+    for(const auto& handle: bucket->second){
+        const PipelineInfo::Ptr& plInfo = m_workList[handle];
+        if(plInfo->autoLoaded && plInfo->pendingRuns == 0){
+            return plInfo;
+        }
+    }
+    return nullptr;
+}
+
+GrpcPipelineManager::PipelineInfo::Ptr GrpcPipelineManager::findEldestPipeline(const std::string& configKey){
+    auto bucket = m_configIndex.find(configKey);
+    if(bucket == m_configIndex.end() || bucket->second.empty()){
+        return nullptr;
+    }
+    return m_workList[bucket->second.front()];
+}
+
+bool GrpcPipelineManager::acquireResourceByPreemption(unsigned weightToAcquire){
+    // best-effort work is only given up when the weight reclaimed from it is enough
+    int reclaimable = (int)m_maxConcurrentWorkload - m_currentWorkloadWeight;
+    for(const auto& item: m_workList){
+        const PipelineInfo::Ptr& plInfo = item.second;
+        std::lock_guard<std::mutex> lg(plInfo->runMutex);
+        if(plInfo->priorities.preemptible()){
+            reclaimable += plInfo->suggestedWeight;
+        }
+    }
+    if(reclaimable < (int)weightToAcquire){
+        _TRC("Not preempting best-effort pipelines, {} reclaimable out of {} to acquire", reclaimable, weightToAcquire);
+        return false;
+    }
+
+    while(true){
+        PipelineInfo::Ptr victim;
+        for(const auto& item: m_workList){
+            const PipelineInfo::Ptr& plInfo = item.second;
+            {
+                // pipelines with normal or real-time runs pending are never preempted
+                std::lock_guard<std::mutex> lg(plInfo->runMutex);
+                if(!plInfo->priorities.preemptible()){
+                    continue;
+                }
+            }
+            if(!victim){
+                victim = plInfo;
+                continue;
+            }
+            bool idle = plInfo->pendingRuns == 0;
+            bool victimIdle = victim->pendingRuns == 0;
+            if((idle && !victimIdle) || (idle == victimIdle && plInfo->heartbeat < victim->heartbeat)){
+                victim = plInfo;
+            }
+        }
+        if(!victim){
+            return false;
+        }
+        _INF("Preempting best-effort pipeline with handle {} for a real-time task", victim->jobHandle);
+        removeFromWorkList(victim->jobHandle);
+
+        // the pipeline is stopped, no more responses would be emitted on pending runs
+        for(const auto& client: victim->commHandle){
+            replyRunError(client, 503, "Preempted by a real-time task", victim->jobHandle);
+            GrpcServer::getInstance().replyFinish(client);
+        }
+        victim->commHandle.clear();
+
+        if(acquireResourceByWorkloadWeight(weightToAcquire)){
+            return true;
+        }
+    }
+}
+
+double GrpcPipelineManager::estimateRunCost(const PipelineInfo& plInfo){
+    std::lock_guard<std::mutex> lg(m_runCostMutex);
+    auto iter = m_runCost.find(plInfo.configKey);
+    return iter == m_runCost.end() ? RUN_COST_DEFAULT_MS * plInfo.suggestedWeight : iter->second;
+}
+
+void GrpcPipelineManager::onRunFinished(PipelineInfo& plInfo){
+    uint64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    PipelineInfo::RunRecord record;
+    {
+        std::lock_guard<std::mutex> lg(plInfo.runMutex);
+        if(plInfo.runRecords.empty()){
+            return;
+        }
+        record = std::move(plInfo.runRecords.back());
+        plInfo.runRecords.pop_back();
+        plInfo.priorities.remove(record.priority);
+
+        // runs on a pipeline are served one after another, the service starts when the previous run finishes
+        uint64_t serviceStart = std::max(record.submitTime, plInfo.lastFinish);
+        plInfo.lastFinish = now;
+        now -= serviceStart;
+    }
+    double serviceTime = (double)now;
+
+    {
+        std::lock_guard<std::mutex> lg(m_runCostMutex);
+        if(m_runCost.size() >= RUN_COST_TABLE_MAX_SIZE && m_runCost.find(plInfo.configKey) == m_runCost.end()){
+            m_runCost.clear();
+        }
+        auto iter = m_runCost.emplace(plInfo.configKey, serviceTime).first;
+        iter->second += RUN_COST_SMOOTHING_FACTOR * (serviceTime - iter->second);
+    }
+    {
+        std::lock_guard<std::mutex> lg(m_waitingQueueMutex);
+        chargeClient(record.clientId, serviceTime - record.chargedCost);
+    }
+}
+
+bool GrpcPipelineManager::acquireResourceByEviction(unsigned weightToAcquire, const std::string& configKey){
+    // idle pipelines are only evicted when the weight reclaimed from them is enough
+    int reclaimable = (int)m_maxConcurrentWorkload - m_currentWorkloadWeight;
+    for(const auto& bucket: m_configIndex){
+        if(bucket.first == configKey){
+            continue;
+        }
+        for(const auto& handle: bucket.second){
+            const PipelineInfo::Ptr& plInfo = m_workList[handle];
+            if(plInfo->autoLoaded && plInfo->pendingRuns == 0){
+                reclaimable += plInfo->suggestedWeight;
+            }
+        }
+    }
+    if(reclaimable < (int)weightToAcquire){
+        _TRC("Not evicting idle pipelines, {} reclaimable out of {} to acquire", reclaimable, weightToAcquire);
+        return false;
+    }
+
+    while(true){
+        // the least recently used idle pipeline among other configs
+        PipelineInfo::Ptr victim;
+        for(const auto& bucket: m_configIndex){
+            if(bucket.first == configKey){
+                continue;
+            }
+            for(const auto& handle: bucket.second){
+                const PipelineInfo::Ptr& plInfo = m_workList[handle];
+                if(plInfo->autoLoaded && plInfo->pendingRuns == 0){
+                    if(!victim || plInfo->heartbeat < victim->heartbeat){
+                        victim = plInfo;
+                    }
+                    break;
+                }
+            }
+        }
+        if(!victim){
+            return false;
+        }
+        _TRC("Evicting idle pipeline with handle {} to make room for another config", victim->jobHandle);
+        removeFromWorkList(victim->jobHandle);
+        if(acquireResourceByWorkloadWeight(weightToAcquire)){
+            return true;
+        }
+    }
+}
+
+void GrpcPipelineManager::applyResultFormat(PipelineInfo& plInfo){
+    if(!plInfo.pipeline || plInfo.commHandle.empty()){
+        return;
+    }
+    baseResponseNode::ResultFormat_t format = GrpcServer::getInstance().getResultFormat(plInfo.commHandle.back());
+    dynamic_cast<baseResponseNode&>(plInfo.pipeline->getNodeHandle("Output")).setResultFormat(format);
+    _TRC("Pipeline with handle {} switches result format to {}", plInfo.jobHandle, (int)format);
+}
+
 void GrpcPipelineManager::replyLoadPipeline(GrpcServer::Handle client, unsigned code, const std::string& description, Handle jobHandle){
     boost::property_tree::ptree jsonTree;
     
@@ -16,6 +16,8 @@
 #include <thread>
 #include <atomic>
 #include <list>
+#include <mutex>
+#include <condition_variable>
 
 #include <boost/pool/object_pool.hpp>
 #include <boost/pool/pool_alloc.hpp>
@@ -23,14 +25,24 @@
 #include <grpcpp/grpcpp.h>
 
 #include "common/logger.hpp"
+#include "common/latency_tracer.hpp"
 #include "low_latency_server/grpc_server/grpcServer.hpp"
 #include "low_latency_server/grpc_server/grpcPipelineManager.hpp"
+#include "low_latency_server/grpc_server/replyBackpressure.hpp"
 
 // protobuf
 #include "ai_v1.grpc.pb.h"
 
 #define CONN_POOL_INIT_COUNT 32
 
+// max number of replies merged into one message when the client asks for coalescing
+#define REPLY_COALESCE_MAX_COUNT 32
+// interval a lossless producer rechecks the connection state while the reply queue is full
+#define REPLY_QUEUE_WAIT_INTERVAL_MS 100
+// max time a lossless producer is held on a full reply queue. The producer is the pipeline thread shared by all
+// runs of the pipeline, so beyond this the stream is ended with RESOURCE_EXHAUSTED rather than stalling the other runs
+#define REPLY_QUEUE_MAX_WAIT_MS 1000
+
 #define _AI_INF_CAST_VOIDP_TO_UID(voidp) ((uint16_t)(((reinterpret_cast<std::size_t>(voidp) & UINT32_MAX)>>16)))
 #define _AI_INF_CAST_VOIDP_TO_MSG_TYPE(voidp) ((MessageType)(reinterpret_cast<std::size_t>(voidp) & UINT16_MAX))
 
@@ -43,6 +55,8 @@ namespace inference{
 struct _GrpcCtx{
     hce_ai::ai_inference::AsyncService* service;
     grpc::ServerCompletionQueue* cq;
+    std::size_t replyQueueDepth;    // 0 means unbounded
+    unsigned shardId;               // index of the completion queue polling this connection
 };
 
 class GrpcServer::Impl{
@@ -50,7 +64,7 @@ public:
     class ConnPool{
     public:
 
-        ConnPool(hce_ai::ai_inference::AsyncService* service, grpc::ServerCompletionQueue* cq);
+        ConnPool(hce_ai::ai_inference::AsyncService* service, grpc::ServerCompletionQueue* cq, std::size_t replyQueueDepth, unsigned shardId);
 
         ~ConnPool() = default;
 
@@ -83,6 +97,8 @@ public:
     private:
         hce_ai::ai_inference::AsyncService* m_service;
         grpc::ServerCompletionQueue* m_cq;
+        std::size_t m_replyQueueDepth;
+        unsigned m_shardId;
 
         boost::object_pool<_CommHandle> m_objPool;
         std::unordered_map<uint16_t, Handle, std::hash<uint16_t>, std::equal_to<uint16_t>, 
@@ -117,15 +133,24 @@ private:
         Stopped
     };    
 
-    void workload();
+    /**
+     * @brief a completion queue with the connections it serves, polled by one thread only. connections
+     * are pinned to the shard where their rpc is requested, so the pool and state machines of a shard
+     * are never touched by other polling threads
+    */
+    struct _Shard{
+        std::unique_ptr<grpc::ServerCompletionQueue> cq;
+        std::unique_ptr<ConnPool> connPool;
+    };
+
+    void workload(unsigned shardId);
 
     CommConfig m_config;
     std::vector<std::thread> m_threads;
     std::atomic<State> m_state;
-    std::unique_ptr<ConnPool> m_connPool;
+    std::vector<_Shard> m_shards;
 
     hce_ai::ai_inference::AsyncService m_service;
-    std::unique_ptr<grpc::ServerCompletionQueue> m_cq;
     std::unique_ptr<grpc::Server> m_server;
 };
 
@@ -154,6 +179,19 @@ public:
 
     hceAiStatus_t writeFinish();
 
+    /**
+     * @brief end the stream with RESOURCE_EXHAUSTED for a lossless client stalled on a full reply queue,
+     * replies already queued are still delivered ahead of the status
+    */
+    void writeExhausted();
+
+    /**
+     * @brief status the stream is finished with
+    */
+    grpc::Status finishStatus() const;
+
+    baseResponseNode::ResultFormat_t getResultFormat() const;
+
 private:
     enum MessageType{
         MessageTypeDefault = 0,
@@ -197,9 +235,24 @@ private:
     // What we send back to the client.
     hce_ai::AI_Response m_reply;
 
-    // reply queue for cached messages
+    // reply queue for cached messages, bounded by m_grpcCtx.replyQueueDepth
     std::list<hce_ai::AI_Response, boost::fast_pool_allocator<hce_ai::AI_Response>> m_replyQueue;
     std::mutex m_replyQueueMutex;
+    std::condition_variable m_replyQueueCv;     // signaled when a cached reply is sent
+    std::size_t m_droppedReplies;               // guarded by m_replyQueueMutex
+    std::atomic<bool> m_replyExhausted;         // lossless client stalled on a full queue, the stream is being ended
+    ReplyBackpressure m_backpressure;
+
+    // reply flow control requested by client
+    std::atomic<int> m_replyPolicy;             // hce_ai::ReplyPolicy
+    std::atomic<bool> m_coalesceReplies;
+    std::atomic<uint64_t> m_replySeq;           // keys replies in AI_Response.responses when coalescing
+
+    LatencyTracer::Gauge* m_replyQueueGauge;    // cached replies of all connections
+    LatencyTracer::Gauge* m_droppedRepliesGauge;
+    LatencyTracer::Gauge* m_coalescedRepliesGauge;
+    LatencyTracer::Stage* m_writeStage;         // from issuing a write to its completion, per shard
+    uint64_t m_writeIssuedAt;                   // guarded by m_writeMutex, one write in flight at most
 
 
     volatile bool m_writeInProgress; // indicating a write has been fired but haven't received from cq
@@ -210,6 +263,8 @@ private:
 
     std::atomic<State> m_state;  // The current serving state.
 
+    std::atomic<int> m_resultFormat;  // baseResponseNode::ResultFormat_t requested by client
+
     GrpcServer::Impl::ConnPool* m_poolCtx;
 
     /**
@@ -256,18 +311,36 @@ private:
     */
     void makeBadReqReply();
 
+    /**
+     * @brief convert a response of output nodes into protobuf message, under coalescing mode
+     * the response is carried by AI_Response.responses keyed by its sequence number
+    */
+    hce_ai::AI_Response makeReplyMessage(const baseResponseNode::Response& reply);
+
+    /**
+     * @brief cache a reply while a write is in progress, merge it into the last cached message
+     * or drop the eldest ones according to the reply policy.
+     * m_writeMutex should be held by caller
+    */
+    void cacheReply(hce_ai::AI_Response&& res);
+
+    /**
+     * @brief send the eldest cached reply. m_writeMutex should be held by caller, m_replyQueue should not be empty
+    */
+    void writeCachedReply();
+
     /**
      * @brief parse client request, submit tasks to pipeline manager
     */
     void parseClientRequest();
 };
 
-GrpcServer::Impl::ConnPool::ConnPool(hce_ai::ai_inference::AsyncService* service, grpc::ServerCompletionQueue* cq):m_ctr(0u), m_objPool(CONN_POOL_INIT_COUNT, 0),
-                m_service(service), m_cq(cq){}
+GrpcServer::Impl::ConnPool::ConnPool(hce_ai::ai_inference::AsyncService* service, grpc::ServerCompletionQueue* cq, std::size_t replyQueueDepth, unsigned shardId):m_ctr(0u), m_objPool(CONN_POOL_INIT_COUNT, 0),
+                m_service(service), m_cq(cq), m_replyQueueDepth(replyQueueDepth), m_shardId(shardId){}
 
 GrpcServer::Handle GrpcServer::Impl::ConnPool::create(){
     uint16_t key = m_ctr.fetch_add(1);
-    GrpcServer::Handle handle(m_objPool.construct(_GrpcCtx{m_service, m_cq}, key, this), [this](_CommHandle* ptr){ m_objPool.destroy(ptr);});
+    GrpcServer::Handle handle(m_objPool.construct(_GrpcCtx{m_service, m_cq, m_replyQueueDepth, m_shardId}, key, this), [this](_CommHandle* ptr){ m_objPool.destroy(ptr);});
     _TRC("Add connection with uid {} into the conn pool", key);
     m_connections.emplace(key, handle);
     return handle;
@@ -303,15 +376,22 @@ GrpcServer::Handle GrpcServer::Impl::ConnPool::get(void* tag){
 
 void GrpcServer::Impl::ConnPool::add(void* tag){
     uint16_t key = _AI_INF_CAST_VOIDP_TO_UID(tag);
-    GrpcServer::Handle handle(m_objPool.construct(_GrpcCtx{m_service, m_cq}, key, this), [this](_CommHandle* ptr){ m_objPool.destroy(ptr);});
+    GrpcServer::Handle handle(m_objPool.construct(_GrpcCtx{m_service, m_cq, m_replyQueueDepth, m_shardId}, key, this), [this](_CommHandle* ptr){ m_objPool.destroy(ptr);});
     _TRC("Add new connection with uid {} into the conn pool", key);
     m_connections.emplace(key, handle);
 }
 
 GrpcServer::_CommHandle::_CommHandle(const _GrpcCtx& grpcCtx, uint16_t uid, 
-        GrpcServer::Impl::ConnPool* poolCtx):m_grpcCtx(grpcCtx), m_responder(&m_ctx), m_state(StateDefault), m_uid(uid),
-        m_poolCtx(poolCtx), m_writeInProgress(false){
+        GrpcServer::Impl::ConnPool* poolCtx):m_uid(uid), m_grpcCtx(grpcCtx), m_droppedReplies(0u),
+        m_replyExhausted(false), m_backpressure(std::chrono::milliseconds(REPLY_QUEUE_MAX_WAIT_MS),
+        std::chrono::milliseconds(REPLY_QUEUE_WAIT_INTERVAL_MS)), m_replyPolicy(hce_ai::ReplyPolicy::LOSSLESS), m_coalesceReplies(false), m_replySeq(0u), m_writeIssuedAt(0u),
+        m_writeInProgress(false), m_responder(&m_ctx), m_state(StateDefault),
+        m_resultFormat(baseResponseNode::RESULT_FORMAT_JSON), m_poolCtx(poolCtx){
     _TRC("Connection handle with uid {} created", m_uid);
+    m_replyQueueGauge = LatencyTracer::getInstance().getGauge("grpc_reply_queue");
+    m_droppedRepliesGauge = LatencyTracer::getInstance().getGauge("grpc_dropped_replies");
+    m_coalescedRepliesGauge = LatencyTracer::getInstance().getGauge("grpc_coalesced_replies");
+    m_writeStage = LatencyTracer::getInstance().getStage("grpc_write");
     uint32_t temp = getTag(Request);
     m_grpcCtx.service->RequestRun(&m_ctx, &m_responder, m_grpcCtx.cq, m_grpcCtx.cq, reinterpret_cast<void*>(temp));
     m_ctx.AsyncNotifyWhenDone(reinterpret_cast<void*>(getTag(Done)));
@@ -319,6 +399,10 @@ GrpcServer::_CommHandle::_CommHandle(const _GrpcCtx& grpcCtx, uint16_t uid,
 
 GrpcServer::_CommHandle::~_CommHandle(){
     // _TRC("Connection handle with uid {} destroyed", m_uid);
+    // replies never sent, e.g. on a dropped connection, leave the gauge of all connections
+    if(!m_replyQueue.empty()){
+        LatencyTracer::getInstance().addGauge(m_replyQueueGauge, -(int64_t)m_replyQueue.size());
+    }
 }
 
 void GrpcServer::_CommHandle::mTypeDefault(void* tag) const {
@@ -349,6 +433,8 @@ void GrpcServer::_CommHandle::parseClientRequest() {
     std::vector<std::string> mediaUris;
     unsigned suggestedWeight = 0;
     unsigned streamNum = 1;
+    PipelineManager::Priority priority = PipelineManager::PRIORITY_NORMAL;
+    std::string clientId;
     std::string target = "run";
     try {
 
@@ -372,6 +458,34 @@ void GrpcServer::_CommHandle::parseClientRequest() {
             }
         }
 
+        if (m_request.has_resultformat() && m_request.resultformat() == hce_ai::ResultFormat::PROTOBUF) {
+            m_resultFormat = baseResponseNode::RESULT_FORMAT_TYPED;
+        }
+        else {
+            m_resultFormat = baseResponseNode::RESULT_FORMAT_JSON;
+        }
+
+        if (m_request.has_priority()) {
+            if (m_request.priority() == hce_ai::Priority::REALTIME) {
+                priority = PipelineManager::PRIORITY_REALTIME;
+            }
+            else if (m_request.priority() == hce_ai::Priority::BEST_EFFORT) {
+                priority = PipelineManager::PRIORITY_BEST_EFFORT;
+            }
+        }
+
+        if (m_request.has_clientid()) {
+            clientId = m_request.clientid();
+        }
+
+        if (m_request.has_replypolicy()) {
+            m_replyPolicy = m_request.replypolicy();
+        }
+
+        if (m_request.has_coalescereplies()) {
+            m_coalesceReplies = m_request.coalescereplies();
+        }
+
         // jobHandle or pipelineConfig: at least one should be provided
         if (m_request.has_jobhandle()) {
             jobHandle = m_request.jobhandle();
@@ -416,10 +530,15 @@ void GrpcServer::_CommHandle::parseClientRequest() {
     _TRC("  pipelineConfig: {}", pipelineConfig);
     _TRC("  suggestedWeight: {}", suggestedWeight);
     _TRC("  streamNum: {}", streamNum);
+    _TRC("  resultFormat: {}", m_resultFormat.load());
+    _TRC("  priority: {}", priority);
+    _TRC("  clientId: {}", clientId);
+    _TRC("  replyPolicy: {}", m_replyPolicy.load());
+    _TRC("  coalesceReplies: {}", m_coalesceReplies.load());
     _TRC("  mediaUris size: {}", mediaUris.size());
     if (target == "load_pipeline") {
         _TRC("[GRPC]: Connection uid {} client load pipeline request submited to pipeline manager", m_uid);
-        GrpcPipelineManager::getInstance().submitLoadPipeline(pipelineConfig, shared_from_this(), jobHandle, suggestedWeight, streamNum);
+        GrpcPipelineManager::getInstance().submitLoadPipeline(pipelineConfig, shared_from_this(), jobHandle, suggestedWeight, streamNum, priority, clientId);
     } else if (target == "unload_pipeline") {
         _TRC("[GRPC]: Connection uid {} client unload pipeline: {} request submited to pipeline manager", m_uid, jobHandle);
         GrpcPipelineManager::getInstance().submitUnloadPipeline(jobHandle, shared_from_this());
@@ -432,10 +551,10 @@ void GrpcServer::_CommHandle::parseClientRequest() {
         }
         if (pipelineConfig.empty()){
             _TRC("[GRPC]: Connection uid {} client run pipeline request submited to pipeline manager", m_uid);
-            GrpcPipelineManager::getInstance().submitRun(mediaUris, jobHandle, shared_from_this());
+            GrpcPipelineManager::getInstance().submitRun(mediaUris, jobHandle, shared_from_this(), priority, clientId);
         } else {
             _TRC("[GRPC]: Connection uid {} client auto run pipeline request submited to pipeline manager", m_uid);
-            GrpcPipelineManager::getInstance().submitAutoRun(mediaUris, pipelineConfig, shared_from_this(), suggestedWeight, streamNum);
+            GrpcPipelineManager::getInstance().submitAutoRun(mediaUris, pipelineConfig, shared_from_this(), suggestedWeight, streamNum, priority, clientId);
             _TRC("[GRPC]: Connection uid {} client auto run pipeline request submited to pipeline manager done!", m_uid);
         }
     } else {
@@ -496,31 +615,29 @@ void GrpcServer::_CommHandle::mTypeWrite(bool ok) {
         _TRC("Server write returned with uid {}", m_uid);
         if (m_state == InProgress) {
             std::lock_guard<std::mutex> lg(m_writeMutex);
+            LatencyTracer::getInstance().record(m_writeStage, m_grpcCtx.shardId, m_uid, m_writeIssuedAt, LatencyTracer::now());
             // for sanity: the reply messages must have been replied to the client, so that `m_writeInProgress == true` here.
             HVA_ASSERT(m_writeInProgress);
+            std::lock_guard<std::mutex> lk(m_replyQueueMutex);
             if (m_replyQueue.empty()) {
                 // reset m_writeInProgress, the server is ready for the next reply
                 m_writeInProgress = false;
             } else {
                 // still have cached rely in m_replyQueue, m_responder should trigger the Write process now
-                std::lock_guard<std::mutex> lk(m_replyQueueMutex);
-                const auto& toSend = m_replyQueue.front();
-                m_responder.Write(toSend, reinterpret_cast<void*>(getTag(Write)));
-                m_replyQueue.pop_front();
+                writeCachedReply();
             }
         } else if (m_state == ServerDone) {
             std::lock_guard<std::mutex> lg(m_writeMutex);
+            LatencyTracer::getInstance().record(m_writeStage, m_grpcCtx.shardId, m_uid, m_writeIssuedAt, LatencyTracer::now());
             // for sanity: the reply messages must have been replied to the client, so that `m_writeInProgress == true` here.
             HVA_ASSERT(m_writeInProgress);
+            std::lock_guard<std::mutex> lk(m_replyQueueMutex);
             if (m_replyQueue.empty()) {
                 _TRC("Connection with uid {} writes finish within ServerDone state", m_uid);
-                m_responder.Finish(grpc::Status::OK, reinterpret_cast<void*>(getTag(WriteFinish)));
+                m_responder.Finish(finishStatus(), reinterpret_cast<void*>(getTag(WriteFinish)));
             } else {
                 // still have cached rely in m_replyQueue, m_responder should trigger the Write process now
-                std::lock_guard<std::mutex> lk(m_replyQueueMutex);
-                const auto& toSend = m_replyQueue.front();
-                m_responder.Write(toSend, reinterpret_cast<void*>(getTag(Write)));
-                m_replyQueue.pop_front();
+                writeCachedReply();
             }
         } else {
             _ERR("Write received from cq in error state with uid {}. State is {}", m_uid, m_state);
@@ -546,8 +663,13 @@ void GrpcServer::_CommHandle::mTypeWriteFinish(void* tag, bool ok) {
         if (!m_replyQueue.empty()) {
             // still have cached rely in m_replyQueue, this is an invalid server state
             _ERR("[WriteFinish] The server is already at state {} while still have cached reply in queue!", m_state);
+            LatencyTracer::getInstance().addGauge(m_replyQueueGauge, -(int64_t)m_replyQueue.size());
             m_replyQueue.clear();
         }
+        if (m_droppedReplies > 0) {
+            _INF("Connection with uid {} dropped {} replies as the client fell behind", m_uid, m_droppedReplies);
+        }
+        m_replyQueueCv.notify_all();
         std::lock_guard<std::mutex> lg(m_writeMutex);
         // Ignore all cached replies in m_replyQueue, and reset m_writeInProgress, the server is ready for the next reply
         m_writeInProgress = false;
@@ -631,35 +753,181 @@ void GrpcServer::_CommHandle::proceed(void* tag, bool ok){
     }
 }
 
+baseResponseNode::ResultFormat_t GrpcServer::_CommHandle::getResultFormat() const{
+    return (baseResponseNode::ResultFormat_t)m_resultFormat.load();
+}
+
+/**
+ * @brief encode typed result of output nodes into protobuf message
+*/
+static void fillFrameResult(const baseResponseNode::Result& result, hce_ai::Frame_Result* msg){
+    msg->set_statuscode(result.statusCode);
+    msg->set_description(result.description);
+    msg->set_streamid(result.streamId);
+    msg->set_frameid(result.frameId);
+    msg->set_latency(result.latency);
+    msg->set_inferencelatency(result.inferenceLatency);
+    for(const auto& item: result.latencies){
+        (*msg->mutable_latencies())[item.first] = item.second;
+    }
+    msg->mutable_roiinfo()->Reserve(result.rois.size());
+    for(const auto& roi: result.rois){
+        hce_ai::ROI_Result* roiMsg = msg->add_roiinfo();
+        roiMsg->mutable_roi()->Add(roi.roi, roi.roi + 4);
+        roiMsg->set_roiclass(roi.roiClass);
+        roiMsg->set_roiscore(roi.roiScore);
+        roiMsg->set_trackid(roi.trackId);
+        roiMsg->set_trackstatus(roi.trackStatus);
+        if(!roi.featureVector.empty()){
+            roiMsg->set_featurevector(roi.featureVector);
+        }
+        for(const auto& attr: roi.attributes){
+            hce_ai::ROI_Attribute& attrMsg = (*roiMsg->mutable_attribute())[attr.first];
+            attrMsg.set_label(attr.second.label);
+            attrMsg.set_score(attr.second.score);
+        }
+        roiMsg->mutable_mediabirdviewroi()->Add(roi.mediaBirdviewRoi, roi.mediaBirdviewRoi + 4);
+        roiMsg->mutable_fusionroistate()->Add(roi.fusionRoiState, roi.fusionRoiState + 4);
+        roiMsg->mutable_fusionroisize()->Add(roi.fusionRoiSize, roi.fusionRoiSize + 2);
+        roiMsg->set_sensorsource(roi.sensorSource);
+    }
+    msg->mutable_pointclouds()->Reserve(result.pointClouds.size());
+    for(const auto& point: result.pointClouds){
+        hce_ai::Radar_Point* pointMsg = msg->add_pointclouds();
+        pointMsg->set_rangeidx(point.rangeIdx);
+        pointMsg->set_range(point.range);
+        pointMsg->set_speedidx(point.speedIdx);
+        pointMsg->set_speed(point.speed);
+        pointMsg->set_snr(point.snr);
+        pointMsg->set_aoavar(point.aoaVar);
+    }
+    msg->mutable_clusters()->Reserve(result.clusters.size());
+    for(const auto& cluster: result.clusters){
+        hce_ai::Radar_Cluster* clusterMsg = msg->add_clusters();
+        clusterMsg->set_numpoints(cluster.numPoints);
+        clusterMsg->mutable_center()->Add(cluster.center, cluster.center + 2);
+        clusterMsg->mutable_size()->Add(cluster.size, cluster.size + 2);
+        clusterMsg->set_avgvel(cluster.avgVel);
+        clusterMsg->set_centerrangevar(cluster.centerRangeVar);
+        clusterMsg->set_centeranglevar(cluster.centerAngleVar);
+        clusterMsg->set_centerdopplervar(cluster.centerDopplerVar);
+    }
+    msg->mutable_tracks()->Reserve(result.tracks.size());
+    for(const auto& track: result.tracks){
+        hce_ai::Radar_Track* trackMsg = msg->add_tracks();
+        trackMsg->set_trackid(track.trackId);
+        trackMsg->set_state(track.state);
+        trackMsg->mutable_trackstate()->Add(track.trackState, track.trackState + 4);
+        trackMsg->mutable_size()->Add(track.size, track.size + 2);
+    }
+}
+
+hce_ai::AI_Response GrpcServer::_CommHandle::makeReplyMessage(const baseResponseNode::Response& reply){
+    hce_ai::AI_Response res;
+    res.set_status(hce_ai::AI_Response_Status(reply.status));
+    // serialized here on first use if the output node shares a lazy json message
+    const std::string& message = reply.getMessage();
+    if(m_coalesceReplies){
+        hce_ai::Stream_Response& sr = (*res.mutable_responses())[std::to_string(m_replySeq.fetch_add(1))];
+        sr.set_jsonmessages(message);
+        if(reply.result){
+            hce_ai::Frame_Result result;
+            fillFrameResult(*reply.result, &result);
+            sr.set_binary(result.SerializeAsString());
+        }
+    }
+    else{
+        if(!message.empty()){
+            res.set_message(message);
+        }
+        if(reply.result){
+            fillFrameResult(*reply.result, res.mutable_result());
+        }
+    }
+    for(const auto& pair: reply.responses){
+        hce_ai::Stream_Response sr;
+        sr.set_jsonmessages(pair.second.stringData);
+        if(!pair.second.binaryData.empty()){
+            // sr.set_binary(pair.second.binaryData.get(), pair.second.length);
+            sr.set_binary(pair.second.binaryData.c_str(), pair.second.length);
+        }
+        (*res.mutable_responses())[pair.first] = sr;
+    }
+    return res;
+}
+
+void GrpcServer::_CommHandle::cacheReply(hce_ai::AI_Response&& res){
+    std::lock_guard<std::mutex> lk(m_replyQueueMutex);
+    if(m_coalesceReplies && !m_replyQueue.empty()){
+        hce_ai::AI_Response& last = m_replyQueue.back();
+        if(last.status() == res.status() && last.responses_size() + res.responses_size() <= REPLY_COALESCE_MAX_COUNT){
+            // the last cached message has not been sent yet, merge into it
+            for(auto& pair: *res.mutable_responses()){
+                (*last.mutable_responses())[pair.first].Swap(&pair.second);
+            }
+            LatencyTracer::getInstance().addGauge(m_coalescedRepliesGauge, 1);
+            return;
+        }
+    }
+
+    if(m_grpcCtx.replyQueueDepth > 0 && m_replyQueue.size() >= m_grpcCtx.replyQueueDepth &&
+            m_replyPolicy == hce_ai::ReplyPolicy::LATEST_WINS){
+        // client falls behind, the eldest replies are outdated
+        m_replyQueue.pop_front();
+        ++m_droppedReplies;
+        LatencyTracer::getInstance().addGauge(m_droppedRepliesGauge, 1);
+        LatencyTracer::getInstance().addGauge(m_replyQueueGauge, -1);
+    }
+    _TRC("Connection with uid {} cached reply with status {}", m_uid, res.status());
+    m_replyQueue.push_back(std::move(res));
+    LatencyTracer::getInstance().addGauge(m_replyQueueGauge, 1);
+}
+
+void GrpcServer::_CommHandle::writeCachedReply(){
+    const auto& toSend = m_replyQueue.front();
+    m_writeIssuedAt = LatencyTracer::now();
+    m_responder.Write(toSend, reinterpret_cast<void*>(getTag(Write)));
+    m_replyQueue.pop_front();
+    LatencyTracer::getInstance().addGauge(m_replyQueueGauge, -1);
+    m_replyQueueCv.notify_all();
+}
+
 hceAiStatus_t GrpcServer::_CommHandle::write(const baseResponseNode::Response& reply){
     if(m_state == InProgress){
-        hce_ai::AI_Response res;
-        res.set_status(hce_ai::AI_Response_Status(reply.status));
-        if(!reply.message.empty()){
-            res.set_message(reply.message);
-        }
-        for(const auto& pair: reply.responses){
-            hce_ai::Stream_Response sr;
-            sr.set_jsonmessages(pair.second.stringData);
-            if(!pair.second.binaryData.empty()){
-                // sr.set_binary(pair.second.binaryData.get(), pair.second.length);
-                sr.set_binary(pair.second.binaryData.c_str(), pair.second.length);
+        if(m_grpcCtx.replyQueueDepth > 0 && m_replyPolicy == hce_ai::ReplyPolicy::LOSSLESS){
+            // lossless client falls behind, hold the producer until the queue drains, for REPLY_QUEUE_MAX_WAIT_MS at most.
+            // the bound is soft as concurrent producers may pass at the same time
+            ReplyBackpressure::Result_t ret;
+            {
+                std::unique_lock<std::mutex> lk(m_replyQueueMutex);
+                ret = m_backpressure.wait(lk, m_replyQueueCv,
+                        [this](){ return m_replyQueue.size() >= m_grpcCtx.replyQueueDepth; },
+                        [this](){ return m_state == InProgress; });
+            }
+            if(ret == ReplyBackpressure::REPLY_EXHAUSTED){
+                writeExhausted();
+                return hceAiServiceNotReady;
             }
-            (*res.mutable_responses())[pair.first] = sr;
         }
 
+        hce_ai::AI_Response res = makeReplyMessage(reply);
+
         std::lock_guard<std::mutex> lg(m_writeMutex);
+        if(m_state != InProgress){
+            // the stream is ended while the reply was held, e.g. for a stalled lossless client
+            _TRC("Connection with uid {} skipped reply with status {} at state {}", m_uid, res.status(), m_state);
+            return hceAiServiceNotReady;
+        }
         if(!m_writeInProgress){
             _TRC("Connection with uid {} make reply with status {}", m_uid, res.status());
             // Sever can reply messages to client immediately
+            m_writeIssuedAt = LatencyTracer::now();
             m_responder.Write(res, reinterpret_cast<void*>(getTag(Write)));
             m_writeInProgress = true;
         }
         else{
             // indicating a write has been fired but haven't been received from cq, so we cache the new reply in m_replyQueue
-            std::lock_guard<std::mutex> lk(m_replyQueueMutex);
-            _TRC("Connection with uid {} cached reply with status {}", m_uid, res.status());
-            m_replyQueue.push_back(res);
+            cacheReply(std::move(res));
         }
         return hceAiSuccess;
     }
@@ -668,6 +936,10 @@ hceAiStatus_t GrpcServer::_CommHandle::write(const baseResponseNode::Response& r
         // to-do: possibly to stop the running pipeline to save resource
         return hceAiServiceNotReady;
     }
+    else if(m_replyExhausted){
+        _TRC("Connection with uid {} skipped reply with status {} as the stream is ended", m_uid, reply.status);
+        return hceAiServiceNotReady;
+    }
     else{
         _ERR("Connection with uid {} tried to make reply status {} at wrong state {}", m_uid, reply.status, m_state);
         return hceAiFailure;
@@ -682,7 +954,7 @@ hceAiStatus_t GrpcServer::_CommHandle::writeFinish(){
             _TRC("Connection with uid {} writes finish", m_uid);
             m_state = ServerDone;
             // server reply to the client immediately
-            m_responder.Finish(grpc::Status::OK, reinterpret_cast<void*>(getTag(WriteFinish)));
+            m_responder.Finish(finishStatus(), reinterpret_cast<void*>(getTag(WriteFinish)));
             _TRC("Connection with uid {} done writing finish", m_uid);
         }
         else{
@@ -694,6 +966,10 @@ hceAiStatus_t GrpcServer::_CommHandle::writeFinish(){
         _WRN("Connection with uid {} failed to write finish due to connection dropped", m_uid);
         return hceAiServiceNotReady;
     }
+    else if(m_replyExhausted){
+        _TRC("Connection with uid {} skipped finish as the stream is ended", m_uid);
+        return hceAiSuccess;
+    }
     else{
         _ERR("Connection with uid {} tried to write finish at wrong state {}", m_uid, m_state);
         return hceAiFailure;
@@ -702,6 +978,34 @@ hceAiStatus_t GrpcServer::_CommHandle::writeFinish(){
     return hceAiSuccess;
 }
 
+void GrpcServer::_CommHandle::writeExhausted(){
+    std::lock_guard<std::mutex> lg(m_writeMutex);
+    if(m_state != InProgress){
+        return;
+    }
+    _WRN("Connection with uid {} ends the stream with RESOURCE_EXHAUSTED as the lossless client stalled for {} ms",
+            m_uid, REPLY_QUEUE_MAX_WAIT_MS);
+    m_replyExhausted = true;
+    m_state = ServerDone;
+    {
+        // wake up the other producers held on the queue
+        std::lock_guard<std::mutex> lk(m_replyQueueMutex);
+        m_replyQueueCv.notify_all();
+    }
+    if(!m_writeInProgress){
+        m_writeInProgress = true;
+        m_responder.Finish(finishStatus(), reinterpret_cast<void*>(getTag(WriteFinish)));
+    }
+    // otherwise the status is sent once the queued replies are written, see mTypeWrite()
+}
+
+grpc::Status GrpcServer::_CommHandle::finishStatus() const{
+    if(m_replyExhausted){
+        return grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED, "Client fell behind on a lossless reply stream");
+    }
+    return grpc::Status::OK;
+}
+
 bool GrpcServer::_CommHandle::isActive() const{
     return m_state==InProgress;
 }
@@ -729,6 +1033,7 @@ hceAiStatus_t GrpcServer::Impl::init(const CommConfig& config){
         return hceAiFailure;
     }
     m_config = config;
+    HVA_ASSERT(m_config.threadPoolSize > 0);
 
     HVA_ASSERT(!m_config.serverAddr.empty());
     std::string server_address(m_config.serverAddr);
@@ -741,20 +1046,24 @@ hceAiStatus_t GrpcServer::Impl::init(const CommConfig& config){
     builder.RegisterService(&m_service);
     builder.SetMaxReceiveMessageSize(INT_MAX);
     // builder.SetMaxReceiveMessageSize(-1);
-    // Get hold of the completion queue used for the asynchronous communication
-    // with the gRPC runtime.
-    m_cq = builder.AddCompletionQueue();
+    // Get hold of the completion queues used for the asynchronous communication
+    // with the gRPC runtime, one for each polling thread
+    m_shards.resize(m_config.threadPoolSize);
+    for(auto& shard: m_shards){
+        shard.cq = builder.AddCompletionQueue();
+    }
     // Finally assemble the server.
     m_server = builder.BuildAndStart();
     _INF("Server set to listen on {}", server_address);
-    m_connPool = std::unique_ptr<ConnPool>(new ConnPool(&m_service, m_cq.get()));
+    for(unsigned i = 0; i < m_shards.size(); ++i){
+        m_shards[i].connPool = std::unique_ptr<ConnPool>(new ConnPool(&m_service, m_shards[i].cq.get(), m_config.replyQueueDepth, i));
+    }
+    _INF("Server reply queue depth per connection sets to {}", m_config.replyQueueDepth);
     m_state = Initialized;
     return hceAiSuccess;
 }
 
 hceAiStatus_t GrpcServer::Impl::start(){
-    HVA_ASSERT(m_config.threadPoolSize > 0);
-    
     if(m_state != Initialized){
         _ERR("Comm Manager is not in correct state during init!");
         return hceAiFailure;
@@ -763,28 +1072,30 @@ hceAiStatus_t GrpcServer::Impl::start(){
     m_state = Running;
     m_threads.reserve(m_config.threadPoolSize);
     for(unsigned i = 0; i < m_config.threadPoolSize; ++i){
-        m_threads.emplace_back(&GrpcServer::Impl::workload, this);
+        m_threads.emplace_back(&GrpcServer::Impl::workload, this, i);
     }
-    _INF("Server starts {} listener. Listening starts", m_config.threadPoolSize);
+    _INF("Server starts {} listener, each on its own completion queue. Listening starts", m_config.threadPoolSize);
 
     return hceAiSuccess;
 }
 
-void GrpcServer::Impl::workload(){
+void GrpcServer::Impl::workload(unsigned shardId){
     HVA_ASSERT(m_state == Running);
-    
-    m_connPool->create();
+
+    grpc::ServerCompletionQueue* cq = m_shards[shardId].cq.get();
+    ConnPool* connPool = m_shards[shardId].connPool.get();
+    connPool->create();
 
     void* tag;
     bool ok;
     while(m_state == Running){
-        if(!m_cq->Next(&tag, &ok)){
+        if(!cq->Next(&tag, &ok)){
             _DBG("Completion queue shuts down");
             // to-do: destruct the conn pool
             break;
         }
 
-        GrpcServer::Handle handle = m_connPool->get(tag);
+        GrpcServer::Handle handle = connPool->get(tag);
         if(handle){
             handle->proceed(tag, ok);
         }
@@ -825,8 +1136,9 @@ void GrpcServer::Impl::stop(){
     for(auto& item: m_threads){
         item.join();
     }
-    m_cq->Shutdown();
-
+    for(auto& shard: m_shards){
+        shard.cq->Shutdown();
+    }
 
     m_state = Stopped;
 }
@@ -864,6 +1176,10 @@ hceAiStatus_t GrpcServer::replyFinish(Handle handle){
     return m_impl->replyFinish(handle);
 }
 
+baseResponseNode::ResultFormat_t GrpcServer::getResultFormat(Handle handle){
+    return handle ? handle->getResultFormat() : baseResponseNode::RESULT_FORMAT_JSON;
+}
+
 }
 
 }
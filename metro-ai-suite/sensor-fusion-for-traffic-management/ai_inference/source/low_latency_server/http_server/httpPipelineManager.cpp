@@ -98,6 +98,7 @@ void HttpPipelineManager::watch(){
         if(iter->second->heartbeat <= heartbeatThresh){
             _TRC("Pipeline with handle {} exceeds max pipeline lifetime ({}s). stopping", iter->second->jobHandle, m_maxPipelineLifetime);
             iter->second->pipeline->stop();
+            unregisterTracedNodes(iter->second->jobHandle);
             // to-do: if we need a wait here?
             releaseResourceByWorkloadWeight(iter->second->suggestedWeight);
             iter = m_workList.erase(iter);
@@ -261,6 +262,7 @@ hceAiStatus_t HttpPipelineManager::loop(){
                 }
                 else{
                     item->second->pipeline->stop();
+                    unregisterTracedNodes(ptr->jobHandle);
                     // to-do: if we need a wait here?
                     m_workList.erase(ptr->jobHandle);
                     replyUnloadPipeline(ptr->commHandle, 200, "Success", ptr->jobHandle);
@@ -444,9 +446,7 @@ hceAiStatus_t HttpPipelineManager::submitLoadPipeline(
     suggestedWeight = suggestedWeight == 0 ? 1 : suggestedWeight;
 
     {
-        LoadTaskInfo::Ptr pendingTask = std::shared_ptr<LoadTaskInfo>(
-            m_ltiPool.construct(),
-            [this](LoadTaskInfo* ptr) { m_ltiPool.destroy(ptr); });
+        LoadTaskInfo::Ptr pendingTask = makeTask(m_ltiPool);
         HCE_AI_ASSERT(pendingTask);
         pendingTask->taskType = Task::TASK_LOAD;
         pendingTask->commHandle = commHandle;
@@ -476,9 +476,7 @@ hceAiStatus_t HttpPipelineManager::submitRun(
     HCE_AI_ASSERT(mediaUris.size() != 0);
 
     {
-        RunTaskInfo::Ptr pendingTask = std::shared_ptr<RunTaskInfo>(
-            m_rtiPool.construct(),
-            [this](RunTaskInfo* ptr) { m_rtiPool.destroy(ptr); });
+        RunTaskInfo::Ptr pendingTask = makeTask(m_rtiPool);
         HCE_AI_ASSERT(pendingTask);
         pendingTask->taskType = Task::TASK_RUN;
         pendingTask->commHandle = commHandle;
@@ -514,9 +512,7 @@ hceAiStatus_t HttpPipelineManager::submitAutoRun(
     suggestedWeight = suggestedWeight == 0 ? 1 : suggestedWeight;
 
     {
-        AutoRunTaskInfo::Ptr pendingTask = std::shared_ptr<AutoRunTaskInfo>(
-            m_artiPool.construct(),
-            [this](AutoRunTaskInfo* ptr) { m_artiPool.destroy(ptr); });
+        AutoRunTaskInfo::Ptr pendingTask = makeTask(m_artiPool);
         HCE_AI_ASSERT(pendingTask);
         pendingTask->taskType = Task::TASK_AUTO_RUN;
         pendingTask->commHandle = commHandle;
@@ -540,8 +536,7 @@ hceAiStatus_t HttpPipelineManager::submitAutoRun(
 */
 hceAiStatus_t HttpPipelineManager::submitUnloadPipeline(Handle jobHandle, HttpServerLowLatency::ClientDes commHandle){
     {
-        UnloadTaskInfo::Ptr pendingTask = std::shared_ptr<UnloadTaskInfo>(m_utiPool.construct(), 
-                [this](UnloadTaskInfo* ptr){ m_utiPool.destroy(ptr);});
+        UnloadTaskInfo::Ptr pendingTask = makeTask(m_utiPool);
         HCE_AI_ASSERT(pendingTask);
         pendingTask->taskType = Task::TASK_UNLOAD;
         pendingTask->commHandle = commHandle;
@@ -573,6 +568,8 @@ HttpPipelineManager::hvaPipelinePtr HttpPipelineManager::run(PipelineInfo::Ptr p
         return hvaPipelinePtr();
     }
 
+    registerTracedNodes(*pl, pipelionConfig, plInfo->jobHandle);
+
     std::shared_ptr<_restReplyListener> listener(m_rrlPool.construct(plInfo), 
             [this](_restReplyListener* ptr){m_rrlPool.destroy(ptr);});
 
@@ -26,10 +26,20 @@
 #include <mutex>
 #include <unordered_map>
 #include <list>
+#include <vector>
+#include <memory>
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <streambuf>
+#include <istream>
 
 #include "common/logger.hpp"
+#include "common/latency_tracer.hpp"
 #include "low_latency_server/http_server/lowLatencyServer.hpp"
 #include "low_latency_server/http_server/httpPipelineManager.hpp"
+#include "low_latency_server/resultCache.hpp"
 
 #define DEFAULT_SOCKET_QUEUE_SIZE 128
 
@@ -42,6 +52,8 @@
 #define INPUT_FEATURE_CHUNK_SIZE sizeof(int8_t)
 #define INPUT_FEATURE_CHUNK_COUNT 512*64*4 // 512-long feature x say, 64 features per req x say 4 requests at a time
 #define CLIENT_DES_CHUNK_COUNT 32
+#define CONN_CONTEXT_CHUNK_COUNT 128
+#define BODY_ARENA_RETAINED_CHUNK_COUNT 16 // body arena larger than this (in incoming message chunks) is released after each request
 
 
 namespace hce{
@@ -50,104 +62,252 @@ namespace ai{
 
 namespace inference{
 
-struct HttpServerLowLatency::_ClientDes{
-    uv_tcp_t* conn;
-};
-
 class HttpServerLowLatency::Impl{
 public:
+    class _EventLoop;
+
     Impl();
 
     ~Impl();
 
-    hceAiStatus_t init(const std::string& address, unsigned port);
+    hceAiStatus_t init(const std::string& address, unsigned port, std::size_t maxBodySize, unsigned loopCount);
 
     hceAiStatus_t run();
 
     void stop();
 
-    hceAiStatus_t reply(ClientDes client, unsigned code, const std::string& reply);
+    hceAiStatus_t reply(ClientDes client, unsigned code, const std::string& reply, bool cacheable);
 
-private:
-    hceAiStatus_t workload();
+    bool healthCheck();
 
+private:
     inline bool validateIP(const std::string& addr) const{
         struct sockaddr_in sa;
         return 0 != inet_pton(AF_INET, addr.c_str(), &(sa.sin_addr));
     };
 
-    class _ConnRegistry{
-    public:
-        _ConnRegistry(){ };
+    // event loops, each accepting and serving its own connections on its own thread
+    std::vector<std::unique_ptr<_EventLoop>> m_loops;
 
-        ~_ConnRegistry(){ };
+    std::atomic<uint64_t> m_watchdogVal;
+};
 
-        void registerConn(uv_tcp_t* conn){
-            _TRC("[HTTP]: registering a conn with addr {}", (void*)conn);
-            std::lock_guard<std::mutex> lg(m_mutex);
-            m_opennedConn[conn] = std::string();
-        }
+struct HttpServerLowLatency::_ClientDes{
+    uv_tcp_t* conn;
+    Impl::_EventLoop* loop;     // the event loop owning conn, replies are written from there
+    bool cacheable;             // a successful reply is stored in ResultCache under cacheKey
+    ResultCache::Key cacheKey;
+    std::vector<std::string> cacheContentFiles;     // local files of the request verified by content, see ResultCache
+};
 
-        void unregisterConn(uv_tcp_t* conn){
-            _TRC("[HTTP]: unregistering a conn with addr {}", (void*)conn);
-            std::lock_guard<std::mutex> lg(m_mutex);
-            m_opennedConn.erase(conn);
-        }
+/**
+ * @brief one libuv loop of the http server. With more than one loop, every loop binds its own
+ * listener on the same address with SO_REUSEPORT and the kernel spreads incoming connections
+ * across them, a connection is then served by a single loop for its whole lifetime
+*/
+class HttpServerLowLatency::Impl::_EventLoop{
+public:
+    _EventLoop(Impl* server, unsigned index);
 
-        bool exist(uv_tcp_t* conn){
-            _TRC("[HTTP]: checking a conn with addr {}", (void*)conn);
-            std::lock_guard<std::mutex> lg(m_mutex);
-            return m_opennedConn.find(conn) != m_opennedConn.end();
-        }
+    ~_EventLoop();
 
-        bool appendMsg(uv_tcp_t* conn, const std::string& msg){
-            std::lock_guard<std::mutex> lg(m_mutex);
-            if(m_opennedConn.find(conn) == m_opennedConn.end()){
+    hceAiStatus_t init(const std::string& address, unsigned port, std::size_t maxBodySize, bool reusePort);
+
+    hceAiStatus_t run();
+
+    void stop();
+
+    hceAiStatus_t reply(ClientDes client, unsigned code, const std::string& reply);
+
+private:
+    hceAiStatus_t workload();
+
+    hceAiStatus_t bindListener();
+
+    // growable buffer holding the body of the request being parsed on a connection,
+    // backed by contiguous chunks of the incoming message pool and reused across requests
+    class _BodyArena{
+    public:
+        _BodyArena(boost::pool<boost::default_user_allocator_new_delete>& pool):m_pool(pool), m_data(nullptr), m_chunkCount(0), m_size(0){ };
+
+        ~_BodyArena(){ release(); };
+
+        _BodyArena(const _BodyArena&) = delete;
+
+        _BodyArena& operator=(const _BodyArena&) = delete;
+
+        bool reserve(std::size_t size){
+            if(size <= m_chunkCount * INCOMING_MESSAGE_CHUNK_SIZE){
+                return true;
+            }
+            // grow geometrically so that bodies without content-length are still copied O(n)
+            std::size_t chunkCount = std::max((size + INCOMING_MESSAGE_CHUNK_SIZE - 1) / INCOMING_MESSAGE_CHUNK_SIZE, m_chunkCount * 2);
+            char* data = reinterpret_cast<char*>(m_pool.ordered_malloc(chunkCount));
+            if(!data){
                 return false;
             }
-            std::string prevMsg = m_opennedConn[conn];
-            m_opennedConn[conn] = prevMsg + msg;
+            if(m_size > 0){
+                memcpy(data, m_data, m_size);
+            }
+            if(m_data){
+                m_pool.ordered_free(m_data, m_chunkCount);
+            }
+            m_data = data;
+            m_chunkCount = chunkCount;
+            _TRC("[HTTP]: Body arena grown to {} chunks", m_chunkCount);
             return true;
         };
 
-        bool replaceMsg(uv_tcp_t* conn, const std::string& msg){
-            std::lock_guard<std::mutex> lg(m_mutex);
-            if(m_opennedConn.find(conn) == m_opennedConn.end()){
+        bool append(const char* data, std::size_t size){
+            if(!reserve(m_size + size)){
                 return false;
             }
-            m_opennedConn[conn] = msg;
+            memcpy(m_data + m_size, data, size);
+            m_size += size;
             return true;
         };
 
-        bool deleteMsg(uv_tcp_t* conn){
-            std::lock_guard<std::mutex> lg(m_mutex);
-            if(m_opennedConn.find(conn) == m_opennedConn.end()){
-                return false;
+        void clear(){
+            m_size = 0;
+            // do not let a keep-alive connection hold a large upload buffer after use
+            if(m_chunkCount > BODY_ARENA_RETAINED_CHUNK_COUNT){
+                release();
             }
-            m_opennedConn[conn].clear();
-            return true;
         };
 
-        std::string getMsg(uv_tcp_t* conn){
-            std::lock_guard<std::mutex> lg(m_mutex);
-            if(m_opennedConn.find(conn) == m_opennedConn.end()){
-                return std::string();
+        void release(){
+            if(m_data){
+                m_pool.ordered_free(m_data, m_chunkCount);
             }
-            return m_opennedConn[conn];
+            m_data = nullptr;
+            m_chunkCount = 0;
+            m_size = 0;
+        };
+
+        const char* data() const{
+            return m_data;
+        };
+
+        std::size_t size() const{
+            return m_size;
+        };
+
+    private:
+        boost::pool<boost::default_user_allocator_new_delete>& m_pool;
+        char* m_data;
+        std::size_t m_chunkCount;
+        std::size_t m_size;
+    };
+
+    // beast body type storing the request body straight into the connection's body arena
+    struct _ArenaBody{
+        using value_type = _BodyArena*;
+
+        static std::uint64_t size(const value_type& body){
+            return body->size();
+        }
+
+        class reader{
+        public:
+            template<bool isRequest, class Fields>
+            reader(boost::beast::http::header<isRequest, Fields>&, value_type& body):m_body(body){ };
+
+            void init(const boost::optional<std::uint64_t>& contentLength, boost::beast::error_code& ec){
+                m_body->clear();
+                if(contentLength && !m_body->reserve(*contentLength)){
+                    ec = boost::beast::http::error::buffer_overflow;
+                    return;
+                }
+                ec = {};
+            };
+
+            template<class ConstBufferSequence>
+            std::size_t put(const ConstBufferSequence& buffers, boost::beast::error_code& ec){
+                std::size_t bytes = 0;
+                for(auto iter = boost::asio::buffer_sequence_begin(buffers); iter != boost::asio::buffer_sequence_end(buffers); ++iter){
+                    boost::asio::const_buffer buffer = *iter;
+                    if(!m_body->append(reinterpret_cast<const char*>(buffer.data()), buffer.size())){
+                        ec = boost::beast::http::error::buffer_overflow;
+                        return bytes;
+                    }
+                    bytes += buffer.size();
+                }
+                ec = {};
+                return bytes;
+            };
+
+            void finish(boost::beast::error_code& ec){
+                ec = {};
+            };
+
+        private:
+            value_type& m_body;
+        };
+    };
+
+    using _Request = boost::beast::http::request<_ArenaBody>;
+
+    // read-only stream over a body arena, lets json parsing run without copying the body
+    class _ArenaStreamBuf : public std::streambuf{
+    public:
+        _ArenaStreamBuf(const _BodyArena& arena){
+            char* begin = const_cast<char*>(arena.data());
+            setg(begin, begin, begin + arena.size());
         };
+    };
+
+    // per-connection parsing state, only touched by the uv loop thread
+    struct _ConnContext{
+        _ConnContext(boost::pool<boost::default_user_allocator_new_delete>& pool):arena(pool){ };
+
+        boost::optional<boost::beast::http::request_parser<_ArenaBody>> parser;    // parser of the request in progress, kept across reads
+        std::string pending;    // bytes not yet consumed by the parser, i.e. a partial start line, header or chunk size
+        _BodyArena arena;
+    };
+
+    class _ConnRegistry{
+    public:
+        _ConnRegistry(){ };
+
+        ~_ConnRegistry(){ };
+
+        void registerConn(uv_tcp_t* conn, _ConnContext* context){
+            _TRC("[HTTP]: registering a conn with addr {}", (void*)conn);
+            std::lock_guard<std::mutex> lg(m_mutex);
+            m_opennedConn[conn] = context;
+        }
 
-        bool hasMsg(uv_tcp_t* conn){
+        _ConnContext* unregisterConn(uv_tcp_t* conn){
+            _TRC("[HTTP]: unregistering a conn with addr {}", (void*)conn);
             std::lock_guard<std::mutex> lg(m_mutex);
-            if(m_opennedConn.find(conn) == m_opennedConn.end()){
-                return false;
+            auto iter = m_opennedConn.find(conn);
+            if(iter == m_opennedConn.end()){
+                return nullptr;
             }
-            return !m_opennedConn[conn].empty();
+            _ConnContext* context = iter->second;
+            m_opennedConn.erase(iter);
+            return context;
+        }
+
+        bool exist(uv_tcp_t* conn){
+            _TRC("[HTTP]: checking a conn with addr {}", (void*)conn);
+            std::lock_guard<std::mutex> lg(m_mutex);
+            return m_opennedConn.find(conn) != m_opennedConn.end();
+        }
+
+        _ConnContext* getContext(uv_tcp_t* conn){
+            std::lock_guard<std::mutex> lg(m_mutex);
+            auto iter = m_opennedConn.find(conn);
+            if(iter == m_opennedConn.end()){
+                return nullptr;
+            }
+            return iter->second;
         };
 
     private:
         std::mutex m_mutex;
-        std::unordered_map<uv_tcp_t*, std::string, std::hash<uv_tcp_t*>, std::equal_to<uv_tcp_t*>,
-                boost::fast_pool_allocator<std::pair<uv_tcp_t*, std::string>>> m_opennedConn; 
+        std::unordered_map<uv_tcp_t*, _ConnContext*, std::hash<uv_tcp_t*>, std::equal_to<uv_tcp_t*>,
+                boost::fast_pool_allocator<std::pair<uv_tcp_t* const, _ConnContext*>>> m_opennedConn; 
     };
 
     // server state
@@ -168,7 +328,7 @@ private:
 
     #define _HCE_AI_LL_HTTP_SERVER_CALLBACK_WRAPPER_DEF(func,signature,args...) \
         static void _HCE_AI_LL_HTTP_SERVER_CALLBACK_WRAPPER_NAME(func)signature { \
-            Impl* thisPtr = reinterpret_cast<Impl*>(handle->data); \
+            _EventLoop* thisPtr = reinterpret_cast<_EventLoop*>(handle->data); \
             thisPtr->func(args);\
         }
 
@@ -194,11 +354,19 @@ private:
     void onReplyComplete(uv_write_t* req, int status);
     _HCE_AI_LL_HTTP_SERVER_CALLBACK_WRAPPER_DEF(onReplyComplete, (uv_write_t* handle, int status), handle, status);
 
-    inline void makeBadReqReply(uv_stream_t* client){
+    void onShutdown(uv_shutdown_t* req, int status);
+    _HCE_AI_LL_HTTP_SERVER_CALLBACK_WRAPPER_DEF(onShutdown, (uv_shutdown_t* handle, int status), handle, status);
+
+    /**
+     * @param closeConn reply with `Connection: close` and close the connection once the reply is sent, for requests
+     * the parser failed on, after which the rest of the bytes on the connection can not be framed
+    */
+    inline void makeBadReqReply(uv_stream_t* client, bool closeConn = false){
         std::stringstream ss;
         boost::beast::http::response<boost::beast::http::empty_body> res{boost::beast::http::status::bad_request, 11};
         // res.set(boost::beast::http::field::server, 001);
         res.set(boost::beast::http::field::content_type, "text/html");
+        res.keep_alive(!closeConn);
         res.prepare_payload();
         ss << res;
 
@@ -215,6 +383,28 @@ private:
         req->buf = uv_buf_init(reply, size);
         uv_write((uv_write_t*) req, client, &req->buf, 1, _HCE_AI_LL_HTTP_SERVER_CALLBACK_WRAPPER_NAME(onReplyComplete));
         _TRC("[HTTP]: Reply string wrote to uv loop");
+
+        if(closeConn){
+            closeAfterReply(client);
+        }
+    };
+
+    /**
+     * @brief stop reading from the connection and close it once the replies written so far are sent
+    */
+    inline void closeAfterReply(uv_stream_t* client){
+        uv_read_stop(client);
+        uv_shutdown_t* req = m_shutdownReqPool.malloc();
+        HCE_AI_ASSERT(req);
+        req->data = reinterpret_cast<void*>(this);
+        int ret = uv_shutdown(req, client, _HCE_AI_LL_HTTP_SERVER_CALLBACK_WRAPPER_NAME(onShutdown));
+        if(ret){
+            _ERR("[HTTP]: Failed to shutdown connection: {}", uv_strerror(ret));
+            m_shutdownReqPool.free(req);
+            if(!uv_is_closing((uv_handle_t*) client)){
+                uv_close((uv_handle_t*) client, _HCE_AI_LL_HTTP_SERVER_CALLBACK_WRAPPER_NAME(onConnectionClose));
+            }
+        }
     };
 
     inline void makeOkReply(uv_stream_t* client){
@@ -255,9 +445,56 @@ private:
         uv_write((uv_write_t*) req, client, &req->buf, 1, _HCE_AI_LL_HTTP_SERVER_CALLBACK_WRAPPER_NAME(onReplyComplete));
     };
 
-    bool healthCheck();
+    inline void makeMethodNotAllowedReply(uv_stream_t* client, const char* allow){
+        std::stringstream ss;
+        boost::beast::http::response<boost::beast::http::empty_body> res{boost::beast::http::status::method_not_allowed, 11};
+        res.set(boost::beast::http::field::allow, allow);
+        res.prepare_payload();
+        ss << res;
+
+        std::string replyString = ss.str();
+
+        write_req_t *req = m_writeReqPool.malloc();
+        HCE_AI_ASSERT(req);
+        req->req.data = reinterpret_cast<void*>(this);
+
+        unsigned size = replyString.size();
+        char* reply = reinterpret_cast<char*>(m_replyMsgPool.ordered_malloc(replyString.size()));
+        HCE_AI_ASSERT(reply);
+        replyString.copy(reply, size);
+        req->buf = uv_buf_init(reply, size);
+        uv_write((uv_write_t*) req, client, &req->buf, 1, _HCE_AI_LL_HTTP_SERVER_CALLBACK_WRAPPER_NAME(onReplyComplete));
+    };
+
+    inline void makeJsonReply(uv_stream_t* client, const std::string& body){
+        std::stringstream ss;
+        boost::beast::http::response<boost::beast::http::string_body> res{boost::beast::http::status::ok, 11};
+        res.set(boost::beast::http::field::content_type, "application/json");
+        res.body() = body;
+        res.prepare_payload();
+        ss << res;
+
+        std::string replyString = ss.str();
+
+        write_req_t *req = m_writeReqPool.malloc();
+        HCE_AI_ASSERT(req);
+        req->req.data = reinterpret_cast<void*>(this);
+
+        unsigned size = replyString.size();
+        char* reply = reinterpret_cast<char*>(m_replyMsgPool.ordered_malloc(replyString.size()));
+        HCE_AI_ASSERT(reply);
+        replyString.copy(reply, size);
+        req->buf = uv_buf_init(reply, size);
+        uv_write((uv_write_t*) req, client, &req->buf, 1, _HCE_AI_LL_HTTP_SERVER_CALLBACK_WRAPPER_NAME(onReplyComplete));
+    };
+
+    void processRequest(uv_stream_t* client, _Request& req);
+
+    Impl* m_server;
+    unsigned m_index;
 
     // http server contexts
+    uv_loop_t m_uvLoopStorage;
     uv_loop_t* m_uvLoop;
     uv_tcp_t m_tcpServer;
     sockaddr_in m_addrIn;
@@ -268,13 +505,17 @@ private:
     // config
     std::string m_address;
     unsigned m_port;
+    std::size_t m_maxBodySize;
+    bool m_reusePort;
 
     // various memory pools and allocators
     boost::object_pool<uv_tcp_t> m_tcpCleintPool; // allocator for http client structs
     boost::pool<boost::default_user_allocator_new_delete> m_incomingMsgPool; // allocator for http incoming messages
     boost::object_pool<write_req_t> m_writeReqPool; // allocator for http reply write handles
+    boost::object_pool<uv_shutdown_t> m_shutdownReqPool; // allocator for shutdown handles of connections closed by the server
     boost::pool<boost::default_user_allocator_new_delete> m_replyMsgPool; // allocator for reply message
     boost::object_pool<_ClientDes> m_clientDesPool; // allocator for client descriptor
+    boost::object_pool<_ConnContext> m_connContextPool; // allocator for per-connection parsing state, only used at http server thread
     std::mutex m_clientDesPoolMtx; // as object pool malloc and free can happen concurrently by different threads 
                                    // i.e. malloc at http server thread and free at pipeline manager thread
 
@@ -286,25 +527,24 @@ private:
             boost::fast_pool_allocator<std::pair<uv_tcp_t*, std::pair<unsigned, std::string>>>> m_replyQueue;
     std::mutex m_replyQueueMutex;
 
-    std::atomic<uint64_t> m_watchdogVal;
-
     std::thread m_thread;
 };
 
-HttpServerLowLatency::Impl::Impl():m_state(Default), m_tcpCleintPool(TCP_CLIENT_POOL_CHUNK_COUNT, 0), 
+HttpServerLowLatency::Impl::_EventLoop::_EventLoop(Impl* server, unsigned index):m_server(server), m_index(index), m_state(Default), m_tcpCleintPool(TCP_CLIENT_POOL_CHUNK_COUNT, 0), 
         m_incomingMsgPool(INCOMING_MESSAGE_CHUNK_SIZE, INCOMING_MESSAGE_CHUNK_COUNT, 0), m_writeReqPool(WRITE_REQ_POOL_CHUNK_COUNT, 0),
         m_replyMsgPool(REPLY_MESSAGE_CHUNK_SIZE, REPLY_MESSAGE_CHUNK_COUNT, 0), m_clientDesPool(CLIENT_DES_CHUNK_COUNT, 0),
-        m_port(0), m_watchdogVal(0u){
-    m_uvLoop = uv_default_loop();
+        m_connContextPool(CONN_CONTEXT_CHUNK_COUNT, 0), m_port(0), m_maxBodySize(0), m_reusePort(false){
+    uv_loop_init(&m_uvLoopStorage);
+    m_uvLoop = &m_uvLoopStorage;
     uv_async_init(m_uvLoop, &m_asyncReply, _HCE_AI_LL_HTTP_SERVER_CALLBACK_WRAPPER_NAME(onAsyncReply));
     m_asyncReply.data = reinterpret_cast<void*>(this);
     uv_timer_init(m_uvLoop, &m_timer);
     m_timer.data = reinterpret_cast<void*>(this);
     uv_timer_start(&m_timer, _HCE_AI_LL_HTTP_SERVER_CALLBACK_WRAPPER_NAME(onTimeUp), 10, 10);
-    _TRC("[HTTP]: uv loop inited");
+    _TRC("[HTTP]: uv loop {} inited", m_index);
 }
 
-HttpServerLowLatency::Impl::~Impl(){
+HttpServerLowLatency::Impl::_EventLoop::~_EventLoop(){
 
 }
 
@@ -321,7 +561,7 @@ bool HttpServerLowLatency::Impl::healthCheck(){
     return true;
 }
 
-void HttpServerLowLatency::Impl::onAsyncReply(uv_async_t* handle){
+void HttpServerLowLatency::Impl::_EventLoop::onAsyncReply(uv_async_t* handle){
     std::lock_guard<std::mutex> lg(m_replyQueueMutex);
     auto iter = m_replyQueue.begin();
     while(iter != m_replyQueue.end()){
@@ -357,7 +597,7 @@ void HttpServerLowLatency::Impl::onAsyncReply(uv_async_t* handle){
     }
 }
 
-void HttpServerLowLatency::Impl::onTimeUp(uv_timer_t* handle){
+void HttpServerLowLatency::Impl::_EventLoop::onTimeUp(uv_timer_t* handle){
     if(StopTriggered == m_state.load(std::memory_order_consume)){
         uv_timer_stop(handle);
         uv_stop(m_uvLoop);
@@ -365,14 +605,14 @@ void HttpServerLowLatency::Impl::onTimeUp(uv_timer_t* handle){
     }
 }
 
-void HttpServerLowLatency::Impl::onIncomingMsgBufRequired(uv_handle_t *handle, size_t suggested_size, uv_buf_t *buf){
-    buf->base = reinterpret_cast<char*>(m_incomingMsgPool.ordered_malloc(INCOMING_MESSAGE_CHUNK_SIZE));
-    buf->len = INCOMING_MESSAGE_CHUNK_SIZE;
-    memset(buf->base, 0, buf->len);
+void HttpServerLowLatency::Impl::_EventLoop::onIncomingMsgBufRequired(uv_handle_t *handle, size_t suggested_size, uv_buf_t *buf){
+    // one chunk of the pool, i.e. INCOMING_MESSAGE_CHUNK_SIZE bytes
+    buf->base = reinterpret_cast<char*>(m_incomingMsgPool.malloc());
+    buf->len = buf->base ? INCOMING_MESSAGE_CHUNK_SIZE : 0;
     _TRC("[HTTP]: Allocate a buffer with size {} in incoming message pool", INCOMING_MESSAGE_CHUNK_SIZE);
 }
 
-void HttpServerLowLatency::Impl::onConnectionIn(uv_stream_t *server, int status) {
+void HttpServerLowLatency::Impl::_EventLoop::onConnectionIn(uv_stream_t *server, int status) {
     if (status < 0) {
         _ERR("New connection error: {}", uv_strerror(status));
         return;
@@ -385,7 +625,7 @@ void HttpServerLowLatency::Impl::onConnectionIn(uv_stream_t *server, int status)
     client->data = reinterpret_cast<void*>(this);
     if (uv_accept(server, (uv_stream_t*) client) == 0) {
         _TRC("[HTTP]: Connection accepted");
-        m_openedConn.registerConn(client);
+        m_openedConn.registerConn(client, m_connContextPool.construct(m_incomingMsgPool));
         uv_read_start((uv_stream_t*) client, _HCE_AI_LL_HTTP_SERVER_CALLBACK_WRAPPER_NAME(onIncomingMsgBufRequired), _HCE_AI_LL_HTTP_SERVER_CALLBACK_WRAPPER_NAME(onRead));
     }
     else {
@@ -394,308 +634,413 @@ void HttpServerLowLatency::Impl::onConnectionIn(uv_stream_t *server, int status)
     }
 }
 
-void HttpServerLowLatency::Impl::onRead(uv_stream_t *client, ssize_t nread, const uv_buf_t *buf){
+void HttpServerLowLatency::Impl::_EventLoop::onRead(uv_stream_t *client, ssize_t nread, const uv_buf_t *buf){
     if (nread > 0) {
-         
-        std::string reqString(buf->base, buf->len);
-        reqString.erase(std::find(reqString.begin(), reqString.end(), '\0'), reqString.end());
-        _TRC("[HTTP]: New message coming");
-        m_incomingMsgPool.ordered_free(buf->base, buf->len);
-        _TRC("[HTTP]: Freed incoming message buffer with length {}", buf->len);
-        std::string pendingReqString = m_openedConn.getMsg((uv_tcp_t*)client);
-        if(!pendingReqString.empty()){
-            // has unfinished message from last read
-            std::stringstream tempss;
-            tempss << pendingReqString << reqString;
-            reqString = tempss.str();
-            _TRC("[HTTP]: Append with previous message");
-        }
-
-        boost::beast::error_code ec;
-        boost::beast::http::request_parser<boost::beast::http::string_body> parser;
-
-        // Set the eager parse option.
-        parser.eager(true);
-
-        // The default limit is 1MB for requests and 8MB for responses.
-        // If this is set to `boost::none`, then the body limit is disabled.
-        parser.body_limit(boost::none);
-        
-        // Write a buffer sequence to the parser.
-        parser.put(boost::asio::buffer(reqString), ec);
-        
-        /// @brief Check here on ec returns
-        // if parse sucess: `Sucess`
-        // others: `body limit exceeded`, `bad method`
-        if (ec) {
-            _ERR("[HTTP]: Request body parse error: {}", ec.message());
-            makeBadReqReply(client);
+        _TRC("[HTTP]: New message coming with {} bytes", nread);
+        _ConnContext* context = m_openedConn.getContext((uv_tcp_t*)client);
+        if(!context){
+            _ERR("[HTTP]: Message received on an unregistered connection");
+            m_incomingMsgPool.free(buf->base);
             return;
         }
 
-        /// @brief 
-        // parser.is_done(): Returns true if the message is complete.
-        if(!parser.is_done()){
-            m_openedConn.replaceMsg((uv_tcp_t*)client, reqString);
-            _TRC("[HTTP]: Incomplete message. Cached");
-            return;
+        // bytes left over from last read only exist when the parser needed more data to
+        // make progress on a start line, header or chunk size, which are all short
+        const char* data = buf->base;
+        std::size_t size = nread;
+        bool usePending = !context->pending.empty();
+        if(usePending){
+            context->pending.append(buf->base, nread);
+            data = context->pending.data();
+            size = context->pending.size();
+            _TRC("[HTTP]: Append with {} pending bytes", context->pending.size() - nread);
         }
 
-        _TRC("[HTTP]: message to be processed: {}", reqString);
+        // the parser keeps its state across reads so each byte is parsed once, body bytes
+        // go straight into the connection's body arena
+        bool failed = false;
+        while(size > 0){
+            if(!context->parser){
+                context->parser.emplace();
+                // Set the eager parse option.
+                context->parser->eager(true);
+                context->parser->body_limit(m_maxBodySize);
+                context->parser->get().body() = &context->arena;
+            }
+
+            boost::beast::error_code ec;
+            std::size_t consumed = context->parser->put(boost::asio::buffer(data, size), ec);
+            data += consumed;
+            size -= consumed;
+
+            if(ec == boost::beast::http::error::need_more){
+                break;
+            }
+
+            /// @brief Check here on ec returns
+            // if parse sucess: `Sucess`
+            // others: `body limit exceeded`, `bad method`
+            if(ec){
+                _ERR("[HTTP]: Request parse error: {}", ec.message());
+                makeBadReqReply(client, true);
+                failed = true;
+                break;
+            }
 
-        // valid http request, we delete the cached message
-        m_openedConn.deleteMsg((uv_tcp_t*)client);
+            if(context->parser->is_done()){
+                processRequest(client, context->parser->get());
+                // parsers are single-use, a new one is created for the next request on this connection
+                context->parser.reset();
+                context->arena.clear();
+                continue;
+            }
 
-        boost::beast::http::verb verb = parser.get().method();
+            if(consumed == 0){
+                break;
+            }
+        }
+        m_incomingMsgPool.free(buf->base);
 
-        if(verb == boost::beast::http::verb::post){
-            std::string reqBodyString = parser.get().body();
-            boost::property_tree::ptree ptree;
-            std::stringstream ss(reqBodyString);
-            try {
-                boost::property_tree::read_json(ss, ptree);
-            } catch (const boost::property_tree::ptree_error& e){
-                _ERR("[HTTP]: Read json message failed: {}", boost::diagnostic_information(e));
+        if(failed){
+            // the connection is closing, drop the broken request and whatever follows it
+            context->parser.reset();
+            context->arena.clear();
+            context->pending.clear();
+        }
+        else if(usePending){
+            context->pending.erase(0, context->pending.size() - size);
+        }
+        else{
+            context->pending.assign(data, size);
+        }
+        if(!context->pending.empty()){
+            _TRC("[HTTP]: Incomplete message. {} bytes cached", context->pending.size());
+        }
+        return;
+    }
+    else{
+        if(buf->base && buf->len > 0){
+            m_incomingMsgPool.free(buf->base);
+            _TRC("[HTTP]: freed a buffer with len {} under nread <= 0", buf->len);
+        }
+        _TRC("[HTTP]: under nread <= 0 comes a buf with len {}", buf->len);
+    }
+    if (nread < 0) {
+        if (nread != UV_EOF){
+            _ERR("[HTTP]: uv read error: {}", uv_err_name(nread));
+        }
+        uv_close((uv_handle_t*) client, _HCE_AI_LL_HTTP_SERVER_CALLBACK_WRAPPER_NAME(onConnectionClose));
+    }
+}
+
+void HttpServerLowLatency::Impl::_EventLoop::processRequest(uv_stream_t* client, _Request& req){
+    _TRC("[HTTP]: request to be processed: {} {} with body of {} bytes", std::string(req.method_string()), std::string(req.target()), req.body()->size());
+
+    boost::beast::http::verb verb = req.method();
+
+    if(req.target() == "/latency/reset" || req.target() == "/result_cache/reset"){
+        // state-changing, so POST only and the body is ignored
+        if(verb != boost::beast::http::verb::post){
+            std::string targetString(req.target());
+            _ERR("[HTTP]: {} only accepts POST!", targetString);
+            makeMethodNotAllowedReply(client, "POST");
+        }
+        else if(req.target() == "/latency/reset"){
+            _TRC("[HTTP]: latency reset request received");
+            LatencyTracer::getInstance().reset();
+            makeOkReply(client);
+        }
+        else{
+            _TRC("[HTTP]: result cache reset request received");
+            ResultCache::getInstance().clear();
+            makeOkReply(client);
+        }
+    }
+    else if(verb == boost::beast::http::verb::post){
+        boost::property_tree::ptree ptree;
+        _ArenaStreamBuf bodyBuf(*req.body());
+        std::istream ss(&bodyBuf);
+        try {
+            boost::property_tree::read_json(ss, ptree);
+        } catch (const boost::property_tree::ptree_error& e){
+            _ERR("[HTTP]: Read json message failed: {}", boost::diagnostic_information(e));
+            makeBadReqReply(client);
+            return;
+        } catch (boost::exception& e){
+            _ERR("[HTTP]: Unclassified error while parsing json from coming message: {}", boost::diagnostic_information(e));
+            makeBadReqReply(client);
+            return;
+        }
+
+        if (ptree.empty()){
+            _ERR("[HTTP]: Request string provided does not contain valid json structure");
+            makeBadReqReply(client);
+            return;
+        }
+
+        auto target = req.target();
+        if(target == "/load_pipeline"){
+            _TRC("[HTTP]: load_pipeline request received");
+            std::string pipelineConfig;
+            unsigned suggestedWeight = 0;
+            unsigned streamNum = 1;
+            try{
+                pipelineConfig = ptree.get<std::string>("pipelineConfig");
+                // support cross-stream style pipeline config
+                if (pipelineConfig.find("stream_placeholder") != std::string::npos) {
+                    streamNum = ptree.get<unsigned>("streamNum");
+                    if (streamNum < 1) {
+                        throw std::runtime_error("Invalid streamNum, required: > 0!");
+                    }
+                    pipelineConfig = std::regex_replace(pipelineConfig, std::regex("stream_placeholder"), std::to_string(streamNum));
+                }
+                
+                auto optionalSuggestedWeight = ptree.get_optional<unsigned>("suggestedWeight");
+                if(optionalSuggestedWeight){
+                    suggestedWeight = optionalSuggestedWeight.get();
+                }
+            }
+            catch (const boost::property_tree::ptree_bad_path& e) {
+                _ERR("[HTTP]: Parsing failed: {}", e.what());
+                makeBadReqReply(client);
+                return;
+            } catch (const boost::property_tree::ptree_bad_data& e) {
+                _ERR("[HTTP]: Parsing failed: {}", e.what());
                 makeBadReqReply(client);
                 return;
-            } catch (boost::exception& e){
-                _ERR("[HTTP]: Unclassified error while parsing json from coming message: {}", boost::diagnostic_information(e));
+            } catch (boost::exception& e) {
+                _ERR("[HTTP]: Unclassified error upon parsing json file: {}", boost::diagnostic_information(e));
                 makeBadReqReply(client);
                 return;
             }
-
-            if (ptree.empty()){
-                _ERR("[HTTP]: Request string provided does not contain valid json structure");
+            
+            if(pipelineConfig.empty()){
+                _ERR("[HTTP]: Empty pipeline config");
                 makeBadReqReply(client);
                 return;
             }
 
-            auto target = parser.get().target();
-            if(target == "/load_pipeline"){
-                _TRC("[HTTP]: load_pipeline request received");
-                std::string pipelineConfig;
-                unsigned suggestedWeight = 0;
-                unsigned streamNum = 1;
-                try{
-                    pipelineConfig = ptree.get<std::string>("pipelineConfig");
-                    // support cross-stream style pipeline config
-                    if (pipelineConfig.find("stream_placeholder") != std::string::npos) {
-                        streamNum = ptree.get<unsigned>("streamNum");
-                        if (streamNum < 1) {
-                            throw std::runtime_error("Invalid streamNum, required: > 0!");
-                        }
-                        pipelineConfig = std::regex_replace(pipelineConfig, std::regex("stream_placeholder"), std::to_string(streamNum));
-                    }
-                    
-                    auto optionalSuggestedWeight = ptree.get_optional<unsigned>("suggestedWeight");
-                    if(optionalSuggestedWeight){
-                        suggestedWeight = optionalSuggestedWeight.get();
-                    }
-                }
-                catch (const boost::property_tree::ptree_bad_path& e) {
-                    _ERR("[HTTP]: Parsing failed: {}", e.what());
-                    makeBadReqReply(client);
-                    return;
-                } catch (const boost::property_tree::ptree_bad_data& e) {
-                    _ERR("[HTTP]: Parsing failed: {}", e.what());
-                    makeBadReqReply(client);
-                    return;
-                } catch (boost::exception& e) {
-                    _ERR("[HTTP]: Unclassified error upon parsing json file: {}", boost::diagnostic_information(e));
-                    makeBadReqReply(client);
-                    return;
-                }
-                
-                if(pipelineConfig.empty()){
-                    _ERR("[HTTP]: Empty pipeline config");
-                    makeBadReqReply(client);
-                    return;
-                }
+            _ClientDes* tempDes;
+            {
+                std::lock_guard<std::mutex> lg(m_clientDesPoolMtx);
+                tempDes = m_clientDesPool.malloc();
+            }
+            ClientDes desc(tempDes, [this](_ClientDes* ptr){ std::lock_guard<std::mutex> lg(m_clientDesPoolMtx); m_clientDesPool.free(ptr);});
+            HCE_AI_ASSERT(desc);
+            desc->conn = (uv_tcp_t*)client;
+            desc->loop = this;
+            desc->cacheable = false;
+            HttpPipelineManager::Handle jobHandle;
+            HttpPipelineManager::getInstance().submitLoadPipeline(pipelineConfig, desc, jobHandle, suggestedWeight, streamNum);
+            _TRC("[HTTP]: load pipeline req with job handle {} submited to pipeline manager", jobHandle);
+        }
+        else if(target == "/unload_pipeline"){
+            _TRC("[HTTP]: unload_pipeline request received");
+            HttpPipelineManager::Handle jobHandle;
+            try{
+                jobHandle = ptree.get<uint32_t>("handle");
+            }
+            catch (const boost::property_tree::ptree_bad_path& e) {
+                _ERR("[HTTP]: Parsing failed: {}", e.what());
+                makeBadReqReply(client);
+                return;
+            } catch (const boost::property_tree::ptree_bad_data& e) {
+                _ERR("[HTTP]: Parsing failed: {}", e.what());
+                makeBadReqReply(client);
+                return;
+            } catch (boost::exception& e) {
+                _ERR("[HTTP]: Unclassified error upon parsing json file: {}", boost::diagnostic_information(e));
+                makeBadReqReply(client);
+                return;
+            }
 
-                _ClientDes* tempDes;
-                {
-                    std::lock_guard<std::mutex> lg(m_clientDesPoolMtx);
-                    tempDes = m_clientDesPool.malloc();
-                }
-                ClientDes desc(tempDes, [this](_ClientDes* ptr){ std::lock_guard<std::mutex> lg(m_clientDesPoolMtx); m_clientDesPool.free(ptr);});
-                HCE_AI_ASSERT(desc);
-                desc->conn = (uv_tcp_t*)client;
-                HttpPipelineManager::Handle jobHandle;
-                HttpPipelineManager::getInstance().submitLoadPipeline(pipelineConfig, desc, jobHandle, suggestedWeight, streamNum);
-                _TRC("[HTTP]: load pipeline req with job handle {} submited to pipeline manager", jobHandle);
+            _ClientDes* tempDes;
+            {
+                std::lock_guard<std::mutex> lg(m_clientDesPoolMtx);
+                tempDes = m_clientDesPool.malloc();
+                HCE_AI_ASSERT(tempDes);
             }
-            else if(target == "/unload_pipeline"){
-                _TRC("[HTTP]: unload_pipeline request received");
-                HttpPipelineManager::Handle jobHandle;
-                try{
-                    jobHandle = ptree.get<uint32_t>("handle");
-                }
-                catch (const boost::property_tree::ptree_bad_path& e) {
-                    _ERR("[HTTP]: Parsing failed: {}", e.what());
-                    makeBadReqReply(client);
-                    return;
-                } catch (const boost::property_tree::ptree_bad_data& e) {
-                    _ERR("[HTTP]: Parsing failed: {}", e.what());
-                    makeBadReqReply(client);
-                    return;
-                } catch (boost::exception& e) {
-                    _ERR("[HTTP]: Unclassified error upon parsing json file: {}", boost::diagnostic_information(e));
-                    makeBadReqReply(client);
-                    return;
+            ClientDes desc(tempDes, [this](_ClientDes* ptr){ std::lock_guard<std::mutex> lg(m_clientDesPoolMtx); m_clientDesPool.free(ptr);});
+            HCE_AI_ASSERT(desc);
+            desc->conn = (uv_tcp_t*)client;
+            desc->loop = this;
+            desc->cacheable = false;
+            HttpPipelineManager::getInstance().submitUnloadPipeline(jobHandle, desc);
+            _TRC("[HTTP]: unload pipeline req with job handle {} submited to pipeline manager", jobHandle);
+        }
+        else if(target == "/run"){
+            _TRC("[HTTP]: run request received");
+            HttpPipelineManager::Handle jobHandle = 0;
+            std::string pipelineConfig;
+            std::vector<std::string> mediaUris;
+            unsigned suggestedWeight = 0;
+            unsigned streamNum = 1;
+            try{
+                for(const auto& item: ptree.get_child("mediaUri")){
+                    mediaUris.push_back(item.second.data());
                 }
 
-                _ClientDes* tempDes;
-                {
-                    std::lock_guard<std::mutex> lg(m_clientDesPoolMtx);
-                    tempDes = m_clientDesPool.malloc();
-                    HCE_AI_ASSERT(tempDes);
+                auto optionalSuggestedWeight = ptree.get_optional<unsigned>("suggestedWeight");
+                if(optionalSuggestedWeight){
+                    suggestedWeight = optionalSuggestedWeight.get();
                 }
-                ClientDes desc(tempDes, [this](_ClientDes* ptr){ std::lock_guard<std::mutex> lg(m_clientDesPoolMtx); m_clientDesPool.free(ptr);});
-                HCE_AI_ASSERT(desc);
-                desc->conn = (uv_tcp_t*)client;
-                HttpPipelineManager::getInstance().submitUnloadPipeline(jobHandle, desc);
-                _TRC("[HTTP]: unload pipeline req with job handle {} submited to pipeline manager", jobHandle);
-            }
-            else if(target == "/run"){
-                _TRC("[HTTP]: run request received");
-                HttpPipelineManager::Handle jobHandle = 0;
-                std::string pipelineConfig;
-                std::vector<std::string> mediaUris;
-                unsigned suggestedWeight = 0;
-                unsigned streamNum = 1;
-                try{
-                    for(const auto& item: ptree.get_child("mediaUri")){
-                        mediaUris.push_back(item.second.data());
-                    }
 
-                    auto optionalSuggestedWeight = ptree.get_optional<unsigned>("suggestedWeight");
-                    if(optionalSuggestedWeight){
-                        suggestedWeight = optionalSuggestedWeight.get();
+                auto optionalStreamNum = ptree.get_optional<unsigned>("streamNum");
+                if(optionalStreamNum){
+                    streamNum = optionalStreamNum.get();
+                    if (streamNum < 1) {
+                        throw std::runtime_error("Invalid streamNum, required: > 0!");
                     }
+                }
 
-                    auto optionalStreamNum = ptree.get_optional<unsigned>("streamNum");
-                    if(optionalStreamNum){
-                        streamNum = optionalStreamNum.get();
-                        if (streamNum < 1) {
-                            throw std::runtime_error("Invalid streamNum, required: > 0!");
+                auto optionalJobHandle = ptree.get_optional<uint32_t>("handle");
+                if(optionalJobHandle){
+                    jobHandle = optionalJobHandle.get();
+                }
+                else{
+                    pipelineConfig = ptree.get<std::string>("pipelineConfig");
+                    
+                    // support cross-stream style pipeline config
+                    if (pipelineConfig.find("stream_placeholder") != std::string::npos) {
+                        if (mediaUris.size() < streamNum) {
+                            throw std::runtime_error("Input mediaUris should be no less than the streamNum!");
                         }
+                        pipelineConfig = std::regex_replace(pipelineConfig, std::regex("stream_placeholder"), std::to_string(streamNum));
                     }
-
-                    auto optionalJobHandle = ptree.get_optional<uint32_t>("handle");
-                    if(optionalJobHandle){
-                        jobHandle = optionalJobHandle.get();
-                    }
-                    else{
-                        pipelineConfig = ptree.get<std::string>("pipelineConfig");
-                        
-                        // support cross-stream style pipeline config
-                        if (pipelineConfig.find("stream_placeholder") != std::string::npos) {
-                            if (mediaUris.size() < streamNum) {
-                                throw std::runtime_error("Input mediaUris should be no less than the streamNum!");
-                            }
-                            pipelineConfig = std::regex_replace(pipelineConfig, std::regex("stream_placeholder"), std::to_string(streamNum));
-                        }
-                        else if (streamNum > 1) {
-                            _WRN("[HTTP]: pipelineConfig do not contain `stream_placeholder`, request parameter: `streamNum` will not take effect, revert streamNum to 1!");
-                            streamNum = 1;
-                        }
+                    else if (streamNum > 1) {
+                        _WRN("[HTTP]: pipelineConfig do not contain `stream_placeholder`, request parameter: `streamNum` will not take effect, revert streamNum to 1!");
+                        streamNum = 1;
                     }
                 }
-                catch (const boost::property_tree::ptree_bad_path& e) {
-                    _ERR("[HTTP]: Parsing failed: {}", e.what());
-                    makeBadReqReply(client);
-                    return;
-                } catch (const boost::property_tree::ptree_bad_data& e) {
-                    _ERR("[HTTP]: Parsing failed: {}", e.what());
-                    makeBadReqReply(client);
-                    return;
-                } catch (boost::exception& e) {
-                    _ERR("[HTTP]: Unclassified error upon parsing json file: {}", boost::diagnostic_information(e));
-                    makeBadReqReply(client);
-                    return;
-                }
+            }
+            catch (const boost::property_tree::ptree_bad_path& e) {
+                _ERR("[HTTP]: Parsing failed: {}", e.what());
+                makeBadReqReply(client);
+                return;
+            } catch (const boost::property_tree::ptree_bad_data& e) {
+                _ERR("[HTTP]: Parsing failed: {}", e.what());
+                makeBadReqReply(client);
+                return;
+            } catch (boost::exception& e) {
+                _ERR("[HTTP]: Unclassified error upon parsing json file: {}", boost::diagnostic_information(e));
+                makeBadReqReply(client);
+                return;
+            }
 
-                if(mediaUris.size() == 0){
-                    _ERR("[HTTP]: Empty media uri");
-                    makeBadReqReply(client);
+            if(mediaUris.size() == 0){
+                _ERR("[HTTP]: Empty media uri");
+                makeBadReqReply(client);
+                return;
+            }
+
+            // results of auto run requests are cached by pipeline config, those on a loaded pipeline are not
+            // as the pipeline behind a handle is unknown here
+            ResultCache::Key cacheKey;
+            std::vector<std::string> cacheContentFiles;
+            bool cacheable = !pipelineConfig.empty() && ResultCache::getInstance().enabled();
+            if(cacheable){
+                cacheKey = ResultCache::makeKey(pipelineConfig, mediaUris, cacheContentFiles);
+                std::string cachedResult;
+                if(ResultCache::getInstance().lookup(cacheKey, cacheContentFiles, cachedResult)){
+                    _TRC("[HTTP]: run request replied from result cache");
+                    makeJsonReply(client, cachedResult);
                     return;
                 }
+            }
 
-                _ClientDes* tempDes;
-                {
-                    std::lock_guard<std::mutex> lg(m_clientDesPoolMtx);
-                    tempDes = m_clientDesPool.malloc();
-                    HCE_AI_ASSERT(tempDes);
-                }
-                ClientDes desc(tempDes, [this](_ClientDes* ptr){ std::lock_guard<std::mutex> lg(m_clientDesPoolMtx); m_clientDesPool.free(ptr);});
-                desc->conn = (uv_tcp_t*)client;
-                if(pipelineConfig.empty()){
-                    HttpPipelineManager::getInstance().submitRun(mediaUris, jobHandle, desc);
-                    _TRC("[HTTP]: run pipeline req with job handle {} submited to pipeline manager", jobHandle);
-                }
-                else{
-                    HttpPipelineManager::getInstance().submitAutoRun(mediaUris, pipelineConfig, desc, suggestedWeight, streamNum);
-                    _TRC("[HTTP]: auto run pipeline req with job handle submited to pipeline manager");
-                }
-                
+            _ClientDes* tempDes;
+            {
+                std::lock_guard<std::mutex> lg(m_clientDesPoolMtx);
+                tempDes = m_clientDesPool.malloc();
+                HCE_AI_ASSERT(tempDes);
+            }
+            ClientDes desc(tempDes, [this](_ClientDes* ptr){ std::lock_guard<std::mutex> lg(m_clientDesPoolMtx); m_clientDesPool.free(ptr);});
+            desc->conn = (uv_tcp_t*)client;
+            desc->loop = this;
+            desc->cacheable = cacheable;
+            desc->cacheKey = cacheKey;
+            desc->cacheContentFiles = std::move(cacheContentFiles);
+            if(pipelineConfig.empty()){
+                HttpPipelineManager::getInstance().submitRun(mediaUris, jobHandle, desc);
+                _TRC("[HTTP]: run pipeline req with job handle {} submited to pipeline manager", jobHandle);
             }
             else{
-                std::string targetString(target);
-                _ERR("[HTTP]: Illegal target {} received!", targetString);
-                makeBadReqReply(client);
-                return;
+                HttpPipelineManager::getInstance().submitAutoRun(mediaUris, pipelineConfig, desc, suggestedWeight, streamNum);
+                _TRC("[HTTP]: auto run pipeline req with job handle submited to pipeline manager");
             }
+            
         }
-        else if(verb == boost::beast::http::verb::get){
-            auto target = parser.get().target();
-            if(target == "/healthz"){
-                _TRC("[HTTP]: health check request received");
-                if(healthCheck()){
-                    makeOkReply(client);
-                }
-                else{
-                    _ERR("[HTTP]: health check failed!");
-                    makeInternalServerErrorReply(client);
-                }
+        else{
+            std::string targetString(target);
+            _ERR("[HTTP]: Illegal target {} received!", targetString);
+            makeBadReqReply(client);
+            return;
+        }
+    }
+    else if(verb == boost::beast::http::verb::get){
+        auto target = req.target();
+        if(target == "/healthz"){
+            _TRC("[HTTP]: health check request received");
+            if(m_server->healthCheck()){
+                makeOkReply(client);
             }
             else{
-                std::string targetString(target);
-                _ERR("[HTTP]: Illegal target {} received!", targetString);
-                makeBadReqReply(client);
-                return;
+                _ERR("[HTTP]: health check failed!");
+                makeInternalServerErrorReply(client);
             }
         }
+        else if(target == "/latency"){
+            // per-stage latency histograms and queue depth gauges
+            _TRC("[HTTP]: latency statistics request received");
+            makeJsonReply(client, LatencyTracer::getInstance().exportStats());
+        }
+        else if(target == "/latency/trace"){
+            // recent trace events in chrome trace format, load with chrome://tracing or perfetto
+            _TRC("[HTTP]: latency trace request received");
+            makeJsonReply(client, LatencyTracer::getInstance().exportChromeTrace());
+        }
+        else if(target == "/result_cache"){
+            _TRC("[HTTP]: result cache statistics request received");
+            makeJsonReply(client, ResultCache::getInstance().exportStats());
+        }
         else{
-            std::string verbString(boost::beast::http::to_string(verb));
-            _ERR("[HTTP]: Illegal verb {} received!", verbString);
+            std::string targetString(target);
+            _ERR("[HTTP]: Illegal target {} received!", targetString);
             makeBadReqReply(client);
             return;
         }
-        return;
     }
     else{
-        if(buf->base && buf->len > 0){
-            m_incomingMsgPool.ordered_free(buf->base, buf->len);
-            _TRC("[HTTP]: freed a buffer with len {} under nread <= 0", buf->len);
-        }
-        _TRC("[HTTP]: under nread <= 0 comes a buf with len {}", buf->len);
-    }
-    if (nread < 0) {
-        if (nread != UV_EOF){
-            _ERR("[HTTP]: uv read error: {}", uv_err_name(nread));
-        }
-        uv_close((uv_handle_t*) client, _HCE_AI_LL_HTTP_SERVER_CALLBACK_WRAPPER_NAME(onConnectionClose));
+        std::string verbString(boost::beast::http::to_string(verb));
+        _ERR("[HTTP]: Illegal verb {} received!", verbString);
+        makeBadReqReply(client);
+        return;
     }
 }
 
-void HttpServerLowLatency::Impl::onConnectionClose(uv_handle_t* handle){
+void HttpServerLowLatency::Impl::_EventLoop::onConnectionClose(uv_handle_t* handle){
     uv_tcp_t* tmp = reinterpret_cast<uv_tcp_t*>(handle);
-    m_openedConn.unregisterConn(tmp);
+    _ConnContext* context = m_openedConn.unregisterConn(tmp);
+    if(context){
+        m_connContextPool.destroy(context);
+    }
     m_tcpCleintPool.free(reinterpret_cast<uv_tcp_t*>(tmp));
     _TRC("[HTTP]: Connection closed");
 }
 
-void HttpServerLowLatency::Impl::onReplyComplete(uv_write_t* req, int status){
+void HttpServerLowLatency::Impl::_EventLoop::onShutdown(uv_shutdown_t* req, int status){
+    if (status) {
+        _TRC("[HTTP]: Shutdown error: {}", uv_strerror(status));
+    }
+    uv_stream_t* client = req->handle;
+    m_shutdownReqPool.free(req);
+    if(!uv_is_closing((uv_handle_t*) client)){
+        uv_close((uv_handle_t*) client, _HCE_AI_LL_HTTP_SERVER_CALLBACK_WRAPPER_NAME(onConnectionClose));
+    }
+    _TRC("[HTTP]: Connection closed by server");
+}
+
+void HttpServerLowLatency::Impl::_EventLoop::onReplyComplete(uv_write_t* req, int status){
     if (status) {
         _ERR("[HTTP]: Write error: {}", uv_strerror(status));
     }
@@ -706,35 +1051,71 @@ void HttpServerLowLatency::Impl::onReplyComplete(uv_write_t* req, int status){
     _TRC("[HTTP]: Freed a write request and reply message pool buffer");
 }
 
-hceAiStatus_t HttpServerLowLatency::Impl::init(const std::string& address, unsigned port){
+hceAiStatus_t HttpServerLowLatency::Impl::_EventLoop::init(const std::string& address, unsigned port, std::size_t maxBodySize, bool reusePort){
     HCE_AI_CHECK_RETURN_IF_FAIL(State::Default == m_state, hceAiInvalidCall);
-    HCE_AI_CHECK_RETURN_IF_FAIL(validateIP(address), hceAiBadArgument);
-    HCE_AI_CHECK_RETURN_IF_FAIL(port<=65536, hceAiBadArgument);
 
     m_address = address;
     m_port = port;
+    m_maxBodySize = maxBodySize;
+    m_reusePort = reusePort;
 
     m_state.store(State::Initialized, std::memory_order_release);
 
-    _TRC("[HTTP]: Init completed");
+    _TRC("[HTTP]: Init completed on loop {}", m_index);
 
     return hceAiSuccess;
 }
 
-hceAiStatus_t HttpServerLowLatency::Impl::run(){
+hceAiStatus_t HttpServerLowLatency::Impl::_EventLoop::run(){
     HCE_AI_CHECK_RETURN_IF_FAIL(State::Initialized == m_state, hceAiInvalidCall);
 
-    m_thread = std::thread(&HttpServerLowLatency::Impl::workload, this);
+    m_thread = std::thread(&HttpServerLowLatency::Impl::_EventLoop::workload, this);
 
     return hceAiSuccess;
 }
 
-hceAiStatus_t HttpServerLowLatency::Impl::workload(){
-    _TRC("[HTTP]: http server at {}:{}", m_address, m_port);
+hceAiStatus_t HttpServerLowLatency::Impl::_EventLoop::bindListener(){
     uv_tcp_init(m_uvLoop, &m_tcpServer);
     m_tcpServer.data = reinterpret_cast<void*>(this);
     uv_ip4_addr(m_address.c_str(), m_port, &m_addrIn);
-    uv_tcp_bind(&m_tcpServer, (const struct sockaddr*)&m_addrIn, 0);
+    if(!m_reusePort){
+        uv_tcp_bind(&m_tcpServer, (const struct sockaddr*)&m_addrIn, 0);
+        return hceAiSuccess;
+    }
+
+    // libuv does not expose SO_REUSEPORT on all supported versions, so the socket is
+    // created here and handed over to the uv tcp handle
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(fd < 0){
+        _ERR("[HTTP]: Create listener socket failed on loop {}: {}", m_index, strerror(errno));
+        return hceAiSocketListenFailure;
+    }
+    int on = 1;
+    if(0 != setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) ||
+            0 != setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on))){
+        _ERR("[HTTP]: Set SO_REUSEPORT failed on loop {}: {}", m_index, strerror(errno));
+        close(fd);
+        return hceAiSocketListenFailure;
+    }
+    if(0 != bind(fd, (const struct sockaddr*)&m_addrIn, sizeof(m_addrIn))){
+        _ERR("[HTTP]: Bind failed on loop {}: {}", m_index, strerror(errno));
+        close(fd);
+        return hceAiSocketListenFailure;
+    }
+    int r = uv_tcp_open(&m_tcpServer, fd);
+    if(r){
+        _ERR("[HTTP]: Open listener socket failed on loop {}: {}", m_index, uv_strerror(r));
+        close(fd);
+        return hceAiSocketListenFailure;
+    }
+    return hceAiSuccess;
+}
+
+hceAiStatus_t HttpServerLowLatency::Impl::_EventLoop::workload(){
+    _TRC("[HTTP]: http server loop {} at {}:{}", m_index, m_address, m_port);
+    if(hceAiSuccess != bindListener()){
+        return hceAiSocketListenFailure;
+    }
 
     _TRC("[HTTP]: running starts");
     int r = uv_listen((uv_stream_t*) &m_tcpServer, DEFAULT_SOCKET_QUEUE_SIZE, _HCE_AI_LL_HTTP_SERVER_CALLBACK_WRAPPER_NAME(onConnectionIn));
@@ -752,14 +1133,16 @@ hceAiStatus_t HttpServerLowLatency::Impl::workload(){
     }
 }
 
-void HttpServerLowLatency::Impl::stop(){
+void HttpServerLowLatency::Impl::_EventLoop::stop(){
     State expected = State::Running;
     m_state.compare_exchange_strong(expected, State::StopTriggered, std::memory_order_acq_rel);
-    m_thread.join();
-    _TRC("[HTTP]: stopped");
+    if(m_thread.joinable()){
+        m_thread.join();
+    }
+    _TRC("[HTTP]: loop {} stopped", m_index);
 }
 
-hceAiStatus_t HttpServerLowLatency::Impl::reply(ClientDes client, unsigned code, const std::string& reply){
+hceAiStatus_t HttpServerLowLatency::Impl::_EventLoop::reply(ClientDes client, unsigned code, const std::string& reply){
     HCE_AI_CHECK_RETURN_IF_FAIL(m_openedConn.exist(client->conn), hceAiBadArgument);
 
     _TRC("[HTTP]: Adding a reply message with code {} to reply queue", code);
@@ -771,6 +1154,64 @@ hceAiStatus_t HttpServerLowLatency::Impl::reply(ClientDes client, unsigned code,
     return hceAiSuccess;
 }
 
+HttpServerLowLatency::Impl::Impl():m_watchdogVal(0u){
+
+}
+
+HttpServerLowLatency::Impl::~Impl(){
+
+}
+
+hceAiStatus_t HttpServerLowLatency::Impl::init(const std::string& address, unsigned port, std::size_t maxBodySize, unsigned loopCount){
+    HCE_AI_CHECK_RETURN_IF_FAIL(m_loops.empty(), hceAiInvalidCall);
+    HCE_AI_CHECK_RETURN_IF_FAIL(validateIP(address), hceAiBadArgument);
+    HCE_AI_CHECK_RETURN_IF_FAIL(port<=65536, hceAiBadArgument);
+    HCE_AI_CHECK_RETURN_IF_FAIL(maxBodySize > 0, hceAiBadArgument);
+    HCE_AI_CHECK_RETURN_IF_FAIL(loopCount > 0, hceAiBadArgument);
+
+    for(unsigned i = 0; i < loopCount; ++i){
+        m_loops.emplace_back(new _EventLoop(this, i));
+        // a single loop keeps the exclusive bind
+        hceAiStatus_t sts = m_loops.back()->init(address, port, maxBodySize, loopCount > 1);
+        if(hceAiSuccess != sts){
+            m_loops.clear();
+            return sts;
+        }
+    }
+
+    _TRC("[HTTP]: Init completed with {} loops", loopCount);
+
+    return hceAiSuccess;
+}
+
+hceAiStatus_t HttpServerLowLatency::Impl::run(){
+    HCE_AI_CHECK_RETURN_IF_FAIL(!m_loops.empty(), hceAiInvalidCall);
+
+    for(auto& loop: m_loops){
+        hceAiStatus_t sts = loop->run();
+        if(hceAiSuccess != sts){
+            return sts;
+        }
+    }
+    return hceAiSuccess;
+}
+
+void HttpServerLowLatency::Impl::stop(){
+    for(auto& loop: m_loops){
+        loop->stop();
+    }
+    _TRC("[HTTP]: stopped");
+}
+
+hceAiStatus_t HttpServerLowLatency::Impl::reply(ClientDes client, unsigned code, const std::string& reply, bool cacheable){
+    HCE_AI_CHECK_RETURN_IF_FAIL(client && client->loop, hceAiBadArgument);
+    if(200 == code && cacheable && client->cacheable){
+        // called from pipeline threads, the content of local files is hashed here rather than on the event loop
+        ResultCache::getInstance().insert(client->cacheKey, client->cacheContentFiles, reply);
+    }
+    return client->loop->reply(client, code, reply);
+}
+
 HttpServerLowLatency::HttpServerLowLatency():m_impl(new Impl){
 
 }
@@ -782,8 +1223,8 @@ HttpServerLowLatency& HttpServerLowLatency::getInstance(){
     return inst;
 }
 
-hceAiStatus_t HttpServerLowLatency::init(const std::string& address, unsigned port){
-    return m_impl->init(address, port);
+hceAiStatus_t HttpServerLowLatency::init(const std::string& address, unsigned port, std::size_t maxBodySize, unsigned loopCount){
+    return m_impl->init(address, port, maxBodySize, loopCount);
 }
 
 hceAiStatus_t HttpServerLowLatency::run(){
@@ -794,8 +1235,8 @@ void HttpServerLowLatency::stop(){
     m_impl->stop();
 }
 
-hceAiStatus_t HttpServerLowLatency::reply(ClientDes client, unsigned code, const std::string& reply){
-    return m_impl->reply(client, code, reply);
+hceAiStatus_t HttpServerLowLatency::reply(ClientDes client, unsigned code, const std::string& reply, bool cacheable){
+    return m_impl->reply(client, code, reply, cacheable);
 }
 
 
@@ -15,11 +15,14 @@
 #include <csignal>
 #include <cstring>
 #include <fstream>
+#include <sstream>
 #include <boost/program_options.hpp>
 #include <boost/exception/all.hpp>
 #include "common/logger.hpp"
+#include "common/latency_tracer.hpp"
 #include "low_latency_server/http_server/httpPipelineManager.hpp"
 #include "low_latency_server/http_server/lowLatencyServer.hpp"
+#include "low_latency_server/resultCache.hpp"
 #include "low_latency_server/grpc_server/grpcPipelineManager.hpp"
 #include "low_latency_server/grpc_server/grpcServer.hpp"
 
@@ -38,10 +41,20 @@ struct Config{
     std::string httpServerAddr;
     unsigned httpServerPort;
     unsigned gRPCServerPort;
+    unsigned gRPCReplyQueueDepth;
+    unsigned gRPCThreadCount;
+    unsigned httpMaxBodySize;
+    unsigned httpLoopCount;
+    unsigned resultCacheSize;
+    unsigned resultCacheTtl;
 
     unsigned maxConcurrentWorkload;
     unsigned maxPipelineLifetime;
     unsigned pipelineManagerPoolSize;
+    unsigned warmPipelinesPerConfig;
+    std::string clientShares;
+
+    bool traceEnable;
 };
 
 Config parseConf(int argc, char** argv){
@@ -76,12 +89,31 @@ Config parseConf(int argc, char** argv){
             ("HTTP.address", po::value<std::string>(&config.httpServerAddr), "HTTP server address")
             ("HTTP.RESTfulPort", po::value<unsigned>(&config.httpServerPort), "HTTP server port")
             ("HTTP.gRPCPort", po::value<unsigned>(&config.gRPCServerPort), "gRPC server port")
+            ("HTTP.gRPCThreadCount", po::value<unsigned>(&config.gRPCThreadCount)->default_value(1),
+                                              "Number of gRPC completion queues, each polled by its own thread. Default as 1.")
+            ("HTTP.gRPCReplyQueueDepth", po::value<unsigned>(&config.gRPCReplyQueueDepth)->default_value(64),
+                                              "Max replies pending on a gRPC stream while the client falls behind, 0 as unbounded. Default as 64.")
+            ("HTTP.maxBodySize", po::value<unsigned>(&config.httpMaxBodySize)->default_value(64),
+                                              "Max size (MB) of a RESTful request body. Default as 64.")
+            ("HTTP.loopCount", po::value<unsigned>(&config.httpLoopCount)->default_value(1),
+                                              "Number of RESTful server event loops, each on its own thread. Default as 1.")
+            ("HTTP.resultCacheSize", po::value<unsigned>(&config.resultCacheSize)->default_value(0),
+                                              "Max size (MB) of cached RESTful run results, 0 as disabled. Default as 0.")
+            ("HTTP.resultCacheTtl", po::value<unsigned>(&config.resultCacheTtl)->default_value(60),
+                                              "Lifetime (seconds) of a cached RESTful run result, 0 as never expire. Default as 60.")
 
             ("Pipeline.maxConcurrentWorkload", po::value<unsigned>(&config.maxConcurrentWorkload), "Max pipeline counts running concurrently")
             ("Pipeline.maxPipelineLifetime", po::value<unsigned>(&config.maxPipelineLifetime)->default_value(30),
                                               "Max pipeline lifetime (seconds). Default as 30.")
             ("Pipeline.pipelineManagerPoolSize", po::value<unsigned>(&config.pipelineManagerPoolSize)->default_value(1),
-                                              "Pipeline manager pool size. Default as 1.");
+                                              "Pipeline manager pool size. Default as 1.")
+            ("Pipeline.warmPipelinesPerConfig", po::value<unsigned>(&config.warmPipelinesPerConfig)->default_value(0),
+                                              "Idle auto-loaded pipelines kept beyond lifetime for each pipeline config. Default as 0.")
+            ("Pipeline.clientShares", po::value<std::string>(&config.clientShares)->default_value(""),
+                                              "Fair-share weights of clients as `clientId:share,...`, unlisted clients have share 1. Default as empty.")
+
+            ("Trace.enable", po::value<bool>(&config.traceEnable)->default_value(false),
+                                              "Enable per-stage latency histograms and tracing, served at /latency. Default as false.");
 
         po::variables_map confVm;
         std::ifstream ifile(confPath, std::ifstream::in);
@@ -100,6 +132,28 @@ Config parseConf(int argc, char** argv){
     }
 }
 
+/**
+ * @brief parse `clientId:share,clientId:share` into a map, malformed entries are skipped
+*/
+std::unordered_map<std::string, double> parseClientShares(const std::string& clientShares){
+    std::unordered_map<std::string, double> shares;
+    std::stringstream ss(clientShares);
+    std::string item;
+    while(std::getline(ss, item, ',')){
+        std::size_t pos = item.rfind(':');
+        if(pos == std::string::npos || pos == 0){
+            std::cerr << "Ignored malformed client share: " << item << std::endl;
+            continue;
+        }
+        try{
+            shares[item.substr(0, pos)] = std::stod(item.substr(pos + 1));
+        }catch(const std::exception& e){
+            std::cerr << "Ignored malformed client share: " << item << std::endl;
+        }
+    }
+    return shares;
+}
+
 void onExitSignal(int sig, siginfo_t *info, void *ucontext){
     std::cout << "Exiting..." << std::endl;
     g_running.store(false, std::memory_order_release);
@@ -109,7 +163,9 @@ void onExitSignal(int sig, siginfo_t *info, void *ucontext){
 void startHTTPServer(Config config) {
     HttpPipelineManager::getInstance().init(config.maxConcurrentWorkload, config.maxPipelineLifetime, config.logSeverity);
     HttpPipelineManager::getInstance().start(config.pipelineManagerPoolSize);
-    HttpServerLowLatency::getInstance().init(config.httpServerAddr, config.httpServerPort);
+    ResultCache::getInstance().init((std::size_t)config.resultCacheSize * 1024 * 1024, config.resultCacheTtl);
+    HttpServerLowLatency::getInstance().init(config.httpServerAddr, config.httpServerPort, (std::size_t)config.httpMaxBodySize * 1024 * 1024,
+                                             config.httpLoopCount);
     HttpServerLowLatency::getInstance().run();
     if(g_running.load(std::memory_order_acquire)){
         std::unique_lock<std::mutex> lk(g_mutex);
@@ -121,10 +177,13 @@ void startHTTPServer(Config config) {
 
 void startgRPCServer(Config config) {
     GrpcPipelineManager::getInstance().init(config.maxConcurrentWorkload, config.maxPipelineLifetime, config.logSeverity);
+    GrpcPipelineManager::getInstance().setWarmPipelinesPerConfig(config.warmPipelinesPerConfig);
+    GrpcPipelineManager::getInstance().setClientShares(parseClientShares(config.clientShares));
     GrpcPipelineManager::getInstance().start(config.pipelineManagerPoolSize);
     GrpcServer::CommConfig commConfig;
     commConfig.serverAddr = config.httpServerAddr + ":" + std::to_string(config.gRPCServerPort);
-    commConfig.threadPoolSize = 1;
+    commConfig.threadPoolSize = config.gRPCThreadCount;
+    commConfig.replyQueueDepth = config.gRPCReplyQueueDepth;
     GrpcServer::getInstance().init(commConfig);
     GrpcServer::getInstance().start();
     if(g_running.load(std::memory_order_acquire)){
@@ -148,6 +207,8 @@ int main(int argc, char* argv[]){
 
     Logger::init(config.logDir, config.logMaxFileCount, config.logMaxFileSize, config.logSeverity);
 
+    LatencyTracer::getInstance().setEnabled(config.traceEnable);
+
     std::thread t1([config](){startHTTPServer(config);});
     std::thread t2([config](){startgRPCServer(config);});
     t1.join();
@@ -13,6 +13,7 @@
 */
 
 #include "low_latency_server/pipelineManager.hpp"
+#include "common/latency_tracer.hpp"
 
 namespace hce{
 
@@ -20,7 +21,7 @@ namespace ai{
 
 namespace inference{
 
-PipelineManager::PipelineManager(): m_state(Stopped), m_handleCtr(HANDLE_START_INDEX), m_currentWorkloadWeight(0),
+PipelineManager::PipelineManager(): m_state(Stopped), m_resourceEpoch(0u), m_virtualClock(0.0), m_handleCtr(HANDLE_START_INDEX), m_currentWorkloadWeight(0),
         m_pipelinePool(PIPELINE_POOL_INIT_COUNT, 0), m_maxConcurrentWorkload(0u), m_maxPipelineLifetime(30u) {
     hvaLogger.setLogLevel(hva::hvaLogger_t::LogLevel::DEBUG);
     hvaLogger.enableProfiling();
@@ -37,6 +38,19 @@ uint64_t PipelineManager::healthCheck() const{
     return m_watchdogVal.load(std::memory_order_acquire);
 }
 
+void PipelineManager::setClientShares(const std::unordered_map<std::string, double>& clientShares){
+    std::lock_guard<std::mutex> lg(m_waitingQueueMutex);
+    m_clientShares.clear();
+    for(const auto& item: clientShares){
+        if(item.second <= 0.0){
+            _WRN("Invalid share {} of client {}, required: > 0. Ignored", item.second, item.first);
+            continue;
+        }
+        m_clientShares.emplace(item.first, item.second);
+        _INF("Client {} share sets to {}", item.first, item.second);
+    }
+}
+
 /**
  * @brief initialize pipeline_manager with MaxConcurrentWorkload
  * @param MaxConcurrentWorkload
@@ -139,10 +153,94 @@ bool PipelineManager::acquireResourceByWorkloadWeight(unsigned weightToAcquire){
 void PipelineManager::releaseResourceByWorkloadWeight(unsigned weightToRelease){
     m_currentWorkloadWeight.fetch_sub(weightToRelease);
     HVA_ASSERT(m_currentWorkloadWeight >= 0);
-    m_waitingQueueCv.notify_all(); // notify cv so that those blocked by few of resource can try again
+    notifyResourceEvent(); // so that those blocked by few of resource can try again
     _DBG("Released workload resource by {}. Now {}", weightToRelease, m_currentWorkloadWeight);
 }
 
+/**
+ * @brief wake up tasks deferred for lack of resources, they are put ahead of newer tasks
+*/
+void PipelineManager::registerTracedNodes(hva::hvaPipeline_t& pipeline, const std::string& pipelineConfig, Handle jobHandle){
+    if(!LatencyTracer::getInstance().enabled()){
+        return;
+    }
+    // stream ids restart from 0 in each pipeline, stages recorded by the nodes are keyed by the job handle as well
+    try{
+        boost::property_tree::ptree config;
+        std::stringstream ss(pipelineConfig);
+        boost::property_tree::read_json(ss, config);
+        for(const auto& node: config.get_child("Nodes")){
+            LatencyTracer::getInstance().registerNode(&pipeline.getNodeHandle(node.second.get<std::string>("Node Name")),
+                                                      jobHandle);
+        }
+    } catch(std::exception& e){
+        _WRN("Unable to register the nodes of pipeline with handle {} for latency tracing: {}", jobHandle, e.what());
+    }
+}
+
+void PipelineManager::unregisterTracedNodes(Handle jobHandle){
+    LatencyTracer::getInstance().unregisterPipeline(jobHandle);
+}
+
+void PipelineManager::notifyResourceEvent(){
+    {
+        std::lock_guard<std::mutex> lg(m_waitingQueueMutex);
+        ++m_resourceEpoch;
+        m_waitingQueue.splice(m_waitingQueue.begin(), m_deferredQueue);
+    }
+    m_waitingQueueCv.notify_all();
+}
+
+/**
+ * @brief weighted fair queueing among clients within each priority
+*/
+std::list<PipelineManager::Task::Ptr, boost::fast_pool_allocator<PipelineManager::Task::Ptr>>::iterator PipelineManager::selectNextTask(){
+    auto virtualTime = [this](const std::string& clientId){
+        auto iter = m_clientVirtualTime.find(clientId);
+        return iter == m_clientVirtualTime.end() ? m_virtualClock : std::max(iter->second, m_virtualClock);
+    };
+
+    auto best = m_waitingQueue.begin();
+    if(best == m_waitingQueue.end()){
+        return best;
+    }
+    double bestVirtualTime = virtualTime((*best)->clientId);
+    for(auto iter = std::next(best); iter != m_waitingQueue.end(); ++iter){
+        if((*iter)->priority > (*best)->priority){
+            continue;
+        }
+        double curVirtualTime = virtualTime((*iter)->clientId);
+        if((*iter)->priority < (*best)->priority || curVirtualTime < bestVirtualTime){
+            best = iter;
+            bestVirtualTime = curVirtualTime;
+        }
+    }
+    m_virtualClock = bestVirtualTime;
+    return best;
+}
+
+void PipelineManager::chargeClient(const std::string& clientId, double cost){
+    auto share = m_clientShares.find(clientId);
+    double clientShare = share == m_clientShares.end() ? 1.0 : share->second;
+
+    auto iter = m_clientVirtualTime.find(clientId);
+    if(iter == m_clientVirtualTime.end()){
+        iter = m_clientVirtualTime.emplace(clientId, m_virtualClock).first;
+    }
+    else if(iter->second < m_virtualClock){
+        // clients idle for a while do not accumulate credits
+        iter->second = m_virtualClock;
+    }
+    iter->second += cost / clientShare;
+
+    if(m_clientVirtualTime.size() > CLIENT_VIRTUAL_TIME_PRUNE_SIZE){
+        // those would restart from m_virtualClock anyway
+        for(auto item = m_clientVirtualTime.begin(); item != m_clientVirtualTime.end(); ){
+            item = item->second <= m_virtualClock ? m_clientVirtualTime.erase(item) : std::next(item);
+        }
+    }
+}
+
 }
 
 }
@@ -0,0 +1,222 @@
+/*
+ * INTEL CONFIDENTIAL
+ *
+ * Copyright (C) 2024 Intel Corporation.
+ *
+ * This software and the related documents are Intel copyrighted materials, and your use of
+ * them is governed by the express license under which they were provided to you (License).
+ * Unless the License provides otherwise, you may not use, modify, copy, publish, distribute,
+ * disclose or transmit this software or the related documents without Intel's prior written permission.
+ *
+ * This software and the related documents are provided as is, with no express or implied warranties,
+ * other than those that are expressly stated in the License.
+*/
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string_view>
+#include <sys/stat.h>
+
+#include "common/logger.hpp"
+#include "low_latency_server/resultCache.hpp"
+
+namespace hce{
+
+namespace ai{
+
+namespace inference{
+
+namespace{
+
+inline uint64_t fnv1a(uint64_t hash, const void* data, std::size_t size){
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+    for(std::size_t i = 0; i < size; ++i){
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ull;
+    }
+    return hash;
+}
+
+inline uint64_t combine(uint64_t seed, uint64_t value){
+    return seed ^ (value + 0x9E3779B97F4A7C15ull + (seed << 6) + (seed >> 2));
+}
+
+inline bool readFile(const std::string& path, std::string& content){
+    std::ifstream ifs(path, std::ios::in | std::ios::binary);
+    if(!ifs){
+        return false;
+    }
+    std::ostringstream oss;
+    oss << ifs.rdbuf();
+    content = oss.str();
+    return true;
+}
+
+inline uint64_t nowMs(){
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}
+
+ResultCache::ResultCache():m_capacity(0u), m_ttlMs(0u), m_hits(0u), m_misses(0u), m_insertions(0u),
+        m_expirations(0u), m_evictionsBase(0u){
+
+}
+
+ResultCache::~ResultCache(){
+
+}
+
+ResultCache& ResultCache::getInstance(){
+    static ResultCache inst;
+    return inst;
+}
+
+void ResultCache::init(std::size_t capacityBytes, unsigned ttlSeconds){
+    m_capacity = capacityBytes;
+    m_ttlMs = (uint64_t)ttlSeconds * 1000;
+    m_cache.reset();
+    if(m_capacity > 0){
+        m_cache.reset(new ShardedLRUCache<Key, Entry, KeyHash>(m_capacity, RESULT_CACHE_SHARD_COUNT,
+                [](const Key&, const Entry& entry){ return entry.result->size() + RESULT_CACHE_ENTRY_OVERHEAD; }));
+        _INF("Result cache enabled with capacity {} bytes, ttl {}s", m_capacity, ttlSeconds);
+    }
+    m_hits = m_misses = m_insertions = m_expirations = m_evictionsBase = 0;
+}
+
+ResultCache::Key ResultCache::makeKey(const std::string& pipelineConfig, const std::vector<std::string>& mediaUris,
+                                      std::vector<std::string>& contentFiles){
+    Key key;
+    key.configHash = std::hash<std::string>()(pipelineConfig);
+    key.mediaHash = 0xCBF29CE484222325ull;
+    key.mediaCheck = mediaUris.size();
+    contentFiles.clear();
+    for(const auto& uri: mediaUris){
+        key.mediaHash = fnv1a(key.mediaHash, uri.data(), uri.size());
+        key.mediaCheck = combine(key.mediaCheck, std::hash<std::string>()(uri));
+
+        // a short uri naming an existing file. Inline media is far longer than any path
+        struct stat st;
+        if(uri.size() < 4096 && 0 == stat(uri.c_str(), &st) && S_ISREG(st.st_mode)){
+            // tagged with the file version, only metadata is read here
+            uint64_t version[4] = {(uint64_t)st.st_size, (uint64_t)st.st_ino, (uint64_t)st.st_mtim.tv_sec,
+                                   (uint64_t)st.st_mtim.tv_nsec};
+            key.mediaHash = fnv1a(key.mediaHash, version, sizeof(version));
+            key.mediaCheck = combine(key.mediaCheck, std::hash<std::string_view>()(
+                    std::string_view(reinterpret_cast<const char*>(version), sizeof(version))));
+            if((std::size_t)st.st_size <= RESULT_CACHE_CONTENT_HASH_MAX_SIZE){
+                // mtime may be too coarse to tell a file rewritten within the same tick, large files e.g. videos
+                // are trusted by their version
+                contentFiles.push_back(uri);
+            }
+        }
+        // separator, so that uris {"ab", "c"} and {"a", "bc"} differ
+        key.mediaHash = fnv1a(key.mediaHash, "\n", 1);
+    }
+    return key;
+}
+
+bool ResultCache::hashContent(const std::vector<std::string>& files, uint64_t& hash){
+    hash = 0xCBF29CE484222325ull;
+    std::string content;
+    for(const auto& file: files){
+        if(!readFile(file, content)){
+            return false;
+        }
+        uint64_t size = content.size();
+        hash = fnv1a(hash, &size, sizeof(size));
+        hash = fnv1a(hash, content.data(), content.size());
+    }
+    return true;
+}
+
+bool ResultCache::lookup(const Key& key, const std::vector<std::string>& contentFiles, std::string& result){
+    if(!enabled()){
+        return false;
+    }
+    Entry entry;
+    bool expired = false;
+    bool hit = m_cache->try_get(key, entry, [this, &expired](const Entry& cached){
+        expired = m_ttlMs > 0 && nowMs() - cached.insertTime > m_ttlMs;
+        return !expired;
+    });
+    if(hit && !contentFiles.empty()){
+        // read only on a hit, a miss runs the pipeline anyway
+        uint64_t contentHash;
+        hit = hashContent(contentFiles, contentHash) && contentHash == entry.contentHash;
+    }
+    if(!hit){
+        ++m_misses;
+        if(expired){
+            ++m_expirations;
+        }
+        return false;
+    }
+    ++m_hits;
+    // copy outside of the cache lock, the entry may be evicted meanwhile
+    result = *entry.result;
+    return true;
+}
+
+void ResultCache::insert(const Key& key, const std::vector<std::string>& contentFiles, const std::string& result){
+    if(!enabled()){
+        return;
+    }
+    uint64_t contentHash;
+    if(!hashContent(contentFiles, contentHash)){
+        _WRN("Result not cached as the media files can not be read");
+        return;
+    }
+    // identical requests in flight at the same time replace each other, keeping the latest result
+    if(m_cache->put(key, {std::make_shared<const std::string>(result), nowMs(), contentHash})){
+        ++m_insertions;
+    }
+}
+
+void ResultCache::clear(){
+    if(enabled()){
+        m_cache->clear();
+        m_evictionsBase = m_cache->evictions();
+    }
+    m_hits = m_misses = m_insertions = m_expirations = 0;
+}
+
+ResultCache::Stats ResultCache::getStats(){
+    Stats stats = Stats();
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    stats.insertions = m_insertions;
+    stats.expirations = m_expirations;
+    stats.capacity = m_capacity;
+    if(enabled()){
+        stats.evictions = m_cache->evictions() - m_evictionsBase;
+        stats.entries = m_cache->size();
+        stats.bytes = m_cache->cost();
+    }
+    return stats;
+}
+
+std::string ResultCache::exportStats(){
+    Stats stats = getStats();
+    uint64_t lookups = stats.hits + stats.misses;
+    std::stringstream ss;
+    ss << "{\n"
+       << "    \"hits\": " << stats.hits << ",\n"
+       << "    \"misses\": " << stats.misses << ",\n"
+       << "    \"hit_ratio\": " << (lookups > 0 ? (double)stats.hits / lookups : 0.0) << ",\n"
+       << "    \"insertions\": " << stats.insertions << ",\n"
+       << "    \"evictions\": " << stats.evictions << ",\n"
+       << "    \"expirations\": " << stats.expirations << ",\n"
+       << "    \"entries\": " << stats.entries << ",\n"
+       << "    \"bytes\": " << stats.bytes << ",\n"
+       << "    \"capacity\": " << stats.capacity << "\n"
+       << "}\n";
+    return ss.str();
+}
+
+}
+
+}
+
+}
@@ -13,6 +13,7 @@
 */
 
 #include "modules/inference_util/detection/detection_post_processor.hpp"
+#include "modules/inference_util/detection/detection_simd_kernel.hpp"
 
 
 namespace hce{
@@ -342,6 +343,12 @@ AnchorTransformProcessor::AnchorTransformProcessor(
 
     // params.bbox_prediction.pred_bbox_wh.scale_h
     m_bbox_predition.pred_bbox_wh.scale_h = pred_bbox_wh_items["scale_h"].get<float>();
+
+    // cells are rejected on raw outputs, sigmoid is never evaluated for them
+    m_raw_conf_thresh = m_output_sigmoid_activation
+                            ? detection_simd::inverseSigmoidThreshold(m_model_output_cfg.conf_thresh)
+                            : m_model_output_cfg.conf_thresh;
+    m_decode = selectDecodeKernel();
 }
 
 AnchorTransformProcessor::~AnchorTransformProcessor() {
@@ -357,10 +364,9 @@ void AnchorTransformProcessor::process(std::vector<float*>& inputs) {
     if(inputs.size() == 0) {
         return;
     }
-    std::vector<std::vector<float>> voutputs;
+    std::vector<float> voutputs;
     std::vector<float*> outputs;
     
-    std::vector<int> location_index = m_model_output_cfg.detection_output.location_index;
     int confidence_index = m_model_output_cfg.detection_output.confidence_index;
     int first_class_prob_index =
         m_model_output_cfg.detection_output.first_class_prob_index;
@@ -368,123 +374,212 @@ void AnchorTransformProcessor::process(std::vector<float*>& inputs) {
     // for sanity
     HVA_ASSERT(confidence_index >= 0 || first_class_prob_index >= 0);
 
-    int num_classes = m_model_output_cfg.num_classes;
-    int detection_output_size = m_model_output_cfg.detection_output.size;
+    size_t detection_output_size = m_model_output_cfg.detection_output.size;
 
     // for sanity
     if (m_model_output_cfg.detection_output.bbox_format != DetBBoxFormat_t::CENTER_SIZE) {
         throw std::invalid_argument(
             "AnchorTransform only support for detection_output.bbox_format with CENTER_SIZE!");
     }
+    if (m_decode == nullptr) {
+        char log[512];
+        sprintf(log,
+                "Invalid model_output layput: DetOutputDimsLayout_t %d "
+                "recieved for processor: %s",
+                (int)m_model_output_cfg.layout, ProcessorName().c_str());
+        throw std::invalid_argument(log);
+    }
 
     // parse data in  output layer to bounding boxes
     for (auto& data : inputs) {
-        for (size_t anchor_index = 0; anchor_index < m_anchors.size(); ++anchor_index) {
-            const float anchor_scale_w = m_anchors[anchor_index].first;
-            const float anchor_scale_h = m_anchors[anchor_index].second;
-
-            for (size_t cell_index_x = 0; cell_index_x < m_out_feature.first; ++cell_index_x) {
-                for (size_t cell_index_y = 0; cell_index_y < m_out_feature.second; ++cell_index_y) {
-                    
-                    float confidence = 1.0;
-                    if (confidence_index >= 0) {
-                        confidence = trySigmoid(data[getIndex(confidence_index, anchor_index, cell_index_x, cell_index_y)]);
-                        // early filter bboxes with low confidence
-                        if (confidence < m_model_output_cfg.conf_thresh) {
-                            continue;
-                        }
-                    }
+        (this->*m_decode)(data, voutputs);
 
-                    // obj class_prob exists, update confidence witho bbox_conf * class_prob
-                    if (first_class_prob_index >= 0) {
-                        float max_cls_prob = data[getIndex(first_class_prob_index, anchor_index, cell_index_x, cell_index_y)];
-                        for (size_t cls_idx = 1; cls_idx < num_classes; cls_idx ++) {
-                            
-                            const float bbox_class_prob = data[getIndex(first_class_prob_index + cls_idx, anchor_index, cell_index_x, cell_index_y)];
-                            max_cls_prob = bbox_class_prob > max_cls_prob ? bbox_class_prob : max_cls_prob;
-                        }
-                        confidence = confidence * trySigmoid(max_cls_prob);
-                        // early filter bboxes with low confidence
-                        if (confidence < m_model_output_cfg.conf_thresh) {
-                            continue;
-                        }
-                    }
+        // reuse the data pointer to save processed detection_outputs 
+        size_t num_outputs = voutputs.size() / detection_output_size;
+        memcpy(data, voutputs.data(), voutputs.size() * sizeof(data[0]));
+        for (size_t idx = 0; idx < num_outputs; idx ++) {
+            outputs.push_back(data + idx * detection_output_size);
+        }
+    }
+    inputs = outputs;
+}
 
-                    // 
-                    // @brief anchor transform for yolo series
-                    // > (x, y) - coordinates of box center
-                    // > (h, w) - height and width of box, apply exponential function and multiply them by 
-                    //          the corresponding anchors to get the absolute height and width values 
-                    // 
-                    
-                    // get raw data from output blob
-                    float raw_x_center = trySigmoid(data[getIndex(location_index[0], anchor_index, cell_index_x, cell_index_y)]);
-                    float raw_y_center = trySigmoid(data[getIndex(location_index[1], anchor_index, cell_index_x, cell_index_y)]);
-                    float raw_w = trySigmoid(data[getIndex(location_index[2], anchor_index, cell_index_x, cell_index_y)]);
-                    float raw_h = trySigmoid(data[getIndex(location_index[3], anchor_index, cell_index_x, cell_index_y)]);
-
-                    // grid offset, i.e. y = factor * x + grid_offset
-                    // in YoloV2/V3, factor = 1.0, grid_offset = 0
-                    // in YoloV5, factor = 2.0, grid_offset = -0.5
-                    auto pred_bbox_xy = m_bbox_predition.pred_bbox_xy;
-                    const float bbox_x_center =
-                        (cell_index_x + raw_x_center * pred_bbox_xy.factor +
-                        pred_bbox_xy.grid_offset) /
-                        pred_bbox_xy.scale_w;
-                    const float bbox_y_center =
-                        (cell_index_y + raw_y_center * pred_bbox_xy.factor +
-                        pred_bbox_xy.grid_offset) /
-                        pred_bbox_xy.scale_h;
-                        
-                    // in YoloV2/V3, factor = 1.0, transform function is exponential
-                    // in YoloV5, factor = 2.0, transform function is square
-                    auto pred_bbox_wh = m_bbox_predition.pred_bbox_wh;
-                    const float bbox_w = (tryTransform(raw_w * pred_bbox_wh.factor) * anchor_scale_w) / pred_bbox_wh.scale_w;
-                    const float bbox_h = (tryTransform(raw_h * pred_bbox_wh.factor) * anchor_scale_h) / pred_bbox_wh.scale_h;
-
-                    // center to corner
-                    const float bbox_x = bbox_x_center - bbox_w / 2;
-                    const float bbox_y = bbox_y_center - bbox_h / 2;
-
-                    // assemble pure detection_outputs
-                    std::vector<float> vdata(detection_output_size);
-                    for (size_t det_idx = 0; det_idx < detection_output_size; det_idx ++) {
-
-                        // update bbox predictions
-                        if (det_idx == location_index[0]) {
-                            vdata[det_idx] = m_clip_normalized_rect ? clipNormalizedVal(bbox_x) : bbox_x;
-                        }
-                        else if (det_idx == location_index[1]) {
-                            vdata[det_idx] = m_clip_normalized_rect ? clipNormalizedVal(bbox_y) : bbox_y;
-                        }
-                        else if (det_idx == location_index[2]) {
-                            vdata[det_idx] = m_clip_normalized_rect ? clipNormalizedVal(bbox_w) : bbox_w;
-                        }
-                        else if (det_idx == location_index[3]) {
-                            vdata[det_idx] = m_clip_normalized_rect ? clipNormalizedVal(bbox_h) : bbox_h;
-                        }
-                        else {
-                            // sigmoid (if need) other fields in detection_outputs
-                            vdata[det_idx] = trySigmoid(data[getIndex(det_idx, anchor_index, cell_index_x, cell_index_y)]);
-                        }
-                    }
-                    voutputs.push_back(vdata);
-                }
-                int a = 0;
+/**
+ * @brief select the decode kernel according to model_proc, called once at construction
+*/
+AnchorTransformProcessor::DecodeFunc AnchorTransformProcessor::selectDecodeKernel() {
+
+    using Layout = DetOutputDimsLayout_t;
+    using Func = TransfromFunction_t;
+    const bool exponential = m_bbox_predition.pred_bbox_wh.function == Func::EXPONENTIAL;
+
+    switch (m_model_output_cfg.layout) {
+        case Layout::BCxCy:
+            if (m_output_sigmoid_activation) {
+                return exponential ? &AnchorTransformProcessor::decode<Layout::BCxCy, true, Func::EXPONENTIAL>
+                                   : &AnchorTransformProcessor::decode<Layout::BCxCy, true, Func::SQUARE>;
+            }
+            return exponential ? &AnchorTransformProcessor::decode<Layout::BCxCy, false, Func::EXPONENTIAL>
+                               : &AnchorTransformProcessor::decode<Layout::BCxCy, false, Func::SQUARE>;
+        case Layout::CxCyB:
+            if (m_output_sigmoid_activation) {
+                return exponential ? &AnchorTransformProcessor::decode<Layout::CxCyB, true, Func::EXPONENTIAL>
+                                   : &AnchorTransformProcessor::decode<Layout::CxCyB, true, Func::SQUARE>;
+            }
+            return exponential ? &AnchorTransformProcessor::decode<Layout::CxCyB, false, Func::EXPONENTIAL>
+                               : &AnchorTransformProcessor::decode<Layout::CxCyB, false, Func::SQUARE>;
+        default:
+            // layout B does not need anchor transform, reported at process()
+            return nullptr;
+    }
+}
+
+/**
+ * @brief scan the objectness (or class-max) plane first, then decode and class-reduce
+ *  only the surviving cells.
+ *  > Step1. SIMD thresholding on raw outputs in memory order, sigmoid is skipped for rejected cells
+ *  > Step2. survivors are re-ordered to (cell_x, cell_y) as the reference implementation does
+ *  > Step3. exact confidence check, class-max and bbox decode on survivors
+*/
+template <DetOutputDimsLayout_t Layout, bool Sigmoid, AnchorTransformProcessor::TransfromFunction_t Transform>
+void AnchorTransformProcessor::decode(const float* data, std::vector<float>& decoded) {
+
+    const std::vector<int>& location_index = m_model_output_cfg.detection_output.location_index;
+    const int confidence_index = m_model_output_cfg.detection_output.confidence_index;
+    const int first_class_prob_index =
+        m_model_output_cfg.detection_output.first_class_prob_index;
+    const size_t num_classes = m_model_output_cfg.num_classes;
+    const size_t detection_output_size = m_model_output_cfg.detection_output.size;
+    const float conf_thresh = m_model_output_cfg.conf_thresh;
+
+    const size_t feature_w = m_out_feature.first;
+    const size_t feature_h = m_out_feature.second;
+    const size_t feature_size = feature_w * feature_h;
+    // distance between two adjacent cells / two adjacent fields of the same cell
+    const size_t cell_stride = Layout == DetOutputDimsLayout_t::BCxCy ? 1 : m_anchors.size() * detection_output_size;
+    const size_t field_stride = Layout == DetOutputDimsLayout_t::BCxCy ? feature_size : 1;
+
+    const auto pred_bbox_xy = m_bbox_predition.pred_bbox_xy;
+    const auto pred_bbox_wh = m_bbox_predition.pred_bbox_wh;
+
+    std::vector<uint32_t> cells;
+    std::vector<float> cls_max_plane;
+    cells.reserve(feature_size);
+
+    for (size_t anchor_index = 0; anchor_index < m_anchors.size(); ++anchor_index) {
+        const float anchor_scale_w = m_anchors[anchor_index].first;
+        const float anchor_scale_h = m_anchors[anchor_index].second;
+        const float* anchor_data = data + getIndex<Layout>(0, anchor_index, 0);
+
+        // 
+        // Step1. early reject cells on raw outputs
+        // 
+        cells.clear();
+        if (confidence_index >= 0) {
+            detection_simd::collectCandidatesStrided(anchor_data + confidence_index * field_stride,
+                                                     feature_size, cell_stride, m_raw_conf_thresh, cells);
+        }
+        else if (Layout == DetOutputDimsLayout_t::BCxCy && num_classes > 0) {
+            // no objectness, class planes are contiguous: reduce them element-wise first
+            cls_max_plane.resize(feature_size);
+            detection_simd::planeMax(anchor_data + first_class_prob_index * field_stride, field_stride,
+                                     num_classes, feature_size, cls_max_plane.data());
+            detection_simd::collectCandidates(cls_max_plane.data(), feature_size, m_raw_conf_thresh, cells);
+        }
+        else {
+            for (uint32_t cell = 0; cell < feature_size; cell ++) {
+                cells.push_back(cell);
             }
         }
 
-        // reuse the data pointer to save processed detection_outputs 
-        for (size_t idx = 0; idx < voutputs.size(); idx ++) {
-            
-            size_t offset = idx * detection_output_size;
-            memset(data + offset, 0, detection_output_size * sizeof(data[0]));
-            memcpy(data + offset, voutputs[idx].data(), detection_output_size * sizeof(data[0]));
+        // 
+        // Step2. keep the (cell_x, cell_y) output order of the reference implementation
+        // 
+        if (feature_w > 1) {
+            std::sort(cells.begin(), cells.end(), [feature_w, feature_h](uint32_t a, uint32_t b) {
+                return (a % feature_w) * feature_h + a / feature_w < (b % feature_w) * feature_h + b / feature_w;
+            });
+        }
+
+        // 
+        // Step3. decode surviving cells
+        // 
+        for (uint32_t cell : cells) {
+            const size_t cell_index_x = cell % feature_w;
+            const size_t cell_index_y = cell / feature_w;
+            const float* cell_data = anchor_data + cell * cell_stride;
 
-            outputs.push_back(data + offset);
+            float confidence = 1.0;
+            if (confidence_index >= 0) {
+                confidence = trySigmoid<Sigmoid>(cell_data[confidence_index * field_stride]);
+                // early filter bboxes with low confidence
+                if (confidence < conf_thresh) {
+                    continue;
+                }
+            }
+
+            // obj class_prob exists, update confidence witho bbox_conf * class_prob
+            if (first_class_prob_index >= 0) {
+                float max_cls_prob = confidence_index < 0 && !cls_max_plane.empty()
+                                         ? cls_max_plane[cell]
+                                         : detection_simd::stridedMax(cell_data + first_class_prob_index * field_stride,
+                                                                      field_stride, num_classes);
+                confidence = confidence * trySigmoid<Sigmoid>(max_cls_prob);
+                // early filter bboxes with low confidence
+                if (confidence < conf_thresh) {
+                    continue;
+                }
+            }
+
+            // 
+            // @brief anchor transform for yolo series
+            // > (x, y) - coordinates of box center
+            // > (h, w) - height and width of box, apply exponential function and multiply them by 
+            //          the corresponding anchors to get the absolute height and width values 
+            // 
+            
+            // get raw data from output blob
+            float raw_x_center = trySigmoid<Sigmoid>(cell_data[location_index[0] * field_stride]);
+            float raw_y_center = trySigmoid<Sigmoid>(cell_data[location_index[1] * field_stride]);
+            float raw_w = trySigmoid<Sigmoid>(cell_data[location_index[2] * field_stride]);
+            float raw_h = trySigmoid<Sigmoid>(cell_data[location_index[3] * field_stride]);
+
+            // grid offset, i.e. y = factor * x + grid_offset
+            // in YoloV2/V3, factor = 1.0, grid_offset = 0
+            // in YoloV5, factor = 2.0, grid_offset = -0.5
+            const float bbox_x_center =
+                (cell_index_x + raw_x_center * pred_bbox_xy.factor +
+                pred_bbox_xy.grid_offset) /
+                pred_bbox_xy.scale_w;
+            const float bbox_y_center =
+                (cell_index_y + raw_y_center * pred_bbox_xy.factor +
+                pred_bbox_xy.grid_offset) /
+                pred_bbox_xy.scale_h;
+                
+            // in YoloV2/V3, factor = 1.0, transform function is exponential
+            // in YoloV5, factor = 2.0, transform function is square
+            const float bbox_w = (tryTransform<Transform>(raw_w * pred_bbox_wh.factor) * anchor_scale_w) / pred_bbox_wh.scale_w;
+            const float bbox_h = (tryTransform<Transform>(raw_h * pred_bbox_wh.factor) * anchor_scale_h) / pred_bbox_wh.scale_h;
+
+            // center to corner
+            const float bbox_x = bbox_x_center - bbox_w / 2;
+            const float bbox_y = bbox_y_center - bbox_h / 2;
+
+            // assemble pure detection_outputs
+            size_t offset = decoded.size();
+            decoded.resize(offset + detection_output_size);
+            float* vdata = decoded.data() + offset;
+            for (size_t det_idx = 0; det_idx < detection_output_size; det_idx ++) {
+                // sigmoid (if need) other fields in detection_outputs
+                vdata[det_idx] = trySigmoid<Sigmoid>(cell_data[det_idx * field_stride]);
+            }
+            // update bbox predictions
+            vdata[location_index[0]] = m_clip_normalized_rect ? clipNormalizedVal(bbox_x) : bbox_x;
+            vdata[location_index[1]] = m_clip_normalized_rect ? clipNormalizedVal(bbox_y) : bbox_y;
+            vdata[location_index[2]] = m_clip_normalized_rect ? clipNormalizedVal(bbox_w) : bbox_w;
+            vdata[location_index[3]] = m_clip_normalized_rect ? clipNormalizedVal(bbox_h) : bbox_h;
         }
     }
-    inputs = outputs;
 }
 
 /**
@@ -517,45 +612,33 @@ AnchorTransformProcessor::checkFunctions(std::string func_name) {
 /**
  * @brief get output index in blob data
  * @param index  index of detection output field, such as: [x, y, w, h, class_0, class_1, ...]
- *
+ * @param cell_index  cell_index_y * feature_w + cell_index_x
 */
-size_t AnchorTransformProcessor::getIndex(size_t index, size_t anchor_index, size_t cell_index_x, size_t cell_index_y) {
+template <DetOutputDimsLayout_t Layout>
+size_t AnchorTransformProcessor::getIndex(size_t index, size_t anchor_index, size_t cell_index) const {
 
-    size_t feature_w = m_out_feature.first;
-    size_t feature_h = m_out_feature.second;
-    size_t feature_size = feature_w * feature_h;                        // e.g, 13*13
+    size_t feature_size = m_out_feature.first * m_out_feature.second;  // e.g, 13*13
     size_t box_size = m_model_output_cfg.detection_output.size;         // e.g, len([x, y, w, h, class_0, class_1, ...]) = 85
     size_t num_anchors = m_anchors.size();                              // num anchors
 
-    switch (m_model_output_cfg.layout) {
-        case DetOutputDimsLayout_t::BCxCy:
-            {
-                // offset for each proposal
-                size_t offset = anchor_index * box_size * feature_size + cell_index_y * feature_w + cell_index_x;
-                return index * feature_size + offset;
-            }
-        case DetOutputDimsLayout_t::CxCyB:
-            {
-                // offset for each proposal
-                size_t offset = (cell_index_y * feature_w + cell_index_x) * num_anchors * box_size + anchor_index * box_size;
-                return offset + index;
-            }
-            default: {
-                char log[512];
-                sprintf(log,
-                        "Invalid model_output layput: DetOutputDimsLayout_t %d "
-                        "recieved for processor: %s",
-                        (int)m_model_output_cfg.layout, ProcessorName().c_str());
-                throw std::invalid_argument(log);
-            } break;
+    if (Layout == DetOutputDimsLayout_t::BCxCy) {
+        // offset for each proposal
+        size_t offset = anchor_index * box_size * feature_size + cell_index;
+        return index * feature_size + offset;
+    }
+    else {
+        // offset for each proposal
+        size_t offset = cell_index * num_anchors * box_size + anchor_index * box_size;
+        return offset + index;
     }
 }
 
 /**
-     * @brief sigmoid(x) if m_output_sigmoid_activation = true
-    */
+ * @brief sigmoid(x) if Sigmoid = true
+*/
+template <bool Sigmoid>
 float AnchorTransformProcessor::trySigmoid(float x) {
-    if (m_output_sigmoid_activation)
+    if (Sigmoid)
         return 1 / (1 + std::exp(-x));
     else
         return x;
@@ -564,18 +647,12 @@ float AnchorTransformProcessor::trySigmoid(float x) {
 /**
  * @brief transform function apply on x according to the function type
 */
+template <AnchorTransformProcessor::TransfromFunction_t Transform>
 float AnchorTransformProcessor::tryTransform(float x) {
-    switch (m_bbox_predition.pred_bbox_wh.function) {
-        case TransfromFunction_t::EXPONENTIAL:
-            return std::exp(x);
-        case TransfromFunction_t::SQUARE:
-            return std::pow(x, 2);
-        default:
-            throw std::invalid_argument(
-                "Unknown bbox transform function is specified in model_proc, "
-                "supported: " +
-                supportedTransformFuncs());
-    }
+    if (Transform == TransfromFunction_t::EXPONENTIAL)
+        return std::exp(x);
+    else
+        return std::pow(x, 2);
 }
 
 /**
@@ -608,6 +685,35 @@ NMSProcessor::NMSProcessor(
         iter.value().get_to(m_apply_to_layer);
     }
 
+    NMSEngine::Config config;
+    config.iou_threshold = m_iou_threshold;
+
+    // optional: soft_nms, hard NMS is used by default
+    if (JsonReader::check_item(params, "soft_nms")) {
+        auto soft_nms_items = params.at("soft_nms");
+        std::vector<std::string> soft_nms_fields = {"method"};
+        JsonReader::check_required_item(soft_nms_items, soft_nms_fields);
+
+        std::string method = soft_nms_items["method"].get<std::string>();
+        if (method == "linear") {
+            config.soft_nms_method = NMSEngine::SoftNMSMethod_t::LINEAR;
+        }
+        else if (method == "gaussian") {
+            config.soft_nms_method = NMSEngine::SoftNMSMethod_t::GAUSSIAN;
+        }
+        else {
+            throw std::invalid_argument(
+                "Unknown soft_nms method is specified in model_proc: " + method +
+                ", supported: [linear, gaussian]");
+        }
+        if (JsonReader::check_item(soft_nms_items, "sigma")) {
+            config.soft_nms_sigma = soft_nms_items["sigma"].get<float>();
+        }
+        if (JsonReader::check_item(soft_nms_items, "score_threshold")) {
+            config.soft_nms_score_threshold = soft_nms_items["score_threshold"].get<float>();
+        }
+    }
+    m_engine = NMSEngine(config);
 }
 
 NMSProcessor::~NMSProcessor() {
@@ -616,7 +722,7 @@ NMSProcessor::~NMSProcessor() {
 
 /**
  * @brief process with specified Processor instance
- *  Step1. format inputs to std::vector<NMSRect>
+ *  Step1. format inputs to NMSEngine::Workspace
  *  Step2. carry out NMS (depends on class_agnostic)
  * @param input
  */
@@ -633,9 +739,7 @@ void NMSProcessor::process(std::vector<float*>& inputs) {
     //         "NMS do not support for bbox_format: CORNER_SIZE, please transform bboxes at previous!");
     // }
 
-    std::vector<float*> outputs;
-    
-    std::vector<int> location_index = m_model_output_cfg.detection_output.location_index;
+    const std::vector<int>& location_index = m_model_output_cfg.detection_output.location_index;
     int confidence_index = m_model_output_cfg.detection_output.confidence_index;
     int first_class_prob_index =
         m_model_output_cfg.detection_output.first_class_prob_index;
@@ -645,175 +749,102 @@ void NMSProcessor::process(std::vector<float*>& inputs) {
 
     int num_classes = m_model_output_cfg.num_classes;
 
-    if (m_class_agnostic) {
-        // carry out class-agnostic NMS
+    // some model outputs with predicted label_id, but some are not.
+    int predict_label_index =
+        m_model_output_cfg.detection_output.predict_label_index;
 
-        std::vector<NMSRect> objects;
-        // traverse each detection_output
-        for (size_t input_index = 0; input_index < inputs.size(); input_index ++) {
+    if (!m_class_agnostic && predict_label_index < 0 && first_class_prob_index < 0) {
+        // None class-aware information exists in model_output
+        // NMS only can be processed with "class_agnostic" = false
+        throw std::invalid_argument(
+            "None class-aware information exists in model_output, NMS only "
+            "can be processed with class_agnostic = false");
+    }
+
+    // processors are shared by all workers of a node, buffers are kept per thread
+    static thread_local NMSEngine::Workspace workspace;
+    workspace.clear();
 
-            auto data = inputs[input_index];
+    // traverse each detection_output
+    for (size_t input_index = 0; input_index < inputs.size(); input_index ++) {
 
-            NMSRect rect;
-            rect.x = data[location_index[0]];
-            rect.y = data[location_index[1]];
-            rect.w = data[location_index[2]];
-            rect.h = data[location_index[3]];
-            rect.origin_index = input_index;
+        const float* data = inputs[input_index];
 
+        float confidence = 1.0;
+        int label_id = 0;
+        if (!m_class_agnostic && predict_label_index >= 0) {
+            // predict_label exists in model_output
             if (confidence_index >= 0) {
-                rect.confidence = data[confidence_index];
+                confidence = data[confidence_index];
+            }
+            else {
+                // use obj class_prob
+                confidence = data[first_class_prob_index + predict_label_index];
+            }
+            label_id = (int)data[predict_label_index];
+        }
+        else {
+            if (confidence_index >= 0) {
+                confidence = data[confidence_index];
             }
 
             // obj class_prob exists, update confidence witho bbox_conf * class_prob
             if (first_class_prob_index >= 0) {
-                std::vector<float> cls_confidence(
-                    data + first_class_prob_index,
-                    data + first_class_prob_index + num_classes);
-                float max_cls_prob = *(std::max_element(cls_confidence.begin(), cls_confidence.end()));
-                rect.confidence = rect.confidence * max_cls_prob;
+                const float* cls_confidence = data + first_class_prob_index;
+                label_id = (int)std::distance(cls_confidence, std::max_element(cls_confidence, cls_confidence + num_classes));
+                confidence = confidence * cls_confidence[label_id];
             }
-
-            objects.push_back(rect);
         }
 
-        runNMS(objects);
-        for (auto& obj : objects) {
-            outputs.push_back(inputs[obj.origin_index]);
-        }
-        inputs = outputs;
+        workspace.push(data[location_index[0]], data[location_index[1]],
+                       data[location_index[2]], data[location_index[3]],
+                       confidence, label_id);
     }
-    else {
 
-        // some model outputs with predicted label_id, but some are not.
-        int predict_label_index =
-            m_model_output_cfg.detection_output.predict_label_index;
+    m_engine.run(workspace, m_class_agnostic);
 
-        // 
-        // splits inputs into groups according to predicted label
-        //
-
-        // key: label_id, val: objects before nms
-        std::unordered_map<int, std::vector<NMSRect>> class_aware_objects;
-        
-        if (predict_label_index >= 0) {
-            // predict_label exists in model_output
-
-            std::vector<NMSRect> objects;
-            for (size_t input_index = 0; input_index < inputs.size(); input_index ++) {
-
-                auto data = inputs[input_index];
-
-                NMSRect rect;
-                rect.x = data[location_index[0]];
-                rect.y = data[location_index[1]];
-                rect.w = data[location_index[2]];
-                rect.h = data[location_index[3]];
-                rect.origin_index = input_index;
-
-                if (confidence_index >= 0) {
-                    rect.confidence = data[confidence_index];
-                }
-                else {
-                    // use obj class_prob
-                    rect.confidence = data[first_class_prob_index + predict_label_index];
-                }
-
-                int label_id = (int)data[predict_label_index];
-                if (class_aware_objects.count(label_id) == 0) {
-                  class_aware_objects.emplace(label_id, std::vector<NMSRect>());
-                }
-                class_aware_objects[label_id].push_back(rect);
-            }
-        } else if (first_class_prob_index >= 0) {
-            // class-agnostic confidence score exists in model_output
-
-            std::vector<NMSRect> objects;
-            for (size_t input_index = 0; input_index < inputs.size(); input_index ++) {
-
-                auto data = inputs[input_index];
-
-                NMSRect rect;
-                rect.x = data[location_index[0]];
-                rect.y = data[location_index[1]];
-                rect.w = data[location_index[2]];
-                rect.h = data[location_index[3]];
-                rect.origin_index = input_index;
-
-                if (confidence_index >= 0) {
-                    rect.confidence = data[confidence_index];
-                }
-
-                std::vector<float> cls_confidence(
-                    data + first_class_prob_index,
-                    data + first_class_prob_index + num_classes);
-                int label_id = ModelOutputOperator::argmax(cls_confidence);
-                float max_cls_prob = data[first_class_prob_index + label_id];
-                rect.confidence = rect.confidence * max_cls_prob;
-
-                // create category key
-                if (class_aware_objects.count(label_id) == 0) {
-                  class_aware_objects.emplace(label_id, std::vector<NMSRect>());
-                }
-                class_aware_objects[label_id].push_back(rect);
-            }
-        } else {
-            // None class-aware information exists in model_output
-            // NMS only can be processed with "class_agnostic" = false
-            throw std::invalid_argument(
-                "None class-aware information exists in model_output, NMS only "
-                "can be processed with class_agnostic = false");
-        }
-
-        // carry out class-aware NMS
-        for (auto& item : class_aware_objects) {
-            auto objects = item.second;
-            runNMS(objects);
-            for (auto& obj : objects) {
-                outputs.push_back(inputs[obj.origin_index]);
-            }
-        }
-        inputs = outputs;
+    if (m_engine.config().soft_nms_method != NMSEngine::SoftNMSMethod_t::NONE) {
+        applySoftScores(inputs, workspace);
     }
 
+    std::vector<float*> outputs;
+    outputs.reserve(workspace.kept.size());
+    for (int index : workspace.kept) {
+        outputs.push_back(inputs[index]);
+    }
+    inputs = outputs;
 }
 
 /**
-* @brief Do Non Maximum Suppression on a set of proposals wirh pre-defined iou_threshold
-* @param candidates a set of detected objects
-* @return objects after NMS
+ * @brief write soft-NMS decayed scores back to the confidence fields of detection_output
+ *  > the objectness is scaled if exists, otherwise the class probabilities are scaled,
+ *    so that argmax and yolo_multiply mapping ops observe the decayed score
 */
-void NMSProcessor::runNMS(std::vector<NMSRect>& candidates) {
-
-    std::sort(candidates.begin(), candidates.end(), [&](const NMSRect a, const NMSRect b) {
-        return a.confidence > b.confidence;
-    });
-
-    for (auto p_first_candidate = candidates.begin(); p_first_candidate != candidates.end(); ++p_first_candidate) {
-        const auto &first_candidate = *p_first_candidate;
-        double first_candidate_area = first_candidate.w * first_candidate.h;
+void NMSProcessor::applySoftScores(std::vector<float*>& inputs, const NMSEngine::Workspace& ws) {
 
-        for (auto p_candidate = p_first_candidate + 1; p_candidate != candidates.end();) {
-
-            const auto &candidate = *p_candidate;
+    int confidence_index = m_model_output_cfg.detection_output.confidence_index;
+    int first_class_prob_index =
+        m_model_output_cfg.detection_output.first_class_prob_index;
+    int predict_label_index =
+        m_model_output_cfg.detection_output.predict_label_index;
+    int num_classes = m_model_output_cfg.num_classes;
 
-            double inter_width = std::min(first_candidate.x + first_candidate.w, candidate.x + candidate.w) -
-                                std::max(first_candidate.x, candidate.x);
-            double inter_height = std::min(first_candidate.y + first_candidate.h, candidate.y + candidate.h) -
-                                std::max(first_candidate.y, candidate.y);
-            if (inter_width <= 0.0 || inter_height <= 0.0) {
-                ++p_candidate;
-                continue;
+    for (int index : ws.kept) {
+        if (ws.score[index] == 0.0f || ws.soft_score[index] == ws.score[index]) {
+            continue;
+        }
+        float decay = ws.soft_score[index] / ws.score[index];
+        float* data = inputs[index];
+        if (confidence_index >= 0) {
+            data[confidence_index] *= decay;
+        }
+        else if (!m_class_agnostic && predict_label_index >= 0) {
+            data[first_class_prob_index + predict_label_index] *= decay;
+        }
+        else {
+            for (int cls_idx = 0; cls_idx < num_classes; cls_idx ++) {
+                data[first_class_prob_index + cls_idx] *= decay;
             }
-
-            double inter_area = inter_width * inter_height;
-            double candidate_area = candidate.w * candidate.h;
-
-            double overlap = inter_area / (candidate_area + first_candidate_area - inter_area);
-            if (overlap > m_iou_threshold)
-                p_candidate = candidates.erase(p_candidate);
-            else
-                ++p_candidate;
         }
     }
 }
@@ -0,0 +1,416 @@
+/*
+ * INTEL CONFIDENTIAL
+ *
+ * Copyright (C) 2024 Intel Corporation.
+ *
+ * This software and the related documents are Intel copyrighted materials, and your use of
+ * them is governed by the express license under which they were provided to you (License).
+ * Unless the License provides otherwise, you may not use, modify, copy, publish, distribute,
+ * disclose or transmit this software or the related documents without Intel's prior written permission.
+ *
+ * This software and the related documents are provided as is, with no express or implied warranties,
+ * other than those that are expressly stated in the License.
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "modules/inference_util/detection/nms_engine.hpp"
+
+namespace hce{
+
+namespace ai{
+
+namespace inference{
+
+// labels in [0, MAX_DIRECT_LABEL) are mapped to class slots through a direct table
+static constexpr size_t MAX_DIRECT_LABEL = 4096;
+
+void NMSEngine::Workspace::clear() {
+    x.clear();
+    y.clear();
+    x2.clear();
+    y2.clear();
+    area.clear();
+    score.clear();
+    label.clear();
+}
+
+/**
+ * @brief append one candidate in (x, y, w, h) format
+*/
+void NMSEngine::Workspace::push(float bx, float by, float bw, float bh, float confidence, int class_label) {
+    x.push_back(bx);
+    y.push_back(by);
+    x2.push_back(bx + bw);
+    y2.push_back(by + bh);
+    area.push_back(bw * bh);
+    score.push_back(confidence);
+    label.push_back(class_label);
+}
+
+NMSEngine::NMSEngine(const Config& config) : m_config(config) {
+
+}
+
+/**
+ * @brief run NMS on all candidates in workspace
+*/
+void NMSEngine::run(Workspace& ws, bool class_agnostic) const {
+
+    std::vector<int>& kept = ws.kept;
+    kept.clear();
+    if (ws.size() == 0) {
+        return;
+    }
+
+    groupByClass(ws, class_agnostic);
+    if (m_config.soft_nms_method != SoftNMSMethod_t::NONE) {
+        ws.soft_score.assign(ws.score.begin(), ws.score.end());
+    }
+
+    size_t num_segments = ws.segment_begin.size() - 1;
+    for (size_t seg = 0; seg < num_segments; seg ++) {
+        int begin = ws.segment_begin[seg];
+        int end = ws.segment_begin[seg + 1];
+
+        // same comparator as the reference implementation, std::sort on the same input sequence
+        // yields the same permutation, including the order of equal confidences
+        std::sort(ws.order.begin() + begin, ws.order.begin() + end, [&ws](int a, int b) {
+            return ws.score[a] > ws.score[b];
+        });
+
+        // gather sorted SoA
+        for (int pos = begin; pos < end; pos ++) {
+            int idx = ws.order[pos];
+            ws.sx[pos] = ws.x[idx];
+            ws.sy[pos] = ws.y[idx];
+            ws.sx2[pos] = ws.x2[idx];
+            ws.sy2[pos] = ws.y2[idx];
+            ws.sarea[pos] = ws.area[idx];
+            ws.sscore[pos] = ws.score[idx];
+            ws.removed[pos] = 0;
+        }
+
+        if (m_config.soft_nms_method != SoftNMSMethod_t::NONE) {
+            softSweep(ws, begin, end, kept);
+        }
+        else if ((size_t)(end - begin) < m_config.grid_min_candidates ||
+                 !sweepWithGrid(ws, begin, end, kept)) {
+            sweep(ws, begin, end, kept);
+        }
+    }
+}
+
+/**
+ * @brief group candidates by label with a stable counting sort
+*/
+void NMSEngine::groupByClass(Workspace& ws, bool class_agnostic) const {
+
+    const int num = (int)ws.size();
+    ws.order.resize(num);
+    ws.sx.resize(num);
+    ws.sy.resize(num);
+    ws.sx2.resize(num);
+    ws.sy2.resize(num);
+    ws.sarea.resize(num);
+    ws.sscore.resize(num);
+    ws.removed.resize(num);
+
+    if (class_agnostic) {
+        for (int i = 0; i < num; i ++) {
+            ws.order[i] = i;
+        }
+        ws.segment_begin.assign({0, num});
+        return;
+    }
+
+    // label -> slot, slots are assigned in the order of first appearance.
+    // labels are class ids in practice, a direct table is used for them
+    auto slotOf = [&ws](int label) {
+        size_t key = (size_t)label;
+        if (label >= 0 && key < MAX_DIRECT_LABEL) {
+            if (key >= ws.label_slot.size()) {
+                ws.label_slot.resize(key + 1, -1);
+            }
+            if (ws.label_slot[key] < 0) {
+                ws.label_slot[key] = (int)ws.slot_label.size();
+                ws.slot_label.push_back(label);
+            }
+            return ws.label_slot[key];
+        }
+        auto iter = std::find(ws.slot_label.begin(), ws.slot_label.end(), label);
+        if (iter == ws.slot_label.end()) {
+            ws.slot_label.push_back(label);
+            return (int)ws.slot_label.size() - 1;
+        }
+        return (int)std::distance(ws.slot_label.begin(), iter);
+    };
+
+    ws.slot_label.clear();
+    ws.slot_of.resize(num);
+    ws.segment_begin.clear();
+    for (int i = 0; i < num; i ++) {
+        int slot = slotOf(ws.label[i]);
+        if ((size_t)slot >= ws.segment_begin.size()) {
+            ws.segment_begin.push_back(0);
+        }
+        ws.segment_begin[slot] ++;
+        ws.slot_of[i] = slot;
+    }
+
+    // counts to offsets
+    int offset = 0;
+    for (auto& count : ws.segment_begin) {
+        int c = count;
+        count = offset;
+        offset += c;
+    }
+    ws.segment_begin.push_back(offset);
+
+    // stable scatter, candidates of one class keep their input order
+    ws.cursor.assign(ws.segment_begin.begin(), ws.segment_begin.end() - 1);
+    for (int i = 0; i < num; i ++) {
+        ws.order[ws.cursor[ws.slot_of[i]] ++] = i;
+    }
+
+    // reset only the touched entries of the direct table
+    for (int label : ws.slot_label) {
+        size_t key = (size_t)label;
+        if (label >= 0 && key < ws.label_slot.size()) {
+            ws.label_slot[key] = -1;
+        }
+    }
+}
+
+/**
+ * @brief IoU between sorted positions i and j
+*/
+double NMSEngine::iou(const Workspace& ws, int i, int j) {
+    // operands ordered to match std::min / std::max of the reference implementation
+    double inter_width = std::min(ws.sx2[i], ws.sx2[j]) - std::max(ws.sx[i], ws.sx[j]);
+    double inter_height = std::min(ws.sy2[i], ws.sy2[j]) - std::max(ws.sy[i], ws.sy[j]);
+    if (inter_width <= 0.0 || inter_height <= 0.0) {
+        return 0.0;
+    }
+
+    double inter_area = inter_width * inter_height;
+    double first_candidate_area = ws.sarea[i];
+    double candidate_area = ws.sarea[j];
+
+    return inter_area / (candidate_area + first_candidate_area - inter_area);
+}
+
+/**
+ * @brief exact IoU test between sorted positions i and j, matches the reference implementation
+*/
+bool NMSEngine::overlapped(const Workspace& ws, int i, int j) const {
+    return iou(ws, i, j) > m_config.iou_threshold;
+}
+
+/**
+ * @brief hard NMS over one sorted segment, brute-force sweep
+ *  > intersection width / height of box i against 8 (AVX2) or 4 (SSE2) boxes at a time,
+ *    only boxes with positive intersection are tested with the exact double precision IoU
+*/
+void NMSEngine::sweep(Workspace& ws, int begin, int end, std::vector<int>& kept) const {
+
+    for (int i = begin; i < end; i ++) {
+        if (ws.removed[i]) {
+            continue;
+        }
+        kept.push_back(ws.order[i]);
+
+        int j = i + 1;
+#if defined(__AVX2__)
+        const __m256 vx = _mm256_set1_ps(ws.sx[i]);
+        const __m256 vy = _mm256_set1_ps(ws.sy[i]);
+        const __m256 vx2 = _mm256_set1_ps(ws.sx2[i]);
+        const __m256 vy2 = _mm256_set1_ps(ws.sy2[i]);
+        const __m256 zero = _mm256_setzero_ps();
+        for (; j + 8 <= end; j += 8) {
+            // min(a, b) = b < a ? b : a, max(a, b) = a < b ? b : a
+            __m256 iw = _mm256_sub_ps(_mm256_min_ps(_mm256_loadu_ps(&ws.sx2[j]), vx2),
+                                      _mm256_max_ps(_mm256_loadu_ps(&ws.sx[j]), vx));
+            __m256 ih = _mm256_sub_ps(_mm256_min_ps(_mm256_loadu_ps(&ws.sy2[j]), vy2),
+                                      _mm256_max_ps(_mm256_loadu_ps(&ws.sy[j]), vy));
+            int mask = _mm256_movemask_ps(_mm256_and_ps(_mm256_cmp_ps(iw, zero, _CMP_GT_OQ),
+                                                        _mm256_cmp_ps(ih, zero, _CMP_GT_OQ)));
+            while (mask) {
+                int k = j + __builtin_ctz(mask);
+                mask &= mask - 1;
+                if (!ws.removed[k] && overlapped(ws, i, k)) {
+                    ws.removed[k] = 1;
+                }
+            }
+        }
+#elif defined(__SSE2__)
+        const __m128 vx = _mm_set1_ps(ws.sx[i]);
+        const __m128 vy = _mm_set1_ps(ws.sy[i]);
+        const __m128 vx2 = _mm_set1_ps(ws.sx2[i]);
+        const __m128 vy2 = _mm_set1_ps(ws.sy2[i]);
+        const __m128 zero = _mm_setzero_ps();
+        for (; j + 4 <= end; j += 4) {
+            // min(a, b) = b < a ? b : a, max(a, b) = a < b ? b : a
+            __m128 iw = _mm_sub_ps(_mm_min_ps(_mm_loadu_ps(&ws.sx2[j]), vx2),
+                                   _mm_max_ps(_mm_loadu_ps(&ws.sx[j]), vx));
+            __m128 ih = _mm_sub_ps(_mm_min_ps(_mm_loadu_ps(&ws.sy2[j]), vy2),
+                                   _mm_max_ps(_mm_loadu_ps(&ws.sy[j]), vy));
+            int mask = _mm_movemask_ps(_mm_and_ps(_mm_cmpgt_ps(iw, zero), _mm_cmpgt_ps(ih, zero)));
+            while (mask) {
+                int k = j + __builtin_ctz(mask);
+                mask &= mask - 1;
+                if (!ws.removed[k] && overlapped(ws, i, k)) {
+                    ws.removed[k] = 1;
+                }
+            }
+        }
+#endif
+        for (; j < end; j ++) {
+            if (!ws.removed[j] && overlapped(ws, i, j)) {
+                ws.removed[j] = 1;
+            }
+        }
+    }
+}
+
+/**
+ * @brief hard NMS over one sorted segment, candidates are visited through a uniform grid
+ *  > each box is registered in every cell it covers, two boxes with positive intersection
+ *    always share at least one cell, so the kept set is identical to the full sweep
+*/
+bool NMSEngine::sweepWithGrid(Workspace& ws, int begin, int end, std::vector<int>& kept) const {
+
+    const int num = end - begin;
+    float min_x = ws.sx[begin], max_x = ws.sx2[begin];
+    float min_y = ws.sy[begin], max_y = ws.sy2[begin];
+    for (int pos = begin; pos < end; pos ++) {
+        if (!std::isfinite(ws.sx[pos]) || !std::isfinite(ws.sy[pos]) ||
+            !std::isfinite(ws.sx2[pos]) || !std::isfinite(ws.sy2[pos])) {
+            return false;
+        }
+        min_x = std::min(min_x, ws.sx[pos]);
+        max_x = std::max(max_x, ws.sx2[pos]);
+        min_y = std::min(min_y, ws.sy[pos]);
+        max_y = std::max(max_y, ws.sy2[pos]);
+    }
+    if (!(max_x > min_x) || !(max_y > min_y)) {
+        return false;
+    }
+
+    // about 4 boxes per cell on average
+    const int grid = std::max(2, std::min(64, (int)std::sqrt((float)num / 4)));
+    const float scale_x = grid / (max_x - min_x);
+    const float scale_y = grid / (max_y - min_y);
+    auto cellOf = [grid](float v, float origin, float scale) {
+        int c = (int)std::floor((v - origin) * scale);
+        return std::max(0, std::min(grid - 1, c));
+    };
+
+    // count, prefix-sum, fill: positions are inserted in increasing order per cell
+    ws.box_cells.resize((size_t)num * 4);
+    ws.cell_begin.assign((size_t)grid * grid + 1, 0);
+    for (int pos = begin; pos < end; pos ++) {
+        int* cells = &ws.box_cells[(size_t)(pos - begin) * 4];
+        cells[0] = cellOf(ws.sx[pos], min_x, scale_x);
+        cells[1] = cellOf(ws.sx2[pos], min_x, scale_x);
+        cells[2] = cellOf(ws.sy[pos], min_y, scale_y);
+        cells[3] = cellOf(ws.sy2[pos], min_y, scale_y);
+        for (int cy = cells[2]; cy <= cells[3]; cy ++) {
+            for (int cx = cells[0]; cx <= cells[1]; cx ++) {
+                ws.cell_begin[cy * grid + cx + 1] ++;
+            }
+        }
+    }
+    for (size_t c = 1; c < ws.cell_begin.size(); c ++) {
+        ws.cell_begin[c] += ws.cell_begin[c - 1];
+    }
+    ws.cell_items.resize(ws.cell_begin.back());
+    ws.cursor.assign(ws.cell_begin.begin(), ws.cell_begin.end() - 1);
+    for (int pos = begin; pos < end; pos ++) {
+        const int* cells = &ws.box_cells[(size_t)(pos - begin) * 4];
+        for (int cy = cells[2]; cy <= cells[3]; cy ++) {
+            for (int cx = cells[0]; cx <= cells[1]; cx ++) {
+                ws.cell_items[ws.cursor[cy * grid + cx] ++] = pos;
+            }
+        }
+    }
+
+    for (int i = begin; i < end; i ++) {
+        if (ws.removed[i]) {
+            continue;
+        }
+        kept.push_back(ws.order[i]);
+
+        const int* cells = &ws.box_cells[(size_t)(i - begin) * 4];
+        for (int cy = cells[2]; cy <= cells[3]; cy ++) {
+            for (int cx = cells[0]; cx <= cells[1]; cx ++) {
+                int c = cy * grid + cx;
+                auto first = ws.cell_items.begin() + ws.cell_begin[c];
+                auto last = ws.cell_items.begin() + ws.cell_begin[c + 1];
+                // only boxes after i in sorted order can be suppressed by i
+                for (auto iter = std::upper_bound(first, last, i); iter != last; ++iter) {
+                    int j = *iter;
+                    if (!ws.removed[j] && overlapped(ws, i, j)) {
+                        ws.removed[j] = 1;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief soft-NMS over one segment
+ *  > the box with highest (decayed) score is kept at each step, scores of the remaining boxes
+ *    are decayed by their IoU with it, boxes below soft_nms_score_threshold are dropped
+*/
+void NMSEngine::softSweep(Workspace& ws, int begin, int end, std::vector<int>& kept) const {
+
+    for (int step = begin; step < end; step ++) {
+        int best = -1;
+        for (int pos = begin; pos < end; pos ++) {
+            if (!ws.removed[pos] && (best < 0 || ws.sscore[pos] > ws.sscore[best])) {
+                best = pos;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+        ws.removed[best] = 1;
+        ws.soft_score[ws.order[best]] = ws.sscore[best];
+        kept.push_back(ws.order[best]);
+
+        for (int pos = begin; pos < end; pos ++) {
+            if (ws.removed[pos]) {
+                continue;
+            }
+            double overlap = iou(ws, best, pos);
+            if (overlap <= 0.0) {
+                continue;
+            }
+            double weight = 1.0;
+            if (m_config.soft_nms_method == SoftNMSMethod_t::LINEAR) {
+                weight = overlap > m_config.iou_threshold ? 1.0 - overlap : 1.0;
+            }
+            else {
+                weight = std::exp(-(overlap * overlap) / m_config.soft_nms_sigma);
+            }
+            ws.sscore[pos] = (float)(ws.sscore[pos] * weight);
+            if (ws.sscore[pos] < m_config.soft_nms_score_threshold) {
+                ws.removed[pos] = 1;
+            }
+        }
+    }
+}
+
+}   // namespace inference
+
+}   // namespace ai
+
+}   // namespace hce
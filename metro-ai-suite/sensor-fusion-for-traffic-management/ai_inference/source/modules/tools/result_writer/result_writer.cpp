@@ -0,0 +1,549 @@
+/*
+ * INTEL CONFIDENTIAL
+ *
+ * Copyright (C) 2024 Intel Corporation.
+ *
+ * This software and the related documents are Intel copyrighted materials, and your use of
+ * them is governed by the express license under which they were provided to you (License).
+ * Unless the License provides otherwise, you may not use, modify, copy, publish, distribute,
+ * disclose or transmit this software or the related documents without Intel's prior written permission.
+ *
+ * This software and the related documents are provided as is, with no express or implied warranties,
+ * other than those that are expressly stated in the License.
+*/
+
+#include <fstream>
+#include <cinttypes>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unordered_map>
+#include <boost/filesystem.hpp>
+
+#include <inc/api/hvaLogger.hpp>
+
+#include "modules/tools/result_writer/result_writer.hpp"
+
+namespace hce{
+
+namespace ai{
+
+namespace inference{
+
+namespace tools{
+
+ResultFile::~ResultFile() {
+    // the last reference is dropped after the writer is done with the file
+    if (m_fp) {
+        fclose(m_fp);
+        m_fp = nullptr;
+    }
+}
+
+AsyncResultWriter& AsyncResultWriter::getInstance() {
+    static AsyncResultWriter instance;
+    return instance;
+}
+
+AsyncResultWriter::AsyncResultWriter() : m_busy(false), m_stop(false) {
+    m_thread = std::thread(&AsyncResultWriter::run, this);
+}
+
+AsyncResultWriter::~AsyncResultWriter() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_notEmpty.notify_all();
+    m_notFull.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+ResultFile::Ptr AsyncResultWriter::open(const std::string& path, const std::vector<ResultColumn>& columns) {
+    return std::make_shared<ResultFile>(path, columns);
+}
+
+bool AsyncResultWriter::append(const ResultFile::Ptr& file, ResultRecord&& record) {
+    if (!file || file->failed()) {
+        return false;
+    }
+    push({file, std::move(record.finish()), false, 0});
+    return true;
+}
+
+void AsyncResultWriter::close(const ResultFile::Ptr& file) {
+    if (!file) {
+        return;
+    }
+    push({file, std::string(), true, 0});
+}
+
+void AsyncResultWriter::flush() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_drained.wait(lock, [this]() { return m_queue.empty() && !m_busy; });
+}
+
+void AsyncResultWriter::flush(const ResultFile::Ptr& file) {
+    if (!file) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(m_mutex);
+    uint64_t fence = file->m_queued;
+    m_drained.wait(lock, [&]() { return file->m_written >= fence; });
+}
+
+void AsyncResultWriter::push(Task&& task) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_notFull.wait(lock, [this]() { return m_queue.size() < RESULT_WRITER_QUEUE_SIZE || m_stop; });
+    task.seq = ++ task.file->m_queued;
+    m_queue.push_back(std::move(task));
+    lock.unlock();
+    m_notEmpty.notify_one();
+}
+
+void AsyncResultWriter::run() {
+    std::deque<Task> batch;
+    std::vector<ResultFile::Ptr> written;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_busy = false;
+            if (m_queue.empty()) {
+                m_drained.notify_all();
+            }
+            m_notEmpty.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+            if (m_queue.empty()) {
+                // stopped and drained
+                break;
+            }
+            batch.swap(m_queue);
+            m_busy = true;
+        }
+        m_notFull.notify_all();
+
+        for (auto& task : batch) {
+            ResultFile& file = *task.file;
+            if (task.close) {
+                if (file.m_fp) {
+                    fclose(file.m_fp);
+                    file.m_fp = nullptr;
+                }
+                continue;
+            }
+            if (file.m_failed.load()) {
+                continue;
+            }
+            if (write(file, task.data) && (written.empty() || written.back() != task.file)) {
+                written.push_back(task.file);
+            }
+        }
+
+        // one flush per file and batch
+        for (auto& file : written) {
+            if (file->m_fp) {
+                fflush(file->m_fp);
+            }
+        }
+        written.clear();
+
+        // tasks are queued in order, the last task of each file in the batch fences all its earlier ones
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (auto& task : batch) {
+                task.file->m_written = task.seq;
+            }
+        }
+        m_drained.notify_all();
+        batch.clear();
+    }
+}
+
+bool AsyncResultWriter::write(ResultFile& file, const std::string& data) {
+    if (!file.m_fp && !createFile(file)) {
+        file.m_failed.store(true);
+        return false;
+    }
+    if (fwrite(data.data(), 1, data.size(), file.m_fp) != data.size()) {
+        HVA_ERROR("Failed to write result file: %s !", file.m_path.c_str());
+        file.m_failed.store(true);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief open the file for appending, the header is written if the file is new. An existing file is appended to
+ * only if it starts with the same header, e.g. re-opened after close(), otherwise it is truncated, as records of
+ * other columns or versions, or a csv file left from previous releases, would make the whole file unreadable
+*/
+bool AsyncResultWriter::createFile(ResultFile& file) {
+    std::string header(RESULT_FILE_MAGIC, sizeof(RESULT_FILE_MAGIC));
+    uint32_t version = RESULT_FILE_VERSION;
+    uint32_t columnCount = (uint32_t)file.m_columns.size();
+    header.append((const char*)&version, sizeof(version));
+    header.append((const char*)&columnCount, sizeof(columnCount));
+    for (const auto& column : file.m_columns) {
+        uint8_t type = column.type;
+        uint16_t nameLength = (uint16_t)column.name.size();
+        header.append((const char*)&type, sizeof(type));
+        header.append((const char*)&column.flags, sizeof(column.flags));
+        header.append((const char*)&column.groupSize, sizeof(column.groupSize));
+        header.append((const char*)&nameLength, sizeof(nameLength));
+        header.append(column.name);
+    }
+
+    bool append = false;
+    try {
+        boost::filesystem::path path(file.m_path);
+        boost::filesystem::path folder = path.parent_path();
+        if (!folder.empty() && !boost::filesystem::exists(folder)) {
+            HVA_INFO("Folder not exists, create: %s", folder.c_str());
+            boost::filesystem::create_directories(folder);
+        }
+        if (boost::filesystem::exists(path) && boost::filesystem::file_size(path) > 0) {
+            std::string existing(header.size(), '\0');
+            std::ifstream in(file.m_path, std::ios::in | std::ios::binary);
+            append = in.read(&existing[0], existing.size()) && existing == header;
+            if (!append) {
+                HVA_WARNING("Result file %s has a different header, truncated", file.m_path.c_str());
+            }
+        }
+    }
+    catch (const std::exception &e) {
+        HVA_ERROR("Failed to prepare result file: %s, error: %s", file.m_path.c_str(), e.what());
+        return false;
+    }
+
+    file.m_fp = fopen(file.m_path.c_str(), append ? "ab" : "wb");
+    if (!file.m_fp) {
+        HVA_ERROR("Failed to open result file: %s !", file.m_path.c_str());
+        return false;
+    }
+    setvbuf(file.m_fp, nullptr, _IOFBF, RESULT_WRITER_FILE_BUFFER_SIZE);
+    if (append) {
+        return true;
+    }
+
+    if (fwrite(header.data(), 1, header.size(), file.m_fp) != header.size()) {
+        HVA_ERROR("Failed to write header of result file: %s !", file.m_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool ResultPayloadCursor::skip(ResultColumnType type) {
+    size_t len = 0;
+    switch (type) {
+        case RESULT_COLUMN_INT32:
+        case RESULT_COLUMN_UINT32:
+        case RESULT_COLUMN_FLOAT32:
+            len = 4;
+            break;
+        case RESULT_COLUMN_INT64:
+        case RESULT_COLUMN_UINT64:
+        case RESULT_COLUMN_FLOAT64:
+            len = 8;
+            break;
+        default: {
+            uint32_t strLen = 0;
+            if (!get(strLen)) {
+                return false;
+            }
+            len = strLen;
+            break;
+        }
+    }
+    if (m_left < len) {
+        return false;
+    }
+    m_data += len;
+    m_left -= len;
+    return true;
+}
+
+MappedResultFile::~MappedResultFile() {
+    if (m_data) {
+        munmap((void*)m_data, m_size);
+    }
+}
+
+bool MappedResultFile::isResultFile(const std::string& path) {
+    char magic[sizeof(RESULT_FILE_MAGIC)];
+    std::ifstream in(path, std::ios::in | std::ios::binary);
+    if (!in.read(magic, sizeof(magic))) {
+        return false;
+    }
+    return 0 == std::memcmp(magic, RESULT_FILE_MAGIC, sizeof(magic));
+}
+
+bool MappedResultFile::open(const std::string& path, std::string& error) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "failed to open " + path;
+        return false;
+    }
+    struct stat st;
+    if (0 != fstat(fd, &st) || st.st_size <= 0) {
+        ::close(fd);
+        error = "not a result file";
+        return false;
+    }
+    void* addr = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (MAP_FAILED == addr) {
+        error = "failed to map " + path;
+        return false;
+    }
+    m_data = (const char*)addr;
+    m_size = (size_t)st.st_size;
+    madvise(addr, m_size, MADV_SEQUENTIAL);
+
+    ResultPayloadCursor header(m_data, m_size);
+    char magic[sizeof(RESULT_FILE_MAGIC)];
+    uint32_t version = 0, columnCount = 0;
+    if (!header.read(magic, sizeof(magic)) || 0 != std::memcmp(magic, RESULT_FILE_MAGIC, sizeof(magic))) {
+        error = "not a result file";
+        return false;
+    }
+    if (!header.get(version) || version != RESULT_FILE_VERSION) {
+        error = "unsupported result file version " + std::to_string(version);
+        return false;
+    }
+    if (!header.get(columnCount)) {
+        error = "truncated header";
+        return false;
+    }
+    for (uint32_t i = 0; i < columnCount; i ++) {
+        uint8_t type = 0, flags = 0;
+        uint16_t groupSize = 0, nameLength = 0;
+        if (!header.get(type) || !header.get(flags) || !header.get(groupSize) ||
+                !header.get(nameLength) || type > RESULT_COLUMN_KEY_VALUE) {
+            error = "malformed column " + std::to_string(i);
+            return false;
+        }
+        std::string name(nameLength, '\0');
+        if (nameLength > 0 && !header.read(&name[0], nameLength)) {
+            error = "truncated header";
+            return false;
+        }
+        m_columns.emplace_back(name, (ResultColumnType)type, flags, groupSize);
+    }
+    m_dataOffset = m_offset = m_size - header.left();
+    return true;
+}
+
+bool MappedResultFile::next(ResultPayloadCursor& payload, std::string& error) {
+    if (m_offset >= m_size) {
+        return false;
+    }
+    uint32_t len = 0;
+    if (m_size - m_offset < sizeof(len)) {
+        error = "truncated record";
+        return false;
+    }
+    std::memcpy(&len, m_data + m_offset, sizeof(len));
+    if (m_size - m_offset - sizeof(len) < len) {
+        error = "truncated record";
+        return false;
+    }
+    payload = ResultPayloadCursor(m_data + m_offset + sizeof(len), len);
+    m_offset += sizeof(len) + len;
+    return true;
+}
+
+namespace {
+
+/**
+ * @brief format one value the same way as std::to_string() did in the sink nodes
+*/
+bool formatValue(ResultPayloadCursor& cursor, ResultColumnType type, std::string& out) {
+    char buf[64];
+    switch (type) {
+        case RESULT_COLUMN_INT32: {
+            int32_t v;
+            if (!cursor.get(v)) return false;
+            snprintf(buf, sizeof(buf), "%" PRId32, v);
+            break;
+        }
+        case RESULT_COLUMN_UINT32: {
+            uint32_t v;
+            if (!cursor.get(v)) return false;
+            snprintf(buf, sizeof(buf), "%" PRIu32, v);
+            break;
+        }
+        case RESULT_COLUMN_INT64: {
+            int64_t v;
+            if (!cursor.get(v)) return false;
+            snprintf(buf, sizeof(buf), "%" PRId64, v);
+            break;
+        }
+        case RESULT_COLUMN_UINT64: {
+            uint64_t v;
+            if (!cursor.get(v)) return false;
+            snprintf(buf, sizeof(buf), "%" PRIu64, v);
+            break;
+        }
+        case RESULT_COLUMN_FLOAT32: {
+            float v;
+            if (!cursor.get(v)) return false;
+            snprintf(buf, sizeof(buf), "%f", v);
+            break;
+        }
+        case RESULT_COLUMN_FLOAT64: {
+            double v;
+            if (!cursor.get(v)) return false;
+            snprintf(buf, sizeof(buf), "%f", v);
+            break;
+        }
+        default: {
+            std::string v;
+            if (!cursor.get(v)) return false;
+            out += v;
+            return true;
+        }
+    }
+    out += buf;
+    return true;
+}
+
+/**
+ * @brief format one record as a csv line, key-value columns are spread over `keys`
+*/
+bool formatRecord(ResultPayloadCursor cursor, const std::vector<ResultColumn>& columns,
+                  const std::vector<std::vector<std::string>>& keys, std::string& line) {
+    line.clear();
+    for (size_t c = 0; c < columns.size(); c ++) {
+        const ResultColumn& column = columns[c];
+        uint32_t count = 0;
+        if (!cursor.get(count)) {
+            return false;
+        }
+
+        if (RESULT_COLUMN_KEY_VALUE == column.type) {
+            std::unordered_map<std::string, std::string> values;
+            for (uint32_t i = 0; i + 1 < count; i += 2) {
+                std::string key, value;
+                if (!cursor.get(key) || !cursor.get(value)) {
+                    return false;
+                }
+                values[key] = value;
+            }
+            for (const auto& key : keys[c]) {
+                auto it = values.find(key);
+                if (it != values.end()) {
+                    line += it->second;
+                }
+                line += ",";
+            }
+            continue;
+        }
+
+        bool isList = column.flags & RESULT_COLUMN_FLAG_LIST;
+        for (uint32_t i = 0; i < count; i ++) {
+            if (!isList && i > 0) {
+                line += " ";
+            }
+            if (!formatValue(cursor, column.type, line)) {
+                return false;
+            }
+            if (isList) {
+                line += " ";
+                if (column.groupSize > 0 && 0 == (i + 1) % column.groupSize) {
+                    // blank value closing a group
+                    line += "  ";
+                }
+            }
+        }
+        line += ",";
+    }
+    return true;
+}
+
+/**
+ * @brief collect the names of key-value columns in order of first appearance
+*/
+bool collectKeys(MappedResultFile& reader, std::vector<std::vector<std::string>>& keys, std::string& error) {
+    const auto& columns = reader.columns();
+    std::vector<std::unordered_map<std::string, size_t>> seen(columns.size());
+    ResultPayloadCursor cursor;
+    while (reader.next(cursor, error)) {
+        for (size_t c = 0; c < columns.size(); c ++) {
+            uint32_t count = 0;
+            if (!cursor.get(count)) {
+                error = "malformed record";
+                return false;
+            }
+            std::string scratch;
+            for (uint32_t i = 0; i < count; i ++) {
+                if (!formatValue(cursor, columns[c].type, scratch)) {
+                    error = "malformed record";
+                    return false;
+                }
+                if (RESULT_COLUMN_KEY_VALUE == columns[c].type && 0 == i % 2) {
+                    if (seen[c].emplace(scratch, keys[c].size()).second) {
+                        keys[c].push_back(scratch);
+                    }
+                }
+                scratch.clear();
+            }
+        }
+    }
+    reader.rewind();
+    return error.empty();
+}
+
+} // namespace
+
+bool convertResultFileToCsv(const std::string& srcPath, std::ostream& dst, std::string& error) {
+    MappedResultFile reader;
+    if (!reader.open(srcPath, error)) {
+        return false;
+    }
+    const auto& columns = reader.columns();
+
+    std::vector<std::vector<std::string>> keys(columns.size());
+    for (const auto& column : columns) {
+        if (RESULT_COLUMN_KEY_VALUE == column.type) {
+            if (!collectKeys(reader, keys, error)) {
+                return false;
+            }
+            break;
+        }
+    }
+
+    std::string line;
+    for (size_t c = 0; c < columns.size(); c ++) {
+        if (RESULT_COLUMN_KEY_VALUE == columns[c].type) {
+            for (const auto& key : keys[c]) {
+                line += key + ",";
+            }
+        }
+        else {
+            line += columns[c].name + ",";
+        }
+    }
+    dst << line << "\n";
+
+    ResultPayloadCursor payload;
+    size_t recordIdx = 0;
+    while (reader.next(payload, error)) {
+        if (!formatRecord(payload, columns, keys, line)) {
+            error = "malformed record " + std::to_string(recordIdx);
+            return false;
+        }
+        dst << line << "\n";
+        recordIdx ++;
+    }
+    return error.empty();
+}
+
+} // namespace tools
+
+} // namespace inference
+
+} // namespace ai
+
+} // namespace hce
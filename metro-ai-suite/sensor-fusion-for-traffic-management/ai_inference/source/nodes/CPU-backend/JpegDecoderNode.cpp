@@ -44,15 +44,6 @@ int readBuffer (void *opaque, std::uint8_t *buf, int buf_size);
  */
 int writeBuffer(void *opaque, std::uint8_t *buf, int buf_size);
 
-/**
- * @brief read dst uint8_t buffer into jpeg decoder
- * @param opaque source buffer for jpeg decoder
- * @param buf dst uint8_t buffer
- * @param buf_size size of `buf`
- * @return actual read buffer size of `buf`
- */
-int feedDecoder (void *opaque, std::uint8_t *buf, int buf_size);
-
 JpegDecoderNode::JpegDecoderNode(std::size_t totalThreadNum)
 :hva::hvaNode_t(1, 1, totalThreadNum) {
     transitStateTo(hva::hvaState_t::configured); 
@@ -99,7 +90,8 @@ void JpegDecoderNodeWorker::init(){
 }
 
 void JpegDecoderNodeWorker::deinit(){
-    return;
+    m_decoder.deinit();
+    HVA_INFO("%s", DecodedFramePool::getInstance()->report().c_str());
 }
 
 /**
@@ -156,10 +148,19 @@ void JpegDecoderNodeWorker::process(std::size_t batchIdx){
             continue;
         }
 
+        // frames given up for newer ones by the backpressure policy are not decoded
+        BackpressureController::Ptr controllerMeta;
+        bool hasController = buf->getMeta(controllerMeta) == hva::hvaSuccess;
+        bool stale = hasController && controllerMeta->isStale(frameIdx);
+        if (stale) {
+            controllerMeta->recordDrop();
+            HVA_DEBUG("Jpeg decoder skips stale frame %d", frameIdx);
+        }
+
         // read image string data from buffer
         std::string tmpJpgStrData = buf->get<std::string>();
         bool decodeSuccess = false;
-        if(!tmpJpgStrData.empty()){
+        if(!stale && !tmpJpgStrData.empty()){
             
             // inherit rois from previous input field
             std::vector<hva::hvaROI_t> rois;
@@ -170,10 +171,8 @@ void JpegDecoderNodeWorker::process(std::size_t batchIdx){
 
             // start to decode image from buffer
             HVA_DEBUG("Jpeg decoder prepares to feed to ffmpeg");
-            unsigned dstHeight, dstWidth, dstBufsize;
-            uint8_t* dst[4];
-            int dstLinesize[4];
-            bool ret = decodeImage(tmpJpgStrData, dst, dstWidth, dstHeight, dstLinesize, dstBufsize);
+            hva::hvaVideoFrameWithROIBuf_t::Ptr hvabuf;
+            bool ret = decodeImage(tmpJpgStrData, hvabuf);
             HVA_DEBUG("Jpeg decoder prepares to feeding ffmpeg done");
             if(!ret) {
                 HVA_DEBUG("OpenImage failed.\n");
@@ -183,15 +182,8 @@ void JpegDecoderNodeWorker::process(std::size_t batchIdx){
 
                 // decoding job done, send to the subsequent nodes
                 HVA_DEBUG("Jpeg decoder encoding image done");
-                hva::hvaVideoFrameWithROIBuf_t::Ptr hvabuf =
-                    hva::hvaVideoFrameWithROIBuf_t::make_buffer<uint8_t*>(
-                        dst[0], dstBufsize, [](uint8_t* p) { av_freep(&p); });
                 hvabuf->frameId = frameIdx;
-                hvabuf->width = dstWidth;
-                hvabuf->height = dstHeight;
-                hvabuf->stride[0] = (unsigned)dstLinesize[0];       // channels * width
                 hvabuf->rois = rois;
-                hvabuf->drop = false;
                 hvabuf->setMeta<uint64_t>(0);
                 hvabuf->tagAs(tag);
                 jpegBlob->frameId = frameIdx;
@@ -225,8 +217,7 @@ void JpegDecoderNodeWorker::process(std::size_t batchIdx){
             jpegBlob->get(0)->setMeta(meta);
             HVA_DEBUG("Jpeg decoder copied meta to next buffer, mediauri: %s", meta.mediaUri.c_str());
         }
-        SendController::Ptr controllerMeta;
-        if(buf->getMeta(controllerMeta) == hva::hvaSuccess){
+        if(hasController){
             jpegBlob->get(0)->setMeta(controllerMeta);
             HVA_DEBUG("Jpeg decoder copied controller meta to next buffer");
         }
@@ -246,154 +237,12 @@ void JpegDecoderNodeWorker::process(std::size_t batchIdx){
 
 /**
  * @brief to decode images from string buffer
+ * the decoder of this worker is kept opened across images
  * @param imageData string buffer
- * @param dst decoded image
- * @param dstWidth decoded image width
- * @param dstHeight decoded image height
- * @param dstBufsize buffer size for decoded image 
+ * @param hvabuf buffer holding the decoded BGR image
  */
-bool JpegDecoderNodeWorker::decodeImage(std::string& imageData, uint8_t* (&dst_data)[4], 
-                                        unsigned& dstWidth, unsigned& dstHeight, 
-                                        int dstLinesize[4], unsigned& dstBufsize) {
-
-    AVFormatContext *pFormatCtx;
-    AVCodecContext *pCodecCtx; 
-    AVFrame *pFrame;
-    AVPacket *packet;          
-    int stream_index = -1;
-    struct SwsContext *img_convert_ctx; 
-
-    #if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(58, 9, 100)
-        av_register_all(); 
-    #endif
-    pFormatCtx = avformat_alloc_context();   
-
-    // Each block is defined as 4KB
-    int len_size = 32768;
-    unsigned char *aviobuffer = (unsigned char *)av_mallocz(len_size);  // freed in avio_close() <-- avformat_close_input()
-
-    // Allocate and initialize an AVIOContext for buffered I/O
-    std::stringstream ss(imageData);
-    AVIOContext *avio = avio_alloc_context(aviobuffer, len_size, 0, &ss, feedDecoder, NULL, NULL);   
-    pFormatCtx->pb = avio;
-    
-    // Open an input stream and read the header.
-	if(avformat_open_input(&pFormatCtx, NULL, NULL, NULL) != 0) {
-		HVA_DEBUG("Couldn't open input stream.\n");
-        avformat_close_input(&pFormatCtx);
-		return false;
-	}
-    pFormatCtx->max_analyze_duration = AV_TIME_BASE;
-	if(avformat_find_stream_info(pFormatCtx, NULL) < 0) {
-		HVA_DEBUG("Couldn't find stream information.\n");
-        avformat_close_input(&pFormatCtx);
-		return false;
-	}
-
-    // Print detailed information about the input or output format
-    av_dump_format(pFormatCtx, 0, "file", 0);
-    stream_index = av_find_best_stream(pFormatCtx, AVMEDIA_TYPE_VIDEO, -1, -1, NULL, 0);
-    if(stream_index < 0) {
-        HVA_DEBUG("Could not find %s stream in input file \n",
-                av_get_media_type_string(AVMEDIA_TYPE_VIDEO));
-        avformat_close_input(&pFormatCtx);
-        return false;
-    }
-
-    // Find a registered decoder with a matching codec ID
-    const AVCodec *pCodec = avcodec_find_decoder(pFormatCtx->streams[stream_index]->codecpar->codec_id);
-    if(pCodec == NULL) {
-        HVA_DEBUG("Codec not found\n");
-        avformat_close_input(&pFormatCtx);
-        return false;
-    }
-
-    // Allocate an AVCodecContext
-    pCodecCtx = avcodec_alloc_context3(pCodec);
-    if(pCodecCtx == NULL) {
-        HVA_DEBUG("Could not allocate video codec context.\n");
-        avformat_close_input(&pFormatCtx);
-        avcodec_free_context(&pCodecCtx);
-        return false;
-    }
-
-    // Fill the codec context based on the values from the supplied codec parameters.
-    if(avcodec_parameters_to_context(pCodecCtx, pFormatCtx->streams[stream_index]->codecpar) < 0) {
-        HVA_DEBUG("Failed to copy codec parameters to decoder context.\n");
-        avformat_close_input(&pFormatCtx);
-        avcodec_free_context(&pCodecCtx);
-        return false;
-    }
-
-    // Initialize the AVCodecContext to use the given AVCodec
-    if(avcodec_open2(pCodecCtx, pCodec, NULL) < 0) {
-        HVA_DEBUG("Could not open codec\n");
-        avformat_close_input(&pFormatCtx);
-        avcodec_free_context(&pCodecCtx);
-        return false;
-    }
-    pFrame = av_frame_alloc();
-    if(!pFrame) {
-        HVA_DEBUG("Can't allocate memory for AVFrame\n");
-        av_frame_free(&pFrame);
-        avformat_close_input(&pFormatCtx);
-        avcodec_free_context(&pCodecCtx);
-        return false;
-    }
-    // packet = (AVPacket *)av_mallocz(sizeof(AVPacket));
-    packet = av_packet_alloc();
-
-    //Read the next frame of a stream to packet
-    while(av_read_frame(pFormatCtx, packet) >= 0) {
-        if(packet->stream_index != stream_index) {
-            continue;
-        }
-        // Supply raw packet data as input to a decoder
-        int ret = avcodec_send_packet(pCodecCtx, packet);
-
-        // return < 0 if the packet is can't decode. 
-        if(ret < 0) {
-            continue;
-        }
-
-        // Get the decoded output data from a decoder.
-        if(avcodec_receive_frame(pCodecCtx, pFrame) == 0){
-            av_packet_unref(packet);
-            break;
-        }
-    }
-    // Free the requested memory space
-    av_packet_unref(packet);
-    av_packet_free(&packet);
-
-    // Save decoded buffer to string
-
-    // align buffer to a multiple of 64
-    pCodecCtx->width = (pCodecCtx->width + 63) & ~63;
-    pFrame->width = (pFrame->width + 63) & ~63;
-
-    dstBufsize = av_image_alloc(dst_data, dstLinesize, pCodecCtx->width, pCodecCtx->height, AV_PIX_FMT_BGR24, 1);
-    memset(dst_data[0], 0, dstBufsize);
-    img_convert_ctx = sws_getContext(pFrame->width, pFrame->height, pCodecCtx->pix_fmt, pCodecCtx->width,
-                       pCodecCtx->height, AV_PIX_FMT_BGR24, SWS_BICUBIC, NULL, NULL, NULL);
-    
-    // color conversion and scaling for decoded image
-    sws_scale(img_convert_ctx, (const uint8_t *const *)pFrame->data, pFrame->linesize, 0,
-              pFrame->height, dst_data, dstLinesize);
-
-    dstHeight = pFrame->height;
-    dstWidth = pFrame->width;
-
-    // Free the requested memory space
-    av_frame_unref(pFrame);
-    av_frame_free(&pFrame);
-    av_freep(&avio->buffer);
-    av_freep(&avio);
-    avformat_close_input(&pFormatCtx);
-    avcodec_free_context(&pCodecCtx);
-    sws_freeContext(img_convert_ctx);
-
-    return true;    
+bool JpegDecoderNodeWorker::decodeImage(const std::string& imageData, hva::hvaVideoFrameWithROIBuf_t::Ptr& hvabuf) {
+    return m_decoder.decode(imageData, hvabuf);
 }
 
 /**
@@ -554,22 +403,6 @@ std::string JpegDecoderNodeWorker::encodeYUVImage(AVFrame *pFrame) {
     return YUVdata;
 }
 
-/**
- * @brief read dst uint8_t buffer into jpeg decoder
- * @param opaque source buffer for jpeg decoder
- * @param buf dst uint8_t buffer
- * @param buf_size size of `buf`
- * @return actual read buffer size of `buf`
- */
-int feedDecoder (void *opaque, std::uint8_t *buf, int buf_size){
-    std::stringstream* ss = reinterpret_cast<std::stringstream*>(opaque);
-    auto actualSize = ss->readsome((char*)buf, buf_size);
-    HVA_DEBUG("Reads %d bytes into jpeg decoder", actualSize);
-    if (!actualSize)
-        return AVERROR_EOF;
-    return actualSize;
-}
-
 /**
  * @brief copy source buffer to uint8 dst buffer
  * - if read all into dst buffer, set source buffer as empty
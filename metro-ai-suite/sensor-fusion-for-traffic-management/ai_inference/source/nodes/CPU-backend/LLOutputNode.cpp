@@ -51,6 +51,8 @@ void LLOutputNodeWorker::process(std::size_t batchIdx){
 
         hce::ai::inference::HceDatabaseMeta videoMeta;
         inBlob->get(0)->getMeta(videoMeta);
+        // rois are reported on the source image
+        mapToSourceScale(buf->rois, videoMeta.scaleWidth, videoMeta.scaleHeight);
 
         hce::ai::inference::TimeStamp_t timeMeta;
         std::chrono::time_point<std::chrono::high_resolution_clock> startTime;
@@ -62,74 +64,16 @@ void LLOutputNodeWorker::process(std::size_t batchIdx){
         std::chrono::duration<double, std::milli> latencyDuration = endTime - startTime;
         double latency = latencyDuration.count();
 
-        m_jsonTree.clear();
-        m_rois.clear();
-        int roi_idx = 0;
-        for(const auto& item: buf->rois){
-            m_x.clear();
-            m_y.clear();
-            m_w.clear();
-            m_h.clear();
-            m_roiData.clear();
-            m_roi.clear();
-
-            m_x.put("", item.x);
-            m_y.put("", item.y);
-            m_w.put("", item.width);
-            m_h.put("", item.height);
-
-            m_roiData.push_back(std::make_pair("", m_x));
-            m_roiData.push_back(std::make_pair("", m_y));
-            m_roiData.push_back(std::make_pair("", m_w));
-            m_roiData.push_back(std::make_pair("", m_h));
-
-            m_roi.add_child("roi", m_roiData);
-            m_roi.put("feature_vector", item.labelClassification);
-
-            m_roi.put("roi_class", item.labelDetection);
-            m_roi.put("roi_score", item.confidenceDetection);
-
-            boost::property_tree::ptree m_roiAttrData;
-            auto attrs = videoMeta.attributeResult[roi_idx].attr;
-            for (const auto& attr : attrs) {
-                boost::property_tree::ptree label, conf;
-                label.put("", attr.second.label);
-                conf.put("", attr.second.confidence);
-                m_roiAttrData.push_back(std::make_pair(attr.first, label));
-                m_roiAttrData.push_back(std::make_pair(attr.first + "_score", conf));
-            }
-            m_roi.add_child("attribute", m_roiAttrData);
-
-            m_rois.push_back(std::make_pair("", m_roi));
-
-            roi_idx ++;
-        }
-        if(m_rois.empty()){
-            if(buf->drop){
-                m_jsonTree.put("status_code", -2);
-                m_jsonTree.put("description", "Read or decode input media failed");
-                m_jsonTree.put("latency", latency);
-            }
-            else{
-                m_jsonTree.put("status_code", 1u);
-                m_jsonTree.put("description", "noRoiDetected");
-                m_jsonTree.put("latency", latency);
-            }
-        }
-        else{
-            m_jsonTree.put("status_code", 0u);
-            m_jsonTree.put("description", "succeeded");
-            m_jsonTree.add_child("roi_info", m_rois);
-            m_jsonTree.put("latency", latency);
-        }
-        std::stringstream ss;
-        boost::property_tree::json_parser::write_json(ss, m_jsonTree);
-
         baseResponseNode::Response res;
         res.status = 0;
-        res.message = ss.str();
-
-        HVA_DEBUG("Emit: %s on frame id %d", res.message.c_str(), buf->frameId);
+        if (dynamic_cast<LLOutputNode*>(getParentPtr())->getResultFormat() == baseResponseNode::RESULT_FORMAT_TYPED) {
+            res.result = makeResult(inBlob, buf, videoMeta, latency);
+            HVA_DEBUG("Emit typed result with %d rois on frame id %d", res.result->rois.size(), buf->frameId);
+        }
+        else {
+            res.message = makeJsonMessage(buf, videoMeta, latency);
+            HVA_DEBUG("Emit: %s on frame id %d", res.message.c_str(), buf->frameId);
+        }
 
         dynamic_cast<LLOutputNode*>(getParentPtr())->emitOutput(res, (baseResponseNode*)getParentPtr(), nullptr);
 
@@ -141,6 +85,120 @@ void LLOutputNodeWorker::process(std::size_t batchIdx){
 }
 
 
+std::string LLOutputNodeWorker::makeJsonMessage(const hva::hvaVideoFrameWithROIBuf_t::Ptr& buf,
+                                                HceDatabaseMeta& videoMeta, double latency) {
+    m_jsonTree.clear();
+    m_rois.clear();
+    int roi_idx = 0;
+    for(const auto& item: buf->rois){
+        m_x.clear();
+        m_y.clear();
+        m_w.clear();
+        m_h.clear();
+        m_roiData.clear();
+        m_roi.clear();
+
+        m_x.put("", item.x);
+        m_y.put("", item.y);
+        m_w.put("", item.width);
+        m_h.put("", item.height);
+
+        m_roiData.push_back(std::make_pair("", m_x));
+        m_roiData.push_back(std::make_pair("", m_y));
+        m_roiData.push_back(std::make_pair("", m_w));
+        m_roiData.push_back(std::make_pair("", m_h));
+
+        m_roi.add_child("roi", m_roiData);
+        m_roi.put("feature_vector", item.labelClassification);
+
+        m_roi.put("roi_class", item.labelDetection);
+        m_roi.put("roi_score", item.confidenceDetection);
+
+        boost::property_tree::ptree m_roiAttrData;
+        auto attrs = videoMeta.attributeResult[roi_idx].attr;
+        for (const auto& attr : attrs) {
+            boost::property_tree::ptree label, conf;
+            label.put("", attr.second.label);
+            conf.put("", attr.second.confidence);
+            m_roiAttrData.push_back(std::make_pair(attr.first, label));
+            m_roiAttrData.push_back(std::make_pair(attr.first + "_score", conf));
+        }
+        m_roi.add_child("attribute", m_roiAttrData);
+
+        m_rois.push_back(std::make_pair("", m_roi));
+
+        roi_idx ++;
+    }
+    if(m_rois.empty()){
+        if(buf->drop){
+            m_jsonTree.put("status_code", -2);
+            m_jsonTree.put("description", "Read or decode input media failed");
+            m_jsonTree.put("latency", latency);
+        }
+        else{
+            m_jsonTree.put("status_code", 1u);
+            m_jsonTree.put("description", "noRoiDetected");
+            m_jsonTree.put("latency", latency);
+        }
+    }
+    else{
+        m_jsonTree.put("status_code", 0u);
+        m_jsonTree.put("description", "succeeded");
+        m_jsonTree.add_child("roi_info", m_rois);
+        m_jsonTree.put("latency", latency);
+    }
+    std::stringstream ss;
+    boost::property_tree::json_parser::write_json(ss, m_jsonTree);
+    return ss.str();
+}
+
+std::shared_ptr<baseResponseNode::Result> LLOutputNodeWorker::makeResult(const hva::hvaBlob_t::Ptr& inBlob,
+                                                                         const hva::hvaVideoFrameWithROIBuf_t::Ptr& buf,
+                                                                         HceDatabaseMeta& videoMeta, double latency) {
+    auto result = std::make_shared<baseResponseNode::Result>();
+    result->streamId = inBlob->streamId;
+    result->frameId = inBlob->frameId;
+    result->latency = latency;
+
+    result->rois.reserve(buf->rois.size());
+    int roi_idx = 0;
+    for (const auto& item : buf->rois) {
+        baseResponseNode::ResultROI roi;
+        roi.roi[0] = item.x;
+        roi.roi[1] = item.y;
+        roi.roi[2] = item.width;
+        roi.roi[3] = item.height;
+        roi.featureVector = item.labelClassification;
+        roi.roiClass = item.labelDetection;
+        roi.roiScore = item.confidenceDetection;
+
+        auto iter = videoMeta.attributeResult.find(roi_idx);
+        if (iter != videoMeta.attributeResult.end()) {
+            for (const auto& attr : iter->second.attr) {
+                roi.attributes.push_back({attr.first, {attr.second.label, attr.second.confidence}});
+            }
+        }
+        result->rois.push_back(std::move(roi));
+        roi_idx ++;
+    }
+
+    if (result->rois.empty()) {
+        if (buf->drop) {
+            result->statusCode = -2;
+            result->description = "Read or decode input media failed";
+        }
+        else {
+            result->statusCode = 1;
+            result->description = "noRoiDetected";
+        }
+    }
+    else {
+        result->statusCode = 0;
+        result->description = "succeeded";
+    }
+    return result;
+}
+
 LLOutputNode::LLOutputNode(std::size_t totalThreadNum):baseResponseNode(1, 0,totalThreadNum){
 
 }
@@ -23,13 +23,16 @@ namespace inference{
 
 
 //
-// save results as local file:  {timestamp}.csv, 
+// save results as local file:  {timestamp}.bin, 
 // if media_type == `video`, snapshots will be also saved to folder ./snapshot
 //
 LocalFileManager::LocalFileManager() : m_batchIdx(0) {
 }
 
 LocalFileManager::~LocalFileManager() { 
+    if (m_resultFile) {
+        tools::AsyncResultWriter::getInstance().close(m_resultFile);
+    }
 }
 
 void LocalFileManager::init(std::size_t batchIdx) {
@@ -47,49 +50,73 @@ void LocalFileManager::init(std::size_t batchIdx) {
 }
 
 /**
- * save results as local file:  {timestamp}.csv
- * each column name should be consist with hvaROI_t
+ * save results as local binary file: results.bin, one record for each roi, written by the shared result writer,
+ * converted to csv offline by `ResultFileConverter`
 */
 bool LocalFileManager::saveResultsToFile(const unsigned frameId, const unsigned streamId, 
                         const std::vector<hva::hvaROI_t>& rois, HceDatabaseMeta& meta,
                         const int statusCode, const std::string description){
     std::lock_guard<std::mutex> lg(m_fileMutex);
 
+    if (!m_resultFile) {
+        m_resultFile = tools::AsyncResultWriter::getInstance().open(m_resultPath, {
+            // frame-level info
+            {"mediaUri", tools::RESULT_COLUMN_STRING},
+            {"mediaTimeStamp", tools::RESULT_COLUMN_UINT64},
+            {"captureSourceId", tools::RESULT_COLUMN_STRING},
+            {"localFilePath", tools::RESULT_COLUMN_STRING},
+            {"frameId", tools::RESULT_COLUMN_UINT32},
+            {"streamId", tools::RESULT_COLUMN_UINT32},
+            // roi-level info
+            {"roiId", tools::RESULT_COLUMN_UINT64},
+            {"x", tools::RESULT_COLUMN_INT32},
+            {"y", tools::RESULT_COLUMN_INT32},
+            {"width", tools::RESULT_COLUMN_INT32},
+            {"height", tools::RESULT_COLUMN_INT32},
+            {"labelIdDetection", tools::RESULT_COLUMN_INT32},
+            {"labelDetection", tools::RESULT_COLUMN_STRING},
+            {"confidenceDetection", tools::RESULT_COLUMN_FLOAT64},
+            // tracking
+            {"trackingId", tools::RESULT_COLUMN_UINT32},
+            {"trackingStatus", tools::RESULT_COLUMN_STRING},
+            // feature dimension: hvaROI_t use labelIdClassification to record feature dimension
+            {"featureDimension", tools::RESULT_COLUMN_INT32},
+            {"featureVector", tools::RESULT_COLUMN_STRING},
+            // registered attributes
+            {"type", tools::RESULT_COLUMN_STRING},
+            {"type_score", tools::RESULT_COLUMN_FLOAT32},
+            {"color", tools::RESULT_COLUMN_STRING},
+            {"color_score", tools::RESULT_COLUMN_FLOAT32},
+            {"quality_score", tools::RESULT_COLUMN_FLOAT32},
+            // status code
+            {"status", tools::RESULT_COLUMN_INT32},
+            {"description", tools::RESULT_COLUMN_STRING},
+            // other attributes, each becomes columns {name, name_score} in csv
+            {"attributes", tools::RESULT_COLUMN_KEY_VALUE}});
+    }
+
     for (size_t idx = 0; idx < rois.size(); idx ++) {
 
-        std::vector<std::pair<std::string, std::string>> resultSet;
+        tools::ResultRecord record;
 
         // frame-level info
-        resultSet.push_back(addColumnData("mediaUri", meta.mediaUri));
-        resultSet.push_back(addColumnData("mediaTimeStamp", std::to_string(meta.timeStamp)));
-        resultSet.push_back(addColumnData("captureSourceId", meta.captureSourceId));
-        resultSet.push_back(addColumnData("localFilePath", meta.localFilePath));
-        resultSet.push_back(addColumnData("frameId", std::to_string(frameId)));
-        resultSet.push_back(addColumnData("streamId", std::to_string(streamId)));
+        record.put(meta.mediaUri).put(meta.timeStamp).put(meta.captureSourceId).put(meta.localFilePath);
+        record.put(frameId).put(streamId);
 
         // roi-level info
-        resultSet.push_back(addColumnData("roiId", std::to_string(idx)));
-        resultSet.push_back(addColumnData("x", std::to_string(rois[idx].x)));
-        resultSet.push_back(addColumnData("y", std::to_string(rois[idx].y)));
-        resultSet.push_back(addColumnData("width", std::to_string(rois[idx].width)));
-        resultSet.push_back(addColumnData("height", std::to_string(rois[idx].height)));
-        resultSet.push_back(addColumnData("labelIdDetection", std::to_string(rois[idx].labelIdDetection)));
-        resultSet.push_back(addColumnData("labelDetection", rois[idx].labelDetection));
-        resultSet.push_back(addColumnData("confidenceDetection", std::to_string(rois[idx].confidenceDetection)));
+        record.put((uint64_t)idx).put(rois[idx].x).put(rois[idx].y).put(rois[idx].width).put(rois[idx].height);
+        record.put(rois[idx].labelIdDetection).put(rois[idx].labelDetection).put(rois[idx].confidenceDetection);
 
         // tracking
-        resultSet.push_back(addColumnData("trackingId", std::to_string(rois[idx].trackingId)));
-        resultSet.push_back(addColumnData("trackingStatus", vas::ot::TrackStatusToString(rois[idx].trackingStatus)));
-       
+        record.put(rois[idx].trackingId).put(std::string(vas::ot::TrackStatusToString(rois[idx].trackingStatus)));
+
         // feature dimension: hvaROI_t use labelIdClassification to record feature dimension
-        resultSet.push_back(addColumnData("featureDimension", std::to_string(rois[idx].labelIdClassification)));
-        resultSet.push_back(addColumnData("featureVector", rois[idx].labelClassification));
+        record.put(rois[idx].labelIdClassification).put(rois[idx].labelClassification);
 
         // 
-        // to-do: optimize this parsing method
         // Attributes: deal with non-fixed length of attribute model output
         //  > Step 1. extract fixed field: {"type", "color"}
-        //  > Step 2. append other fields at the end of the line
+        //  > Step 2. put other fields as key-value pairs at the end of the record
         // 
         auto attrs = meta.attributeResult[idx].attr;
         std::unordered_map<std::string, std::pair<std::string, float>> attrMap;
@@ -109,108 +136,34 @@ bool LocalFileManager::saveResultsToFile(const unsigned frameId, const unsigned
         std::vector<std::string> _registered_attributes = {"type", "color"};
         for (const auto& _key : _registered_attributes) {
             if (attrMap.count(_key)) {
-                resultSet.push_back(addColumnData(_key, attrMap[_key].first));
-                resultSet.push_back(addColumnData(_key + "_score", std::to_string(attrMap[_key].second)));
+                record.put(attrMap[_key].first).put(attrMap[_key].second);
                 attrMap.erase(_key);
             }
             else {
                 // dummy data
-                resultSet.push_back(addColumnData(_key, ""));
-                resultSet.push_back(addColumnData(_key + "_score", "0"));
+                record.put(std::string()).put(0.0f);
             }
         }
 
         // quality-score
-        resultSet.push_back(addColumnData("quality_score", std::to_string(meta.qualityResult[idx])));
+        record.put(meta.qualityResult[idx]);
 
         // status code
-        resultSet.push_back(addColumnData("status", std::to_string(statusCode)));
-        resultSet.push_back(addColumnData("description", description));
+        record.put(statusCode).put(description);
 
-        // Attributes: "Step 2. append other fields at the end of the line"
+        // Attributes: "Step 2. put other fields as key-value pairs at the end of the record"
+        record.beginList();
         for (const auto& item : attrMap) {
-            std::string _key = item.first;
-            resultSet.push_back(addColumnData(_key, attrMap[_key].first));
-            resultSet.push_back(addColumnData(_key + "_score", std::to_string(attrMap[_key].second)));
+            record.add(item.first).add(item.second.first);
+            record.add(item.first + "_score").add(std::to_string(item.second.second));
         }
+        record.endList();
 
-        // check the folder of result file for the first time
-        if (m_firstLine) {
-            checkPath(m_resultPath);
-        }
-
-        std::ofstream resfile;
-        resfile.open(m_resultPath, std::ios::out | std::ios::app);
-        if (!resfile.is_open()) {
-            HVA_ERROR("Failed to open result file: %s !", m_resultPath.c_str());
+        // written to disk by the writer thread
+        if (!tools::AsyncResultWriter::getInstance().append(m_resultFile, std::move(record))) {
+            HVA_ERROR("Failed to write result file: %s !", m_resultPath.c_str());
             return false;
         }
-
-        // first line: do create csv file and write headers
-        if (m_firstLine) {
-
-            // write headers
-            std::vector<std::string> vecHeaders(m_headers.size());
-            for (auto &item: m_headers) {
-                vecHeaders[item.second] = item.first;
-            }
-            for (auto &header : vecHeaders) {
-                resfile << header << ",";
-            }
-            resfile << "\n";
-            m_firstLine = false;
-        }
-
-        // fomat contents to the corresponding column index
-        bool isHeaderUpdated = false;
-        auto xx = resultSet.size();
-        std::vector<std::string> rowData(resultSet.size());
-        for (auto &item: resultSet) {
-            std::string key = item.first;
-
-            // insert new header
-            if (m_headers.count(key) == 0) {
-                isHeaderUpdated = true;
-                m_headers.emplace(key, m_headers.size());
-            }
-            rowData[m_headers[key]] = item.second;
-        }
-        // start wrting contents
-        for (auto &val : rowData) {
-            resfile << val << ",";
-        }
-        resfile << "\n";
-        resfile.close();
-
-        // 
-        // HEADER PATCH: in case of handling non-fixed length of attributes
-        // csv headers have been created, re-write first line
-        // 
-        if (isHeaderUpdated) {
-            // generate new header line
-            std::vector<std::string> vecHeaders(m_headers.size());
-            for (auto &item: m_headers) {
-                vecHeaders[item.second] = item.first;
-            }
-            std::string content;
-            for (auto &header : vecHeaders) {
-                content += header + ",";
-            }
-
-            try {
-                // replace the first line with new header content
-                replaceLineInFile(m_resultPath, content, 0);
-            }
-            catch (const std::exception &e)
-            {
-                HVA_ERROR("Failed to update header line in result file, error: %s", e.what());
-                return false;
-            }
-            catch (...) {
-                HVA_ERROR("Failed to update header line in result file: %s", m_resultPath.c_str());
-                return false;
-            }
-        }
     }
 
     return true;
@@ -244,12 +197,23 @@ bool LocalFileManager::saveSnapshotsToFile(const hva::hvaVideoFrameWithROIBuf_t:
     return true;
 }
 
+/**
+ * wait until the results saved so far are written to the result file
+*/
+void LocalFileManager::flush() {
+    if (m_resultFile) {
+        tools::AsyncResultWriter::getInstance().flush(m_resultFile);
+    }
+}
+
 /**
  * construct save path for each request
 */
 void LocalFileManager::reset() {
-    m_firstLine = true;
-    m_headers.clear();
+    if (m_resultFile) {
+        tools::AsyncResultWriter::getInstance().close(m_resultFile);
+        m_resultFile.reset();
+    }
     constructSavePath();
 };
 
@@ -275,25 +239,11 @@ void LocalFileManager::constructSavePath() {
 
     std::string activeSaveFolder = tmp;
 
-    m_resultPath = activeSaveFolder + "/results.csv";
+    m_resultPath = activeSaveFolder + "/results.bin";
     m_snapshotPath = activeSaveFolder + "/snapshots";
     HVA_INFO("Results for next request will be saved in: %s", activeSaveFolder.c_str());
 }
 
-/**
- * @brief check filepath
- * if filepath not exist, check the folder
- * if folder not exist, make the dir
-*/
-void LocalFileManager::checkPath(const std::string& path) {
-    boost::filesystem::path p(path);
-    boost::filesystem::path folder = p.parent_path();
-    if (!boost::filesystem::exists(folder)) {
-        HVA_INFO("Folder not exists, create: %s", folder.c_str());
-        boost::filesystem::create_directories(folder.c_str());
-    }
-}
-
 /**
  * @brief check folder
  * if folder not exist, make the dir
@@ -305,48 +255,6 @@ void LocalFileManager::checkFolder(const std::string& path) {
     }
 }
 
-/**
- * @brief add new colum data, also add new key into m_headers at the first time (i.e. m_firstLine == true)
- */
-std::pair<std::string, std::string> LocalFileManager::addColumnData(std::string key, std::string val) {
-    std::pair<std::string, std::string> data = std::make_pair(key, val);
-    if (m_firstLine && m_headers.count(key) == 0) {
-        m_headers.emplace(key, m_headers.size());
-    }
-    return data;
-}
-
-/**
- * @brief replace a specific line, default as the first line
- * @param filepath the file to be modified
- * @param content the dst line content
- * @param lineIndex index for the line to be replaced
- */
-void LocalFileManager::replaceLineInFile(std::string filepath, std::string content, int lineIndex) {
-    std::ifstream infile(filepath);
-    std::vector<std::string> lines;
-    std::string input;
-    while (std::getline(infile, input))
-        lines.push_back(input);
-    infile.close();
-
-    if (lineIndex >= lines.size() || lineIndex < 0) {
-        char msg[256];
-        sprintf(msg,
-                "Failed to replace file at line: %d, total lines: %ld, file "
-                "path: %s",
-                lineIndex, lines.size(), filepath.c_str());
-        throw std::runtime_error(msg);
-    }
-    lines[lineIndex] = content;
-
-    // replace the original contents
-    std::ofstream outfile(filepath, std::ios::trunc);
-    for (auto const& line : lines)
-        outfile << line << '\n';
-    outfile.close();
-}
-
 LLResultSinkFileNodeWorker::LLResultSinkFileNodeWorker(
     hva::hvaNode_t* parentNode,
     const std::string& mediaType)
@@ -410,7 +318,10 @@ void LLResultSinkFileNodeWorker::process(std::size_t batchIdx){
         if(buf->rois.size() != 0){
             status_code = 0u;
             description = "succeeded";
-            m_localFileManager.saveResultsToFile(buf->frameId, inBlob->streamId, buf->rois, meta, status_code, description);
+            // results are saved on the source image, snapshots keep the rois on the decoded frame
+            std::vector<hva::hvaROI_t> rois = buf->rois;
+            mapToSourceScale(rois, meta.scaleWidth, meta.scaleHeight);
+            m_localFileManager.saveResultsToFile(buf->frameId, inBlob->streamId, rois, meta, status_code, description);
             
             HVA_DEBUG("Saved frame %d results", buf->frameId);
         }
@@ -454,6 +365,8 @@ void LLResultSinkFileNodeWorker::process(std::size_t batchIdx){
         if(buf->getTag() == hvaBlobBufferTag::END_OF_REQUEST){
             dynamic_cast<LLResultSinkFileNode*>(getParentPtr())->addEmitFinishFlag();
             HVA_DEBUG("Receive finish flag on framid %u and streamid %u", inBlob->frameId, inBlob->streamId);
+            // results of the request are on disk before the client is told it finished
+            m_localFileManager.flush();
             // reset m_localFileManager for this worker
             m_localFileManager.reset();
         }
@@ -467,6 +380,11 @@ void LLResultSinkFileNodeWorker::process(std::size_t batchIdx){
     }
 }
 
+void LLResultSinkFileNodeWorker::deinit(){
+    m_localFileManager.reset();
+    tools::AsyncResultWriter::getInstance().flush();
+}
+
 hva::hvaStatus_t LLResultSinkFileNodeWorker::reset(){
     m_localFileManager.reset();
     return hva::hvaSuccess;
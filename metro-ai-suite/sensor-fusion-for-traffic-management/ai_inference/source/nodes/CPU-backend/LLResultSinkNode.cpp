@@ -14,6 +14,7 @@
 
 #include <boost/exception/all.hpp>
 #include <sys/timeb.h>
+#include <cstring>
 
 #include <inc/buffer/hvaVideoFrameWithROIBuf.hpp>
 
@@ -110,11 +111,26 @@ void LLResultSinkNodeWorker::constructFeatureSet(const std::vector<hva::hvaROI_t
     // decode feature vector to buffer
     // feature dimension: hvaROI_t use labelIdClassification to record feature dimension
     int featureLength = rois[0].labelIdClassification;
-    std::shared_ptr<uint8_t> buf(new uint8_t[roiCount * featureLength]);
+    if (featureLength <= 0) {
+        HVA_ERROR("Invalid feature dimension: %d", featureLength);
+        return;
+    }
+    // a valid encoding of featureLength bytes may decode up to 2 bytes more before its padding is dropped,
+    // those land on the next slot, decoded after, or on the spare bytes past the last slot
+    const size_t slotCapacity = base64DecodedMaxSize(base64EncodedSize(featureLength));
+    const size_t bufSize = roiCount * featureLength;
+    std::shared_ptr<uint8_t> buf(new uint8_t[bufSize + slotCapacity - featureLength], std::default_delete<uint8_t[]>());
     for (std::size_t i = 0; i < roiCount; ++i) {
-        hce::ai::inference::base64DecodeStringToBuffer(
-            const_cast<std::string&>(rois[i].labelClassification),
-            buf.get() + i * featureLength);
+        uint8_t* slot = buf.get() + i * featureLength;
+        const std::string& encoded = rois[i].labelClassification;
+        size_t decodedLen = 0;
+        // reject oversized input before decoding, it would overrun the buffer
+        if(base64DecodedMaxSize(encoded.size()) > slotCapacity
+                || !hce::ai::inference::base64Decode(slot, encoded.data(), encoded.size(), decodedLen)
+                || decodedLen != (size_t)featureLength){
+            HVA_ERROR("Invalid feature vector of roi %d, %d base64 chars, expected %d bytes", (int)i, (int)encoded.size(), featureLength);
+            std::memset(slot, 0, featureLength);
+        }
     }
     featureSet.featureBuffer = std::move(buf);
 
@@ -153,8 +169,11 @@ void LLResultSinkNodeWorker::process(std::size_t batchIdx){
 
         HceDatabaseMeta meta;
         inBlob->get(0)->getMeta(meta);
+        // rois are saved on the source image
+        mapToSourceScale(buf->rois, meta.scaleWidth, meta.scaleHeight);
 
-        m_jsonTree.clear();
+        int statusCode = 0;
+        std::string description;
 
         std::vector<hva::hvaROI_t> collectedROIs;
         std::vector<std::string> attribs;
@@ -208,36 +227,48 @@ void LLResultSinkNodeWorker::process(std::size_t batchIdx){
                 HVA_DEBUG("RETID: %s", base64EncodeStrToStr(retIds[0]).c_str());
                 HVA_DEBUG("Saved frame %d features with %d returned ids", buf->frameId, retIds.size());
 
-                m_jsonTree.put("status_code", 0u);
-                m_jsonTree.put("description", "succeeded");
+                statusCode = 0;
+                description = "succeeded";
             }
             else {
                 HVA_DEBUG("Fail to save features for: %s", base64EncodeStrToStr(retIds[0]).c_str());
-                m_jsonTree.put("status_code", -3);
-                m_jsonTree.put("description", "Save results to database failed");
+                statusCode = -3;
+                description = "Save results to database failed";
             }
 
 
         }
         else{
             if(buf->drop){
-                m_jsonTree.put("status_code", -2);
-                m_jsonTree.put("description", "Read or decode input media failed");
+                statusCode = -2;
+                description = "Read or decode input media failed";
             }
             else{
-                m_jsonTree.put("status_code", 1u);
-                m_jsonTree.put("description", "noRoiDetected");
+                statusCode = 1;
+                description = "noRoiDetected";
             }
         }
 
-        std::stringstream ss;
-        boost::property_tree::json_parser::write_json(ss, m_jsonTree);
-
         baseResponseNode::Response res;
         res.status = 0;
-        res.message = ss.str();
-
-        HVA_DEBUG("Emit: %s on frame id %d", res.message.c_str(), buf->frameId);
+        if (dynamic_cast<LLResultSinkNode*>(getParentPtr())->getResultFormat() == baseResponseNode::RESULT_FORMAT_TYPED) {
+            res.result = std::make_shared<baseResponseNode::Result>();
+            res.result->statusCode = statusCode;
+            res.result->description = description;
+            res.result->streamId = inBlob->streamId;
+            res.result->frameId = inBlob->frameId;
+            HVA_DEBUG("Emit typed result with status %d on frame id %d", statusCode, buf->frameId);
+        }
+        else {
+            m_jsonTree.clear();
+            m_jsonTree.put("status_code", statusCode);
+            m_jsonTree.put("description", description);
+
+            std::stringstream ss;
+            boost::property_tree::json_parser::write_json(ss, m_jsonTree);
+            res.message = ss.str();
+            HVA_DEBUG("Emit: %s on frame id %d", res.message.c_str(), buf->frameId);
+        }
 
         dynamic_cast<LLResultSinkNode*>(getParentPtr())->emitOutput(res, (baseResponseNode*)getParentPtr(), nullptr);
 
@@ -65,19 +65,27 @@ hva::hvaStatus_t LocalMediaSensorInputNode::configureByString(const std::string&
     m_configParser.getVal<std::string>("ControlType", controlType);
     m_controlType = controlType;
 
+    std::string policy = "block";
+    m_configParser.getVal<std::string>("BackpressurePolicy", policy);
+    if (!BackpressureController::parsePolicy(policy, m_policy)) {
+        HVA_ERROR("Unknown backpressure policy: %s", policy.c_str());
+        return hva::hvaFailure;
+    }
+
     transitStateTo(hva::hvaState_t::configured);
     return hva::hvaSuccess;
 }
 
 std::shared_ptr<hva::hvaNodeWorker_t> LocalMediaSensorInputNode::createNodeWorker() const{
-    return std::shared_ptr<hva::hvaNodeWorker_t>(new LocalMediaSensorInputNodeWorker((hva::hvaNode_t*)this, m_sensorIndices, m_inputCapacity, m_stride, m_frameRate, m_controlType));
+    return std::shared_ptr<hva::hvaNodeWorker_t>(new LocalMediaSensorInputNodeWorker((hva::hvaNode_t*)this, m_sensorIndices, m_inputCapacity, m_stride, m_frameRate, m_controlType, m_policy));
 } 
 
 
 LocalMediaSensorInputNodeWorker::LocalMediaSensorInputNodeWorker(hva::hvaNode_t* parentNode, 
-        const LocalMediaSensorInputNode::InpustSensorIndices_t &sensorIndices, const size_t &inputCapacity, const size_t &stride, const float &frameRate, const std::string &controlType):
-          hva::hvaNodeWorker_t(parentNode), m_ctr(0u), m_sensorIndices(sensorIndices), m_inputCapacity(inputCapacity), m_stride(stride), m_frameRate(frameRate), m_controlType(controlType), m_workStreamId(-1) {
-            m_controllerMap[0] = std::make_shared<SendController>(inputCapacity, stride, controlType);
+        const LocalMediaSensorInputNode::InpustSensorIndices_t &sensorIndices, const size_t &inputCapacity, const size_t &stride, const float &frameRate, const std::string &controlType,
+        const BackpressureController::Policy &policy):
+          hva::hvaNodeWorker_t(parentNode), m_ctr(0u), m_sensorIndices(sensorIndices), m_inputCapacity(inputCapacity), m_stride(stride), m_frameRate(frameRate), m_controlType(controlType), m_policy(policy), m_workStreamId(-1) {
+            m_controllerMap[0] = std::make_shared<BackpressureController>(inputCapacity, stride, controlType, policy);
 }
 
 void LocalMediaSensorInputNodeWorker::process(std::size_t batchIdx){
@@ -160,12 +168,23 @@ void LocalMediaSensorInputNodeWorker::process(std::size_t batchIdx){
             //     getParentPtr()->emitEvent(hvaEvent_PipelineTimeStampRecord, &inputIn);
             // }
 
+            if (streamId == m_workStreamId && m_controllerMap.find(m_workStreamId) == m_controllerMap.end() && 0 < m_inputCapacity) {
+                // key not exists, construct it
+                m_controllerMap[m_workStreamId] = std::make_shared<BackpressureController>(m_inputCapacity, m_stride, m_controlType, m_policy, m_workStreamId);
+            }
+
+            // take credits before reading the file, a frame dropped by the policy is sent on as empty buffer
+            bool controlled = (streamId == m_workStreamId) && (0 < m_inputCapacity);
+            bool admitted = !controlled || m_controllerMap[m_workStreamId]->admit(blob->frameId);
+
             getLatencyMonitor().startRecording(blob->frameId,"reading file");
             std::string path = comingInputs[inputIdx];
             // read binary data
             std::fstream fs;
-            fs.open(path.c_str(), std::fstream::in | std::fstream::binary);
-            if(fs)
+            if (admitted) {
+                fs.open(path.c_str(), std::fstream::in | std::fstream::binary);
+            }
+            if(fs.is_open())
             {
                 fs.seekg (0, fs.end);
                 size_t buffLen = fs.tellg();
@@ -208,18 +227,7 @@ void LocalMediaSensorInputNodeWorker::process(std::size_t batchIdx){
 
             }
 
-            if (streamId == m_workStreamId && m_controllerMap.find(m_workStreamId) == m_controllerMap.end() && 0 < m_inputCapacity) {
-                // key not exists, construct it
-                m_controllerMap[m_workStreamId] = std::make_shared<SendController>(m_inputCapacity, m_stride, m_controlType);
-            }
-
-            if ((streamId == m_workStreamId) && (0 < m_inputCapacity)) {
-                std::unique_lock<std::mutex> lock(m_controllerMap[m_workStreamId]->mtx);
-                while (m_controllerMap[m_workStreamId]->count > (m_inputCapacity - 1) * m_stride) {
-                    (m_controllerMap[m_workStreamId]->notFull).wait(lock);
-                }
-                (m_controllerMap[m_workStreamId]->count) += m_stride;
-                lock.unlock();
+            if (controlled && admitted) {
                 jpgHvaBuf->setMeta(m_controllerMap[m_workStreamId]);
             }
        
@@ -243,7 +251,7 @@ void LocalMediaSensorInputNodeWorker::process(std::size_t batchIdx){
             // auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(epoch).count();
             HVA_INFO("Multi input source node push the %d th jpeg data to blob", blob->frameId);
             // HVA_INFO("Multi input source node push the %d th jpeg data to blob on time %d", blob->frameId, milliseconds);
-            if ((streamId == m_workStreamId) && (0 >= m_inputCapacity || (m_controllerMap[m_workStreamId]->count > (m_inputCapacity - 1) * m_stride)) && (0 != inputIdx) && (0.0 != m_frameRate)) {
+            if ((streamId == m_workStreamId) && (0 >= m_inputCapacity || m_controllerMap[m_workStreamId]->full()) && (0 != inputIdx) && (0.0 != m_frameRate)) {
                 std::this_thread::sleep_for(std::chrono::milliseconds(int(1000 / m_frameRate)));
             }
 
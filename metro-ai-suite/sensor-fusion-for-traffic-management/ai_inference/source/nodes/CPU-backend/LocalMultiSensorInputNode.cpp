@@ -26,7 +26,8 @@ namespace ai{
 
 namespace inference{
 
-LocalMultiSensorInputNode::LocalMultiSensorInputNode(std::size_t totalThreadNum):hva::hvaNode_t(1, 1, totalThreadNum) {
+LocalMultiSensorInputNode::LocalMultiSensorInputNode(std::size_t totalThreadNum):hva::hvaNode_t(1, 1, totalThreadNum),
+        m_readAhead(READ_AHEAD_DEFAULT_DEPTH), m_readThreads(READ_AHEAD_DEFAULT_THREAD_NUM) {
 
 }
 
@@ -71,19 +72,62 @@ hva::hvaStatus_t LocalMultiSensorInputNode::configureByString(const std::string&
     m_configParser.getVal<std::string>("ControlType", controlType);
     m_controlType = controlType;
 
+    std::string policy = "block";
+    m_configParser.getVal<std::string>("BackpressurePolicy", policy);
+    if (!BackpressureController::parsePolicy(policy, m_policy)) {
+        HVA_ERROR("Unknown backpressure policy: %s", policy.c_str());
+        return hva::hvaFailure;
+    }
+
+    // sensor files read ahead of the frame being sent, 0 to read them on the node thread
+    int readAhead = READ_AHEAD_DEFAULT_DEPTH;
+    m_configParser.getVal<int>("ReadAhead", readAhead);
+    m_readAhead = readAhead > 0 ? readAhead : 0;
+
+    int readThreads = READ_AHEAD_DEFAULT_THREAD_NUM;
+    m_configParser.getVal<int>("ReadThreads", readThreads);
+    m_readThreads = readThreads > 0 ? readThreads : 1;
+
     transitStateTo(hva::hvaState_t::configured);
     return hva::hvaSuccess;
 }
 
 std::shared_ptr<hva::hvaNodeWorker_t> LocalMultiSensorInputNode::createNodeWorker() const{
-    return std::shared_ptr<hva::hvaNodeWorker_t>(new LocalMultiInputNodeWorker((hva::hvaNode_t*)this, m_sensorIndices, m_inputCapacity, m_stride, m_frameRate, m_controlType));
+    return std::shared_ptr<hva::hvaNodeWorker_t>(new LocalMultiInputNodeWorker((hva::hvaNode_t*)this, m_sensorIndices, m_inputCapacity, m_stride, m_frameRate, m_controlType, m_policy,
+                                                                               m_readAhead, m_readThreads));
 } 
 
 
 LocalMultiInputNodeWorker::LocalMultiInputNodeWorker(hva::hvaNode_t* parentNode, 
-        const LocalMultiSensorInputNode::InpustSensorIndices_t &sensorIndices, const size_t &inputCapacity, const size_t &stride, const float &frameRate, const std::string &controlType):
-          hva::hvaNodeWorker_t(parentNode), m_ctr(0u), m_sensorIndices(sensorIndices), m_inputCapacity(inputCapacity), m_stride(stride), m_frameRate(frameRate), m_controlType(controlType), m_workStreamId(-1) {
-            m_controllerMap[0] = std::make_shared<SendController>(inputCapacity, stride, controlType);
+        const LocalMultiSensorInputNode::InpustSensorIndices_t &sensorIndices, const size_t &inputCapacity, const size_t &stride, const float &frameRate, const std::string &controlType,
+        const BackpressureController::Policy &policy, const size_t &readAhead, const size_t &readThreads):
+          hva::hvaNodeWorker_t(parentNode), m_ctr(0u), m_sensorIndices(sensorIndices), m_inputCapacity(inputCapacity), m_stride(stride), m_frameRate(frameRate), m_controlType(controlType), m_policy(policy), m_workStreamId(-1) {
+            m_controllerMap[0] = std::make_shared<BackpressureController>(inputCapacity, stride, controlType, policy);
+            m_loader.reset(new tools::ReadAheadLoader<MultiDatasetField_t>(readAhead, readThreads,
+                [this](size_t frameIdx, MultiDatasetField_t& content) { readFrame(frameIdx, content); }));
+}
+
+/**
+ * @brief read the sensor files of one frame, called by the loader I/O threads
+ * @param frameIdx frame index in the coming inputs
+ * @param content receives the file contents, buffers are reused
+ */
+void LocalMultiInputNodeWorker::readFrame(size_t frameIdx, MultiDatasetField_t& content) {
+    content.imageSize = 0;
+    content.radarSize = 0;
+    for (int idx = 0; idx < MULTI_SENSOR_INPUT_NUM; idx ++) {
+        const std::string& path = m_comingInputs[frameIdx * MULTI_SENSOR_INPUT_NUM + idx];
+        // image
+        if (idx == m_sensorIndices.mediaIndex) {
+            tools::readFileInto(path, content.imageContent);
+            content.imageSize = content.imageContent.size();
+        }
+        // radar
+        else if (idx == m_sensorIndices.radarIndex) {
+            tools::readFileInto(path, content.radarContent);
+            content.radarSize = content.radarContent.size();
+        }
+    }
 }
 
 void LocalMultiInputNodeWorker::process(std::size_t batchIdx){
@@ -119,7 +163,13 @@ void LocalMultiInputNodeWorker::process(std::size_t batchIdx){
             m_workStreamId = streamId;
         }
 
-        boost::filesystem::path p(comingInputs[0]);
+        // sensor files are read ahead of the frame being sent, on the loader I/O threads
+        m_loader->cancel();
+        m_comingInputs = std::move(comingInputs);
+        m_loader->start(m_comingInputs.size() / MULTI_SENSOR_INPUT_NUM);
+        MultiDatasetField_t content;
+
+        boost::filesystem::path p(m_comingInputs[0]);
         std::string folder = p.parent_path().c_str();
         // std::string radarConfigPath = folder.substr(0, folder.rfind("/")) + ".h5.json";
         // if (!boost::filesystem::exists(radarConfigPath)) {
@@ -132,15 +182,15 @@ void LocalMultiInputNodeWorker::process(std::size_t batchIdx){
         // HVA_DEBUG("Local MultiSensor Input node success to generate radarConfigPath: %s", radarConfigPath.c_str());
 
         // processing multiple coming medias, send to specified port in sequence
-        for (int inputIdx = 0; inputIdx < comingInputs.size(); inputIdx += MULTI_SENSOR_INPUT_NUM) {
+        for (int inputIdx = 0; inputIdx < m_comingInputs.size(); inputIdx += MULTI_SENSOR_INPUT_NUM) {
 
             // the last request input will be taged as end
-            bool isEnd = (inputIdx >= comingInputs.size() - MULTI_SENSOR_INPUT_NUM);
+            bool isEnd = (inputIdx >= m_comingInputs.size() - MULTI_SENSOR_INPUT_NUM);
 
             /**
-             * process input content
+             * process input content, the buffers of the previous frame go back to the loader
              */
-            MultiDatasetField_t content;
+            m_loader->next(content);
             HceDatabaseMeta meta;
             // meta.radarConfigPath = radarConfigPath;
             hva::hvaROI_t roi;
@@ -154,38 +204,19 @@ void LocalMultiInputNodeWorker::process(std::size_t batchIdx){
             blob->streamId = batchIdx;
             blob->frameId = fetch_increment();
 
-            for (int idx = 0; idx < MULTI_SENSOR_INPUT_NUM; idx ++) {
-
-                std::string path = comingInputs[inputIdx + idx];
-                // read binary data
-                std::fstream fs;
-                fs.open(path.c_str(), std::fstream::in | std::fstream::binary);
-                if(fs)
-                {
-                    fs.seekg (0, fs.end);
-                    size_t buffLen = fs.tellg();
-                    fs.seekg (0, fs.beg);
-                    
-                    // image
-                    if (idx == m_sensorIndices.mediaIndex) {
-
-                        char* buff = new char [buffLen];
-                        fs.read(buff, buffLen);
-                        content.imageContent.assign((char*)buff, (char*)buff + fs.gcount());
-                        content.imageSize = fs.gcount();
-                        delete[] buff;
-                    }
-                    // radar
-                    else if (idx == m_sensorIndices.radarIndex) {
-
-                        auto samples_to_read = buffLen / sizeof(std::complex<float>);
-                        content.radarContent.resize(samples_to_read);
-                        fs.read(reinterpret_cast<char*>(content.radarContent.data()), buffLen);
-                        content.radarSize = content.radarContent.size();
-                        
-                    }
-                }
-                fs.close();
+            if (streamId == m_workStreamId && m_controllerMap.find(m_workStreamId) == m_controllerMap.end() && 0 < m_inputCapacity) {
+                // key not exists, construct it
+                m_controllerMap[m_workStreamId] = std::make_shared<BackpressureController>(m_inputCapacity, m_stride, m_controlType, m_policy, m_workStreamId);
+            }
+
+            // take credits before sending the files, a frame dropped by the policy is sent on as empty buffers
+            bool controlled = (streamId == m_workStreamId) && (0 < m_inputCapacity);
+            bool admitted = !controlled || m_controllerMap[m_workStreamId]->admit(blob->frameId);
+            if (!admitted) {
+                content.imageContent.clear();
+                content.imageSize = 0;
+                content.radarContent.clear();
+                content.radarSize = 0;
             }
 
             HVA_DEBUG("media content size is : %d on frameid %d streamid %d",
@@ -215,18 +246,7 @@ void LocalMultiInputNodeWorker::process(std::size_t batchIdx){
                 radarHvaBuf->tagAs(0);
             }
 
-            if (streamId == m_workStreamId && m_controllerMap.find(m_workStreamId) == m_controllerMap.end() && 0 < m_inputCapacity) {
-                // key not exists, construct it
-                m_controllerMap[m_workStreamId] = std::make_shared<SendController>(m_inputCapacity, m_stride, m_controlType);
-            }
-
-            if ((streamId == m_workStreamId) && (0 < m_inputCapacity)) {
-                std::unique_lock<std::mutex> lock(m_controllerMap[m_workStreamId]->mtx);
-                while (m_controllerMap[m_workStreamId]->count > (m_inputCapacity - 1) * m_stride) {
-                    (m_controllerMap[m_workStreamId]->notFull).wait(lock);
-                }
-                (m_controllerMap[m_workStreamId]->count) += m_stride;
-                lock.unlock();
+            if (controlled && admitted) {
                 jpgHvaBuf->setMeta(m_controllerMap[m_workStreamId]);
                 radarHvaBuf->setMeta(m_controllerMap[m_workStreamId]);
             }
@@ -245,7 +265,7 @@ void LocalMultiInputNodeWorker::process(std::size_t batchIdx){
             // auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(epoch).count();
             HVA_INFO("Multi input source node push the %d th jpeg data to blob", blob->frameId);
             // HVA_INFO("Multi input source node push the %d th jpeg data to blob on time %d", blob->frameId, milliseconds);
-            if ((streamId == m_workStreamId) && (0 >= m_inputCapacity || (m_controllerMap[m_workStreamId]->count > (m_inputCapacity - 1) * m_stride)) && (0 != inputIdx) && (0.0 != m_frameRate)) {
+            if ((streamId == m_workStreamId) && (0 >= m_inputCapacity || m_controllerMap[m_workStreamId]->full()) && (0 != inputIdx) && (0.0 != m_frameRate)) {
                 std::this_thread::sleep_for(std::chrono::milliseconds(int(1000 / m_frameRate)));
             }
         }
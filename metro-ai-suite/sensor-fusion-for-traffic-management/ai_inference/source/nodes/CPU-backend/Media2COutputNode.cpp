@@ -66,30 +66,27 @@ void Media2COutputNodeWorker::process(std::size_t batchIdx)
             HVA_ASSERT(false);
         }
 
-        boost::property_tree::ptree jsonTree;
-        boost::property_tree::ptree roisTree;
-
         hce::ai::inference::TimeStamp_t timeMeta;
         hce::ai::inference::InferenceTimeStamp_t inferenceTimeMeta;
         std::chrono::time_point<std::chrono::high_resolution_clock> startTime;
         std::chrono::time_point<std::chrono::high_resolution_clock> endTime;
 
-        jsonTree.clear();
-        roisTree.clear();
-        std::vector<double> latencies;
-        std::vector<double> inferenceLatencies;
         endTime = std::chrono::high_resolution_clock::now();
 
         hva::hvaBlob_t::Ptr mediaBlob;
         hva::hvaVideoFrameWithROIBuf_t::Ptr mediaBuf;
 
+        // the result is built once and shared by all listeners, json is serialized only if a listener reads it
+        auto result = std::make_shared<baseResponseNode::Result>();
+        result->streamId = vecBlobInput[0]->streamId;
+        result->frameId = vecBlobInput[0]->frameId;
+
         vecBlobInput[0]->get(0)->getMeta(timeMeta);
         std::chrono::duration<double, std::milli> latencyDuration = endTime - timeMeta.timeStamp;
-        double latency = latencyDuration.count();
-        double inferenceLatency = 0.0;
+        result->latency = latencyDuration.count();
 
         if (vecBlobInput[0]->get(0)->getMeta(inferenceTimeMeta) == hva::hvaSuccess) {
-            inferenceLatency = std::chrono::duration<double, std::milli>(inferenceTimeMeta.endTime - inferenceTimeMeta.startTime).count();
+            result->inferenceLatency = std::chrono::duration<double, std::milli>(inferenceTimeMeta.endTime - inferenceTimeMeta.startTime).count();
         }
 
         for (size_t portId = 0; portId < MEDIA_2C_OUTPUT_NODE_INPORT_NUM; portId++) {
@@ -101,86 +98,59 @@ void Media2COutputNodeWorker::process(std::size_t batchIdx)
             mediaBlob->get(0)->getMeta(timeMeta);
             startTime = timeMeta.timeStamp;
             std::chrono::duration<double, std::milli> latencyDuration = endTime - startTime;
-            latencies.push_back(latencyDuration.count());
+            double latency = latencyDuration.count();
 
             mediaBlob->get(0)->getMeta(inferenceTimeMeta);
             latencyDuration = inferenceTimeMeta.endTime - inferenceTimeMeta.startTime;
-            inferenceLatencies.push_back(latencyDuration.count());
-
-            for (const auto &item : mediaBuf->rois) {
-                boost::property_tree::ptree roiInfoTree;
+            double inferenceLatency = latencyDuration.count();
 
-                // media roi
-                boost::property_tree::ptree roiBoxTree;
-                std::vector<int> roiBoxVal = {item.x, item.y, item.width, item.height};
-                putVectorToJson<int>(roiBoxTree, roiBoxVal);
-
-                roiInfoTree.add_child("roi", roiBoxTree);
-                roiInfoTree.put("roi_class", item.labelDetection);
-                roiInfoTree.put("roi_score", item.confidenceDetection);
-
-                // tracking
-                roiInfoTree.put("track_id", item.trackingId);
-                roiInfoTree.put("track_status", vas::ot::TrackStatusToString(item.trackingStatus));
+            result->latencies.emplace_back("inference_latency" + std::to_string(portId + 1), inferenceLatency);
+            result->latencies.emplace_back("latency" + std::to_string(portId + 1), latency);
 
+            for (const auto &item : mediaBuf->rois) {
+                baseResponseNode::ResultROI roi;
+                roi.roi[0] = item.x;
+                roi.roi[1] = item.y;
+                roi.roi[2] = item.width;
+                roi.roi[3] = item.height;
+                roi.roiClass = item.labelDetection;
+                roi.roiScore = item.confidenceDetection;
+                roi.trackId = item.trackingId;
+                roi.trackStatus = vas::ot::TrackStatusToString(item.trackingStatus);
                 // sensor source, -1 means radar
-                roiInfoTree.put("sensor_source", portId);
-
-                // dummy media birdview roi
-                boost::property_tree::ptree roiWorldBoxTree;
-                std::vector<float> roiWorldBoxVal = {0.0, 0.0, 0.0, 0.0};
-                putVectorToJson<float>(roiWorldBoxTree, roiWorldBoxVal);
-                roiInfoTree.add_child("media_birdview_roi", roiWorldBoxTree);
-
-                // dummy data for radar output
-                boost::property_tree::ptree stateTree;
-                std::vector<float> stateVal = {0.0, 0.0, 0.0, 0.0};
-                putVectorToJson<float>(stateTree, stateVal);
-                roiInfoTree.add_child("fusion_roi_state", stateTree);
-
-                boost::property_tree::ptree sizeTree;
-                std::vector<float> sizeVal = {0.0, 0.0};
-                putVectorToJson<float>(sizeTree, sizeVal);
-                roiInfoTree.add_child("fusion_roi_size", sizeTree);
-
-                roisTree.push_back(std::make_pair("", roiInfoTree));
+                roi.sensorSource = portId;
+                result->rois.push_back(std::move(roi));
             }
         }
 
-        if (roisTree.empty()) {
+        if (result->rois.empty()) {
             if (mediaBuf->drop) {
-                jsonTree.put("status_code", -2);
-                jsonTree.put("description", "Read or decode input media failed");
+                result->statusCode = -2;
+                result->description = "Read or decode input media failed";
             }
             else {
-                jsonTree.put("status_code", 1u);
-                jsonTree.put("description", "noRoiDetected");
+                result->statusCode = 1;
+                result->description = "noRoiDetected";
             }
         }
         else {
-            jsonTree.put("status_code", 0u);
-            jsonTree.put("description", "succeeded");
-            jsonTree.add_child("roi_info", roisTree);
+            result->statusCode = 0;
+            result->description = "succeeded";
         }
-        jsonTree.put("inference_latency", inferenceLatency);
-        jsonTree.put("latency", latency);
-
-        for (size_t portId = 0; portId < MEDIA_2C_OUTPUT_NODE_INPORT_NUM; portId++) {
-            double latency = latencies[portId];
-            double inferenceLatency = inferenceLatencies[portId];
-            jsonTree.put("inference_latency" + std::to_string(portId + 1), inferenceLatency);
-            jsonTree.put("latency" + std::to_string(portId + 1), latency);
-        }
-
-        std::stringstream ss;
-        boost::property_tree::json_parser::write_json(ss, jsonTree);
 
         baseResponseNode::Response res;
         res.status = 0;
-        res.message = ss.str();
-        // std::cout << res.message << std::endl;
+        if (dynamic_cast<Media2COutputNode *>(getParentPtr())->getResultFormat() == baseResponseNode::RESULT_FORMAT_TYPED) {
+            res.result = result;
+        }
+        else {
+            res.lazyMessage = std::make_shared<baseResponseNode::LazyJsonMessage>(result,
+                    baseResponseNode::RESULT_JSON_SENSOR_SOURCE | baseResponseNode::RESULT_JSON_MEDIA_BIRDVIEW_ROI |
+                    baseResponseNode::RESULT_JSON_FUSION_ROI | baseResponseNode::RESULT_JSON_INFERENCE_LATENCY |
+                    baseResponseNode::RESULT_JSON_LATENCY);
+        }
 
-        HVA_DEBUG("Emit: %s on frame id %d", res.message.c_str(), mediaBuf->frameId);
+        HVA_DEBUG("Emit result with %d rois on frame id %d", result->rois.size(), mediaBuf->frameId);
 
         dynamic_cast<Media2COutputNode *>(getParentPtr())->emitOutput(res, (baseResponseNode *)getParentPtr(), nullptr);
 
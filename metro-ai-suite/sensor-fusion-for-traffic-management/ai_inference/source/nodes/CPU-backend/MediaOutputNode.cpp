@@ -57,9 +57,6 @@ void MediaOutputNodeWorker::process(std::size_t batchIdx)
         hva::hvaBlob_t::Ptr mediaBlob = vecBlobInput[0];
         HVA_DEBUG("Media output node %d received media blob on frameId %d", batchIdx, mediaBlob->frameId);
 
-        boost::property_tree::ptree jsonTree;
-        boost::property_tree::ptree roisTree;
-
         //
         // process: media pipeline
         //
@@ -75,77 +72,52 @@ void MediaOutputNodeWorker::process(std::size_t batchIdx)
         std::chrono::duration<double, std::milli> latencyDuration = endTime - startTime;
         double latency = latencyDuration.count();
 
-        jsonTree.clear();
-        roisTree.clear();
+        // the result is built once and shared by all listeners, json is serialized only if a listener reads it
+        auto result = std::make_shared<baseResponseNode::Result>();
+        result->streamId = mediaBlob->streamId;
+        result->frameId = mediaBlob->frameId;
+        result->latency = latency;
+        result->rois.reserve(mediaBuf->rois.size());
         for (const auto &item : mediaBuf->rois) {
-            boost::property_tree::ptree roiInfoTree;
-
-            // media roi
-            boost::property_tree::ptree roiBoxTree;
-            std::vector<int> roiBoxVal = {item.x, item.y, item.width, item.height};
-            putVectorToJson<int>(roiBoxTree, roiBoxVal);
-
-            roiInfoTree.add_child("roi", roiBoxTree);
-            roiInfoTree.put("roi_class", item.labelDetection);
-            roiInfoTree.put("roi_score", item.confidenceDetection);
-
-            // tracking
-            roiInfoTree.put("track_id", item.trackingId);
-            roiInfoTree.put("track_status", vas::ot::TrackStatusToString(item.trackingStatus));
-
-            // dummy media birdview roi
-            boost::property_tree::ptree roiWorldBoxTree;
-            std::vector<float> roiWorldBoxVal = {0.0, 0.0, 0.0, 0.0};
-            putVectorToJson<float>(roiWorldBoxTree, roiWorldBoxVal);
-            roiInfoTree.add_child("media_birdview_roi", roiWorldBoxTree);
-
-            // dummy data for radar output
-            boost::property_tree::ptree stateTree;
-            std::vector<float> stateVal = {0.0, 0.0, 0.0, 0.0};
-            putVectorToJson<float>(stateTree, stateVal);
-            roiInfoTree.add_child("fusion_roi_state", stateTree);
-
-            boost::property_tree::ptree sizeTree;
-            std::vector<float> sizeVal = {0.0, 0.0};
-            putVectorToJson<float>(sizeTree, sizeVal);
-            roiInfoTree.add_child("fusion_roi_size", sizeTree);
-
-            // E2E latency
-            // roiInfoTree.put("latency", latency);
-            // roiInfoTree.put("startTime", startTime);
-            // roiInfoTree.put("endTime", endTime);
-
-            roisTree.push_back(std::make_pair("", roiInfoTree));
+            baseResponseNode::ResultROI roi;
+            roi.roi[0] = item.x;
+            roi.roi[1] = item.y;
+            roi.roi[2] = item.width;
+            roi.roi[3] = item.height;
+            roi.roiClass = item.labelDetection;
+            roi.roiScore = item.confidenceDetection;
+            roi.trackId = item.trackingId;
+            roi.trackStatus = vas::ot::TrackStatusToString(item.trackingStatus);
+            result->rois.push_back(std::move(roi));
         }
 
-        if (roisTree.empty()) {
+        if (result->rois.empty()) {
             if (mediaBuf->drop) {
-                jsonTree.put("status_code", -2);
-                jsonTree.put("description", "Read or decode input media failed");
-                jsonTree.put("latency", latency);
+                result->statusCode = -2;
+                result->description = "Read or decode input media failed";
             }
             else {
-                jsonTree.put("status_code", 1u);
-                jsonTree.put("description", "noRoiDetected");
-                jsonTree.put("latency", latency);
+                result->statusCode = 1;
+                result->description = "noRoiDetected";
             }
         }
         else {
-            jsonTree.put("status_code", 0u);
-            jsonTree.put("description", "succeeded");
-            jsonTree.add_child("roi_info", roisTree);
-            jsonTree.put("latency", latency);
+            result->statusCode = 0;
+            result->description = "succeeded";
         }
 
-        std::stringstream ss;
-        boost::property_tree::json_parser::write_json(ss, jsonTree);
-
         baseResponseNode::Response res;
         res.status = 0;
-        res.message = ss.str();
-        // std::cout << res.message << std::endl;
+        if (dynamic_cast<MediaOutputNode *>(getParentPtr())->getResultFormat() == baseResponseNode::RESULT_FORMAT_TYPED) {
+            res.result = result;
+        }
+        else {
+            res.lazyMessage = std::make_shared<baseResponseNode::LazyJsonMessage>(result,
+                    baseResponseNode::RESULT_JSON_MEDIA_BIRDVIEW_ROI | baseResponseNode::RESULT_JSON_FUSION_ROI |
+                    baseResponseNode::RESULT_JSON_LATENCY);
+        }
 
-        HVA_DEBUG("Emit: %s on frame id %d", res.message.c_str(), mediaBuf->frameId);
+        HVA_DEBUG("Emit result with %d rois on frame id %d", result->rois.size(), mediaBuf->frameId);
 
         dynamic_cast<MediaOutputNode *>(getParentPtr())->emitOutput(res, (baseResponseNode *)getParentPtr(), nullptr);
 
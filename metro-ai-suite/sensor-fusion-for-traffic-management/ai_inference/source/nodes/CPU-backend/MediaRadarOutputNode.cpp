@@ -74,115 +74,21 @@ void MediaRadarOutputNodeWorker::process(std::size_t batchIdx){
         hva::hvaBlob_t::Ptr radarBlob = vecBlobInput[m_inPortsInfo.radarInputPort];
         HVA_DEBUG("Media radar output node %d received radar blob on frameId %d", batchIdx, radarBlob->frameId);
         
-        boost::property_tree::ptree jsonTree;
-        boost::property_tree::ptree roisTree;
-
-        // 
-        // process: media pipeline
-        // 
         hva::hvaVideoFrameWithROIBuf_t::Ptr mediaBuf = std::dynamic_pointer_cast<hva::hvaVideoFrameWithROIBuf_t>(mediaBlob->get(0));
-
-        jsonTree.clear();
-        roisTree.clear();
-        for(const auto& item: mediaBuf->rois){
-            boost::property_tree::ptree roiInfoTree;
-
-            // media roi
-            boost::property_tree::ptree roiBoxTree;
-            std::vector<int> roiBoxVal = {item.x, item.y, item.width, item.height};
-            putVectorToJson<int>(roiBoxTree, roiBoxVal);
-
-            roiInfoTree.add_child("roi", roiBoxTree);
-            roiInfoTree.put("roi_class", item.labelDetection);
-            roiInfoTree.put("roi_score", item.confidenceDetection);
-
-            // tracking
-            roiInfoTree.put("track_id", item.trackingId);
-            roiInfoTree.put("track_status", vas::ot::TrackStatusToString(item.trackingStatus));
-
-            // dummy data for radar output
-            boost::property_tree::ptree stateTree;
-            std::vector<float> stateVal = {0.0, 0.0, 0.0, 0.0};
-            putVectorToJson<float>(stateTree, stateVal);
-            roiInfoTree.add_child("fusion_roi_state", stateTree);
-
-            boost::property_tree::ptree sizeTree;
-            std::vector<float> sizeVal = {0.0, 0.0};
-            putVectorToJson<float>(sizeTree, sizeVal);
-            roiInfoTree.add_child("fusion_roi_size", sizeTree);
-
-            roisTree.push_back(std::make_pair("", roiInfoTree));
-        }
-
-        // 
-        // process: radar pipeline
-        // 
         hva::hvaVideoFrameWithMetaROIBuf_t::Ptr radarBuf = std::dynamic_pointer_cast<hva::hvaVideoFrameWithMetaROIBuf_t>(radarBlob->get(0));
 
-        hce::ai::inference::trackerOutput radarOutput;
-        if (hva::hvaSuccess == radarBuf->getMeta(radarOutput)) {
-            for (int i = 0; i < radarOutput.outputInfo.size(); ++i) {
-                boost::property_tree::ptree roiInfoTree;
-
-                // dummy media roi
-                boost::property_tree::ptree roiBoxTree;
-                std::vector<int> roiBoxVal = {0, 0, 0, 0};
-                putVectorToJson<int>(roiBoxTree, roiBoxVal);
-
-                roiInfoTree.add_child("roi", roiBoxTree);
-                roiInfoTree.put("roi_class", "dummy");
-                roiInfoTree.put("roi_score", 0.0);
-
-                // dummy tracking
-                roiInfoTree.put("track_id", 0.0);
-                roiInfoTree.put("track_status", "dummy");
-
-                // radar output
-                boost::property_tree::ptree stateTree;
-                std::vector<float> stateVal = { radarOutput.outputInfo[i].S_hat[0], 
-                                                radarOutput.outputInfo[i].S_hat[1],
-                                                radarOutput.outputInfo[i].S_hat[2],
-                                                radarOutput.outputInfo[i].S_hat[3]};
-                putVectorToJson<float>(stateTree, stateVal);
-                roiInfoTree.add_child("fusion_roi_state", stateTree);
-
-                boost::property_tree::ptree sizeTree;
-                std::vector<float> sizeVal = {radarOutput.outputInfo[i].xSize, radarOutput.outputInfo[i].ySize};
-                putVectorToJson<float>(sizeTree, sizeVal);
-                roiInfoTree.add_child("fusion_roi_size", sizeTree);
-
-                roisTree.push_back(std::make_pair("", roiInfoTree));
-            }
-        }
-        else {
-            // previous node not ever put this type of meta into hvabuf
-            HVA_ERROR("Media radar output node error to parse trackerOutput from radar pipeline at frameid %u and streamid %u", mediaBlob->frameId, mediaBlob->streamId);
-        }
-        
-        if(roisTree.empty()){
-            if(mediaBuf->drop){
-                jsonTree.put("status_code", -2);
-                jsonTree.put("description", "Read or decode input media failed");
-            }
-            else{
-                jsonTree.put("status_code", 1u);
-                jsonTree.put("description", "noRoiDetected");
-            }
-        }
-        else{
-            jsonTree.put("status_code", 0u);
-            jsonTree.put("description", "succeeded");
-            jsonTree.add_child("roi_info", roisTree);
-        }
-
-        std::stringstream ss;
-        boost::property_tree::json_parser::write_json(ss, jsonTree);
+        // the result is built once and shared by all listeners, json is serialized only if a listener reads it
+        std::shared_ptr<baseResponseNode::Result> result = makeResult(mediaBlob, mediaBuf, radarBuf);
 
         baseResponseNode::Response res;
         res.status = 0;
-        res.message = ss.str();
-
-        HVA_DEBUG("Emit: %s on frame id %d", res.message.c_str(), mediaBuf->frameId);
+        if (dynamic_cast<MediaRadarOutputNode*>(getParentPtr())->getResultFormat() == baseResponseNode::RESULT_FORMAT_TYPED) {
+            res.result = result;
+        }
+        else {
+            res.lazyMessage = std::make_shared<baseResponseNode::LazyJsonMessage>(result, baseResponseNode::RESULT_JSON_FUSION_ROI);
+        }
+        HVA_DEBUG("Emit result with %d rois on frame id %d", result->rois.size(), mediaBuf->frameId);
 
         dynamic_cast<MediaRadarOutputNode*>(getParentPtr())->emitOutput(res, (baseResponseNode*)getParentPtr(), nullptr);
 
@@ -193,6 +99,65 @@ void MediaRadarOutputNodeWorker::process(std::size_t batchIdx){
     }
 }
 
+std::shared_ptr<baseResponseNode::Result> MediaRadarOutputNodeWorker::makeResult(const hva::hvaBlob_t::Ptr& mediaBlob,
+                                                                                  const hva::hvaVideoFrameWithROIBuf_t::Ptr& mediaBuf,
+                                                                                  const hva::hvaVideoFrameWithMetaROIBuf_t::Ptr& radarBuf) {
+    auto result = std::make_shared<baseResponseNode::Result>();
+    result->streamId = mediaBlob->streamId;
+    result->frameId = mediaBlob->frameId;
+
+    // media pipeline
+    result->rois.reserve(mediaBuf->rois.size());
+    for (const auto& item : mediaBuf->rois) {
+        baseResponseNode::ResultROI roi;
+        roi.roi[0] = item.x;
+        roi.roi[1] = item.y;
+        roi.roi[2] = item.width;
+        roi.roi[3] = item.height;
+        roi.roiClass = item.labelDetection;
+        roi.roiScore = item.confidenceDetection;
+        roi.trackId = item.trackingId;
+        roi.trackStatus = vas::ot::TrackStatusToString(item.trackingStatus);
+        result->rois.push_back(std::move(roi));
+    }
+
+    // radar pipeline
+    hce::ai::inference::trackerOutput radarOutput;
+    if (hva::hvaSuccess == radarBuf->getMeta(radarOutput)) {
+        for (const auto& item : radarOutput.outputInfo) {
+            baseResponseNode::ResultROI roi;
+            roi.roiClass = "dummy";
+            roi.trackStatus = "dummy";
+            for (int i = 0; i < 4; ++i) {
+                roi.fusionRoiState[i] = item.S_hat[i];
+            }
+            roi.fusionRoiSize[0] = item.xSize;
+            roi.fusionRoiSize[1] = item.ySize;
+            result->rois.push_back(std::move(roi));
+        }
+    }
+    else {
+        // previous node not ever put this type of meta into hvabuf
+        HVA_ERROR("Media radar output node error to parse trackerOutput from radar pipeline at frameid %u and streamid %u", mediaBlob->frameId, mediaBlob->streamId);
+    }
+
+    if (result->rois.empty()) {
+        if (mediaBuf->drop) {
+            result->statusCode = -2;
+            result->description = "Read or decode input media failed";
+        }
+        else {
+            result->statusCode = 1;
+            result->description = "noRoiDetected";
+        }
+    }
+    else {
+        result->statusCode = 0;
+        result->description = "succeeded";
+    }
+    return result;
+}
+
 void MediaRadarOutputNodeWorker::processByLastRun(std::size_t batchIdx){
     dynamic_cast<MediaRadarOutputNode*>(getParentPtr())->emitFinish((baseResponseNode*)getParentPtr(), nullptr);
 }
@@ -103,9 +103,6 @@ void PostFusionOutputNodeWorker::process(std::size_t batchIdx)
         std::shared_ptr<hva::timeStampInfo> postFusionIn = std::make_shared<hva::timeStampInfo>(inBlob->frameId, "postFusionIn");
         getParentPtr()->emitEvent(hvaEvent_PipelineTimeStampRecord, &postFusionIn);
 
-        boost::property_tree::ptree jsonTree;
-        boost::property_tree::ptree roisTree;
-
         //
         // process: media-radar fusion pipeline
         //
@@ -148,14 +145,128 @@ void PostFusionOutputNodeWorker::process(std::size_t batchIdx)
             inferenceLatency = std::chrono::duration<double, std::milli>(inferenceTimeMeta.endTime - inferenceTimeMeta.startTime).count();
         }
 
-        if (hva::hvaSuccess == inBuf->getMeta(fusionOutput)) {
+        bool hasFusionOutput = (hva::hvaSuccess == inBuf->getMeta(fusionOutput));
+        if (hasFusionOutput) {
             getParentPtr()->emitEvent(hvaEvent_PipelineLatencyCapture, &inBuf->frameId);
+        }
+        else {
+            // previous node not ever put this type of meta into hvabuf
+            HVA_ERROR("Post fusion output node error to parse trackerOutput from radar "
+                      "pipeline at frameid %u and streamid %u",
+                      inBlob->frameId, inBlob->streamId);
+        }
+
+        baseResponseNode::Response res;
+        res.status = 0;
+        if (dynamic_cast<PostFusionOutputNode *>(getParentPtr())->getResultFormat() == baseResponseNode::RESULT_FORMAT_TYPED) {
+            res.result = makeResult(inBlob, inBuf, hasFusionOutput ? &fusionOutput : nullptr, latency, inferenceLatency, endTime);
+            HVA_DEBUG("Emit typed result with %d rois on frame id %d", res.result->rois.size(), inBuf->frameId);
+        }
+        else {
+            res.message = makeJsonMessage(inBlob, inBuf, hasFusionOutput ? &fusionOutput : nullptr, latency, inferenceLatency, endTime);
+            HVA_DEBUG("Emit: %s on frame id %d", res.message.c_str(), inBuf->frameId);
+        }
+        // auto now = std::chrono::high_resolution_clock::now();
+        // auto epoch = now.time_since_epoch();
+        // auto milliseconds =
+        // std::chrono::duration_cast<std::chrono::milliseconds>(epoch).count();
+        HVA_DEBUG("Emit on frame id %d", inBuf->frameId);
+        // HVA_INFO("Emit on frame id %d with time %d", inBuf->frameId, milliseconds
+        // );
+        dynamic_cast<PostFusionOutputNode *>(getParentPtr())->emitOutput(res, (baseResponseNode *)getParentPtr(), nullptr);
+
+        std::shared_ptr<hva::timeStampInfo> postFusionOut = std::make_shared<hva::timeStampInfo>(inBlob->frameId, "postFusionOut");
+        getParentPtr()->emitEvent(hvaEvent_PipelineTimeStampRecord, &postFusionOut);
+        // hce::ai::inference::TimeStamp_t timeMeta;
+        // std::chrono::time_point<std::chrono::high_resolution_clock> startTime;
+        // std::chrono::time_point<std::chrono::high_resolution_clock> endTime;
+
+        // inBlob->get(0)->getMeta(timeMeta);
+        // startTime = timeMeta.timeStamp;
+
+        // endTime = std::chrono::high_resolution_clock::now();
+        // auto latencyDuration = endTime - startTime;
+        // auto latency = std::chrono::duration_cast<std::chrono::milliseconds>(latencyDuration).count();
+
+        // if (inBuf->getTag() == 1) {
+        //     // auto now = std::chrono::high_resolution_clock::now();
+        //     // auto epoch = now.time_since_epoch();
+        //     // auto milliseconds =
+        //     // std::chrono::duration_cast<std::chrono::milliseconds>(epoch).count();
+        //     HVA_DEBUG("Emit finish on frame id %d", inBuf->frameId);
+        //     // HVA_INFO("Emit finish on frame id %d with time %d", inBuf->frameId,
+        //     // milliseconds );
+        //     dynamic_cast<PostFusionOutputNode *>(getParentPtr())->emitFinish((baseResponseNode *)getParentPtr(), nullptr);
+        // }
+        if (inBuf->getTag() == hvaBlobBufferTag::END_OF_REQUEST) {
+            dynamic_cast<PostFusionOutputNode *>(getParentPtr())->addEmitFinishFlag();
+            HVA_DEBUG("Receive finish flag on framid %u and streamid %u", inBlob->frameId, inBlob->streamId);
+        }
+    }
+    // check whether to trigger emitFinish()
+    if (dynamic_cast<PostFusionOutputNode *>(getParentPtr())->isEmitFinish()) {
+        // coming batch processed done
+        HVA_DEBUG("Emit finish!");
+        dynamic_cast<PostFusionOutputNode *>(getParentPtr())->emitFinish((baseResponseNode *)getParentPtr(), nullptr);
+    }
+}
 
-            jsonTree.clear();
-            roisTree.clear();
-            // fusion radar output
-            for (size_t roiIdx = 0; roiIdx < fusionOutput.m_fusionBBox.size(); roiIdx++) {
-                hce::ai::inference::FusionBBox fusionBBox = fusionOutput.m_fusionBBox[roiIdx];
+std::string PostFusionOutputNodeWorker::makeJsonMessage(const hva::hvaBlob_t::Ptr& inBlob,
+                                                        const hva::hvaVideoFrameWithROIBuf_t::Ptr& inBuf,
+                                                        const FusionOutput* fusionOutput, double latency, double inferenceLatency,
+                                                        const std::chrono::time_point<std::chrono::high_resolution_clock>& endTime)
+{
+    boost::property_tree::ptree jsonTree;
+    boost::property_tree::ptree roisTree;
+
+    if (fusionOutput) {
+        // fusion radar output
+        for (size_t roiIdx = 0; roiIdx < fusionOutput->m_fusionBBox.size(); roiIdx++) {
+            hce::ai::inference::FusionBBox fusionBBox = fusionOutput->m_fusionBBox[roiIdx];
+            boost::property_tree::ptree roiInfoTree;
+
+            // dummy media roi
+            boost::property_tree::ptree roiBoxTree;
+            std::vector<int> roiBoxVal = {0, 0, 0, 0};
+            putVectorToJson<int>(roiBoxTree, roiBoxVal);
+            roiInfoTree.add_child("roi", roiBoxTree);
+
+            // media birdview roi
+            boost::property_tree::ptree roiRadarBoxTree;
+            std::vector<float> roiRadarBoxVal = {0.0, 0.0, 0.0, 0.0};
+            putVectorToJson<float>(roiRadarBoxTree, roiRadarBoxVal);
+            roiInfoTree.add_child("media_birdview_roi", roiRadarBoxTree);
+
+            // dummy & zero if no corresponding media detection
+            roiInfoTree.put("roi_class", fusionBBox.det.label);
+            roiInfoTree.put("roi_score", fusionBBox.det.confidence);
+
+            // dummy tracking
+            roiInfoTree.put("track_id", 0.0);
+            roiInfoTree.put("track_status", "dummy");
+
+            // sensor source, -1 means radar
+            roiInfoTree.put("sensor_source", -1);
+
+            // radar output
+            boost::property_tree::ptree stateTree;
+            std::vector<float> stateVal = {fusionBBox.radarOutput.S_hat[0], fusionBBox.radarOutput.S_hat[1], fusionBBox.radarOutput.S_hat[2],
+                                           fusionBBox.radarOutput.S_hat[3]};
+            putVectorToJson<float>(stateTree, stateVal);
+            roiInfoTree.add_child("fusion_roi_state", stateTree);
+
+            boost::property_tree::ptree sizeTree;
+            std::vector<float> sizeVal = {fusionBBox.radarOutput.xSize, fusionBBox.radarOutput.ySize};
+            putVectorToJson<float>(sizeTree, sizeVal);
+            roiInfoTree.add_child("fusion_roi_size", sizeTree);
+
+            roisTree.push_back(std::make_pair("", roiInfoTree));
+        }
+
+        // camera detections which is not associated with radar detections
+        for (size_t roiIdx = 0; roiIdx < fusionOutput->m_cameraFusionRadarCoords.size(); roiIdx++) {
+            if (!fusionOutput->m_cameraFusionRadarCoordsIsAssociated[roiIdx]) {
+                hce::ai::inference::DetectedObject detectedObject = fusionOutput->m_cameraFusionRadarCoords[roiIdx];
                 boost::property_tree::ptree roiInfoTree;
 
                 // dummy media roi
@@ -166,13 +277,13 @@ void PostFusionOutputNodeWorker::process(std::size_t batchIdx)
 
                 // media birdview roi
                 boost::property_tree::ptree roiRadarBoxTree;
-                std::vector<float> roiRadarBoxVal = {0.0, 0.0, 0.0, 0.0};
+                std::vector<float> roiRadarBoxVal = {detectedObject.bbox.x, detectedObject.bbox.y, detectedObject.bbox.width, detectedObject.bbox.height};
                 putVectorToJson<float>(roiRadarBoxTree, roiRadarBoxVal);
                 roiInfoTree.add_child("media_birdview_roi", roiRadarBoxTree);
 
                 // dummy & zero if no corresponding media detection
-                roiInfoTree.put("roi_class", fusionBBox.det.label);
-                roiInfoTree.put("roi_score", fusionBBox.det.confidence);
+                roiInfoTree.put("roi_class", detectedObject.label);
+                roiInfoTree.put("roi_score", detectedObject.confidence);
 
                 // dummy tracking
                 roiInfoTree.put("track_id", 0.0);
@@ -181,223 +292,221 @@ void PostFusionOutputNodeWorker::process(std::size_t batchIdx)
                 // sensor source, -1 means radar
                 roiInfoTree.put("sensor_source", -1);
 
+                // radar output
                 // radar output
                 boost::property_tree::ptree stateTree;
-                std::vector<float> stateVal = {fusionBBox.radarOutput.S_hat[0], fusionBBox.radarOutput.S_hat[1], fusionBBox.radarOutput.S_hat[2],
-                                               fusionBBox.radarOutput.S_hat[3]};
+                std::vector<float> stateVal = {0.0, 0.0, 0.0, 0.0};
                 putVectorToJson<float>(stateTree, stateVal);
                 roiInfoTree.add_child("fusion_roi_state", stateTree);
 
                 boost::property_tree::ptree sizeTree;
-                std::vector<float> sizeVal = {fusionBBox.radarOutput.xSize, fusionBBox.radarOutput.ySize};
+                std::vector<float> sizeVal = {0.0, 0.0};
                 putVectorToJson<float>(sizeTree, sizeVal);
                 roiInfoTree.add_child("fusion_roi_size", sizeTree);
 
                 roisTree.push_back(std::make_pair("", roiInfoTree));
             }
+        }
 
-            // camera detections which is not associated with radar detections
-            for (size_t roiIdx = 0; roiIdx < fusionOutput.m_cameraFusionRadarCoords.size(); roiIdx++) {
-                if (!fusionOutput.m_cameraFusionRadarCoordsIsAssociated[roiIdx]) {
-                    hce::ai::inference::DetectedObject detectedObject = fusionOutput.m_cameraFusionRadarCoords[roiIdx];
-                    boost::property_tree::ptree roiInfoTree;
-
-                    // dummy media roi
-                    boost::property_tree::ptree roiBoxTree;
-                    std::vector<int> roiBoxVal = {0, 0, 0, 0};
-                    putVectorToJson<int>(roiBoxTree, roiBoxVal);
-                    roiInfoTree.add_child("roi", roiBoxTree);
-
-                    // media birdview roi
-                    boost::property_tree::ptree roiRadarBoxTree;
-                    std::vector<float> roiRadarBoxVal = {detectedObject.bbox.x, detectedObject.bbox.y, detectedObject.bbox.width, detectedObject.bbox.height};
-                    putVectorToJson<float>(roiRadarBoxTree, roiRadarBoxVal);
-                    roiInfoTree.add_child("media_birdview_roi", roiRadarBoxTree);
-
-                    // dummy & zero if no corresponding media detection
-                    roiInfoTree.put("roi_class", detectedObject.label);
-                    roiInfoTree.put("roi_score", detectedObject.confidence);
-
-                    // dummy tracking
-                    roiInfoTree.put("track_id", 0.0);
-                    roiInfoTree.put("track_status", "dummy");
-
-                    // sensor source, -1 means radar
-                    roiInfoTree.put("sensor_source", -1);
-
-                    // radar output
-                    // radar output
-                    boost::property_tree::ptree stateTree;
-                    std::vector<float> stateVal = {0.0, 0.0, 0.0, 0.0};
-                    putVectorToJson<float>(stateTree, stateVal);
-                    roiInfoTree.add_child("fusion_roi_state", stateTree);
-
-                    boost::property_tree::ptree sizeTree;
-                    std::vector<float> sizeVal = {0.0, 0.0};
-                    putVectorToJson<float>(sizeTree, sizeVal);
-                    roiInfoTree.add_child("fusion_roi_size", sizeTree);
-
-                    roisTree.push_back(std::make_pair("", roiInfoTree));
-                }
-            }
+        // camera detections information
+        for (size_t cameraId = 0; cameraId < fusionOutput->m_numOfCams; cameraId++) {
+            std::vector<hva::hvaROI_t> cameraDetections = fusionOutput->m_cameraRois[cameraId];
+            std::vector<BBox> cameraDetectionsRadarCoords = fusionOutput->m_cameraRadarCoords[cameraId];
+
+            for (size_t roiIdx = 0; roiIdx < cameraDetections.size(); roiIdx++) {
+                hva::hvaROI_t itemPixel = cameraDetections[roiIdx];
+                BBox itemRoiRadar = cameraDetectionsRadarCoords[roiIdx];
+                boost::property_tree::ptree roiInfoTree;
+
+                // media roi
+                boost::property_tree::ptree roiBoxTree;
+                std::vector<int> roiBoxVal = {itemPixel.x, itemPixel.y, itemPixel.width, itemPixel.height};
+                putVectorToJson<int>(roiBoxTree, roiBoxVal);
+                roiInfoTree.add_child("roi", roiBoxTree);
+
+                // media birdview roi
+                boost::property_tree::ptree roiRadarBoxTree;
+                std::vector<float> roiRadarBoxVal = {0, 0, 0, 0};
+                putVectorToJson<float>(roiRadarBoxTree, roiRadarBoxVal);
+                roiInfoTree.add_child("media_birdview_roi", roiRadarBoxTree);
+
+                roiInfoTree.put("roi_class", itemPixel.labelDetection);
+                roiInfoTree.put("roi_score", itemPixel.confidenceDetection);
+
+                // tracking
+                roiInfoTree.put("track_id", itemPixel.trackingId);
+                roiInfoTree.put("track_status", vas::ot::TrackStatusToString(itemPixel.trackingStatus));
+
+                // sensor source, -1 means radar
+                roiInfoTree.put("sensor_source", cameraId);
+
+                // radar output
+                boost::property_tree::ptree stateTree;
+                std::vector<float> stateVal = {0.0, 0.0, 0.0, 0.0};
+                putVectorToJson<float>(stateTree, stateVal);
+                roiInfoTree.add_child("fusion_roi_state", stateTree);
 
-            // camera detections information
-            for (size_t cameraId = 0; cameraId < fusionOutput.m_numOfCams; cameraId++) {
-                std::vector<hva::hvaROI_t> cameraDetections = fusionOutput.m_cameraRois[cameraId];
-                std::vector<BBox> cameraDetectionsRadarCoords = fusionOutput.m_cameraRadarCoords[cameraId];
-
-                for (size_t roiIdx = 0; roiIdx < cameraDetections.size(); roiIdx++) {
-                    hva::hvaROI_t itemPixel = cameraDetections[roiIdx];
-                    BBox itemRoiRadar = cameraDetectionsRadarCoords[roiIdx];
-                    boost::property_tree::ptree roiInfoTree;
-
-                    // media roi
-                    boost::property_tree::ptree roiBoxTree;
-                    std::vector<int> roiBoxVal = {itemPixel.x, itemPixel.y, itemPixel.width, itemPixel.height};
-                    putVectorToJson<int>(roiBoxTree, roiBoxVal);
-                    roiInfoTree.add_child("roi", roiBoxTree);
-
-                    // media birdview roi
-                    boost::property_tree::ptree roiRadarBoxTree;
-                    std::vector<float> roiRadarBoxVal = {0, 0, 0, 0};
-                    putVectorToJson<float>(roiRadarBoxTree, roiRadarBoxVal);
-                    roiInfoTree.add_child("media_birdview_roi", roiRadarBoxTree);
-
-                    roiInfoTree.put("roi_class", itemPixel.labelDetection);
-                    roiInfoTree.put("roi_score", itemPixel.confidenceDetection);
-
-                    // tracking
-                    roiInfoTree.put("track_id", itemPixel.trackingId);
-                    roiInfoTree.put("track_status", vas::ot::TrackStatusToString(itemPixel.trackingStatus));
-
-                    // sensor source, -1 means radar
-                    roiInfoTree.put("sensor_source", cameraId);
-
-                    // radar output
-                    boost::property_tree::ptree stateTree;
-                    std::vector<float> stateVal = {0.0, 0.0, 0.0, 0.0};
-                    putVectorToJson<float>(stateTree, stateVal);
-                    roiInfoTree.add_child("fusion_roi_state", stateTree);
-
-                    boost::property_tree::ptree sizeTree;
-                    std::vector<float> sizeVal = {0.0, 0.0};
-                    putVectorToJson<float>(sizeTree, sizeVal);
-                    roiInfoTree.add_child("fusion_roi_size", sizeTree);
-
-                    roisTree.push_back(std::make_pair("", roiInfoTree));
-                }
+                boost::property_tree::ptree sizeTree;
+                std::vector<float> sizeVal = {0.0, 0.0};
+                putVectorToJson<float>(sizeTree, sizeVal);
+                roiInfoTree.add_child("fusion_roi_size", sizeTree);
+
+                roisTree.push_back(std::make_pair("", roiInfoTree));
             }
         }
-        else {
-            // previous node not ever put this type of meta into hvabuf
-            HVA_ERROR("Post fusion output node error to parse trackerOutput from radar "
-                      "pipeline at frameid %u and streamid %u",
-                      inBlob->frameId, inBlob->streamId);
-        }
+    }
 
-        if (roisTree.empty()) {
-            if (inBuf->drop) {
-                jsonTree.put("status_code", -2);
-                jsonTree.put("description", "Read or decode input media failed");
-            }
-            else {
-                jsonTree.put("status_code", 1u);
-                jsonTree.put("description", "noRoiDetected");
-            }
+    if (roisTree.empty()) {
+        if (inBuf->drop) {
+            jsonTree.put("status_code", -2);
+            jsonTree.put("description", "Read or decode input media failed");
         }
         else {
-            jsonTree.put("status_code", 0u);
-            jsonTree.put("description", "succeeded");
-            jsonTree.add_child("roi_info", roisTree);
+            jsonTree.put("status_code", 1u);
+            jsonTree.put("description", "noRoiDetected");
         }
-        jsonTree.put("inference_latency", inferenceLatency);
-        jsonTree.put("latency", latency);
-        jsonTree.put("stream_id", inBlob->streamId);
-
-        hce::ai::inference::TimeStampAll_t timeMetaAll;
-        if (inBlob->get(0)->getMeta(timeMetaAll) == hva::hvaSuccess) {
-            if (timeMetaAll.timeStamp1 != std::chrono::time_point<std::chrono::high_resolution_clock>()) {
-                latencyDuration = endTime - timeMetaAll.timeStamp1;
-                latency = latencyDuration.count();
-                jsonTree.put("latency1", latency);
-            }
-            if (timeMetaAll.timeStamp2 != std::chrono::time_point<std::chrono::high_resolution_clock>()) {
-                latencyDuration = endTime - timeMetaAll.timeStamp2;
-                latency = latencyDuration.count();
-                jsonTree.put("latency2", latency);
-            }
-            if (timeMetaAll.timeStamp3 != std::chrono::time_point<std::chrono::high_resolution_clock>()) {
-                latencyDuration = endTime - timeMetaAll.timeStamp3;
-                latency = latencyDuration.count();
-                jsonTree.put("latency3", latency);
-            }
-            if (timeMetaAll.timeStamp4 != std::chrono::time_point<std::chrono::high_resolution_clock>()) {
-                latencyDuration = endTime - timeMetaAll.timeStamp4;
-                latency = latencyDuration.count();
-                jsonTree.put("latency4", latency);
-            }
+    }
+    else {
+        jsonTree.put("status_code", 0u);
+        jsonTree.put("description", "succeeded");
+        jsonTree.add_child("roi_info", roisTree);
+    }
+    jsonTree.put("inference_latency", inferenceLatency);
+    jsonTree.put("latency", latency);
+    jsonTree.put("stream_id", inBlob->streamId);
+
+    hce::ai::inference::TimeStampAll_t timeMetaAll;
+    if (inBlob->get(0)->getMeta(timeMetaAll) == hva::hvaSuccess) {
+        if (timeMetaAll.timeStamp1 != std::chrono::time_point<std::chrono::high_resolution_clock>()) {
+            std::chrono::duration<double, std::milli> latencyDuration = endTime - timeMetaAll.timeStamp1;
+            jsonTree.put("latency1", latencyDuration.count());
+        }
+        if (timeMetaAll.timeStamp2 != std::chrono::time_point<std::chrono::high_resolution_clock>()) {
+            std::chrono::duration<double, std::milli> latencyDuration = endTime - timeMetaAll.timeStamp2;
+            jsonTree.put("latency2", latencyDuration.count());
         }
+        if (timeMetaAll.timeStamp3 != std::chrono::time_point<std::chrono::high_resolution_clock>()) {
+            std::chrono::duration<double, std::milli> latencyDuration = endTime - timeMetaAll.timeStamp3;
+            jsonTree.put("latency3", latencyDuration.count());
+        }
+        if (timeMetaAll.timeStamp4 != std::chrono::time_point<std::chrono::high_resolution_clock>()) {
+            std::chrono::duration<double, std::milli> latencyDuration = endTime - timeMetaAll.timeStamp4;
+            jsonTree.put("latency4", latencyDuration.count());
+        }
+    }
 
-        hce::ai::inference::InferenceTimeAll_t inferenceTimeMetaAll;
-        if (inBlob->get(0)->getMeta(inferenceTimeMetaAll) == hva::hvaSuccess) {
-            for (int i = 0; i < 4; i++) {
-                if (0.0 != inferenceTimeMetaAll.inferenceLatencies[i]) {
-                    jsonTree.put("inference_latency" + std::to_string(i + 1), inferenceTimeMetaAll.inferenceLatencies[i]);
-                }
+    hce::ai::inference::InferenceTimeAll_t inferenceTimeMetaAll;
+    if (inBlob->get(0)->getMeta(inferenceTimeMetaAll) == hva::hvaSuccess) {
+        for (int i = 0; i < 4; i++) {
+            if (0.0 != inferenceTimeMetaAll.inferenceLatencies[i]) {
+                jsonTree.put("inference_latency" + std::to_string(i + 1), inferenceTimeMetaAll.inferenceLatencies[i]);
             }
         }
+    }
 
-        std::stringstream ss;
-        boost::property_tree::json_parser::write_json(ss, jsonTree);
-
-        baseResponseNode::Response res;
-        res.status = 0;
-        res.message = ss.str();
+    std::stringstream ss;
+    boost::property_tree::json_parser::write_json(ss, jsonTree);
+    return ss.str();
+}
 
-        HVA_DEBUG("Emit: %s on frame id %d", res.message.c_str(), inBuf->frameId);
-        // auto now = std::chrono::high_resolution_clock::now();
-        // auto epoch = now.time_since_epoch();
-        // auto milliseconds =
-        // std::chrono::duration_cast<std::chrono::milliseconds>(epoch).count();
-        HVA_DEBUG("Emit on frame id %d", inBuf->frameId);
-        // HVA_INFO("Emit on frame id %d with time %d", inBuf->frameId, milliseconds
-        // );
-        dynamic_cast<PostFusionOutputNode *>(getParentPtr())->emitOutput(res, (baseResponseNode *)getParentPtr(), nullptr);
+std::shared_ptr<baseResponseNode::Result> PostFusionOutputNodeWorker::makeResult(const hva::hvaBlob_t::Ptr& inBlob,
+                                                                                  const hva::hvaVideoFrameWithROIBuf_t::Ptr& inBuf,
+                                                                                  const FusionOutput* fusionOutput, double latency, double inferenceLatency,
+                                                                                  const std::chrono::time_point<std::chrono::high_resolution_clock>& endTime)
+{
+    auto result = std::make_shared<baseResponseNode::Result>();
+    result->streamId = inBlob->streamId;
+    result->frameId = inBlob->frameId;
+    result->latency = latency;
+    result->inferenceLatency = inferenceLatency;
+
+    if (fusionOutput) {
+        // fusion radar output
+        for (const auto& fusionBBox : fusionOutput->m_fusionBBox) {
+            baseResponseNode::ResultROI roi;
+            roi.roiClass = fusionBBox.det.label;
+            roi.roiScore = fusionBBox.det.confidence;
+            roi.trackStatus = "dummy";
+            roi.sensorSource = -1;
+            for (int i = 0; i < 4; i++) {
+                roi.fusionRoiState[i] = fusionBBox.radarOutput.S_hat[i];
+            }
+            roi.fusionRoiSize[0] = fusionBBox.radarOutput.xSize;
+            roi.fusionRoiSize[1] = fusionBBox.radarOutput.ySize;
+            result->rois.push_back(std::move(roi));
+        }
 
-        std::shared_ptr<hva::timeStampInfo> postFusionOut = std::make_shared<hva::timeStampInfo>(inBlob->frameId, "postFusionOut");
-        getParentPtr()->emitEvent(hvaEvent_PipelineTimeStampRecord, &postFusionOut);
-        // hce::ai::inference::TimeStamp_t timeMeta;
-        // std::chrono::time_point<std::chrono::high_resolution_clock> startTime;
-        // std::chrono::time_point<std::chrono::high_resolution_clock> endTime;
+        // camera detections which is not associated with radar detections
+        for (size_t roiIdx = 0; roiIdx < fusionOutput->m_cameraFusionRadarCoords.size(); roiIdx++) {
+            if (!fusionOutput->m_cameraFusionRadarCoordsIsAssociated[roiIdx]) {
+                const hce::ai::inference::DetectedObject& detectedObject = fusionOutput->m_cameraFusionRadarCoords[roiIdx];
+                baseResponseNode::ResultROI roi;
+                roi.mediaBirdviewRoi[0] = detectedObject.bbox.x;
+                roi.mediaBirdviewRoi[1] = detectedObject.bbox.y;
+                roi.mediaBirdviewRoi[2] = detectedObject.bbox.width;
+                roi.mediaBirdviewRoi[3] = detectedObject.bbox.height;
+                roi.roiClass = detectedObject.label;
+                roi.roiScore = detectedObject.confidence;
+                roi.trackStatus = "dummy";
+                roi.sensorSource = -1;
+                result->rois.push_back(std::move(roi));
+            }
+        }
 
-        // inBlob->get(0)->getMeta(timeMeta);
-        // startTime = timeMeta.timeStamp;
+        // camera detections information
+        for (size_t cameraId = 0; cameraId < fusionOutput->m_numOfCams; cameraId++) {
+            for (const hva::hvaROI_t& itemPixel : fusionOutput->m_cameraRois[cameraId]) {
+                baseResponseNode::ResultROI roi;
+                roi.roi[0] = itemPixel.x;
+                roi.roi[1] = itemPixel.y;
+                roi.roi[2] = itemPixel.width;
+                roi.roi[3] = itemPixel.height;
+                roi.roiClass = itemPixel.labelDetection;
+                roi.roiScore = itemPixel.confidenceDetection;
+                roi.trackId = itemPixel.trackingId;
+                roi.trackStatus = vas::ot::TrackStatusToString(itemPixel.trackingStatus);
+                roi.sensorSource = cameraId;
+                result->rois.push_back(std::move(roi));
+            }
+        }
+    }
 
-        // endTime = std::chrono::high_resolution_clock::now();
-        // auto latencyDuration = endTime - startTime;
-        // auto latency = std::chrono::duration_cast<std::chrono::milliseconds>(latencyDuration).count();
+    if (result->rois.empty()) {
+        if (inBuf->drop) {
+            result->statusCode = -2;
+            result->description = "Read or decode input media failed";
+        }
+        else {
+            result->statusCode = 1;
+            result->description = "noRoiDetected";
+        }
+    }
+    else {
+        result->statusCode = 0;
+        result->description = "succeeded";
+    }
 
-        // if (inBuf->getTag() == 1) {
-        //     // auto now = std::chrono::high_resolution_clock::now();
-        //     // auto epoch = now.time_since_epoch();
-        //     // auto milliseconds =
-        //     // std::chrono::duration_cast<std::chrono::milliseconds>(epoch).count();
-        //     HVA_DEBUG("Emit finish on frame id %d", inBuf->frameId);
-        //     // HVA_INFO("Emit finish on frame id %d with time %d", inBuf->frameId,
-        //     // milliseconds );
-        //     dynamic_cast<PostFusionOutputNode *>(getParentPtr())->emitFinish((baseResponseNode *)getParentPtr(), nullptr);
-        // }
-        if (inBuf->getTag() == hvaBlobBufferTag::END_OF_REQUEST) {
-            dynamic_cast<PostFusionOutputNode *>(getParentPtr())->addEmitFinishFlag();
-            HVA_DEBUG("Receive finish flag on framid %u and streamid %u", inBlob->frameId, inBlob->streamId);
+    hce::ai::inference::TimeStampAll_t timeMetaAll;
+    if (inBlob->get(0)->getMeta(timeMetaAll) == hva::hvaSuccess) {
+        const std::chrono::time_point<std::chrono::high_resolution_clock> timeStamps[4] = {timeMetaAll.timeStamp1, timeMetaAll.timeStamp2,
+                                                                                           timeMetaAll.timeStamp3, timeMetaAll.timeStamp4};
+        for (int i = 0; i < 4; i++) {
+            if (timeStamps[i] != std::chrono::time_point<std::chrono::high_resolution_clock>()) {
+                std::chrono::duration<double, std::milli> latencyDuration = endTime - timeStamps[i];
+                result->latencies.push_back({"latency" + std::to_string(i + 1), latencyDuration.count()});
+            }
         }
     }
-    // check whether to trigger emitFinish()
-    if (dynamic_cast<PostFusionOutputNode *>(getParentPtr())->isEmitFinish()) {
-        // coming batch processed done
-        HVA_DEBUG("Emit finish!");
-        dynamic_cast<PostFusionOutputNode *>(getParentPtr())->emitFinish((baseResponseNode *)getParentPtr(), nullptr);
+
+    hce::ai::inference::InferenceTimeAll_t inferenceTimeMetaAll;
+    if (inBlob->get(0)->getMeta(inferenceTimeMetaAll) == hva::hvaSuccess) {
+        for (int i = 0; i < 4; i++) {
+            if (0.0 != inferenceTimeMetaAll.inferenceLatencies[i]) {
+                result->latencies.push_back({"inference_latency" + std::to_string(i + 1), inferenceTimeMetaAll.inferenceLatencies[i]});
+            }
+        }
     }
+    return result;
 }
 
 void PostFusionOutputNodeWorker::processByLastRun(std::size_t batchIdx)
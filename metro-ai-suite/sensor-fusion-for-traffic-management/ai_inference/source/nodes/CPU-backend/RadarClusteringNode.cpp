@@ -18,6 +18,7 @@
 #include "inc/buffer/hvaVideoFrameWithROIBuf.hpp"
 #include "inc/buffer/hvaVideoFrameWithMetaROIBuf.hpp"
 #include "nodes/databaseMeta.hpp"
+#include "common/latency_tracer.hpp"
 
 #include <sys/stat.h>
 
@@ -284,6 +285,8 @@ class RadarClusteringNodeWorker::Impl {
 
     bool m_configured;
 
+    uint32_t m_pipelineIndex {0u};      // see LatencyTracer::pipelineOf()
+
     /**
      * @brief Create and initialize clusteringDBscan.
      * @param param RadarClusteringConfig
@@ -335,7 +338,7 @@ RadarClusteringNodeWorker::Impl::~Impl()
 
 void RadarClusteringNodeWorker::Impl::init()
 {
-    return;
+    m_pipelineIndex = LatencyTracer::getInstance().pipelineOf(m_ctx.getParentPtr());
 }
 
 /**
@@ -356,6 +359,8 @@ void RadarClusteringNodeWorker::Impl::process(std::size_t batchIdx)
         std::shared_ptr<hva::timeStampInfo> RadarClusteringIn =
         std::make_shared<hva::timeStampInfo>(blob->frameId, "RadarClusteringIn");
         m_ctx.getParentPtr()->emitEvent(hvaEvent_PipelineTimeStampRecord, &RadarClusteringIn);
+        static LatencyTracer::Stage* latencyStage = LatencyTracer::getInstance().getStage("RadarClusteringNode");
+        LatencyScope latencyScope(latencyStage, blob->streamId, blob->frameId, m_pipelineIndex);
         hva::hvaVideoFrameWithMetaROIBuf_t::Ptr ptrFrameBuf = std::dynamic_pointer_cast<hva::hvaVideoFrameWithMetaROIBuf_t>(blob->get(0));
         HVA_ASSERT(ptrFrameBuf);
 
@@ -29,6 +29,9 @@ LocalFileManager::LocalFileManager() : m_batchIdx(0) {
 }
 
 LocalFileManager::~LocalFileManager() { 
+    if (m_resultFile) {
+        tools::AsyncResultWriter::getInstance().close(m_resultFile);
+    }
 }
 
 void LocalFileManager::init(std::size_t batchIdx) {
@@ -46,8 +49,8 @@ void LocalFileManager::init(std::size_t batchIdx) {
 }
 
 /**
- * save results as local file:  {timestamp}.csv
- * each column name should be consist with hvaROI_t
+ * save results as local binary file: radarResults.bin, written by the shared result writer,
+ * converted to csv offline by `ResultFileConverter`
 */
 
 /*  PonintClouds
@@ -63,177 +66,69 @@ void LocalFileManager::init(std::size_t batchIdx) {
 */
 
 bool LocalFileManager::saveResultsToFile(const unsigned frameId, const clusteringDBscanOutput& output){
-                        // const int statusCode, const std::string description){
     std::lock_guard<std::mutex> lg(m_fileMutex);
 
-    // for (size_t idx = 0; idx < rois.size(); idx ++) {
-        std::vector<std::pair<std::string, std::vector<std::string>>> resultSetVec;
-        // pcl info
-
-        std::vector<std::string> frameIdx;
-        std::vector<std::string> ClusteringNum;
-
-        // information in each cluster, put all information into one vector
-        std::vector<std::string> numPoints;
-        std::vector<std::string> xCenters;
-        std::vector<std::string> yCenters;
-        std::vector<std::string> xSizes;
-        std::vector<std::string> ySizes;
-        std::vector<std::string> avgVels;
-        std::vector<std::string> vxs;
-        std::vector<std::string> vys;
-        std::vector<std::string> centerRangeVars;
-        std::vector<std::string> centerAngleVars;
-        std::vector<std::string> centerDopplerVars;
-        frameIdx.push_back(std::to_string(frameId));
-        HVA_DEBUG("numCluster: %d",output.numCluster);
-        ClusteringNum.push_back(std::to_string(output.numCluster));
-
-        for(int i=0;i<output.numCluster;i++){
-            float xCenter = output.report[i].xCenter;
-            float yCenter = output.report[i].yCenter;
-            float azimuth;
-            // if(yCenter > 0){
-            //     azimuth = atan(output.report[i].xCenter/output.report[i].yCenter)+ CLUSTERTRACKER_PI/2;
-            // }else{
-            //     azimuth = atan(output.report[i].yCenter/output.report[i].xCenter);
-            // }
-            // // float azimuth = atan(output.report[i].xCenter/output.report[i].yCenter);
-            // float avgVel = output.report[i].avgVel;
-            // float vx = avgVel*cos(azimuth);
-            // float vy = avgVel*sin(azimuth);
-            // if(avgVel >0){
-            //     vx = -vx;
-            //     vy = -vy;
-            // }
-            azimuth = atan2(output.report[i].yCenter,output.report[i].xCenter);
-            float vx = output.report[i].avgVel*cos(azimuth);
-            float vy = output.report[i].avgVel*sin(azimuth);
-            numPoints.push_back(std::to_string(output.report[i].numPoints));
-            xCenters.push_back(std::to_string(output.report[i].xCenter));
-            yCenters.push_back(std::to_string(output.report[i].yCenter));
-            xSizes.push_back(std::to_string(output.report[i].xSize));
-            ySizes.push_back(std::to_string(output.report[i].ySize));
-            avgVels.push_back(std::to_string(output.report[i].avgVel));
-            vxs.push_back(std::to_string(vx));
-            vys.push_back(std::to_string(-vy));
-            centerRangeVars.push_back(std::to_string(output.report[i].centerRangeVar));
-            centerAngleVars.push_back(std::to_string(output.report[i].centerAngleVar));
-            centerDopplerVars.push_back(std::to_string(output.report[i].centerDopplerVar));
-   
-        }
-        resultSetVec.push_back(addColumnDataVec("frameId", frameIdx));
-        resultSetVec.push_back(addColumnDataVec("ClusteringNum", ClusteringNum));
-        resultSetVec.push_back(addColumnDataVec("numPointsInClusters", numPoints));
-        resultSetVec.push_back(addColumnDataVec("xCenters", xCenters));
-        resultSetVec.push_back(addColumnDataVec("yCenters", yCenters));
-        resultSetVec.push_back(addColumnDataVec("xSizes", xSizes));
-        resultSetVec.push_back(addColumnDataVec("ySizes", ySizes));
-        resultSetVec.push_back(addColumnDataVec("avgVels", avgVels));
-        resultSetVec.push_back(addColumnDataVec("vxs", vxs));
-        resultSetVec.push_back(addColumnDataVec("vys", vys));
-        resultSetVec.push_back(addColumnDataVec("centerRangeVars", centerRangeVars));
-        resultSetVec.push_back(addColumnDataVec("centerAngleVars", centerAngleVars));
-        resultSetVec.push_back(addColumnDataVec("centerDopplerVars", centerDopplerVars));
-
-        // status code
-        // resultSet.push_back(addColumnData("status", std::to_string(statusCode)));
-        // resultSet.push_back(addColumnData("description", description));
-
-
-        // check the folder of result file for the first time
-        if (m_firstLine) {
-            checkPath(m_resultPath);
-        }
-
-        std::ofstream resfile;
-        resfile.open(m_resultPath, std::ios::out | std::ios::app);
-        if (!resfile.is_open()) {
-            HVA_ERROR("Failed to open result file: %s !", m_resultPath.c_str());
-            return false;
-        }
-
-        // first line: do create csv file and write headers
-        if (m_firstLine) {
-
-            // write headers
-            std::vector<std::string> vecHeaders(m_headers.size());
-            for (auto &item: m_headers) {
-                vecHeaders[item.second] = item.first;
-            }
-            for (auto &header : vecHeaders) {
-                resfile << header << ",";
-            }
-            resfile << "\n";
-            m_firstLine = false;
+    if (!m_resultFile) {
+        std::vector<tools::ResultColumn> columns = {
+            {"frameId", tools::RESULT_COLUMN_UINT32, tools::RESULT_COLUMN_FLAG_LIST},
+            {"ClusteringNum", tools::RESULT_COLUMN_INT32, tools::RESULT_COLUMN_FLAG_LIST},
+            {"numPointsInClusters", tools::RESULT_COLUMN_INT32, tools::RESULT_COLUMN_FLAG_LIST}};
+        for (const auto& name : {"xCenters", "yCenters", "xSizes", "ySizes", "avgVels", "vxs", "vys",
+                                 "centerRangeVars", "centerAngleVars", "centerDopplerVars"}) {
+            columns.emplace_back(name, tools::RESULT_COLUMN_FLOAT32, tools::RESULT_COLUMN_FLAG_LIST);
         }
+        m_resultFile = tools::AsyncResultWriter::getInstance().open(m_resultPath, columns);
+    }
 
-        // fomat contents to the corresponding column index
-        bool isHeaderUpdated = false;
-
-        std::vector<std::vector<std::string>> rowDataVec(resultSetVec.size());
-
-        for (auto &item: resultSetVec) {
-            std::string key = item.first;
-
-            // insert new header
-            if (m_headers.count(key) == 0) {
-                isHeaderUpdated = true;
-                m_headers.emplace(key, m_headers.size());
-            }
-            rowDataVec[m_headers[key]] = item.second;
-        }
-        // start wrting contents
-        for (auto &val : rowDataVec) {
-            // resfile << val << ",";
-            for(auto &innerVal : val){
-                resfile << innerVal << " ";
-            }
-            resfile << ",";
-        }
-        resfile << "\n";
-        resfile.close();
-
-        // 
-        // HEADER PATCH: in case of handling non-fixed length of attributes
-        // csv headers have been created, re-write first line
-        // 
-        if (isHeaderUpdated) {
-            // generate new header line
-            std::vector<std::string> vecHeaders(m_headers.size());
-            for (auto &item: m_headers) {
-                vecHeaders[item.second] = item.first;
-            }
-            std::string content;
-            for (auto &header : vecHeaders) {
-                content += header + ",";
-            }
-
-            try {
-                // replace the first line with new header content
-                replaceLineInFile(m_resultPath, content, 0);
-            }
-            catch (const std::exception &e)
-            {
-                HVA_ERROR("Failed to update header line in result file, error: %s", e.what());
-                return false;
-            }
-            catch (...) {
-                HVA_ERROR("Failed to update header line in result file: %s", m_resultPath.c_str());
-                return false;
-            }
+    // information in each cluster, one column per field holding the values of all the clusters
+    HVA_DEBUG("numCluster: %d",output.numCluster);
+    tools::ResultRecord record;
+    auto putColumn = [&](auto value) {
+        record.beginList();
+        for (int i = 0; i < output.numCluster; i++) {
+            record.add(value(output.report[i]));
         }
-    // }
+        record.endList();
+    };
+    record.put(frameId).put(output.numCluster);
+    putColumn([](const clusteringDBscanReport& r) { return r.numPoints; });
+    putColumn([](const clusteringDBscanReport& r) { return r.xCenter; });
+    putColumn([](const clusteringDBscanReport& r) { return r.yCenter; });
+    putColumn([](const clusteringDBscanReport& r) { return r.xSize; });
+    putColumn([](const clusteringDBscanReport& r) { return r.ySize; });
+    putColumn([](const clusteringDBscanReport& r) { return r.avgVel; });
+    putColumn([](const clusteringDBscanReport& r) { return r.avgVel * cos(atan2(r.yCenter, r.xCenter)); });
+    putColumn([](const clusteringDBscanReport& r) { return -r.avgVel * sin(atan2(r.yCenter, r.xCenter)); });
+    putColumn([](const clusteringDBscanReport& r) { return r.centerRangeVar; });
+    putColumn([](const clusteringDBscanReport& r) { return r.centerAngleVar; });
+    putColumn([](const clusteringDBscanReport& r) { return r.centerDopplerVar; });
+
+    // written to disk by the writer thread
+    if (!tools::AsyncResultWriter::getInstance().append(m_resultFile, std::move(record))) {
+        HVA_ERROR("Failed to write result file: %s !", m_resultPath.c_str());
+        return false;
+    }
 
     return true;
 }
 
+/**
+ * wait until the results saved so far are written to the result file
+*/
+void LocalFileManager::flush() {
+    if (m_resultFile) {
+        tools::AsyncResultWriter::getInstance().flush(m_resultFile);
+    }
+}
+
 /**
  * construct save path for each request
 */
 void LocalFileManager::reset() {
-    m_firstLine = true;
-    m_headers.clear();
+    if (m_resultFile) {
+        tools::AsyncResultWriter::getInstance().close(m_resultFile);
+        m_resultFile.reset();
+    }
     constructSavePath();
 };
 
@@ -259,26 +154,12 @@ void LocalFileManager::constructSavePath() {
 
     std::string activeSaveFolder = tmp;
 
-    m_resultPath = activeSaveFolder + "/radarResults.csv";
+    m_resultPath = activeSaveFolder + "/radarResults.bin";
     HVA_DEBUG("resultPath: %s", m_resultPath.c_str());
     // m_snapshotPath = activeSaveFolder + "/snapshots";
     HVA_INFO("Results for next request will be saved in: %s", activeSaveFolder.c_str());
 }
 
-/**
- * @brief check filepath
- * if filepath not exist, check the folder
- * if folder not exist, make the dir
-*/
-void LocalFileManager::checkPath(const std::string& path) {
-    boost::filesystem::path p(path);
-    boost::filesystem::path folder = p.parent_path();
-    if (!boost::filesystem::exists(folder)) {
-        HVA_INFO("Folder not exists, create: %s", folder.c_str());
-        boost::filesystem::create_directories(folder.c_str());
-    }
-}
-
 /**
  * @brief check folder
  * if folder not exist, make the dir
@@ -290,57 +171,6 @@ void LocalFileManager::checkFolder(const std::string& path) {
     }
 }
 
-/**
- * @brief add new colum data, also add new key into m_headers at the first time (i.e. m_firstLine == true)
- */
-std::pair<std::string, std::string> LocalFileManager::addColumnData(std::string key, std::string val) {
-    std::pair<std::string, std::string> data = std::make_pair(key, val);
-    if (m_firstLine && m_headers.count(key) == 0) {
-        m_headers.emplace(key, m_headers.size());
-    }
-    return data;
-}
-
-std::pair<std::string, std::vector<std::string>> LocalFileManager::addColumnDataVec(std::string key, std::vector<std::string> valVec) {
-    std::pair<std::string, std::vector<std::string>> data = std::make_pair(key, valVec);
-    if (m_firstLine && m_headers.count(key) == 0) {
-        m_headers.emplace(key, m_headers.size());
-    }
-    return data;
-}
-
-
-/**
- * @brief replace a specific line, default as the first line
- * @param filepath the file to be modified
- * @param content the dst line content
- * @param lineIndex index for the line to be replaced
- */
-void LocalFileManager::replaceLineInFile(std::string filepath, std::string content, int lineIndex) {
-    std::ifstream infile(filepath);
-    std::vector<std::string> lines;
-    std::string input;
-    while (std::getline(infile, input))
-        lines.push_back(input);
-    infile.close();
-
-    if (lineIndex >= lines.size() || lineIndex < 0) {
-        char msg[256];
-        sprintf(msg,
-                "Failed to replace file at line: %d, total lines: %ld, file "
-                "path: %s",
-                lineIndex, lines.size(), filepath.c_str());
-        throw std::runtime_error(msg);
-    }
-    lines[lineIndex] = content;
-
-    // replace the original contents
-    std::ofstream outfile(filepath, std::ios::trunc);
-    for (auto const& line : lines)
-        outfile << line << '\n';
-    outfile.close();
-}
-
 RadarClusteringSinkFileNodeWorker::RadarClusteringSinkFileNodeWorker(hva::hvaNode_t* parentNode, const std::string& bufType):hva::hvaNodeWorker_t(parentNode), 
         m_bufType(bufType){
 
@@ -441,6 +271,8 @@ void RadarClusteringSinkFileNodeWorker::process(std::size_t batchIdx){
         HVA_DEBUG("Emit: on frame id %d tag %d",  buf->frameId, buf->getTag());
 
         if(buf->getTag() == 1){
+            // results of the request are on disk before the client is told it finished
+            m_localFileManager.flush();
             HVA_DEBUG("Emit finish on frame id %d", buf->frameId);
             dynamic_cast<RadarClusteringSinkFileNode*>(getParentPtr())->emitFinish((baseResponseNode*)getParentPtr(), nullptr);
         }
@@ -461,6 +293,11 @@ void RadarClusteringSinkFileNodeWorker::processByLastRun(std::size_t batchIdx){
     dynamic_cast<RadarClusteringSinkFileNode*>(getParentPtr())->emitFinish((baseResponseNode*)getParentPtr(), nullptr);
 }
 
+void RadarClusteringSinkFileNodeWorker::deinit(){
+    m_localFileManager.reset();
+    tools::AsyncResultWriter::getInstance().flush();
+}
+
 RadarClusteringSinkFileNode::RadarClusteringSinkFileNode(std::size_t totalThreadNum):baseResponseNode(1, 0,totalThreadNum), m_bufType("FD"){
     transitStateTo(hva::hvaState_t::configured);
 
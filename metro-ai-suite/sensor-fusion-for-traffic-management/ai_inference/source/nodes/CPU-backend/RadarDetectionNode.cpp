@@ -23,6 +23,7 @@
 
 #include "common/base64.hpp"
 #include "nodes/databaseMeta.hpp"
+#include "common/latency_tracer.hpp"
 namespace hce{
 
 namespace ai{
@@ -173,6 +174,8 @@ private:
 
     RadarConfigParam m_radar_config; 
 
+    uint32_t m_pipelineIndex {0u};      // see LatencyTracer::pipelineOf()
+
     // std::atomic<int32_t> m_cntAsyncEnd{0};
     // std::atomic<int32_t> m_cntAsyncStart{0};
 
@@ -209,12 +212,20 @@ void RadarDetectionNodeWorker::Impl::process(std::size_t batchIdx){
         std::shared_ptr<hva::timeStampInfo> RadarDetectionIn =
             std::make_shared<hva::timeStampInfo>(blob->frameId, "RadarDetectionIn");
         m_ctx.getParentPtr()->emitEvent(hvaEvent_PipelineTimeStampRecord, &RadarDetectionIn);
+        static LatencyTracer::Stage* latencyStage = LatencyTracer::getInstance().getStage("RadarDetectionNode");
+        LatencyScope latencyScope(latencyStage, blob->streamId, blob->frameId, m_pipelineIndex);
         
         hva::hvaVideoFrameWithMetaROIBuf_t::Ptr ptrFrameBuf = std::dynamic_pointer_cast<hva::hvaVideoFrameWithMetaROIBuf_t>(blob->get(0));
         RadarConfigParam params;
         ptrFrameBuf->getMeta(params);
 
         unsigned tag = ptrFrameBuf->getTag();
+        // give back the credit on dropped frames as well, e.g. frames turned stale under drop_oldest
+        BackpressureController::Ptr controllerMeta;
+        if(ptrFrameBuf->getMeta(controllerMeta) == hva::hvaSuccess && controllerMeta->controls("Radar")){
+            controllerMeta->release();
+        }
+
         if (!ptrFrameBuf->drop)
         {
 
@@ -244,18 +255,6 @@ void RadarDetectionNodeWorker::Impl::process(std::size_t batchIdx){
             hvabuf->frameId = blob->frameId;
             hvabuf->tagAs(tag);
 
-            SendController::Ptr controllerMeta;
-            if(ptrFrameBuf->getMeta(controllerMeta) == hva::hvaSuccess){
-                if (("Radar" == controllerMeta->controlType) && (0 < controllerMeta->capacity)) {
-                    std::unique_lock<std::mutex> lock(controllerMeta->mtx);
-                    (controllerMeta->count)--;
-                    if (controllerMeta->count % controllerMeta->stride == 0) {
-                        (controllerMeta->notFull).notify_all();
-                    }
-                    lock.unlock();
-                }
-            }
-
             auto radarBlob = hva::hvaBlob_t::make_blob();
    
             radarBlob->frameId = blob->frameId;
@@ -303,7 +302,7 @@ void RadarDetectionNodeWorker::Impl::process(std::size_t batchIdx){
 }
 
 void RadarDetectionNodeWorker::Impl::init(){
-    // todo
+    m_pipelineIndex = LatencyTracer::getInstance().pipelineOf(m_ctx.getParentPtr());
 }
 
 RadarDetectionNodeWorker::RadarDetectionNodeWorker(hva::hvaNode_t *parentNode, RadarConfigParam m_radar_config): 
@@ -51,51 +51,16 @@ void RadarDetectionOutputNodeWorker::process(std::size_t batchIdx){
         double latency = latencyDuration.count();
 
 
-        m_jsonTree.clear();
-        m_rois.clear();
-        int roi_idx = 0;
-        int status_code;
-        std::string description;
-        
-
-        if (buf->get<pointClouds>().num >0)
-        {
-            HVA_DEBUG("pcl number: %d", buf->get<pointClouds>().num);
-            m_jsonTree.put("status_code", 0u);
-            m_jsonTree.put("description", "succeeded");
-            // description = "succeeded";
-            m_jsonTree.put("frameId", buf->frameId);
-            m_jsonTree.put("num", buf->get<pointClouds>().num);
-
-
-            boost::property_tree::ptree pcls;
-            for(int i=0;i<buf->get<pointClouds>().num;i++){
-                boost::property_tree::ptree pcl;
-                pcl.put("rangeIdxArray", buf->get<pointClouds>().rangeIdxArray[i]);
-                pcl.put("rangeFloat", buf->get<pointClouds>().rangeFloat[i]);
-                pcl.put("speedIdxArray", buf->get<pointClouds>().speedIdxArray[i]);
-                pcl.put("speedFloat", buf->get<pointClouds>().speedFloat[i]);
-                pcl.put("SNRArray", buf->get<pointClouds>().SNRArray[i]);
-                pcl.put("aoaVar", buf->get<pointClouds>().aoaVar[i]);
-                pcls.push_back(std::make_pair("", pcl));
-            }
-            m_jsonTree.put("latency", latency);
-            m_jsonTree.add_child("pcl", pcls);
-        }
-        else{
-            m_jsonTree.put("status_code", -2);
-            m_jsonTree.put("description", "failed");
-            m_jsonTree.put("latency", latency);
-        }
-
-        std::stringstream ss;
-        boost::property_tree::json_parser::write_json(ss, m_jsonTree);
-
         baseResponseNode::Response res;
         res.status = 0;
-        res.message = ss.str();
-
-        HVA_DEBUG("Emit: %s on frame id %d", res.message.c_str(), buf->frameId);
+        if (dynamic_cast<RadarDetectionOutputNode*>(getParentPtr())->getResultFormat() == baseResponseNode::RESULT_FORMAT_TYPED) {
+            res.result = makeResult(inBlob, buf, latency);
+            HVA_DEBUG("Emit typed result with %d points on frame id %d", res.result->pointClouds.size(), buf->frameId);
+        }
+        else {
+            res.message = makeJsonMessage(buf, latency);
+            HVA_DEBUG("Emit: %s on frame id %d", res.message.c_str(), buf->frameId);
+        }
 
         dynamic_cast<RadarDetectionOutputNode*>(getParentPtr())->emitOutput(res, (baseResponseNode*)getParentPtr(), nullptr);
         
@@ -109,6 +74,73 @@ void RadarDetectionOutputNodeWorker::process(std::size_t batchIdx){
     }
 }
 
+std::string RadarDetectionOutputNodeWorker::makeJsonMessage(const hva::hvaVideoFrameWithMetaROIBuf_t::Ptr& buf, double latency){
+    m_jsonTree.clear();
+
+    if (buf->get<pointClouds>().num >0)
+    {
+        HVA_DEBUG("pcl number: %d", buf->get<pointClouds>().num);
+        m_jsonTree.put("status_code", 0u);
+        m_jsonTree.put("description", "succeeded");
+        m_jsonTree.put("frameId", buf->frameId);
+        m_jsonTree.put("num", buf->get<pointClouds>().num);
+
+
+        boost::property_tree::ptree pcls;
+        for(int i=0;i<buf->get<pointClouds>().num;i++){
+            boost::property_tree::ptree pcl;
+            pcl.put("rangeIdxArray", buf->get<pointClouds>().rangeIdxArray[i]);
+            pcl.put("rangeFloat", buf->get<pointClouds>().rangeFloat[i]);
+            pcl.put("speedIdxArray", buf->get<pointClouds>().speedIdxArray[i]);
+            pcl.put("speedFloat", buf->get<pointClouds>().speedFloat[i]);
+            pcl.put("SNRArray", buf->get<pointClouds>().SNRArray[i]);
+            pcl.put("aoaVar", buf->get<pointClouds>().aoaVar[i]);
+            pcls.push_back(std::make_pair("", pcl));
+        }
+        m_jsonTree.put("latency", latency);
+        m_jsonTree.add_child("pcl", pcls);
+    }
+    else{
+        m_jsonTree.put("status_code", -2);
+        m_jsonTree.put("description", "failed");
+        m_jsonTree.put("latency", latency);
+    }
+
+    std::stringstream ss;
+    boost::property_tree::json_parser::write_json(ss, m_jsonTree);
+    return ss.str();
+}
+
+std::shared_ptr<baseResponseNode::Result> RadarDetectionOutputNodeWorker::makeResult(const hva::hvaBlob_t::Ptr& inBlob,
+                                                                                     const hva::hvaVideoFrameWithMetaROIBuf_t::Ptr& buf,
+                                                                                     double latency){
+    auto result = std::make_shared<baseResponseNode::Result>();
+    result->streamId = inBlob->streamId;
+    result->frameId = buf->frameId;
+    result->latency = latency;
+
+    const pointClouds& pcl = buf->get<pointClouds>();
+    if (pcl.num > 0) {
+        result->statusCode = 0;
+        result->description = "succeeded";
+        result->pointClouds.resize(pcl.num);
+        for (int i = 0; i < pcl.num; i++) {
+            baseResponseNode::ResultPointCloud& point = result->pointClouds[i];
+            point.rangeIdx = pcl.rangeIdxArray[i];
+            point.range = pcl.rangeFloat[i];
+            point.speedIdx = pcl.speedIdxArray[i];
+            point.speed = pcl.speedFloat[i];
+            point.snr = pcl.SNRArray[i];
+            point.aoaVar = pcl.aoaVar[i];
+        }
+    }
+    else {
+        result->statusCode = -2;
+        result->description = "failed";
+    }
+    return result;
+}
+
 void RadarDetectionOutputNodeWorker::processByLastRun(std::size_t batchIdx){
     dynamic_cast<RadarDetectionOutputNode*>(getParentPtr())->emitFinish((baseResponseNode*)getParentPtr(), nullptr);
 }
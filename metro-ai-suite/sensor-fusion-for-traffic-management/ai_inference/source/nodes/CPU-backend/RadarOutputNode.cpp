@@ -12,6 +12,8 @@
  * other than those that are expressly stated in the License.
  */
 
+#include <algorithm>
+
 #include <boost/exception/all.hpp>
 
 #include <inc/buffer/hvaVideoFrameWithMetaROIBuf.hpp>
@@ -79,9 +81,6 @@ void RadarOutputNodeWorker::process(std::size_t batchIdx)
         unsigned tag = buf->getTag();
         HVA_DEBUG("Radar output start processing %d frame with tag %d", inBlob->frameId, tag);
 
-        boost::property_tree::ptree jsonTree;
-        boost::property_tree::ptree roisTree;
-
         hce::ai::inference::TimeStamp_t timeMeta;
         if (buf->containMeta<hce::ai::inference::TimeStamp_t>()) {
             // success
@@ -98,70 +97,17 @@ void RadarOutputNodeWorker::process(std::size_t batchIdx)
         std::chrono::duration<double, std::milli> latencyDuration = endTime - startTime;
         double latency = latencyDuration.count();
 
-        jsonTree.clear();
-        roisTree.clear();
-
-        int roi_idx = 0;
-        for (const auto &item : output.outputInfo) {
-            boost::property_tree::ptree roiInfoTree;
-
-            // dummy media roi
-            boost::property_tree::ptree roiBoxTree;
-            std::vector<int> roiBoxVal = {0, 0, 0, 0};
-            putVectorToJson<int>(roiBoxTree, roiBoxVal);
-
-            roiInfoTree.add_child("roi", roiBoxTree);
-            roiInfoTree.put("roi_class", "dummy");
-            roiInfoTree.put("roi_score", 0.0);
-
-            // dummy tracking
-            roiInfoTree.put("track_id", 0.0);
-            roiInfoTree.put("track_status", "dummy");
-
-            // dummy media birdview roi
-            boost::property_tree::ptree roiWorldBoxTree;
-            std::vector<float> roiWorldBoxVal = {0.0, 0.0, 0.0, 0.0};
-            putVectorToJson<float>(roiWorldBoxTree, roiWorldBoxVal);
-            roiInfoTree.add_child("media_birdview_roi", roiWorldBoxTree);
-
-            // radar output
-            boost::property_tree::ptree stateTree;
-            std::vector<float> stateVal = {item.S_hat[0], item.S_hat[1], item.S_hat[2], item.S_hat[3]};
-            putVectorToJson<float>(stateTree, stateVal);
-            roiInfoTree.add_child("fusion_roi_state", stateTree);
-
-            boost::property_tree::ptree sizeTree;
-            std::vector<float> sizeVal = {item.xSize, item.ySize};
-            putVectorToJson<float>(sizeTree, sizeVal);
-            roiInfoTree.add_child("fusion_roi_size", sizeTree);
-
-            // E2E latency
-            // roiInfoTree.put("latency", latency);
-
-            roisTree.push_back(std::make_pair("", roiInfoTree));
-        }
-
-        // if(m_bufType == "String" && buf->get<pointClouds>()){
-        if (output.outputInfo.size() > 0) {
-            jsonTree.put("status_code", 0u);
-            jsonTree.put("description", "succeeded");
-            jsonTree.add_child("roi_info", roisTree);
-            jsonTree.put("latency", latency);
+        baseResponseNode::Response res;
+        res.status = 0;
+        if (dynamic_cast<RadarOutputNode *>(getParentPtr())->getResultFormat() == baseResponseNode::RESULT_FORMAT_TYPED) {
+            res.result = makeResult(inBlob, buf, output, latency);
+            HVA_INFO("Emit typed result with %d tracks and %d clusters on frame id %d", res.result->tracks.size(), res.result->clusters.size(),
+                     buf->frameId);
         }
         else {
-            jsonTree.put("status_code", -2);
-            jsonTree.put("description", "failed");
-            jsonTree.put("latency", latency);
+            res.message = makeJsonMessage(output, latency);
+            HVA_INFO("Emit: %s on frame id %d", res.message.c_str(), buf->frameId);
         }
-        std::stringstream ss;
-        boost::property_tree::json_parser::write_json(ss, jsonTree);
-
-        baseResponseNode::Response res;
-        res.status = 0;
-        // res.message = "Success!";
-        res.message = ss.str();
-
-        HVA_INFO("Emit: %s on frame id %d", res.message.c_str(), buf->frameId);
 
         dynamic_cast<RadarOutputNode *>(getParentPtr())->emitOutput(res, (baseResponseNode *)getParentPtr(), nullptr);
         HVA_DEBUG("output tag: %d", buf->getTag());
@@ -174,6 +120,130 @@ void RadarOutputNodeWorker::process(std::size_t batchIdx)
     }
 }
 
+std::string RadarOutputNodeWorker::makeJsonMessage(const trackerOutput &output, double latency)
+{
+    boost::property_tree::ptree jsonTree;
+    boost::property_tree::ptree roisTree;
+
+    for (const auto &item : output.outputInfo) {
+        boost::property_tree::ptree roiInfoTree;
+
+        // dummy media roi
+        boost::property_tree::ptree roiBoxTree;
+        std::vector<int> roiBoxVal = {0, 0, 0, 0};
+        putVectorToJson<int>(roiBoxTree, roiBoxVal);
+
+        roiInfoTree.add_child("roi", roiBoxTree);
+        roiInfoTree.put("roi_class", "dummy");
+        roiInfoTree.put("roi_score", 0.0);
+
+        // dummy tracking
+        roiInfoTree.put("track_id", 0.0);
+        roiInfoTree.put("track_status", "dummy");
+
+        // dummy media birdview roi
+        boost::property_tree::ptree roiWorldBoxTree;
+        std::vector<float> roiWorldBoxVal = {0.0, 0.0, 0.0, 0.0};
+        putVectorToJson<float>(roiWorldBoxTree, roiWorldBoxVal);
+        roiInfoTree.add_child("media_birdview_roi", roiWorldBoxTree);
+
+        // radar output
+        boost::property_tree::ptree stateTree;
+        std::vector<float> stateVal = {item.S_hat[0], item.S_hat[1], item.S_hat[2], item.S_hat[3]};
+        putVectorToJson<float>(stateTree, stateVal);
+        roiInfoTree.add_child("fusion_roi_state", stateTree);
+
+        boost::property_tree::ptree sizeTree;
+        std::vector<float> sizeVal = {item.xSize, item.ySize};
+        putVectorToJson<float>(sizeTree, sizeVal);
+        roiInfoTree.add_child("fusion_roi_size", sizeTree);
+
+        // E2E latency
+        // roiInfoTree.put("latency", latency);
+
+        roisTree.push_back(std::make_pair("", roiInfoTree));
+    }
+
+    // if(m_bufType == "String" && buf->get<pointClouds>()){
+    if (output.outputInfo.size() > 0) {
+        jsonTree.put("status_code", 0u);
+        jsonTree.put("description", "succeeded");
+        jsonTree.add_child("roi_info", roisTree);
+        jsonTree.put("latency", latency);
+    }
+    else {
+        jsonTree.put("status_code", -2);
+        jsonTree.put("description", "failed");
+        jsonTree.put("latency", latency);
+    }
+    std::stringstream ss;
+    boost::property_tree::json_parser::write_json(ss, jsonTree);
+    return ss.str();
+}
+
+std::shared_ptr<baseResponseNode::Result> RadarOutputNodeWorker::makeResult(const hva::hvaBlob_t::Ptr &inBlob,
+                                                                            const hva::hvaVideoFrameWithMetaROIBuf_t::Ptr &buf,
+                                                                            const trackerOutput &output, double latency)
+{
+    auto result = std::make_shared<baseResponseNode::Result>();
+    result->streamId = inBlob->streamId;
+    result->frameId = buf->frameId;
+    result->latency = latency;
+
+    // the tracks as roi_info of json message, with dummy media fields
+    result->rois.reserve(output.outputInfo.size());
+    result->tracks.reserve(output.outputInfo.size());
+    for (const auto &item : output.outputInfo) {
+        baseResponseNode::ResultROI roi;
+        roi.roiClass = "dummy";
+        roi.trackStatus = "dummy";
+        std::copy(item.S_hat, item.S_hat + 4, roi.fusionRoiState);
+        roi.fusionRoiSize[0] = item.xSize;
+        roi.fusionRoiSize[1] = item.ySize;
+        result->rois.push_back(std::move(roi));
+
+        baseResponseNode::ResultTrack track;
+        track.trackId = item.trackerID;
+        track.state = item.state;
+        std::copy(item.S_hat, item.S_hat + 4, track.trackState);
+        track.size[0] = item.xSize;
+        track.size[1] = item.ySize;
+        result->tracks.push_back(track);
+    }
+
+    // clusters the tracks are updated from, left in the buffer by RadarClusteringNode
+    if (buf->containMeta<clusteringDBscanOutput>()) {
+        clusteringDBscanOutput clusters;
+        buf->getMeta(clusters);
+        size_t numCluster = std::min(clusters.report.size(), (size_t)std::max(clusters.numCluster, 0));
+        result->clusters.reserve(numCluster);
+        for (size_t i = 0; i < numCluster; ++i) {
+            const clusteringDBscanReport &item = clusters.report[i];
+            baseResponseNode::ResultCluster cluster;
+            cluster.numPoints = item.numPoints;
+            cluster.center[0] = item.xCenter;
+            cluster.center[1] = item.yCenter;
+            cluster.size[0] = item.xSize;
+            cluster.size[1] = item.ySize;
+            cluster.avgVel = item.avgVel;
+            cluster.centerRangeVar = item.centerRangeVar;
+            cluster.centerAngleVar = item.centerAngleVar;
+            cluster.centerDopplerVar = item.centerDopplerVar;
+            result->clusters.push_back(cluster);
+        }
+    }
+
+    if (output.outputInfo.size() > 0) {
+        result->statusCode = 0;
+        result->description = "succeeded";
+    }
+    else {
+        result->statusCode = -2;
+        result->description = "failed";
+    }
+    return result;
+}
+
 void RadarOutputNodeWorker::processByLastRun(std::size_t batchIdx)
 {
     dynamic_cast<RadarOutputNode *>(getParentPtr())->emitFinish((baseResponseNode *)getParentPtr(), nullptr);
@@ -28,6 +28,9 @@ LocalRadarPCLFileManager::LocalRadarPCLFileManager() : m_batchIdx(0) {
 }
 
 LocalRadarPCLFileManager::~LocalRadarPCLFileManager() { 
+    if (m_resultFile) {
+        tools::AsyncResultWriter::getInstance().close(m_resultFile);
+    }
 }
 
 void LocalRadarPCLFileManager::init(std::size_t batchIdx) {
@@ -45,8 +48,8 @@ void LocalRadarPCLFileManager::init(std::size_t batchIdx) {
 }
 
 /**
- * save results as local file:  {timestamp}.csv
- * each column name should be consist with hvaROI_t
+ * save results as local binary file: radarResults.bin, written by the shared result writer,
+ * converted to csv offline by `ResultFileConverter`
 */
 
 /*  PonintClouds
@@ -62,140 +65,63 @@ void LocalRadarPCLFileManager::init(std::size_t batchIdx) {
 */
 
 bool LocalRadarPCLFileManager::saveResultsToFile(const unsigned frameId, const struct pointClouds& pcl){
-                        // const int statusCode, const std::string description){
     std::lock_guard<std::mutex> lg(m_fileMutex);
 
-    // for (size_t idx = 0; idx < rois.size(); idx ++) {
-        std::vector<std::pair<std::string, std::vector<std::string>>> resultSetVec;
-        // pcl info
-
-        std::vector<std::string> frameIdx;
-        std::vector<std::string> pclNum;
-        std::vector<std::string> rangeIdxArray;
-        std::vector<std::string> rangeFloat;
-        std::vector<std::string> speedIdxArray;
-        std::vector<std::string> speedFloat;
-        std::vector<std::string> SNRArray;
-        std::vector<std::string> aoaVar;
-        frameIdx.push_back(std::to_string(frameId));
-        pclNum.push_back(std::to_string(pcl.num));
-
-        for(int i=0;i<pcl.num;i++){
-            rangeIdxArray.push_back(std::to_string(pcl.rangeIdxArray[i]));
-            rangeFloat.push_back(std::to_string(pcl.rangeFloat[i]));
-            speedIdxArray.push_back(std::to_string(pcl.speedIdxArray[i]));
-            speedFloat.push_back(std::to_string(pcl.speedFloat[i]));
-            SNRArray.push_back(std::to_string(pcl.SNRArray[i]));
-            aoaVar.push_back(std::to_string(pcl.aoaVar[i]));
-    
-        }
-        resultSetVec.push_back(addColumnDataVec("frameId", frameIdx));
-        resultSetVec.push_back(addColumnDataVec("num", pclNum));
-        resultSetVec.push_back(addColumnDataVec("rangeIdxArray", rangeIdxArray));
-        resultSetVec.push_back(addColumnDataVec("rangeFloat", rangeFloat));
-        resultSetVec.push_back(addColumnDataVec("speedIdxArray", speedIdxArray));
-        resultSetVec.push_back(addColumnDataVec("speedFloat", speedFloat));
-        resultSetVec.push_back(addColumnDataVec("SNRArray", SNRArray));
-        resultSetVec.push_back(addColumnDataVec("aoaVar", aoaVar));
-
-        // status code
-        // resultSet.push_back(addColumnData("status", std::to_string(statusCode)));
-        // resultSet.push_back(addColumnData("description", description));
-
-
-        // check the folder of result file for the first time
-        if (m_firstLine) {
-            checkPath(m_resultPath);
-        }
-
-        std::ofstream resfile;
-        resfile.open(m_resultPath, std::ios::out | std::ios::app);
-        if (!resfile.is_open()) {
-            HVA_ERROR("Failed to open result file: %s !", m_resultPath.c_str());
-            return false;
-        }
-
-        // first line: do create csv file and write headers
-        if (m_firstLine) {
-
-            // write headers
-            std::vector<std::string> vecHeaders(m_headers.size());
-            for (auto &item: m_headers) {
-                vecHeaders[item.second] = item.first;
-            }
-            for (auto &header : vecHeaders) {
-                resfile << header << ",";
-            }
-            resfile << "\n";
-            m_firstLine = false;
-        }
-
-        // fomat contents to the corresponding column index
-        bool isHeaderUpdated = false;
-
-        std::vector<std::vector<std::string>> rowDataVec(resultSetVec.size());
-
-        for (auto &item: resultSetVec) {
-            std::string key = item.first;
-
-            // insert new header
-            if (m_headers.count(key) == 0) {
-                isHeaderUpdated = true;
-                m_headers.emplace(key, m_headers.size());
-            }
-            rowDataVec[m_headers[key]] = item.second;
-        }
-        // start wrting contents
-        for (auto &val : rowDataVec) {
-            // resfile << val << ",";
-            for(auto &innerVal : val){
-                resfile << innerVal << " ";
-            }
-            resfile << ",";
-        }
-        resfile << "\n";
-        resfile.close();
-
-        // 
-        // HEADER PATCH: in case of handling non-fixed length of attributes
-        // csv headers have been created, re-write first line
-        // 
-        if (isHeaderUpdated) {
-            // generate new header line
-            std::vector<std::string> vecHeaders(m_headers.size());
-            for (auto &item: m_headers) {
-                vecHeaders[item.second] = item.first;
-            }
-            std::string content;
-            for (auto &header : vecHeaders) {
-                content += header + ",";
-            }
+    if (!m_resultFile) {
+        m_resultFile = tools::AsyncResultWriter::getInstance().open(m_resultPath, {
+            {"frameId", tools::RESULT_COLUMN_UINT32, tools::RESULT_COLUMN_FLAG_LIST},
+            {"num", tools::RESULT_COLUMN_INT32, tools::RESULT_COLUMN_FLAG_LIST},
+            {"rangeIdxArray", tools::RESULT_COLUMN_INT32, tools::RESULT_COLUMN_FLAG_LIST},
+            {"rangeFloat", tools::RESULT_COLUMN_FLOAT32, tools::RESULT_COLUMN_FLAG_LIST},
+            {"speedIdxArray", tools::RESULT_COLUMN_INT32, tools::RESULT_COLUMN_FLAG_LIST},
+            {"speedFloat", tools::RESULT_COLUMN_FLOAT32, tools::RESULT_COLUMN_FLAG_LIST},
+            {"SNRArray", tools::RESULT_COLUMN_FLOAT32, tools::RESULT_COLUMN_FLAG_LIST},
+            {"aoaVar", tools::RESULT_COLUMN_FLOAT32, tools::RESULT_COLUMN_FLAG_LIST}});
+    }
 
-            try {
-                // replace the first line with new header content
-                replaceLineInFile(m_resultPath, content, 0);
-            }
-            catch (const std::exception &e)
-            {
-                HVA_ERROR("Failed to update header line in result file, error: %s", e.what());
-                return false;
-            }
-            catch (...) {
-                HVA_ERROR("Failed to update header line in result file: %s", m_resultPath.c_str());
-                return false;
-            }
+    // pcl info, the first `num` values of each array
+    tools::ResultRecord record;
+    auto putColumn = [&](const auto& values) {
+        record.beginList();
+        for (int i = 0; i < pcl.num; i++) {
+            record.add(values[i]);
         }
-    // }
+        record.endList();
+    };
+    record.put(frameId).put(pcl.num);
+    putColumn(pcl.rangeIdxArray);
+    putColumn(pcl.rangeFloat);
+    putColumn(pcl.speedIdxArray);
+    putColumn(pcl.speedFloat);
+    putColumn(pcl.SNRArray);
+    putColumn(pcl.aoaVar);
+
+    // written to disk by the writer thread
+    if (!tools::AsyncResultWriter::getInstance().append(m_resultFile, std::move(record))) {
+        HVA_ERROR("Failed to write result file: %s !", m_resultPath.c_str());
+        return false;
+    }
 
     return true;
 }
 
+/**
+ * wait until the results saved so far are written to the result file
+*/
+void LocalRadarPCLFileManager::flush() {
+    if (m_resultFile) {
+        tools::AsyncResultWriter::getInstance().flush(m_resultFile);
+    }
+}
+
 /**
  * construct save path for each request
 */
 void LocalRadarPCLFileManager::reset() {
-    m_firstLine = true;
-    m_headers.clear();
+    if (m_resultFile) {
+        tools::AsyncResultWriter::getInstance().close(m_resultFile);
+        m_resultFile.reset();
+    }
     constructSavePath();
 };
 
@@ -221,26 +147,12 @@ void LocalRadarPCLFileManager::constructSavePath() {
 
     std::string activeSaveFolder = tmp;
 
-    m_resultPath = activeSaveFolder + "/radarResults.csv";
+    m_resultPath = activeSaveFolder + "/radarResults.bin";
     HVA_DEBUG("resultPath: %s", m_resultPath.c_str());
     // m_snapshotPath = activeSaveFolder + "/snapshots";
     HVA_INFO("Results for next request will be saved in: %s", activeSaveFolder.c_str());
 }
 
-/**
- * @brief check filepath
- * if filepath not exist, check the folder
- * if folder not exist, make the dir
-*/
-void LocalRadarPCLFileManager::checkPath(const std::string& path) {
-    boost::filesystem::path p(path);
-    boost::filesystem::path folder = p.parent_path();
-    if (!boost::filesystem::exists(folder)) {
-        HVA_INFO("Folder not exists, create: %s", folder.c_str());
-        boost::filesystem::create_directories(folder.c_str());
-    }
-}
-
 /**
  * @brief check folder
  * if folder not exist, make the dir
@@ -252,57 +164,6 @@ void LocalRadarPCLFileManager::checkFolder(const std::string& path) {
     }
 }
 
-/**
- * @brief add new colum data, also add new key into m_headers at the first time (i.e. m_firstLine == true)
- */
-std::pair<std::string, std::string> LocalRadarPCLFileManager::addColumnData(std::string key, std::string val) {
-    std::pair<std::string, std::string> data = std::make_pair(key, val);
-    if (m_firstLine && m_headers.count(key) == 0) {
-        m_headers.emplace(key, m_headers.size());
-    }
-    return data;
-}
-
-std::pair<std::string, std::vector<std::string>> LocalRadarPCLFileManager::addColumnDataVec(std::string key, std::vector<std::string> valVec) {
-    std::pair<std::string, std::vector<std::string>> data = std::make_pair(key, valVec);
-    if (m_firstLine && m_headers.count(key) == 0) {
-        m_headers.emplace(key, m_headers.size());
-    }
-    return data;
-}
-
-
-/**
- * @brief replace a specific line, default as the first line
- * @param filepath the file to be modified
- * @param content the dst line content
- * @param lineIndex index for the line to be replaced
- */
-void LocalRadarPCLFileManager::replaceLineInFile(std::string filepath, std::string content, int lineIndex) {
-    std::ifstream infile(filepath);
-    std::vector<std::string> lines;
-    std::string input;
-    while (std::getline(infile, input))
-        lines.push_back(input);
-    infile.close();
-
-    if (lineIndex >= lines.size() || lineIndex < 0) {
-        char msg[256];
-        sprintf(msg,
-                "Failed to replace file at line: %d, total lines: %ld, file "
-                "path: %s",
-                lineIndex, lines.size(), filepath.c_str());
-        throw std::runtime_error(msg);
-    }
-    lines[lineIndex] = content;
-
-    // replace the original contents
-    std::ofstream outfile(filepath, std::ios::trunc);
-    for (auto const& line : lines)
-        outfile << line << '\n';
-    outfile.close();
-}
-
 RadarPCLSinkFileNodeWorker::RadarPCLSinkFileNodeWorker(hva::hvaNode_t* parentNode, const std::string& bufType):hva::hvaNodeWorker_t(parentNode), 
         m_bufType(bufType){
 
@@ -383,6 +244,8 @@ void RadarPCLSinkFileNodeWorker::process(std::size_t batchIdx){
         HVA_DEBUG("Emit: on frame id %d tag %d",  buf->frameId, buf->getTag());
 
         if(buf->getTag() == 1){
+            // results of the request are on disk before the client is told it finished
+            m_localFileManager.flush();
             HVA_DEBUG("Emit finish on frame id %d", buf->frameId);
             dynamic_cast<RadarPCLSinkFileNode*>(getParentPtr())->emitFinish((baseResponseNode*)getParentPtr(), nullptr);
         }
@@ -403,6 +266,11 @@ void RadarPCLSinkFileNodeWorker::processByLastRun(std::size_t batchIdx){
     dynamic_cast<RadarPCLSinkFileNode*>(getParentPtr())->emitFinish((baseResponseNode*)getParentPtr(), nullptr);
 }
 
+void RadarPCLSinkFileNodeWorker::deinit(){
+    m_localFileManager.reset();
+    tools::AsyncResultWriter::getInstance().flush();
+}
+
 RadarPCLSinkFileNode::RadarPCLSinkFileNode(std::size_t totalThreadNum):baseResponseNode(1, 0,totalThreadNum), m_bufType("FD"){
     transitStateTo(hva::hvaState_t::configured);
 
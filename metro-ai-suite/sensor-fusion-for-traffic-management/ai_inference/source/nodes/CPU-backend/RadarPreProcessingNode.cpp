@@ -19,11 +19,13 @@
 #include <inc/buffer/hvaVideoFrameWithROIBuf.hpp>
 #include <inc/buffer/hvaVideoFrameWithMetaROIBuf.hpp>
 #include "nodes/CPU-backend/RadarPreProcessingNode.hpp"
+#include "modules/inference_util/radar/radar_cube_pool.hpp"
 #include <boost/exception/all.hpp>
 
 #include "common/base64.hpp"
 #include "nodes/radarDatabaseMeta.hpp"
 #include "nodes/databaseMeta.hpp"
+#include "common/latency_tracer.hpp"
 
 namespace hce{
 
@@ -244,10 +246,15 @@ private:
 
     RadarConfigParam m_radar_config;
 
+    RadarCubePool::Ptr m_cubePool;      // radar cubes of this stream, back to the pool once released downstream
+
+    uint32_t m_pipelineIndex {0u};      // see LatencyTracer::pipelineOf()
+
 };
 
 RadarPreprocessingNodeWorker::Impl::Impl(RadarPreprocessingNodeWorker& ctx, RadarConfigParam m_radar_config):
         m_ctx(ctx), m_radar_config(m_radar_config) {
+    m_cubePool = RadarCubePool::create(m_radar_config.m_radar_basic_config_);
 }
 
 RadarPreprocessingNodeWorker::Impl::~Impl(){
@@ -278,31 +285,46 @@ void RadarPreprocessingNodeWorker::Impl::process(std::size_t batchIdx){
         std::shared_ptr<hva::timeStampInfo> RadarPreprocessIn =
             std::make_shared<hva::timeStampInfo>(blob->frameId, "RadarPreprocessIn");
         m_ctx.getParentPtr()->emitEvent(hvaEvent_PipelineTimeStampRecord, &RadarPreprocessIn);
+        static LatencyTracer::Stage* latencyStage = LatencyTracer::getInstance().getStage("RadarPreProcessingNode");
+        LatencyScope latencyScope(latencyStage, blob->streamId, blob->frameId, m_pipelineIndex);
 
         hva::hvaVideoFrameWithROIBuf_t::Ptr ptrFrameBuf = std::dynamic_pointer_cast<hva::hvaVideoFrameWithROIBuf_t>(blob->get(1));
 
         unsigned tag = ptrFrameBuf->getTag();
-        if (!ptrFrameBuf->drop)
+        // frames given up for newer ones by the backpressure policy are not processed
+        BackpressureController::Ptr controllerMeta;
+        bool hasController = ptrFrameBuf->getMeta(controllerMeta) == hva::hvaSuccess;
+        bool stale = hasController && controllerMeta->isStale(blob->frameId);
+        if (stale) {
+            controllerMeta->recordDrop();
+            HVA_DEBUG("Radar preprocessing node skips stale frame %u", blob->frameId);
+        }
+
+        size_t frame_size = ptrFrameBuf->getSize(); // frame_data_size
+        bool valid = frame_size >= m_cubePool->elements();
+        if (!ptrFrameBuf->drop && !valid) {
+            HVA_ERROR("Radar preprocessing node receives %lu values on frame %u, less than a radar cube of %lu", frame_size, blob->frameId, m_cubePool->elements());
+        }
+
+        if (!ptrFrameBuf->drop && !stale && valid)
         {
             radarVec_t frame_data = ptrFrameBuf->get<radarVec_t>();
 
-            size_t frame_size = ptrFrameBuf->getSize(); // frame_data_size
-
             HVA_DEBUG("radar perform preprocessing on frame%d,frame[0]: real %d, imag %d", blob->frameId, (int)frame_data[0].real(), (int)frame_data[0].imag());
             HVA_DEBUG("radar perform preprocessing on frame%d,frame[%d]: real %d, imag %d", blob->frameId, frame_size, (int)frame_data[frame_size - 1].real(), (int)frame_data[frame_size - 1].imag());
-            RadarCube *radar_cube_ = new RadarCube(frame_data.data(), frame_size, blob->frameId, this->m_radar_config.m_radar_basic_config_);
 
-            radar_cube_->radarCube_format(frame_data.data());
-            const int radar_frame_size = radar_cube_->getRadarFrameSize();
+            // format straight from the input frame into a pooled cube
+            ThreeDimArray<ComplexFloat> radarCube = m_cubePool->acquire();
+            radarCubeFormat(frame_data.data(), this->m_radar_config.m_radar_basic_config_, radarCube);
+            const int radar_frame_size = frame_size;
 
-            hva::hvaVideoFrameWithMetaROIBuf_t::Ptr hvabuf = hva::hvaVideoFrameWithMetaROIBuf_t::make_buffer<ThreeDimArray<ComplexFloat>>(radar_cube_->getRadarCube(), radar_frame_size);
+            hva::hvaVideoFrameWithMetaROIBuf_t::Ptr hvabuf = hva::hvaVideoFrameWithMetaROIBuf_t::make_buffer<ThreeDimArray<ComplexFloat>>(radarCube, radar_frame_size);
 
             hvabuf->setMeta(timeMeta);
             hvabuf->setMeta(this->m_radar_config);
             hvabuf->frameId = blob->frameId;
             hvabuf->tagAs(tag);
-            SendController::Ptr controllerMeta;
-            if(ptrFrameBuf->getMeta(controllerMeta) == hva::hvaSuccess){
+            if(hasController){
                 hvabuf->setMeta(controllerMeta);
                 HVA_DEBUG("Radar preprocessing node copied controller meta to next buffer");
             }
@@ -318,7 +340,6 @@ void RadarPreprocessingNodeWorker::Impl::process(std::size_t batchIdx){
             std::make_shared<hva::timeStampInfo>(blob->frameId, "RadarPreprocessOut");
             m_ctx.getParentPtr()->emitEvent(hvaEvent_PipelineTimeStampRecord, &RadarPreprocessOut);
             HVA_DEBUG("Radar preprocessing node sent blob with frameid %u and streamid %u", radarBlob->frameId, radarBlob->streamId);
-            delete radar_cube_;
         }
         else
         {
@@ -326,6 +347,10 @@ void RadarPreprocessingNodeWorker::Impl::process(std::size_t batchIdx){
             hvabuf->frameId = blob->frameId;
             hvabuf->tagAs(tag);
             hvabuf->drop =true;
+            if(hasController){
+                // the credit is given back at the branch end
+                hvabuf->setMeta(controllerMeta);
+            }
             auto radarBlob = hva::hvaBlob_t::make_blob();
 
             radarBlob->frameId = blob->frameId;
@@ -342,7 +367,7 @@ void RadarPreprocessingNodeWorker::Impl::process(std::size_t batchIdx){
 }
 
 void RadarPreprocessingNodeWorker::Impl::init(){
-    // todo
+    m_pipelineIndex = LatencyTracer::getInstance().pipelineOf(m_ctx.getParentPtr());
 }
 
 RadarPreprocessingNodeWorker::RadarPreprocessingNodeWorker(hva::hvaNode_t *parentNode, RadarConfigParam m_radar_config): 
@@ -13,7 +13,9 @@
 */
 
 #include <algorithm>
+#include <charconv>
 #include <cmath>
+#include <fstream>
 
 #include <inc/util/hvaConfigStringParser.hpp>
 #include <inc/buffer/hvaVideoFrameWithROIBuf.hpp>
@@ -24,6 +26,7 @@
 #include "common/base64.hpp"
 #include "nodes/radarDatabaseMeta.hpp"
 #include "nodes/databaseMeta.hpp"
+#include "modules/tools/result_writer/result_writer.hpp"
 
 namespace hce{
 
@@ -31,6 +34,221 @@ namespace ai{
 
 namespace inference{
 
+/**
+ * @brief radar results parsed once from the data file, shared by the workers and replayed for each repeat
+*/
+struct RadarResultTable{
+    std::vector<trackerOutputDataType> trackers;    // trackers of all the frames, in frame order
+    std::vector<size_t> frameOffsets;               // trackers of frame i: [frameOffsets[i], frameOffsets[i + 1])
+
+    RadarResultTable() : frameOffsets(1, 0) {};
+
+    size_t frameNum() const { return frameOffsets.size() - 1; };
+
+    /**
+     * @brief append one frame, values are in the layout of the csv columns
+     * @return false on mismatched column sizes
+    */
+    bool addFrame(const std::vector<float>& radarRoiValues, const std::vector<float>& radarSizeValues,
+                  const std::vector<int>& radarStateValues, const std::vector<int>& radarIDValues){
+        size_t numTrackers = radarIDValues.size();
+        if (radarRoiValues.size() / 4 != numTrackers || radarSizeValues.size() / 2 != numTrackers || radarStateValues.size() != numTrackers) {
+            return false;
+        }
+        for (size_t i = 0; i < numTrackers; ++i) {
+            trackerOutputDataType outputData;
+            outputData.trackerID = radarIDValues[i];
+            outputData.state = radarStateValues[i];
+            for (int j = 0; j < 4; ++j) {
+                outputData.S_hat[j] = radarRoiValues[i * 4 + j];
+            }
+            outputData.xSize = radarSizeValues[i * 2];
+            outputData.ySize = radarSizeValues[i * 2 + 1];
+            trackers.push_back(outputData);
+        }
+        frameOffsets.push_back(trackers.size());
+        return true;
+    }
+};
+
+namespace {
+
+/**
+ * @brief parse the space separated numbers of one csv cell
+*/
+template<typename T>
+bool parseCell(const char* begin, const char* end, std::vector<T>& values){
+    values.clear();
+    const char* p = begin;
+    while (true) {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '+')) {
+            ++p;
+        }
+        if (p >= end) {
+            return true;
+        }
+        T value;
+        auto ret = std::from_chars(p, end, value);
+        if (ret.ec != std::errc()) {
+            return false;
+        }
+        values.push_back(value);
+        p = ret.ptr;
+    }
+}
+
+/**
+ * @brief load csv radar results: frameId,radarRoi,radarSize,radarState,radarID, with a header line
+*/
+bool loadRadarResultsFromCSV(const std::string& csvFilePath, RadarResultTable& table){
+    std::ifstream file(csvFilePath, std::ios::in | std::ios::binary);
+    if (!file.is_open()) {
+        HVA_ERROR("Failed to open CSV file: %s", csvFilePath.c_str());
+        return false;
+    }
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    const char* p = content.data();
+    const char* end = p + content.size();
+    const char* lineEnd = std::find(p, end, '\n');
+    if (lineEnd == end) {
+        HVA_ERROR("Failed to read header from CSV file: %s", csvFilePath.c_str());
+        return false;
+    }
+
+    std::vector<float> radarRoiValues;
+    std::vector<float> radarSizeValues;
+    std::vector<int> radarStateValues;
+    std::vector<int> radarIDValues;
+    size_t lineIdx = 1;
+    for (p = lineEnd + 1; p < end; ++lineIdx) {
+        lineEnd = std::find(p, end, '\n');
+        const char* rowEnd = (lineEnd > p && *(lineEnd - 1) == '\r') ? lineEnd - 1 : lineEnd;
+        const char* row = p;
+        p = (lineEnd == end) ? end : lineEnd + 1;
+        if (rowEnd == row) {
+            continue;
+        }
+
+        // cells: frameId (unused, frames are renumbered on replay), radarRoi, radarSize, radarState, radarID
+        std::pair<const char*, const char*> cells[5];
+        size_t cellNum = 0;
+        const char* cellBegin = row;
+        for (const char* c = row; c <= rowEnd && cellNum < 5; ++c) {
+            if (c == rowEnd || *c == ',') {
+                cells[cellNum++] = {cellBegin, c};
+                cellBegin = c + 1;
+            }
+        }
+        for (; cellNum < 5; ++cellNum) {
+            cells[cellNum] = {rowEnd, rowEnd};
+        }
+
+        if (!parseCell(cells[1].first, cells[1].second, radarRoiValues) || !parseCell(cells[2].first, cells[2].second, radarSizeValues) ||
+                !parseCell(cells[3].first, cells[3].second, radarStateValues) || !parseCell(cells[4].first, cells[4].second, radarIDValues) ||
+                !table.addFrame(radarRoiValues, radarSizeValues, radarStateValues, radarIDValues)) {
+            HVA_ERROR("Data mismatch in CSV file: %s, line %lu", csvFilePath.c_str(), lineIdx);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief load binary radar results written by `RadarResultSinkFileNode`, mapped and read in place
+*/
+bool loadRadarResultsFromBin(const std::string& binFilePath, RadarResultTable& table){
+    tools::MappedResultFile file;
+    std::string error;
+    if (!file.open(binFilePath, error)) {
+        HVA_ERROR("Failed to open radar result file: %s, error: %s", binFilePath.c_str(), error.c_str());
+        return false;
+    }
+
+    enum { ROI = 0, SIZE, STATE, ID, FIELD_NUM };
+    const std::vector<std::pair<std::string, tools::ResultColumnType>> fields = {
+        {"radarRoi", tools::RESULT_COLUMN_FLOAT32}, {"radarSize", tools::RESULT_COLUMN_FLOAT32},
+        {"radarState", tools::RESULT_COLUMN_INT32}, {"radarID", tools::RESULT_COLUMN_INT32}};
+    const auto& columns = file.columns();
+    std::vector<int> columnField(columns.size(), -1);
+    for (int field = 0; field < FIELD_NUM; ++field) {
+        auto it = std::find_if(columns.begin(), columns.end(), [&](const tools::ResultColumn& column) {
+            return column.name == fields[field].first && column.type == fields[field].second;
+        });
+        if (it == columns.end()) {
+            HVA_ERROR("Column %s missing in radar result file: %s", fields[field].first.c_str(), binFilePath.c_str());
+            return false;
+        }
+        columnField[it - columns.begin()] = field;
+    }
+
+    std::vector<float> radarRoiValues;
+    std::vector<float> radarSizeValues;
+    std::vector<int> radarStateValues;
+    std::vector<int> radarIDValues;
+    tools::ResultPayloadCursor record;
+    size_t recordIdx = 0;
+    while (file.next(record, error)) {
+        bool ok = true;
+        radarRoiValues.clear();
+        radarSizeValues.clear();
+        radarStateValues.clear();
+        radarIDValues.clear();
+        for (size_t c = 0; c < columns.size() && ok; ++c) {
+            uint32_t count = 0;
+            ok = record.get(count);
+            for (uint32_t i = 0; i < count && ok; ++i) {
+                float fValue;
+                int iValue;
+                switch (columnField[c]) {
+                    case ROI:
+                        ok = record.get(fValue);
+                        radarRoiValues.push_back(fValue);
+                        break;
+                    case SIZE:
+                        ok = record.get(fValue);
+                        radarSizeValues.push_back(fValue);
+                        break;
+                    case STATE:
+                        ok = record.get(iValue);
+                        radarStateValues.push_back(iValue);
+                        break;
+                    case ID:
+                        ok = record.get(iValue);
+                        radarIDValues.push_back(iValue);
+                        break;
+                    default:
+                        ok = record.skip(columns[c].type);
+                        break;
+                }
+            }
+        }
+        if (!ok || !table.addFrame(radarRoiValues, radarSizeValues, radarStateValues, radarIDValues)) {
+            HVA_ERROR("Data mismatch in radar result file: %s, record %lu", binFilePath.c_str(), recordIdx);
+        }
+        ++recordIdx;
+    }
+    if (!error.empty()) {
+        HVA_ERROR("Failed to read radar result file: %s, error: %s", binFilePath.c_str(), error.c_str());
+    }
+    return true;
+}
+
+/**
+ * @brief load radar results from the csv or binary file, detected by the file content
+*/
+std::shared_ptr<const RadarResultTable> loadRadarResults(const std::string& filePath){
+    auto table = std::make_shared<RadarResultTable>();
+    bool ret = tools::MappedResultFile::isResultFile(filePath) ? loadRadarResultsFromBin(filePath, *table)
+                                                                : loadRadarResultsFromCSV(filePath, *table);
+    if (!ret) {
+        return nullptr;
+    }
+    HVA_INFO("Loaded %lu radar frames from: %s", table->frameNum(), filePath.c_str());
+    return table;
+}
+
+} // namespace
+
 class RadarResultReadFileNode::Impl{
 public:
 
@@ -78,6 +296,7 @@ private:
     // boost::property_tree::ptree TrackingConfig;
     RadarConfigParam  m_radar_config;
 
+    std::shared_ptr<const RadarResultTable> m_radarResults;     // parsed once, replayed by the workers
 
     // RadarResultReadFileNode::Ptr m_model;
 };
@@ -114,6 +333,11 @@ hva::hvaStatus_t RadarResultReadFileNode::Impl::configureByString(const std::str
     HVA_DEBUG("CSV file path (%s) read", csvFilePath.c_str());
 
     m_radar_config.CSVFilePath = csvFilePath;
+    m_radarResults = loadRadarResults(csvFilePath);
+    if (!m_radarResults) {
+        HVA_ERROR("Failed to load radar results from: %s", csvFilePath.c_str());
+        return hva::hvaFailure;
+    }
 
     int dataRepeatsNum =1;
     m_configParser.getVal<int>("DataRepeatsNum", dataRepeatsNum);
@@ -195,7 +419,7 @@ hva::hvaStatus_t RadarResultReadFileNode::Impl::configureByString(const std::str
 * @param void
 */
 std::shared_ptr<hva::hvaNodeWorker_t> RadarResultReadFileNode::Impl::createNodeWorker(RadarResultReadFileNode* parent) const{
-    return std::shared_ptr<hva::hvaNodeWorker_t>{new RadarResultReadFileNodeWorker{parent, m_radar_config}};
+    return std::shared_ptr<hva::hvaNodeWorker_t>{new RadarResultReadFileNodeWorker{parent, m_radar_config, m_radarResults}};
 }
 
 hva::hvaStatus_t RadarResultReadFileNode::Impl::rearm(){
@@ -237,7 +461,7 @@ hva::hvaStatus_t RadarResultReadFileNode::reset(){
 class RadarResultReadFileNodeWorker::Impl{
 public:
 
-    Impl(RadarResultReadFileNodeWorker& ctx, RadarConfigParam m_radar_config);
+    Impl(RadarResultReadFileNodeWorker& ctx, RadarConfigParam m_radar_config, std::shared_ptr<const RadarResultTable> table);
 
     ~Impl();
     
@@ -249,7 +473,6 @@ public:
 
     void init();
 
-    bool readRadarDataFromCSV(const std::string& csvFilePath, trackerOutput& content, unsigned int targetFrameId);
     void sendEmptyBuf(hva::hvaBlob_t::Ptr inBlob, int tag);
 
     /**
@@ -263,14 +486,15 @@ private:
     RadarResultReadFileNodeWorker& m_ctx;
 
     RadarConfigParam m_radar_config;
+    std::shared_ptr<const RadarResultTable> m_radarResults;
     int m_workStreamId;
     std::atomic<unsigned> m_ctr;
     //std::string CSVFilePath;
 
 };
 
-RadarResultReadFileNodeWorker::Impl::Impl(RadarResultReadFileNodeWorker& ctx, RadarConfigParam m_radar_config):
-        m_ctx(ctx), m_radar_config(m_radar_config), m_workStreamId(-1) {
+RadarResultReadFileNodeWorker::Impl::Impl(RadarResultReadFileNodeWorker& ctx, RadarConfigParam m_radar_config, std::shared_ptr<const RadarResultTable> table):
+        m_ctx(ctx), m_radar_config(m_radar_config), m_radarResults(table), m_workStreamId(-1), m_ctr(0) {
 }
 
 RadarResultReadFileNodeWorker::Impl::~Impl(){
@@ -332,81 +556,23 @@ void RadarResultReadFileNodeWorker::Impl::process(std::size_t batchIdx) {
         m_workStreamId = streamId;
         }
 
-        std::string csvFilePath = m_radar_config.CSVFilePath;
-        
-        for (unsigned int repeat = 0; repeat < m_radar_config.csvRepeatNum; ++repeat) {
-            std::ifstream file(csvFilePath);
-
-            if (!file.is_open()) {
-                HVA_ERROR("Failed to open CSV file: %s", csvFilePath.c_str());
-                return;
-            }
-
-            std::string line;
-            
-            if (!std::getline(file, line)) {
-                HVA_ERROR("Failed to read header from CSV file: %s", csvFilePath.c_str());
-                return;
-            }
-
-            while (std::getline(file, line)) {
-                std::istringstream lineStream(line);
-                std::string cell;
+        if (!m_radarResults) {
+            HVA_ERROR("No radar results loaded from: %s", m_radar_config.CSVFilePath.c_str());
+            return;
+        }
 
-                // Get frameId
-                std::getline(lineStream, cell, ',');
-                // unsigned int frameId = std::stoul(cell);
+        // replay the parsed frames, no file access nor parsing per repeat
+        const RadarResultTable& table = *m_radarResults;
+        for (unsigned int repeat = 0; repeat < m_radar_config.csvRepeatNum; ++repeat) {
+            for (size_t frameIdx = 0; frameIdx < table.frameNum(); ++frameIdx) {
                 unsigned int frameId = fetch_increment();
                 std::shared_ptr<hva::timeStampInfo> RadarReaderIn =
                 std::make_shared<hva::timeStampInfo>(frameId, "RadarReaderIn");
                 m_ctx.getParentPtr()->emitEvent(hvaEvent_PipelineTimeStampRecord, &RadarReaderIn);
-                std::vector<float> radarRoiValues;
-                std::vector<float> radarSizeValues;
-                std::vector<int> radarStateValues;
-                std::vector<int> radarIDValues;
-
-                std::getline(lineStream, cell, ',');
-                std::istringstream radarRoiStream(cell);
-                while (radarRoiStream >> cell) {
-                    radarRoiValues.push_back(std::stof(cell));
-                }
-
-                std::getline(lineStream, cell, ',');
-                std::istringstream radarSizeStream(cell);
-                while (radarSizeStream >> cell) {
-                    radarSizeValues.push_back(std::stof(cell));
-                }
-
-                std::getline(lineStream, cell, ',');
-                std::istringstream radarStateStream(cell);
-                while (radarStateStream >> cell) {
-                    radarStateValues.push_back(std::stoi(cell));
-                }
-
-                std::getline(lineStream, cell, ',');
-                std::istringstream radarIDStream(cell);
-                while (radarIDStream >> cell) {
-                    radarIDValues.push_back(std::stoi(cell));
-                }
-
-                size_t numTrackers = radarIDValues.size();
-                if (radarRoiValues.size() / 4 != numTrackers || radarSizeValues.size() / 2 != numTrackers || radarStateValues.size() != numTrackers) {
-                    HVA_ERROR("Data mismatch in CSV file: %s", csvFilePath.c_str());
-                    continue;
-                }
 
                 trackerOutput trackerData;
-                for (size_t i = 0; i < numTrackers; ++i) {
-                    trackerOutputDataType outputData;
-                    outputData.trackerID = radarIDValues[i];
-                    outputData.state = radarStateValues[i];
-                    for (int j = 0; j < 4; ++j) {
-                        outputData.S_hat[j] = radarRoiValues[i * 4 + j];
-                    }
-                    outputData.xSize = radarSizeValues[i * 2];
-                    outputData.ySize = radarSizeValues[i * 2 + 1];
-                    trackerData.outputInfo.push_back(outputData);
-                }
+                trackerData.outputInfo.assign(table.trackers.begin() + table.frameOffsets[frameIdx],
+                                              table.trackers.begin() + table.frameOffsets[frameIdx + 1]);
 
                 // Create and send blob
                 auto radarBlob = hva::hvaBlob_t::make_blob();
@@ -414,7 +580,7 @@ void RadarResultReadFileNodeWorker::Impl::process(std::size_t batchIdx) {
                 radarBlob->streamId = m_workStreamId;
 
                 hva::hvaVideoFrameWithMetaROIBuf_t::Ptr hvabuf = hva::hvaVideoFrameWithMetaROIBuf_t::make_buffer<ThreeDimArray<ComplexFloat>>(ThreeDimArray<ComplexFloat>(0, 0, 0), 0);
-                hvabuf->setMeta<trackerOutput>(trackerData);
+                hvabuf->setMeta<trackerOutput>(std::move(trackerData));
                 hvabuf->frameId = frameId;
                 hvabuf->tagAs(0); // Tag as regular data
 
@@ -428,8 +594,6 @@ void RadarResultReadFileNodeWorker::Impl::process(std::size_t batchIdx) {
                 HVA_DEBUG("Radar result node sent blob with frameid %u", radarBlob->frameId);
 
             }
-
-            file.close();
         }
 
     }
@@ -445,8 +609,9 @@ void RadarResultReadFileNodeWorker::Impl::init(){
     // todo
 }
 
-RadarResultReadFileNodeWorker::RadarResultReadFileNodeWorker(hva::hvaNode_t *parentNode, RadarConfigParam m_radar_config): 
-        hva::hvaNodeWorker_t(parentNode), m_impl(new Impl(*this, m_radar_config)) {
+RadarResultReadFileNodeWorker::RadarResultReadFileNodeWorker(hva::hvaNode_t *parentNode, RadarConfigParam m_radar_config,
+                                                             std::shared_ptr<const RadarResultTable> table): 
+        hva::hvaNodeWorker_t(parentNode), m_impl(new Impl(*this, m_radar_config, table)) {
     
 }
 
@@ -28,6 +28,9 @@ LocalFileManager::LocalFileManager() : m_batchIdx(0) {
 }
 
 LocalFileManager::~LocalFileManager() { 
+    if (m_resultFile) {
+        tools::AsyncResultWriter::getInstance().close(m_resultFile);
+    }
 }
 
 void LocalFileManager::init(std::size_t batchIdx) {
@@ -45,146 +48,69 @@ void LocalFileManager::init(std::size_t batchIdx) {
 }
 
 /**
- * save results as local file:  {timestamp}.csv
- * each column name should be consist with hvaROI_t
+ * save results as local binary file: radarResults.bin, written by the shared result writer,
+ * converted to csv offline by `ResultFileConverter`
 */
 
 bool LocalFileManager::saveResultsToFile(const unsigned frameId, const trackerOutput& output){
-                        // const int statusCode, const std::string description){
     std::lock_guard<std::mutex> lg(m_fileMutex);
 
-        std::vector<std::pair<std::string, std::vector<std::string>>> resultSetVec;
-        // radar tracking info
-
-        std::vector<std::string> frameIdx;
-        std::vector<std::string> radarRoi;
-        std::vector<std::string> radarSize;
-        std::vector<std::string> radarState;
-        std::vector<std::string> radarID;
-
-        frameIdx.push_back(std::to_string(frameId));
-
-        for (const auto &item : output.outputInfo){
-
-            std::vector<float> stateVal = {item.S_hat[0], item.S_hat[1], item.S_hat[2], item.S_hat[3]};
-            std::vector<float> sizeVal = {item.xSize, item.ySize};
-            for(int i=0;i<4;i++){
-                radarRoi.push_back(std::to_string(stateVal[i]));
-            }
-            radarRoi.push_back(" ");
-            for(int j=0;j<2;j++){
-                radarSize.push_back(std::to_string(sizeVal[j]));
-            }
-            radarSize.push_back(" ");
-            radarState.push_back(std::to_string(item.state));
-            radarID.push_back(std::to_string(item.trackerID));
-        }
-
-
-        resultSetVec.push_back(addColumnDataVec("frameId", frameIdx));
-        resultSetVec.push_back(addColumnDataVec("radarRoi", radarRoi));
-        resultSetVec.push_back(addColumnDataVec("radarSize", radarSize));
-        resultSetVec.push_back(addColumnDataVec("radarState", radarState));
-        resultSetVec.push_back(addColumnDataVec("radarID", radarID));
-
-        // // status code
-        // // resultSet.push_back(addColumnData("status", std::to_string(statusCode)));
-        // // resultSet.push_back(addColumnData("description", description));
-
-
-        // check the folder of result file for the first time
-
-        if (m_firstLine) {
-            checkPath(m_resultPath);
-        }
-
-        std::ofstream resfile;
-        resfile.open(m_resultPath, std::ios::out | std::ios::app);
-        if (!resfile.is_open()) {
-            HVA_ERROR("Failed to open result file: %s !", m_resultPath.c_str());
-            return false;
-        }
-
-        // first line: do create csv file and write headers
-        if (m_firstLine) {
-
-            // write headers
-            std::vector<std::string> vecHeaders(m_headers.size());
-            for (auto &item: m_headers) {
-                vecHeaders[item.second] = item.first;
-            }
-            for (auto &header : vecHeaders) {
-                resfile << header << ",";
-            }
-            resfile << "\n";
-            m_firstLine = false;
-        }
+    if (!m_resultFile) {
+        m_resultFile = tools::AsyncResultWriter::getInstance().open(m_resultPath, {
+            {"frameId", tools::RESULT_COLUMN_UINT32, tools::RESULT_COLUMN_FLAG_LIST},
+            {"radarRoi", tools::RESULT_COLUMN_FLOAT32, tools::RESULT_COLUMN_FLAG_LIST, 4},
+            {"radarSize", tools::RESULT_COLUMN_FLOAT32, tools::RESULT_COLUMN_FLAG_LIST, 2},
+            {"radarState", tools::RESULT_COLUMN_INT32, tools::RESULT_COLUMN_FLAG_LIST},
+            {"radarID", tools::RESULT_COLUMN_INT32, tools::RESULT_COLUMN_FLAG_LIST}});
+    }
 
-        // fomat contents to the corresponding column index
-        bool isHeaderUpdated = false;
+    // radar tracking info, one column per field holding the values of all the tracked objects
+    tools::ResultRecord record;
+    record.put(frameId);
+    record.beginList();
+    for (const auto &item : output.outputInfo) {
+        record.add(item.S_hat[0]).add(item.S_hat[1]).add(item.S_hat[2]).add(item.S_hat[3]);
+    }
+    record.endList().beginList();
+    for (const auto &item : output.outputInfo) {
+        record.add(item.xSize).add(item.ySize);
+    }
+    record.endList().beginList();
+    for (const auto &item : output.outputInfo) {
+        record.add(item.state);
+    }
+    record.endList().beginList();
+    for (const auto &item : output.outputInfo) {
+        record.add(item.trackerID);
+    }
+    record.endList();
 
-        std::vector<std::vector<std::string>> rowDataVec(resultSetVec.size());
-        
-        for (auto &item: resultSetVec) {
-            std::string key = item.first;
-            // insert new header
-            if (m_headers.count(key) == 0) {
-                isHeaderUpdated = true;
-                m_headers.emplace(key, m_headers.size());
-            }
-
-            rowDataVec[m_headers[key]] = item.second;
-        }
-        // start wrting contents
-        for (auto &val : rowDataVec) {
-            // resfile << val << ",";
-            for(auto &innerVal : val){
-                resfile << innerVal << " ";
-            }
-            resfile << ",";
-        }
-        resfile << "\n";
-        resfile.close();
-
-        // 
-        // HEADER PATCH: in case of handling non-fixed length of attributes
-        // csv headers have been created, re-write first line
-        // 
-        if (isHeaderUpdated) {
-            // generate new header line
-            std::vector<std::string> vecHeaders(m_headers.size());
-            for (auto &item: m_headers) {
-                vecHeaders[item.second] = item.first;
-            }
-            std::string content;
-            for (auto &header : vecHeaders) {
-                content += header + ",";
-            }
-
-            try {
-                // replace the first line with new header content
-                replaceLineInFile(m_resultPath, content, 0);
-            }
-            catch (const std::exception &e)
-            {
-                HVA_ERROR("Failed to update header line in result file, error: %s", e.what());
-                return false;
-            }
-            catch (...) {
-                HVA_ERROR("Failed to update header line in result file: %s", m_resultPath.c_str());
-                return false;
-            }
-        }
+    // written to disk by the writer thread
+    if (!tools::AsyncResultWriter::getInstance().append(m_resultFile, std::move(record))) {
+        HVA_ERROR("Failed to write result file: %s !", m_resultPath.c_str());
+        return false;
+    }
 
     return true;
 }
 
+/**
+ * wait until the results saved so far are written to the result file
+*/
+void LocalFileManager::flush() {
+    if (m_resultFile) {
+        tools::AsyncResultWriter::getInstance().flush(m_resultFile);
+    }
+}
+
 /**
  * construct save path for each request
 */
 void LocalFileManager::reset() {
-    m_firstLine = true;
-    m_headers.clear();
+    if (m_resultFile) {
+        tools::AsyncResultWriter::getInstance().close(m_resultFile);
+        m_resultFile.reset();
+    }
     constructSavePath();
 };
 
@@ -210,26 +136,12 @@ void LocalFileManager::constructSavePath() {
 
     std::string activeSaveFolder = tmp;
 
-    m_resultPath = activeSaveFolder + "/radarResults.csv";
+    m_resultPath = activeSaveFolder + "/radarResults.bin";
     HVA_DEBUG("resultPath: %s", m_resultPath.c_str());
     // m_snapshotPath = activeSaveFolder + "/snapshots";
     HVA_INFO("Results for next request will be saved in: %s", activeSaveFolder.c_str());
 }
 
-/**
- * @brief check filepath
- * if filepath not exist, check the folder
- * if folder not exist, make the dir
-*/
-void LocalFileManager::checkPath(const std::string& path) {
-    boost::filesystem::path p(path);
-    boost::filesystem::path folder = p.parent_path();
-    if (!boost::filesystem::exists(folder)) {
-        HVA_INFO("Folder not exists, create: %s", folder.c_str());
-        boost::filesystem::create_directories(folder.c_str());
-    }
-}
-
 /**
  * @brief check folder
  * if folder not exist, make the dir
@@ -241,57 +153,6 @@ void LocalFileManager::checkFolder(const std::string& path) {
     }
 }
 
-/**
- * @brief add new colum data, also add new key into m_headers at the first time (i.e. m_firstLine == true)
- */
-std::pair<std::string, std::string> LocalFileManager::addColumnData(std::string key, std::string val) {
-    std::pair<std::string, std::string> data = std::make_pair(key, val);
-    if (m_firstLine && m_headers.count(key) == 0) {
-        m_headers.emplace(key, m_headers.size());
-    }
-    return data;
-}
-
-std::pair<std::string, std::vector<std::string>> LocalFileManager::addColumnDataVec(std::string key, std::vector<std::string> valVec) {
-    std::pair<std::string, std::vector<std::string>> data = std::make_pair(key, valVec);
-    if (m_firstLine && m_headers.count(key) == 0) {
-        m_headers.emplace(key, m_headers.size());
-    }
-    return data;
-}
-
-
-/**
- * @brief replace a specific line, default as the first line
- * @param filepath the file to be modified
- * @param content the dst line content
- * @param lineIndex index for the line to be replaced
- */
-void LocalFileManager::replaceLineInFile(std::string filepath, std::string content, int lineIndex) {
-    std::ifstream infile(filepath);
-    std::vector<std::string> lines;
-    std::string input;
-    while (std::getline(infile, input))
-        lines.push_back(input);
-    infile.close();
-
-    if (lineIndex >= lines.size() || lineIndex < 0) {
-        char msg[256];
-        sprintf(msg,
-                "Failed to replace file at line: %d, total lines: %ld, file "
-                "path: %s",
-                lineIndex, lines.size(), filepath.c_str());
-        throw std::runtime_error(msg);
-    }
-    lines[lineIndex] = content;
-
-    // replace the original contents
-    std::ofstream outfile(filepath, std::ios::trunc);
-    for (auto const& line : lines)
-        outfile << line << '\n';
-    outfile.close();
-}
-
 RadarResultSinkFileNodeWorker::RadarResultSinkFileNodeWorker(hva::hvaNode_t* parentNode, const std::string& bufType):hva::hvaNodeWorker_t(parentNode), 
         m_bufType(bufType){
 
@@ -370,6 +231,8 @@ void RadarResultSinkFileNodeWorker::process(std::size_t batchIdx){
         HVA_DEBUG("Emit: on frame id %d tag %d",  buf->frameId, buf->getTag());
 
         if(buf->getTag() == 1){
+            // results of the request are on disk before the client is told it finished
+            m_localFileManager.flush();
             HVA_DEBUG("Emit finish on frame id %d", buf->frameId);
             dynamic_cast<RadarResultSinkFileNode*>(getParentPtr())->emitFinish((baseResponseNode*)getParentPtr(), nullptr);
         }
@@ -390,6 +253,11 @@ void RadarResultSinkFileNodeWorker::processByLastRun(std::size_t batchIdx){
     dynamic_cast<RadarResultSinkFileNode*>(getParentPtr())->emitFinish((baseResponseNode*)getParentPtr(), nullptr);
 }
 
+void RadarResultSinkFileNodeWorker::deinit(){
+    m_localFileManager.reset();
+    tools::AsyncResultWriter::getInstance().flush();
+}
+
 RadarResultSinkFileNode::RadarResultSinkFileNode(std::size_t totalThreadNum):baseResponseNode(1, 0,totalThreadNum), m_bufType("FD"){
     transitStateTo(hva::hvaState_t::configured);
 
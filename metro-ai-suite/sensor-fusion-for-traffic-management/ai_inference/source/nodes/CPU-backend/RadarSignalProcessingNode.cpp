@@ -24,6 +24,7 @@
 
 #include "common/base64.hpp"
 #include "nodes/databaseMeta.hpp"
+#include "common/latency_tracer.hpp"
 #include "nodes/radarDatabaseMeta.hpp"
 #include "libradar.h"
 #include <memory>
@@ -282,6 +283,8 @@ private:
     // std::shared_ptr<void> buf = nullptr;
     RadarCube rc;
 
+    uint32_t m_pipelineIndex {0u};      // see LatencyTracer::pipelineOf()
+
 };
 
 RadarSignalProcessingNodeWorker::Impl::Impl(RadarSignalProcessingNodeWorker& ctx, RadarConfigParam m_radar_config):
@@ -461,6 +464,8 @@ void RadarSignalProcessingNodeWorker::Impl::process(std::size_t batchIdx){
         std::shared_ptr<hva::timeStampInfo> RadarSignalProcessingIn =
             std::make_shared<hva::timeStampInfo>(blob->frameId, "RadarSignalProcessingIn");
         m_ctx.getParentPtr()->emitEvent(hvaEvent_PipelineTimeStampRecord, &RadarSignalProcessingIn);
+        static LatencyTracer::Stage* latencyStage = LatencyTracer::getInstance().getStage("RadarSignalProcessingNode");
+        LatencyScope latencyScope(latencyStage, blob->streamId, blob->frameId, m_pipelineIndex);
         
         hva::hvaVideoFrameWithROIBuf_t::Ptr ptrFrameBuf = std::dynamic_pointer_cast<hva::hvaVideoFrameWithROIBuf_t>(blob->get(1));
         // if (!m_isTrackerInitialized) {
@@ -469,6 +474,12 @@ void RadarSignalProcessingNodeWorker::Impl::process(std::size_t batchIdx){
         // }
 
         unsigned tag = ptrFrameBuf->getTag();
+        // give back the credit on dropped frames as well, e.g. frames turned stale under drop_oldest
+        BackpressureController::Ptr controllerMeta;
+        if(ptrFrameBuf->getMeta(controllerMeta) == hva::hvaSuccess && controllerMeta->controls("Radar")){
+            controllerMeta->release();
+        }
+
         if (!ptrFrameBuf->drop)
         {
 
@@ -531,17 +542,6 @@ void RadarSignalProcessingNodeWorker::Impl::process(std::size_t batchIdx){
                 HVA_ERROR("radarDetection failed");
             }
 
-            SendController::Ptr controllerMeta;
-            if(ptrFrameBuf->getMeta(controllerMeta) == hva::hvaSuccess){
-                if (("Radar" == controllerMeta->controlType) && (0 < controllerMeta->capacity)) {
-                    std::unique_lock<std::mutex> lock(controllerMeta->mtx);
-                    (controllerMeta->count)--;
-                    if (controllerMeta->count % controllerMeta->stride == 0) {
-                        (controllerMeta->notFull).notify_all();
-                    }
-                    lock.unlock();
-                }
-            }
             
             if(radarClustering(m_handle, &rr, &cr)!= R_SUCCESS){
                 HVA_ERROR("radarClustering failed");
@@ -663,7 +663,7 @@ void RadarSignalProcessingNodeWorker::Impl::process(std::size_t batchIdx){
 }
 
 void RadarSignalProcessingNodeWorker::Impl::init(){
-
+    m_pipelineIndex = LatencyTracer::getInstance().pipelineOf(m_ctx.getParentPtr());
 }
 
 hva::hvaStatus_t RadarSignalProcessingNodeWorker::Impl::rearm(){
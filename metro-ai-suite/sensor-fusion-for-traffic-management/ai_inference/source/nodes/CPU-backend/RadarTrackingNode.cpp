@@ -18,6 +18,7 @@
 #include "inc/buffer/hvaVideoFrameWithROIBuf.hpp"
 #include "inc/buffer/hvaVideoFrameWithMetaROIBuf.hpp"
 #include "nodes/databaseMeta.hpp"
+#include "common/latency_tracer.hpp"
 
 #include <chrono>
 #include <cmath>
@@ -247,6 +248,8 @@ class RadarTrackingNodeWorker::Impl {
     bool m_isTrackerInitialized;
 
     std::chrono::high_resolution_clock::time_point m_prevTimestamp;
+
+    uint32_t m_pipelineIndex {0u};      // see LatencyTracer::pipelineOf()
 };
 
 RadarTrackingNodeWorker::Impl::Impl(RadarTrackingNodeWorker &ctx) : m_ctx(ctx), m_isTrackerInitialized(false) {}
@@ -255,7 +258,7 @@ RadarTrackingNodeWorker::Impl::~Impl() {}
 
 void RadarTrackingNodeWorker::Impl::init()
 {
-    return;
+    m_pipelineIndex = LatencyTracer::getInstance().pipelineOf(m_ctx.getParentPtr());
 }
 
 /**
@@ -276,6 +279,8 @@ void RadarTrackingNodeWorker::Impl::process(std::size_t batchIdx)
         std::shared_ptr<hva::timeStampInfo> RadarTrackingIn =
         std::make_shared<hva::timeStampInfo>(blob->frameId, "RadarTrackingIn");
         m_ctx.getParentPtr()->emitEvent(hvaEvent_PipelineTimeStampRecord, &RadarTrackingIn);
+        static LatencyTracer::Stage* latencyStage = LatencyTracer::getInstance().getStage("RadarTrackingNode");
+        LatencyScope latencyScope(latencyStage, blob->streamId, blob->frameId, m_pipelineIndex);
         hva::hvaVideoFrameWithMetaROIBuf_t::Ptr ptrFrameBuf = std::dynamic_pointer_cast<hva::hvaVideoFrameWithMetaROIBuf_t>(blob->get(0));
         HVA_ASSERT(ptrFrameBuf);
         // inherit meta data from previous input field
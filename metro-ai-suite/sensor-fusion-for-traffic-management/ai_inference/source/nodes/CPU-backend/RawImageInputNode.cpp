@@ -103,17 +103,14 @@ readMediaStatus_t RawImageInputNodeWorker::processMediaContent(const std::string
         return readMediaStatus_t::Failure;
     }
 
-    try{
-        content = base64DecodeStrToStr(base64Image);
-    }
-    catch (boost::exception& e){
-        HVA_ERROR("Failed to decoder image: %s", boost::diagnostic_information(e).c_str());
-        return readMediaStatus_t::Failure;
-    }
-    catch (...){
+    // decode straight into content, no intermediate string
+    content.resize(base64DecodedMaxSize(base64Image.size()));
+    size_t decodedLen = 0;
+    if(!base64Decode(&content[0], base64Image.data(), base64Image.size(), decodedLen)){
         HVA_ERROR("Attempt to decode a value not in base64 char set!");
         return readMediaStatus_t::Failure;
     }
+    content.resize(decodedLen);
 
     roi.x = x;
     roi.y = y;
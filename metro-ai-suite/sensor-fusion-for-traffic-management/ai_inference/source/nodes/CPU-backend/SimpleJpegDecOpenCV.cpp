@@ -26,18 +26,45 @@ namespace ai{
 namespace inference{
 
 SimpleJpegDecOpenCV::SimpleJpegDecOpenCV(std::size_t totalThreadNum)
-:hva::hvaNode_t(1, 1, totalThreadNum)
+:hva::hvaNode_t(1, 1, totalThreadNum), m_targetWidth(0), m_targetHeight(0)
 {
     transitStateTo(hva::hvaState_t::configured); 
 }
 
+hva::hvaStatus_t SimpleJpegDecOpenCV::configureByString(const std::string& config)
+{
+    if (config.empty()) {
+        // decode at full size
+        return hva::hvaSuccess;
+    }
+    if (!m_configParser.parse(config)) {
+        HVA_ERROR("Illegal parse string!");
+        return hva::hvaFailure;
+    }
+
+    int targetWidth = 0;
+    int targetHeight = 0;
+    m_configParser.getVal<int>("TargetWidth", targetWidth);
+    m_configParser.getVal<int>("TargetHeight", targetHeight);
+    if (targetWidth < 0 || targetHeight < 0) {
+        HVA_ERROR("Invalid target size: %dx%d", targetWidth, targetHeight);
+        return hva::hvaFailure;
+    }
+    m_targetWidth = targetWidth;
+    m_targetHeight = targetHeight;
+    HVA_DEBUG("Simple jpeg decoder decodes towards target size %ux%u", m_targetWidth, m_targetHeight);
+
+    transitStateTo(hva::hvaState_t::configured);
+    return hva::hvaSuccess;
+}
+
 std::shared_ptr<hva::hvaNodeWorker_t> SimpleJpegDecOpenCV::createNodeWorker() const
 {
-    return std::shared_ptr<hva::hvaNodeWorker_t>(new SimpleJpegDecOpenCVWorker((hva::hvaNode_t*)this));
+    return std::shared_ptr<hva::hvaNodeWorker_t>(new SimpleJpegDecOpenCVWorker((hva::hvaNode_t*)this, m_targetWidth, m_targetHeight));
 }
 
-SimpleJpegDecOpenCVWorker::SimpleJpegDecOpenCVWorker(hva::hvaNode_t* parentNode)
-:hva::hvaNodeWorker_t(parentNode)
+SimpleJpegDecOpenCVWorker::SimpleJpegDecOpenCVWorker(hva::hvaNode_t* parentNode, unsigned targetWidth, unsigned targetHeight)
+:hva::hvaNodeWorker_t(parentNode), m_decoder(targetWidth, targetHeight)
 {
     
 }
@@ -78,6 +105,7 @@ void SimpleJpegDecOpenCVWorker::init()
 
 void SimpleJpegDecOpenCVWorker::deinit()
 {
+    HVA_INFO("%s", DecodedFramePool::getInstance()->report().c_str());
     return;
 }
 
@@ -98,32 +126,29 @@ void SimpleJpegDecOpenCVWorker::process(std::size_t batchIdx)
 
             auto jpegBlob = hva::hvaBlob_t::make_blob();
 
-            if(!tmpJpgStrData.empty()){
+            // decoded straight into a pooled frame owned by the output buffer
+            hva::hvaVideoFrameWithROIBuf_t::Ptr hvabuf;
+            HVA_DEBUG("Jpeg decoder prepares to decode");
+            int scaleDenom = 1;
+            bool decoded = !tmpJpgStrData.empty() && m_decoder.decode(tmpJpgStrData, hvabuf, &scaleDenom);
+            HVA_DEBUG("Jpeg decoder decoding done");
+
+            if(decoded){
                 std::vector<hva::hvaROI_t> rois;
                 if(!buf->rois.empty()){
                     rois = buf->rois;
                     HVA_DEBUG("Jpeg decoder receives a buffer with rois of size %d", buf->rois.size());
+                    // rois are given on the full-size image
+                    for(auto& roi : rois){
+                        roi.x /= scaleDenom;
+                        roi.y /= scaleDenom;
+                        roi.width = ScaledJpegDecoder::scaledSize(roi.width, scaleDenom);
+                        roi.height = ScaledJpegDecoder::scaledSize(roi.height, scaleDenom);
+                    }
                 }
 
-                HVA_DEBUG("Jpeg decoder prepares to feed to opencv");
-                cv::Mat rawData( 1, tmpJpgStrData.size(), CV_8UC1, (void*)tmpJpgStrData.c_str() );
-                cv::Mat decodedImage  =  imdecode( rawData, cv::ImreadModes::IMREAD_COLOR);
-                HVA_DEBUG("Jpeg decoder feeding opencv done");
-
-                unsigned width = decodedImage.size().width;
-                unsigned height = decodedImage.size().height;
-                unsigned channel = decodedImage.channels();
-
-                HVA_DEBUG("Decoded image at width: %d, height: %d and channel: %d", width, height, channel);
-                std::string toSend((char*)decodedImage.data, width*height*channel);
-                hva::hvaVideoFrameWithROIBuf_t::Ptr hvabuf =
-                        hva::hvaVideoFrameWithROIBuf_t::make_buffer<uint8_t*>(
-                            (uint8_t *)toSend.c_str(), toSend.size());
+                HVA_DEBUG("Decoded image at width: %d, height: %d", hvabuf->width, hvabuf->height);
                 hvabuf->frameId = frameIdx;
-                hvabuf->width = width;
-                hvabuf->height = height;
-                hvabuf->stride[0] = channel * width;
-                hvabuf->drop = false;
                 hvabuf->rois = rois;
                 hvabuf->setMeta<uint64_t>(0);
                 hvabuf->tagAs(tag);
@@ -132,8 +157,8 @@ void SimpleJpegDecOpenCVWorker::process(std::size_t batchIdx)
                 
             }
             else{
-                HVA_DEBUG("Jpeg decoder receives an empty buf on frame %d", frameIdx);
-                hva::hvaVideoFrameWithROIBuf_t::Ptr hvabuf = hva::hvaVideoFrameWithROIBuf_t::make_buffer<uint8_t*>(NULL, 0);
+                HVA_DEBUG("Jpeg decoder receives an empty or undecodable buf on frame %d", frameIdx);
+                hvabuf = hva::hvaVideoFrameWithROIBuf_t::make_buffer<uint8_t*>(NULL, 0);
                 hvabuf->frameId = frameIdx;
                 hvabuf->width = 0;
                 hvabuf->height = 0;
@@ -147,9 +172,12 @@ void SimpleJpegDecOpenCVWorker::process(std::size_t batchIdx)
 
             HceDatabaseMeta meta;
             if(buf->getMeta(meta) == hva::hvaSuccess){
-                jpegBlob->get(0)->setMeta(meta);
                 HVA_DEBUG("Jpeg Decoder copied meta to next buffer, mediauri: %s", meta.mediaUri.c_str());
             }
+            // output nodes map rois back to the full-size image by the scale
+            meta.scaleWidth = (float)scaleDenom;
+            meta.scaleHeight = (float)scaleDenom;
+            jpegBlob->get(0)->setMeta(meta);
             
             sendOutput(jpegBlob, 0, std::chrono::milliseconds(0));
         }
@@ -20,6 +20,7 @@
 #include <vector>
 #include <string.h>
 #include <thread>
+#include <mutex>
 #include <inttypes.h>
 
 #include <inc/util/hvaConfigStringParser.hpp>
@@ -34,6 +35,36 @@ namespace ai{
 
 namespace inference{
 
+/**
+ * @brief store of the media storage service: media to minIO, media attributes to greenplum
+*/
+class MediaStorageObjectStore : public tools::ObjectStore {
+public:
+    MediaStorageObjectStore(const std::string& configmapFile) : m_configmapFile(configmapFile) {
+        m_storageClient = std::unique_ptr<hce::storage::Media_Storage>(new hce::storage::Media_Storage());
+        // the sdk global state is shared by all clients, initialize it only once per process
+        static std::once_flag globalInitFlag;
+        std::call_once(globalInitFlag, [this]() { m_storageClient->global_init(); });
+        m_storageClient->init(m_configmapFile);
+        HVA_DEBUG("Media storage client init using config file at %s", m_configmapFile.c_str());
+    }
+
+    virtual bool generateURI(const std::string& mediaType, const std::string& dataSource, std::string& uri) override {
+        m_storageClient->generate_media_URI(mediaType, dataSource, uri);
+        return !uri.empty();
+    }
+
+    virtual bool put(const tools::UploadObject& object) override {
+        return m_storageClient->upload_media_buffer(m_configmapFile, object.uri, object.content,
+                                                    object.content.size(), object.attributes) ==
+               hce::storage::status_code::normal;
+    }
+
+private:
+    std::string m_configmapFile;
+    std::unique_ptr<hce::storage::Media_Storage> m_storageClient;
+};
+
 StorageImageUploadNode::StorageImageUploadNode(std::size_t totalThreadNum):hva::hvaNode_t(1, 1, totalThreadNum){
 
 }
@@ -71,9 +102,69 @@ hva::hvaStatus_t StorageImageUploadNode::configureByString(const std::string& co
     bool requireROI = true;
     m_configParser.getVal<bool>("RequireROI", requireROI);
 
+    int jpegQuality = 95;
+    m_configParser.getVal<int>("JpegQuality", jpegQuality);
+
+    // storage backend:
+    // > media_storage: media storage service configured in /opt/hce-configs/media_storage_configmap.json
+    // > filesystem: local directory StorageDirectory, a stand-in for testing
+    std::string storageBackend = "media_storage";
+    m_configParser.getVal<std::string>("StorageBackend", storageBackend);
+    std::string storageDirectory = "./uploads";
+    m_configParser.getVal<std::string>("StorageDirectory", storageDirectory);
+    if (storageBackend != "media_storage" && storageBackend != "filesystem") {
+        HVA_ERROR("Unknown storage backend: %s, should be media_storage or filesystem", storageBackend.c_str());
+        return hva::hvaFailure;
+    }
+
+    // uploads are encoded and put asynchronously, at most UploadQueueSize of them in flight
+    tools::AsyncUploaderConfig uploaderConfig;
+    int queueSize = UPLOAD_DEFAULT_QUEUE_SIZE;
+    m_configParser.getVal<int>("UploadQueueSize", queueSize);
+    int encodeThreads = UPLOAD_DEFAULT_ENCODE_THREAD_NUM;
+    m_configParser.getVal<int>("EncodeThreads", encodeThreads);
+    int uploadThreads = UPLOAD_DEFAULT_UPLOAD_THREAD_NUM;
+    m_configParser.getVal<int>("UploadThreads", uploadThreads);
+    int batchSize = UPLOAD_DEFAULT_BATCH_SIZE;
+    m_configParser.getVal<int>("UploadBatchSize", batchSize);
+    int maxRetries = UPLOAD_DEFAULT_MAX_RETRIES;
+    m_configParser.getVal<int>("UploadRetries", maxRetries);
+    int retryBackoffMs = UPLOAD_DEFAULT_RETRY_BACKOFF_MS;
+    m_configParser.getVal<int>("UploadRetryBackoffMs", retryBackoffMs);
+    if (queueSize <= 0 || encodeThreads <= 0 || uploadThreads <= 0 || batchSize <= 0 || maxRetries < 0 || retryBackoffMs < 0) {
+        HVA_ERROR("Invalid upload config, queue size, threads and batch size should be positive, retries and backoff non-negative");
+        return hva::hvaFailure;
+    }
+
+    // QueueFullPolicy, policy when the upload queue is full:
+    // > block: default, wait for room, slowing down the pipeline to the storage, no frame is left un-uploaded
+    // > drop: skip uploading the frame, the pipeline goes on, each drop is logged as warning with the total count
+    std::string queueFullPolicy = "block";
+    m_configParser.getVal<std::string>("QueueFullPolicy", queueFullPolicy);
+    if (queueFullPolicy == "drop") {
+        uploaderConfig.policy = tools::QueueFullPolicy::Drop;
+    }
+    else if (queueFullPolicy == "block") {
+        uploaderConfig.policy = tools::QueueFullPolicy::Block;
+    }
+    else {
+        HVA_ERROR("Unknown queue full policy: %s, should be drop or block", queueFullPolicy.c_str());
+        return hva::hvaFailure;
+    }
+    uploaderConfig.queueSize = queueSize;
+    uploaderConfig.encodeThreadNum = encodeThreads;
+    uploaderConfig.uploadThreadNum = uploadThreads;
+    uploaderConfig.batchSize = batchSize;
+    uploaderConfig.maxRetries = maxRetries;
+    uploaderConfig.retryBackoffMs = retryBackoffMs;
+
     m_mediaType = mediaType;
     m_dataSource = dataSource;
     m_requireROI = requireROI;
+    m_jpegQuality = jpegQuality;
+    m_storageBackend = storageBackend;
+    m_storageDirectory = storageDirectory;
+    m_uploaderConfig = uploaderConfig;
     
     transitStateTo(hva::hvaState_t::configured);
     return hva::hvaSuccess;
@@ -86,26 +177,47 @@ hva::hvaStatus_t StorageImageUploadNode::configureByString(const std::string& co
 std::shared_ptr<hva::hvaNodeWorker_t> StorageImageUploadNode::createNodeWorker()
     const {
   return std::shared_ptr<hva::hvaNodeWorker_t>(new StorageImageUploadNodeWorker(
-      (hva::hvaNode_t*)this, m_mediaType, m_dataSource, m_requireROI));
+      (hva::hvaNode_t*)this, m_mediaType, m_dataSource, m_requireROI, m_jpegQuality,
+      m_storageBackend, m_storageDirectory, m_uploaderConfig));
 }
 
 StorageImageUploadNodeWorker::StorageImageUploadNodeWorker(
     hva::hvaNode_t* parentNode, const std::string& mediaType,
-    const std::string& dataSource, bool requireROI)
+    const std::string& dataSource, bool requireROI, int jpegQuality,
+    const std::string& storageBackend, const std::string& storageDirectory,
+    const tools::AsyncUploaderConfig& uploaderConfig)
     : hva::hvaNodeWorker_t(parentNode),
       m_ctr(0u),
       m_mediaType(mediaType),
       m_dataSource(dataSource),
-      m_requireROI(requireROI) {}
+      m_requireROI(requireROI),
+      m_jpegQuality(jpegQuality),
+      m_storageBackend(storageBackend),
+      m_storageDirectory(storageDirectory),
+      m_uploaderConfig(uploaderConfig) {}
+
+tools::ObjectStore::Ptr StorageImageUploadNodeWorker::createStore() const {
+    if (m_storageBackend == "filesystem") {
+        return std::make_shared<tools::FileObjectStore>(m_storageDirectory);
+    }
+    return std::make_shared<MediaStorageObjectStore>(m_configmapFile);
+}
 
 void StorageImageUploadNodeWorker::init(){
 
     m_configmapFile = "/opt/hce-configs/media_storage_configmap.json";
-    m_storageClient = std::unique_ptr<hce::storage::Media_Storage>(new hce::storage::Media_Storage());
-    m_storageClient->global_init();
-    m_storageClient->init(m_configmapFile);
-    HVA_DEBUG("Media storage client init using config file at %s", m_configmapFile.c_str());
-    
+    m_uriStore = createStore();
+    m_uploader.reset(new tools::AsyncUploader(m_uploaderConfig, [this]() { return createStore(); }));
+    HVA_DEBUG("Storage image upload node uploads to %s with %lu encode threads and %lu upload threads",
+              m_storageBackend.c_str(), m_uploaderConfig.encodeThreadNum, m_uploaderConfig.uploadThreadNum);
+}
+
+void StorageImageUploadNodeWorker::deinit(){
+    if (m_uploader) {
+        m_uploader->stop();
+        HVA_INFO("Storage image upload node %s", m_uploader->report().c_str());
+        m_uploader.reset();
+    }
 }
 
 /**
@@ -219,22 +331,13 @@ void StorageImageUploadNodeWorker::process(std::size_t batchIdx){
         {
             /**
              * @brief 
-             * 1. encode image
-             * 2. generate media_uri
-             * 3. upload bgr buffer to minIO database
-             * 4. replace media_uri in blob as currently generated uri
+             * 1. generate media_uri
+             * 2. queue the image to the uploader, which encodes it and uploads the jpg to minIO database
+             * 3. replace media_uri in blob as currently generated uri, if queued
              */
 
-            // start to encode image to jpg from buffer
-            std::vector<unsigned char> img_encode;
-            HVA_DEBUG("Storage image upload node encode image from buffer");
-            cv::Mat decodedImage(input_height, input_width, CV_8UC3, (uint8_t*)pBuffer);
-            cv::imencode(".jpg", decodedImage, img_encode);
-            std::string bgrMediaContent(img_encode.begin(), img_encode.end());
-            HVA_DEBUG("Storage image upload node encode image from buffer done");
-
             std::string image_uri;
-            m_storageClient->generate_media_URI(m_mediaType, m_dataSource, image_uri);
+            m_uriStore->generateURI(m_mediaType, m_dataSource, image_uri);
             HVA_DEBUG("Success to generate media URI: %s", image_uri.c_str());
 
             HceDatabaseMeta meta;
@@ -250,27 +353,42 @@ void StorageImageUploadNodeWorker::process(std::size_t batchIdx){
             else {
                 HVA_DEBUG("post_media_attributes at frameid: %u, got:\n%s", ptrVideoBuf->frameId, post_media_attributes.c_str());
 
-                // upload media to minIO
-                // upload meta-data to greenplum
-                if (m_storageClient->upload_media_buffer(
-                        m_configmapFile, image_uri, bgrMediaContent, bgrMediaContent.size(),
-                        post_media_attributes) ==
-                    hce::storage::status_code::normal) {
-                  HVA_DEBUG(
-                      "Success to upload_media_buffer with media_uri: %s at "
-                      "frameid: %u",
-                      image_uri.c_str(), ptrVideoBuf->frameId);
-                } else {
-                  HVA_ERROR(
-                      "Failed to upload_media_buffer with media_uri: %s at "
-                      "frameid: %u",
-                      image_uri.c_str(), ptrVideoBuf->frameId);
+                tools::UploadJob job;
+                job.object.uri = image_uri;
+                job.object.attributes = post_media_attributes;
+                // the job holds the frame until it is encoded on an encode thread
+                int quality = m_jpegQuality;
+                job.encode = [ptrVideoBuf, pBuffer, input_width, input_height, quality](std::string& content) {
+                    std::vector<unsigned char> img_encode;
+                    cv::Mat decodedImage(input_height, input_width, CV_8UC3, (uint8_t*)pBuffer);
+                    if (!cv::imencode(".jpg", decodedImage, img_encode, {cv::IMWRITE_JPEG_QUALITY, quality})) {
+                        return false;
+                    }
+                    content.assign(img_encode.begin(), img_encode.end());
+                    return true;
+                };
+                unsigned frameId = ptrVideoBuf->frameId;
+                job.done = [frameId](const tools::UploadObject& object, bool stored) {
+                    if (stored) {
+                        HVA_DEBUG("Success to upload_media_buffer with media_uri: %s at frameid: %u",
+                                  object.uri.c_str(), frameId);
+                    }
+                    else {
+                        HVA_ERROR("Failed to upload_media_buffer with media_uri: %s at frameid: %u",
+                                  object.uri.c_str(), frameId);
+                    }
+                };
+
+                if (m_uploader->submit(std::move(job))) {
+                    // replace original media uri with newly generated uri
+                    // specifically: video_media_uri => snapshot_image_media_uri
+                    meta.mediaUri = image_uri;
+                    ptrVideoBuf->setMeta(meta);
+                }
+                else {
+                    HVA_WARNING("Upload queue is full, skip uploading media_uri: %s at frameid: %u, %lu uploads dropped so far",
+                                image_uri.c_str(), frameId, (unsigned long)m_uploader->statistics().dropped);
                 }
-                
-                // replace original media uri with newly generated uri
-                // specifically: video_media_uri => snapshot_image_media_uri
-                meta.mediaUri = image_uri;
-                ptrVideoBuf->setMeta(meta);
             }
                     
             // process done
@@ -422,6 +422,13 @@ void TrackerNodeWorker_CPU::Impl::process(std::size_t batchIdx){
         if(ptrVideoBuf->drop){
 
             ptrVideoBuf->rois.clear();
+            // give back the credit on dropped frames as well, e.g. frames turned stale under drop_oldest
+            BackpressureController::Ptr controllerMeta;
+            if (blob->get(0)->getMeta(controllerMeta) == hva::hvaSuccess) {
+                if ((m_workStreamId >= 0) && (streamId == m_workStreamId) && controllerMeta->controls("Video")) {
+                    controllerMeta->release();
+                }
+            }
             HVA_DEBUG("Tracker node dropped a frame on frameid %u and streamid %u", blob->frameId, blob->streamId);
             // sendOutput called at ~_TrackerResultCollector()
             return;
@@ -439,15 +446,10 @@ void TrackerNodeWorker_CPU::Impl::process(std::size_t batchIdx){
         if(ptrVideoBuf->rois.size() == 0){
             // if none rois are received, and none tracklets exist, then no need to do tracking here.
             if (m_producedTracklets.size() == 0) {
-                SendController::Ptr controllerMeta;
+                BackpressureController::Ptr controllerMeta;
                 if (blob->get(0)->getMeta(controllerMeta) == hva::hvaSuccess) {
-                    if ((m_workStreamId >= 0) && (streamId == m_workStreamId) && ("Video" == controllerMeta->controlType) && (0 < controllerMeta->capacity)) {
-                        std::unique_lock<std::mutex> lock(controllerMeta->mtx);
-                        (controllerMeta->count)--;
-                        if (controllerMeta->count % controllerMeta->stride == 0) {
-                            (controllerMeta->notFull).notify_all();
-                        }
-                        lock.unlock();
+                    if ((m_workStreamId >= 0) && (streamId == m_workStreamId) && controllerMeta->controls("Video")) {
+                        controllerMeta->release();
                     }
                 }
                 HVA_DEBUG("No ROI is provided on frameid %u at TrackerNode. And no tracklets exist, skipping...", blob->frameId);
@@ -554,15 +556,10 @@ void TrackerNodeWorker_CPU::Impl::process(std::size_t batchIdx){
                         blob->frameId, blob->streamId, trk_in.track_id);
                 }
             }
-            SendController::Ptr controllerMeta;
-            if(blob->get(0)->getMeta(controllerMeta) == hva::hvaSuccess){
-                if ((m_workStreamId >= 0) && (streamId == m_workStreamId) && ("Video" == controllerMeta->controlType) && (0 < controllerMeta->capacity)) {
-                    std::unique_lock<std::mutex> lock(controllerMeta->mtx);
-                    (controllerMeta->count)--;
-                    if (controllerMeta->count % controllerMeta->stride == 0) {
-                        (controllerMeta->notFull).notify_all();
-                    }
-                    lock.unlock();
+            BackpressureController::Ptr controllerMeta;
+            if (blob->get(0)->getMeta(controllerMeta) == hva::hvaSuccess) {
+                if ((m_workStreamId >= 0) && (streamId == m_workStreamId) && controllerMeta->controls("Video")) {
+                    controllerMeta->release();
                 }
             }
 
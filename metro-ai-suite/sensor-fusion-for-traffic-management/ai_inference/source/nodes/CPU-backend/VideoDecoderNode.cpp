@@ -22,14 +22,16 @@ namespace ai {
 namespace inference {
 
 VideoDecoderNode::VideoDecoderNode(std::size_t totalThreadNum)
-    : hva::hvaNode_t(1, 1, totalThreadNum) {
+    : hva::hvaNode_t(1, 1, totalThreadNum), m_waitTime(0),
+      m_decodeThreads(VIDEO_DECODER_DEFAULT_THREAD_NUM), m_decodeThreadType(FF_THREAD_FRAME | FF_THREAD_SLICE) {
   transitStateTo(hva::hvaState_t::configured);
 }
 
 std::shared_ptr<hva::hvaNodeWorker_t> VideoDecoderNode::createNodeWorker()
     const {
   return std::shared_ptr<hva::hvaNodeWorker_t>(new VideoDecoderNodeWorker(
-      (hva::hvaNode_t*)this, "VideoDecoderNodeWorkerInstance", m_waitTime));
+      (hva::hvaNode_t*)this, "VideoDecoderNodeWorkerInstance", m_waitTime,
+      m_decodeThreads, m_decodeThreadType));
 }
 
 std::string VideoDecoderNode::name() { return m_name; }
@@ -52,18 +54,43 @@ hva::hvaStatus_t VideoDecoderNode::configureByString(
   m_waitTime = waitTime;
   HVA_DEBUG("video decoder node sending frames with wait time: %f s", m_waitTime);
 
+  int decodeThreads = VIDEO_DECODER_DEFAULT_THREAD_NUM;
+  m_configParser.getVal<int>("DecodeThreads", decodeThreads);
+  if (decodeThreads < 0) {
+    HVA_ERROR("Invalid decode threads: %d", decodeThreads);
+    return hva::hvaFailure;
+  }
+  m_decodeThreads = decodeThreads;
+
+  std::string decodeThreadType = "auto";
+  m_configParser.getVal<std::string>("DecodeThreadType", decodeThreadType);
+  if (decodeThreadType == "frame") {
+    m_decodeThreadType = FF_THREAD_FRAME;
+  } else if (decodeThreadType == "slice") {
+    m_decodeThreadType = FF_THREAD_SLICE;
+  } else if (decodeThreadType == "auto") {
+    m_decodeThreadType = FF_THREAD_FRAME | FF_THREAD_SLICE;
+  } else {
+    HVA_ERROR("Unrecognized decode thread type: %s", decodeThreadType.c_str());
+    return hva::hvaFailure;
+  }
+  HVA_DEBUG("video decoder node decoding with %d threads, thread type: %s", m_decodeThreads, decodeThreadType.c_str());
+
   transitStateTo(hva::hvaState_t::configured);
   return hva::hvaSuccess;
 }
 
 VideoDecoderNodeWorker::VideoDecoderNodeWorker(hva::hvaNode_t* parentNode,
-                                             std::string name, float waitTime)
+                                             std::string name, float waitTime,
+                                             int decodeThreads, int decodeThreadType)
     : hva::hvaNodeWorker_t(parentNode),
       m_ctr(0u),
       m_name(name),
       m_StartFlag(false),
       m_waitTime(waitTime),
-      m_workStreamId(-1) {}
+      m_workStreamId(-1) {
+  m_decoderManager.setThreading(decodeThreads, decodeThreadType);
+}
 
 VideoDecoderNodeWorker::~VideoDecoderNodeWorker() {}
 
@@ -84,6 +111,7 @@ void VideoDecoderNodeWorker::init() {
 
 void VideoDecoderNodeWorker::deinit() { 
   m_decoderManager.deinit();
+  HVA_INFO("%s", DecodedFramePool::getInstance()->report().c_str());
   return; 
 }
 
@@ -119,6 +147,19 @@ void VideoDecoderNodeWorker::sendBlob(const hva::hvaVideoFrameWithROIBuf_t::Ptr
 
 }
 
+void VideoDecoderNodeWorker::sendFrame(const hva::hvaVideoFrameWithROIBuf_t::Ptr hvabuf, unsigned tag,
+                                       const hce::ai::inference::HceDatabaseMeta& meta, unsigned streamId) {
+    hvabuf->tagAs(tag);
+
+    // send decoded frame
+    sendBlob(hvabuf, meta, streamId);
+    HVA_DEBUG("This is %d frame, it's status is %d", hvabuf->frameId,
+              hvabuf->getTag());
+
+    // Slow down the decode to prevent queue blocking
+    sleep(m_waitTime);
+}
+
 void VideoDecoderNodeWorker::process(std::size_t batchIdx) {
   HVA_DEBUG("Start to video decoder node process");
   std::vector<std::shared_ptr<hva::hvaBlob_t>> vecBlobInput =
@@ -177,16 +218,21 @@ void VideoDecoderNodeWorker::process(std::size_t batchIdx) {
       HVA_DEBUG("Video decoder prepares to feed to ffmpeg");
       // process start
       HVA_DEBUG("Video decoder start decoding");
-      if (!m_decoderManager.startDecode(tmpVideoStrData)) {
+      bool endOfVideo = videoBuf->getTag() == hvaBlobBufferTag::END_OF_REQUEST;
+      if (!m_decoderManager.startDecode(tmpVideoStrData, endOfVideo)) {
           HVA_ASSERT(false);
       }
       
       int decodedCnt = 0;
       int status = 0;
+      videoMeta.bufType = HceDataMetaBufType::BUFTYPE_UINT8;
+      // frames are sent one behind the decoder, so that the last one of the video is known when sent
+      hva::hvaVideoFrameWithROIBuf_t::Ptr pendingBuf = NULL;
       while (status == 0) {
 
         // 
         // decode next frame and save to hva::hvaVideoFrameWithROIBuf_t
+        //  frames are sent downstream as they complete, while the decoder threads go on
         //
         hva::hvaVideoFrameWithROIBuf_t::Ptr hvabuf = NULL;
         status = m_decoderManager.decodeNext(hvabuf);
@@ -204,30 +250,32 @@ void VideoDecoderNodeWorker::process(std::size_t batchIdx) {
         hvabuf->rois = rois;
         hvabuf->setMeta<uint64_t>(0);
 
-        // decide buffer tag
-        unsigned tag;
-        if (status == 1 && videoBuf->getTag() == hvaBlobBufferTag::END_OF_REQUEST) {
-          // the end of video buffer
-          tag = (unsigned)hvaBlobBufferTag::END_OF_REQUEST;
-        }
-        else {
-          tag = (unsigned)hvaBlobBufferTag::NORMAL;
+        if (pendingBuf) {
+          sendFrame(pendingBuf, (unsigned)hvaBlobBufferTag::NORMAL, videoMeta, pBlob->streamId);
         }
-        hvabuf->tagAs(tag);
-
-        // send decoded frame
-        videoMeta.bufType = HceDataMetaBufType::BUFTYPE_UINT8;
-        sendBlob(hvabuf, videoMeta, pBlob->streamId);
-        HVA_DEBUG("This is %d frame, it's status is %d", hvabuf->frameId,
-                  hvabuf->getTag());
-        
-        // Slow down the decode to prevent queue blocking
-        sleep(m_waitTime);
+        pendingBuf = hvabuf;
 
       } // is still going
 
+      // the last frame of this buffer, ends the request at the end of video
+      unsigned lastTag = endOfVideo ? (unsigned)hvaBlobBufferTag::END_OF_REQUEST : (unsigned)hvaBlobBufferTag::NORMAL;
+      if (pendingBuf) {
+        sendFrame(pendingBuf, lastTag, videoMeta, pBlob->streamId);
+      } else if (endOfVideo) {
+        HVA_WARNING("Video decoder got no frame from the last buffer, send empty buffer as the last frame.");
+        hva::hvaVideoFrameWithROIBuf_t::Ptr hvabuf =
+            hva::hvaVideoFrameWithROIBuf_t::make_buffer<uint8_t*>(NULL, 0);
+        hvabuf->frameId = m_decoderManager.getFrameOrder();
+        hvabuf->width = 0;
+        hvabuf->height = 0;
+        hvabuf->drop = true;
+        hvabuf->setMeta<uint64_t>(0);
+        hvabuf->tagAs(lastTag);
+        sendBlob(hvabuf, videoMeta, pBlob->streamId);
+      }
+
       // Coming the end of video buffer, manage decoder's status
-      if (videoBuf->getTag() == hvaBlobBufferTag::END_OF_REQUEST) {
+      if (endOfVideo) {
             // transit DECODER_BUFFER_EOS -> DECODER_VIDEO_EOS
             m_decoderManager.setState(decodeStatus_t::DECODER_VIDEO_EOS);
             m_decoderManager.deinitDecoder();
@@ -736,7 +736,7 @@ void VPLDecoderNodeWorker::deinit() { return;}
  */
 unsigned VPLDecoderNodeWorker::fetch_increment() { return m_ctr++; }
 
-void VPLDecoderNodeWorker::sendEmptyBlob(unsigned tag, unsigned frameId, unsigned streamId) {
+void VPLDecoderNodeWorker::sendEmptyBlob(unsigned tag, unsigned frameId, unsigned streamId, BackpressureController::Ptr controller) {
     hva::hvaVideoFrameWithROIBuf_t::Ptr hvabuf;
     hvabuf = hva::hvaVideoFrameWithROIBuf_t::make_buffer<mfxFrameSurface1*>(NULL, 0);
     
@@ -746,6 +746,10 @@ void VPLDecoderNodeWorker::sendEmptyBlob(unsigned tag, unsigned frameId, unsigne
     hvabuf->drop = true;
     hvabuf->setMeta<uint64_t>(0);
     hvabuf->tagAs(tag);
+    if (controller) {
+        // the credit is given back at the branch end
+        hvabuf->setMeta(controller);
+    }
 
     auto jpegBlob = hva::hvaBlob_t::make_blob();
     // frameIdx for blobs should always keep increasing
@@ -803,6 +807,15 @@ void VPLDecoderNodeWorker::process(std::size_t batchIdx) {
             m_workStreamId = streamId;
         }
 
+        // frames given up for newer ones by the backpressure policy are not decoded
+        BackpressureController::Ptr controllerMeta;
+        if (videoBuf->getMeta(controllerMeta) == hva::hvaSuccess && controllerMeta->isStale(pBlob->frameId)) {
+            controllerMeta->recordDrop();
+            HVA_DEBUG("Video VPL decoder skips stale frame %d", pBlob->frameId);
+            sendEmptyBlob(videoBuf->getTag(), m_vplDecoderManager.getFrameOrder(), streamId, controllerMeta);
+            continue;
+        }
+
         // Get the video buffer
         std::string tmpVideoStrData = videoBuf->get<std::string>();
         HVA_DEBUG("tmpVideoStrData size is %d", tmpVideoStrData.size());
@@ -939,8 +952,7 @@ void VPLDecoderNodeWorker::process(std::size_t batchIdx) {
                     HVA_DEBUG("Video VPL decoder copied meta to next buffer, mediauri: %s",
                                 meta.mediaUri.c_str());
                 }
-                SendController::Ptr controllerMeta;
-                if(videoBuf->getMeta(controllerMeta) == hva::hvaSuccess){
+                if(controllerMeta){
                     jpegBlob->get(0)->setMeta(controllerMeta);
                     HVA_DEBUG("Video VPL decoder copied controller meta to next buffer");
                 }
@@ -1007,7 +1019,7 @@ void VPLDecoderNodeWorker::process(std::size_t batchIdx) {
             
             // send empty blob as the last frame
             unsigned frameId = m_vplDecoderManager.getFrameOrder();
-            sendEmptyBlob(videoBuf->getTag(), frameId, streamId);
+            sendEmptyBlob(videoBuf->getTag(), frameId, streamId, controllerMeta);
             return;
         }
     }
@@ -12,6 +12,11 @@
  * other than those that are expressly stated in the License.
 */
 
+#include <cmath>
+#include <sstream>
+
+#include <boost/property_tree/json_parser.hpp>
+
 #include "nodes/base/baseResponseNode.hpp"
 
 namespace hce{
@@ -47,10 +52,15 @@ public:
     */
     bool isEmitFinish();
 
+    void setResultFormat(ResultFormat_t format);
+
+    ResultFormat_t getResultFormat() const;
+
 private: 
     baseResponseNode& m_ctx;
     std::vector<std::shared_ptr<EmitListener>> m_listeners;
     std::atomic<int> m_emitFinishFlag{0};
+    std::atomic<int> m_resultFormat{RESULT_FORMAT_JSON};
     
 };
 
@@ -71,8 +81,14 @@ void baseResponseNode::Impl::clearAllEmitListener(){
 }
 
 bool baseResponseNode::Impl::emitOutput(Response res, const baseResponseNode* node, void* data){
-    for(const auto& item: m_listeners){
-        item->onEmit(std::move(res), node, data);
+    // listeners share the result and lazy message of the response, only the last one may take it over
+    for(size_t i = 0; i < m_listeners.size(); ++i){
+        if(i + 1 < m_listeners.size()){
+            m_listeners[i]->onEmit(res, node, data);
+        }
+        else{
+            m_listeners[i]->onEmit(std::move(res), node, data);
+        }
     }
     return true;
 }
@@ -108,6 +124,94 @@ bool baseResponseNode::Impl::isEmitFinish() {
     }
 }
 
+void baseResponseNode::Impl::setResultFormat(ResultFormat_t format) {
+    m_resultFormat.store(format, std::memory_order_release);
+}
+
+baseResponseNode::ResultFormat_t baseResponseNode::Impl::getResultFormat() const {
+    return (ResultFormat_t)m_resultFormat.load(std::memory_order_acquire);
+}
+
+baseResponseNode::LazyJsonMessage::LazyJsonMessage(std::shared_ptr<const Result> result, unsigned fields)
+        :m_result(std::move(result)), m_fields(fields){
+
+}
+
+const std::string& baseResponseNode::LazyJsonMessage::get() const{
+    std::call_once(m_once, [this](){
+        if(m_result){
+            m_message = baseResponseNode::makeJsonMessage(*m_result, m_fields);
+        }
+    });
+    return m_message;
+}
+
+template <typename T>
+static void putArrayToJson(boost::property_tree::ptree& jsonTree, const T* content, size_t size){
+    for(size_t i = 0; i < size; ++i){
+        boost::property_tree::ptree valTree;
+        valTree.put("", content[i]);
+        jsonTree.push_back(std::make_pair("", valTree));
+    }
+}
+
+std::string baseResponseNode::makeJsonMessage(const Result& result, unsigned fields){
+    boost::property_tree::ptree jsonTree;
+    boost::property_tree::ptree roisTree;
+
+    for(const auto& item: result.rois){
+        boost::property_tree::ptree roiInfoTree;
+
+        boost::property_tree::ptree roiBoxTree;
+        putArrayToJson(roiBoxTree, item.roi, 4);
+        roiInfoTree.add_child("roi", roiBoxTree);
+        roiInfoTree.put("roi_class", item.roiClass);
+        roiInfoTree.put("roi_score", item.roiScore);
+
+        roiInfoTree.put("track_id", item.trackId);
+        roiInfoTree.put("track_status", item.trackStatus);
+
+        if(fields & RESULT_JSON_SENSOR_SOURCE){
+            roiInfoTree.put("sensor_source", item.sensorSource);
+        }
+        if(fields & RESULT_JSON_MEDIA_BIRDVIEW_ROI){
+            boost::property_tree::ptree roiWorldBoxTree;
+            putArrayToJson(roiWorldBoxTree, item.mediaBirdviewRoi, 4);
+            roiInfoTree.add_child("media_birdview_roi", roiWorldBoxTree);
+        }
+        if(fields & RESULT_JSON_FUSION_ROI){
+            boost::property_tree::ptree stateTree;
+            putArrayToJson(stateTree, item.fusionRoiState, 4);
+            roiInfoTree.add_child("fusion_roi_state", stateTree);
+
+            boost::property_tree::ptree sizeTree;
+            putArrayToJson(sizeTree, item.fusionRoiSize, 2);
+            roiInfoTree.add_child("fusion_roi_size", sizeTree);
+        }
+
+        roisTree.push_back(std::make_pair("", roiInfoTree));
+    }
+
+    jsonTree.put("status_code", result.statusCode);
+    jsonTree.put("description", result.description);
+    if(!roisTree.empty()){
+        jsonTree.add_child("roi_info", roisTree);
+    }
+    if(fields & RESULT_JSON_INFERENCE_LATENCY){
+        jsonTree.put("inference_latency", result.inferenceLatency);
+    }
+    if(fields & RESULT_JSON_LATENCY){
+        jsonTree.put("latency", result.latency);
+        for(const auto& item: result.latencies){
+            jsonTree.put(item.first, item.second);
+        }
+    }
+
+    std::stringstream ss;
+    boost::property_tree::json_parser::write_json(ss, jsonTree);
+    return ss.str();
+}
+
 baseResponseNode::EmitListener::EmitListener(){
 
 }
@@ -180,6 +284,14 @@ bool baseResponseNode::isEmitFinish() {
     return m_impl->isEmitFinish();
 }
 
+void baseResponseNode::setResultFormat(ResultFormat_t format) {
+    m_impl->setResultFormat(format);
+}
+
+baseResponseNode::ResultFormat_t baseResponseNode::getResultFormat() const {
+    return m_impl->getResultFormat();
+}
+
 baseResponseNodeWorker::baseResponseNodeWorker(hva::hvaNode_t* parentNode)
     : hva::hvaNodeWorker_t(parentNode), m_workStreamId(-1) {
 }
@@ -206,6 +318,18 @@ bool baseResponseNodeWorker::validateStreamInput(const hva::hvaBlob_t::Ptr& blob
     return true;
 }
 
+void baseResponseNodeWorker::mapToSourceScale(std::vector<hva::hvaROI_t>& rois, float scaleWidth, float scaleHeight) {
+    if (scaleWidth == 1.0f && scaleHeight == 1.0f) {
+        return;
+    }
+    for (auto& roi : rois) {
+        roi.x = (int)std::lround(roi.x * scaleWidth);
+        roi.y = (int)std::lround(roi.y * scaleHeight);
+        roi.width = (int)std::lround(roi.width * scaleWidth);
+        roi.height = (int)std::lround(roi.height * scaleHeight);
+    }
+}
+
 }
 
 }
@@ -0,0 +1,65 @@
+/*
+ * INTEL CONFIDENTIAL
+ *
+ * Copyright (C) 2024 Intel Corporation.
+ *
+ * This software and the related documents are Intel copyrighted materials, and your use of
+ * them is governed by the express license under which they were provided to you (License).
+ * Unless the License provides otherwise, you may not use, modify, copy, publish, distribute,
+ * disclose or transmit this software or the related documents without Intel's prior written permission.
+ *
+ * This software and the related documents are provided as is, with no express or implied warranties,
+ * other than those that are expressly stated in the License.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <string>
+
+#include "modules/tools/result_writer/result_writer.hpp"
+
+/**
+ * @brief convert a binary result file written by the result sink nodes, e.g. results.bin or radarResults.bin,
+ * to the csv layout the sink nodes wrote before.
+ *
+ *  ResultFileConverter <results.bin> [<results.csv>]
+ *
+ * The csv is written next to the binary file with the extension replaced when no output path is given.
+*/
+int main(int argc, char** argv){
+    if(argc < 2){
+        std::cout << "Usage: " << argv[0] << " <results.bin> [<results.csv>]" << std::endl;
+        return -1;
+    }
+
+    std::string srcPath(argv[1]);
+    std::string dstPath;
+    if(argc > 2){
+        dstPath = argv[2];
+    }
+    else{
+        std::size_t pos = srcPath.rfind('.');
+        std::size_t sep = srcPath.rfind('/');
+        if(pos != std::string::npos && (sep == std::string::npos || pos > sep)){
+            dstPath = srcPath.substr(0, pos) + ".csv";
+        }
+        else{
+            dstPath = srcPath + ".csv";
+        }
+    }
+
+    std::ofstream dst(dstPath, std::ios::out | std::ios::trunc);
+    if(!dst.is_open()){
+        std::cout << "Failed to open output file: " << dstPath << std::endl;
+        return -1;
+    }
+
+    std::string error;
+    if(!hce::ai::inference::tools::convertResultFileToCsv(srcPath, dst, error)){
+        std::cout << "Failed to convert " << srcPath << ": " << error << std::endl;
+        return -1;
+    }
+
+    std::cout << "Converted " << srcPath << " to " << dstPath << std::endl;
+    return 0;
+}
@@ -0,0 +1,64 @@
+/*
+ * INTEL CONFIDENTIAL
+ *
+ * Copyright (C) 2024 Intel Corporation.
+ *
+ * This software and the related documents are Intel copyrighted materials, and your use of
+ * them is governed by the express license under which they were provided to you (License).
+ * Unless the License provides otherwise, you may not use, modify, copy, publish, distribute,
+ * disclose or transmit this software or the related documents without Intel's prior written permission.
+ *
+ * This software and the related documents are provided as is, with no express or implied warranties,
+ * other than those that are expressly stated in the License.
+*/
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "lru_cache.h"
+
+using StringCache = ShardedLRUCache<std::string, std::string>;
+
+/**
+ * @brief a single shard costing values by their size, so that capacity and evictions are deterministic
+*/
+static StringCache::CostFunction sizeCost = [](const std::string&, const std::string& value){
+    return value.size();
+};
+
+TEST(ShardedLRUCacheTest, EVICTLEASTRECENTLYUSED) {
+    StringCache cache(8, 1, sizeCost);
+    EXPECT_TRUE(cache.put("a", "1234"));
+    EXPECT_TRUE(cache.put("b", "1234"));
+
+    // "a" becomes the most recently used, "b" is evicted
+    std::string value;
+    EXPECT_TRUE(cache.try_get("a", value));
+    EXPECT_TRUE(cache.put("c", "12"));
+    EXPECT_EQ(cache.count("b"), 0u);
+    EXPECT_EQ(cache.count("a"), 1u);
+    EXPECT_EQ(cache.cost(), 6u);
+    EXPECT_EQ(cache.evictions(), 1u);
+}
+
+TEST(ShardedLRUCacheTest, REPLACEWITHOVERSIZEDVALUE) {
+    StringCache cache(8, 1, sizeCost);
+    EXPECT_TRUE(cache.put("a", "1234"));
+
+    // the oversized value is not cached and the previous value must not be returned any more
+    EXPECT_FALSE(cache.put("a", "123456789"));
+    std::string value;
+    EXPECT_FALSE(cache.try_get("a", value));
+    EXPECT_EQ(cache.size(), 0u);
+    EXPECT_EQ(cache.cost(), 0u);
+}
+
+int main(int argc, char** argv){
+
+    // unit test using googletest
+    printf("Running main() from %s\n", __FILE__);
+    testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,81 @@
+/*
+ * INTEL CONFIDENTIAL
+ *
+ * Copyright (C) 2024 Intel Corporation.
+ *
+ * This software and the related documents are Intel copyrighted materials, and your use of
+ * them is governed by the express license under which they were provided to you (License).
+ * Unless the License provides otherwise, you may not use, modify, copy, publish, distribute,
+ * disclose or transmit this software or the related documents without Intel's prior written permission.
+ *
+ * This software and the related documents are provided as is, with no express or implied warranties,
+ * other than those that are expressly stated in the License.
+*/
+
+#include <gtest/gtest.h>
+
+#include "low_latency_server/pipelineManager.hpp"
+
+using namespace hce::ai::inference;
+
+using RunPriorities = PipelineManager::RunPriorities;
+
+/**
+ * @brief runs are added as GrpcPipelineManager::dispatchRun() queues them on a shared pipeline and removed in
+ * the order they finish, a real-time request may preempt the pipeline only while it is preemptible()
+*/
+TEST(PipelinePreemptionTest, NORMALANDBESTEFFORTRUNS) {
+    // pipeline auto loaded by a normal run, a best-effort run queued after it
+    RunPriorities priorities(PipelineManager::PRIORITY_NORMAL);
+    priorities.add(PipelineManager::PRIORITY_NORMAL);
+    priorities.add(PipelineManager::PRIORITY_BEST_EFFORT);
+    EXPECT_EQ(priorities.current(), PipelineManager::PRIORITY_NORMAL);
+    EXPECT_FALSE(priorities.preemptible());
+
+    // only the best-effort run is left
+    priorities.remove(PipelineManager::PRIORITY_NORMAL);
+    EXPECT_EQ(priorities.current(), PipelineManager::PRIORITY_BEST_EFFORT);
+    EXPECT_TRUE(priorities.preemptible());
+
+    // idle pipeline keeps the priority of its latest run
+    priorities.remove(PipelineManager::PRIORITY_BEST_EFFORT);
+    EXPECT_TRUE(priorities.preemptible());
+}
+
+TEST(PipelinePreemptionTest, BESTEFFORTTHENNORMALRUNS) {
+    // the normal run queued the latest does not let the best-effort run lower the priority
+    RunPriorities priorities(PipelineManager::PRIORITY_BEST_EFFORT);
+    priorities.add(PipelineManager::PRIORITY_BEST_EFFORT);
+    EXPECT_TRUE(priorities.preemptible());
+    priorities.add(PipelineManager::PRIORITY_NORMAL);
+    EXPECT_FALSE(priorities.preemptible());
+
+    priorities.remove(PipelineManager::PRIORITY_BEST_EFFORT);
+    EXPECT_FALSE(priorities.preemptible());
+    priorities.remove(PipelineManager::PRIORITY_NORMAL);
+    EXPECT_EQ(priorities.current(), PipelineManager::PRIORITY_NORMAL);
+    EXPECT_FALSE(priorities.preemptible());
+}
+
+TEST(PipelinePreemptionTest, REALTIMERUNS) {
+    RunPriorities priorities(PipelineManager::PRIORITY_BEST_EFFORT);
+    priorities.add(PipelineManager::PRIORITY_REALTIME);
+    priorities.add(PipelineManager::PRIORITY_BEST_EFFORT);
+    priorities.add(PipelineManager::PRIORITY_NORMAL);
+    EXPECT_EQ(priorities.current(), PipelineManager::PRIORITY_REALTIME);
+
+    priorities.remove(PipelineManager::PRIORITY_REALTIME);
+    EXPECT_EQ(priorities.current(), PipelineManager::PRIORITY_NORMAL);
+    priorities.remove(PipelineManager::PRIORITY_BEST_EFFORT);
+    priorities.remove(PipelineManager::PRIORITY_NORMAL);
+    EXPECT_EQ(priorities.current(), PipelineManager::PRIORITY_NORMAL);
+}
+
+int main(int argc, char** argv){
+
+    // unit test using googletest
+    printf("Running main() from %s\n", __FILE__);
+    testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,124 @@
+/*
+ * INTEL CONFIDENTIAL
+ *
+ * Copyright (C) 2024 Intel Corporation.
+ *
+ * This software and the related documents are Intel copyrighted materials, and your use of
+ * them is governed by the express license under which they were provided to you (License).
+ * Unless the License provides otherwise, you may not use, modify, copy, publish, distribute,
+ * disclose or transmit this software or the related documents without Intel's prior written permission.
+ *
+ * This software and the related documents are provided as is, with no express or implied warranties,
+ * other than those that are expressly stated in the License.
+*/
+
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include <gtest/gtest.h>
+
+#include "low_latency_server/grpc_server/replyBackpressure.hpp"
+
+using namespace hce::ai::inference;
+
+#define QUEUE_DEPTH 2
+#define MAX_WAIT_MS 200
+#define RECHECK_INTERVAL_MS 20
+
+/**
+ * @brief reply queue of a lossless stream as held by GrpcServer::_CommHandle: producers wait on it, the consumer
+ * stands for the completion of grpc writes
+*/
+class ReplyQueue{
+public:
+    ReplyQueue(): backpressure(std::chrono::milliseconds(MAX_WAIT_MS), std::chrono::milliseconds(RECHECK_INTERVAL_MS)){ };
+
+    ReplyBackpressure::Result_t produce(){
+        std::unique_lock<std::mutex> lk(mutex);
+        ReplyBackpressure::Result_t ret = backpressure.wait(lk, cv,
+                [this](){ return size >= QUEUE_DEPTH; }, [this](){ return active; });
+        if(ret == ReplyBackpressure::REPLY_READY){
+            ++size;
+        }
+        return ret;
+    };
+
+    void consume(){
+        std::lock_guard<std::mutex> lg(mutex);
+        --size;
+        cv.notify_all();
+    };
+
+    void close(){
+        std::lock_guard<std::mutex> lg(mutex);
+        active = false;
+        cv.notify_all();
+    };
+
+    ReplyBackpressure backpressure;
+    std::mutex mutex;
+    std::condition_variable cv;
+    unsigned size = 0;
+    bool active = true;
+};
+
+static int64_t elapsedMs(std::chrono::steady_clock::time_point start){
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+TEST(ReplyBackpressureTest, STALLEDCLIENT) {
+    ReplyQueue queue;
+    EXPECT_EQ(queue.produce(), ReplyBackpressure::REPLY_READY);
+    EXPECT_EQ(queue.produce(), ReplyBackpressure::REPLY_READY);
+
+    // the client never reads, the producer is held for the max wait and the stream is reported exhausted,
+    // no queued reply is dropped
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(queue.produce(), ReplyBackpressure::REPLY_EXHAUSTED);
+    EXPECT_GE(elapsedMs(start), MAX_WAIT_MS);
+    EXPECT_EQ(queue.size, (unsigned)QUEUE_DEPTH);
+}
+
+TEST(ReplyBackpressureTest, SLOWCLIENT) {
+    ReplyQueue queue;
+    EXPECT_EQ(queue.produce(), ReplyBackpressure::REPLY_READY);
+    EXPECT_EQ(queue.produce(), ReplyBackpressure::REPLY_READY);
+
+    // the client falls behind but catches up within the max wait
+    std::thread consumer([&queue](){
+        std::this_thread::sleep_for(std::chrono::milliseconds(MAX_WAIT_MS / 4));
+        queue.consume();
+    });
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(queue.produce(), ReplyBackpressure::REPLY_READY);
+    EXPECT_LT(elapsedMs(start), MAX_WAIT_MS);
+    EXPECT_EQ(queue.size, (unsigned)QUEUE_DEPTH);
+    consumer.join();
+}
+
+TEST(ReplyBackpressureTest, CLOSEDSTREAM) {
+    ReplyQueue queue;
+    EXPECT_EQ(queue.produce(), ReplyBackpressure::REPLY_READY);
+    EXPECT_EQ(queue.produce(), ReplyBackpressure::REPLY_READY);
+
+    // the stream ends while the producer is held, e.g. ended by another producer timing out
+    std::thread closer([&queue](){
+        std::this_thread::sleep_for(std::chrono::milliseconds(MAX_WAIT_MS / 4));
+        queue.close();
+    });
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(queue.produce(), ReplyBackpressure::REPLY_CLOSED);
+    EXPECT_LT(elapsedMs(start), MAX_WAIT_MS);
+    closer.join();
+}
+
+int main(int argc, char** argv){
+
+    // unit test using googletest
+    printf("Running main() from %s\n", __FILE__);
+    testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
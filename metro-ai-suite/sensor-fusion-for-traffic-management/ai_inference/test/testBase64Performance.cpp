@@ -0,0 +1,99 @@
+/*
+ * INTEL CONFIDENTIAL
+ *
+ * Copyright (C) 2024 Intel Corporation.
+ *
+ * This software and the related documents are Intel copyrighted materials, and your use of
+ * them is governed by the express license under which they were provided to you (License).
+ * Unless the License provides otherwise, you may not use, modify, copy, publish, distribute,
+ * disclose or transmit this software or the related documents without Intel's prior written permission.
+ *
+ * This software and the related documents are provided as is, with no express or implied warranties,
+ * other than those that are expressly stated in the License.
+*/
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <random>
+
+#include "common/base64.hpp"
+
+using namespace hce::ai::inference;
+
+/**
+ * @brief throughput of the base64 codec against the boost archive iterators it replaces, on random payloads
+ * of the size of a typical jpeg image carried by RawImageInputNode
+*/
+
+std::string boostEncode(const std::string& val){
+    using namespace boost::archive::iterators;
+    using It = base64_from_binary<transform_width<std::string::const_iterator, 6, 8>>;
+    auto tmp = std::string(It(std::begin(val)), It(std::end(val)));
+    return tmp.append((3 - val.size() % 3) % 3, '=');
+}
+
+std::string boostDecode(const std::string& val){
+    using namespace boost::archive::iterators;
+    using It = transform_width<binary_from_base64<std::string::const_iterator>, 8, 6>;
+    // padding is stripped here as binary_from_base64 does not accept '='
+    std::string stripped = boost::algorithm::trim_right_copy_if(val, [](char c) {
+        return c == '=';
+    });
+    return std::string(It(std::begin(stripped)), It(std::end(stripped)));
+}
+
+template <typename Func>
+double measure(const std::string& name, unsigned repeats, std::size_t bytes, Func func){
+    auto a = std::chrono::high_resolution_clock::now();
+    for(unsigned i = 0; i < repeats; ++i){
+        func();
+    }
+    auto b = std::chrono::high_resolution_clock::now();
+    double seconds = std::chrono::duration_cast<std::chrono::microseconds>(b - a).count() / 1000000.0;
+    double mbps = (double)bytes * repeats / (1024.0 * 1024.0) / seconds;
+    std::cout << name << ": " << mbps << " MB/s" << std::endl;
+    return mbps;
+}
+
+int main(int argc, char** argv)
+{
+    if(argc > 3)
+    {
+        std::cerr <<
+            "Usage: testBase64Performance [<payload_bytes>] [<repeats>]\n" <<
+            "Example:\n" <<
+            "    testBase64Performance 2097152 50\n";
+        return EXIT_FAILURE;
+    }
+    std::size_t payloadSize = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2 * 1024 * 1024;
+    unsigned repeats = argc > 2 ? atoi(argv[2]) : 50;
+
+    std::mt19937 rng(2024);
+    std::string payload(payloadSize, '\0');
+    for(auto& c: payload){
+        c = (char)(rng() & 0xFF);
+    }
+
+    std::string encoded = base64EncodeStrToStr(payload);
+    if(encoded != boostEncode(payload) || base64DecodeStrToStr(encoded) != payload){
+        std::cerr << "Round trip check failed!" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "Codec: " << base64CodecName() << ", payload: " << payloadSize << " bytes, repeats: " << repeats << std::endl;
+
+    std::string out;
+    double boostEnc = measure("boost encode", repeats, payloadSize, [&](){ out = boostEncode(payload); });
+    double enc = measure("encode", repeats, payloadSize, [&](){ out = base64EncodeStrToStr(payload); });
+    double boostDec = measure("boost decode", repeats, payloadSize, [&](){ out = boostDecode(encoded); });
+
+    std::string decoded(base64DecodedMaxSize(encoded.size()), '\0');
+    std::size_t decodedLen = 0;
+    double dec = measure("decode into buffer", repeats, payloadSize, [&](){
+        base64Decode(&decoded[0], encoded.data(), encoded.size(), decodedLen);
+    });
+
+    std::cout << "\nencode speedup: " << enc / boostEnc << "x, decode speedup: " << dec / boostDec << "x" << std::endl;
+    return EXIT_SUCCESS;
+}
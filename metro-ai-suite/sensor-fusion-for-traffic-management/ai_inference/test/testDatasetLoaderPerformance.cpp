@@ -0,0 +1,147 @@
+/*
+ * INTEL CONFIDENTIAL
+ *
+ * Copyright (C) 2024 Intel Corporation.
+ *
+ * This software and the related documents are Intel copyrighted materials, and your use of
+ * them is governed by the express license under which they were provided to you (License).
+ * Unless the License provides otherwise, you may not use, modify, copy, publish, distribute,
+ * disclose or transmit this software or the related documents without Intel's prior written permission.
+ *
+ * This software and the related documents are provided as is, with no express or implied warranties,
+ * other than those that are expressly stated in the License.
+*/
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <vector>
+#include <thread>
+#include <complex>
+#include <algorithm>
+
+#include <boost/filesystem.hpp>
+
+#include "modules/tools/dataset_loader/read_ahead_loader.hpp"
+
+/**
+ * @brief frames/s of the LocalMultiSensorInputNode read path against the read-ahead depth.
+ * Each frame is an image file and a radar file, read into reused buffers the same way as the node does. The
+ * consumer spends a fixed time on every frame to stand for the rest of the pipeline. Before each run the
+ * files are evicted from the page cache, so that every run starts cold. Without a dataset folder a synthetic
+ * dataset is written to a temporary folder.
+*/
+
+using namespace hce::ai::inference;
+
+struct Frame{
+    std::string image;
+    std::vector<std::complex<float>> radar;
+};
+
+std::vector<std::string> makeDataset(const std::string& folder, unsigned frameNum){
+    boost::filesystem::create_directories(folder);
+    std::string image(256 * 1024, 'i');
+    std::vector<std::complex<float>> radar(256 * 256, {1.0f, 2.0f});
+    std::vector<std::string> files;
+    for(unsigned i = 0; i < frameNum; ++i){
+        char name[64];
+        snprintf(name, sizeof(name), "/%06u", i);
+        files.push_back(folder + name + ".jpg");
+        files.push_back(folder + name + ".bin");
+        FILE* fp = fopen(files[files.size() - 2].c_str(), "wb");
+        fwrite(image.data(), 1, image.size(), fp);
+        fclose(fp);
+        fp = fopen(files.back().c_str(), "wb");
+        fwrite(radar.data(), sizeof(radar[0]), radar.size(), fp);
+        fclose(fp);
+    }
+    sync();
+    return files;
+}
+
+// sorted files of the folder, consecutive files form a frame: {image, radar}
+std::vector<std::string> listDataset(const std::string& folder){
+    std::vector<std::string> files;
+    for(boost::filesystem::recursive_directory_iterator it(folder), end; it != end; ++it){
+        if(boost::filesystem::is_regular_file(it->path())){
+            files.push_back(it->path().string());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    files.resize(files.size() / 2 * 2);
+    return files;
+}
+
+void dropPageCache(const std::vector<std::string>& files){
+    for(const auto& file: files){
+        int fd = open(file.c_str(), O_RDONLY);
+        if(fd >= 0){
+            posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+            close(fd);
+        }
+    }
+}
+
+void run(const std::vector<std::string>& files, size_t depth, size_t threadNum, unsigned consumeUs){
+    dropPageCache(files);
+
+    tools::ReadAheadLoader<Frame> loader(depth, threadNum, [&](size_t idx, Frame& frame){
+        tools::readFileInto(files[idx * 2], frame.image);
+        tools::readFileInto(files[idx * 2 + 1], frame.radar);
+    });
+
+    size_t bytes = 0;
+    size_t frameNum = files.size() / 2;
+    auto a = std::chrono::high_resolution_clock::now();
+    loader.start(frameNum);
+    Frame frame;
+    while(loader.next(frame)){
+        bytes += frame.image.size() + frame.radar.size() * sizeof(frame.radar[0]);
+        if(consumeUs > 0){
+            std::this_thread::sleep_for(std::chrono::microseconds(consumeUs));
+        }
+    }
+    auto b = std::chrono::high_resolution_clock::now();
+    double seconds = std::chrono::duration_cast<std::chrono::microseconds>(b - a).count() / 1000000.0;
+    std::cout << "read ahead " << depth << ", " << threadNum << " threads: " << frameNum / seconds << " frames/s, "
+              << bytes / seconds / 1024 / 1024 << " MB/s" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    if(argc > 5)
+    {
+        std::cerr <<
+            "Usage: testDatasetLoaderPerformance [<dataset_folder>] [<consume_us>] [<read_threads>] [<frame_number>]\n" <<
+            "Example:\n" <<
+            "    testDatasetLoaderPerformance /opt/datasets/raddet 1000 2\n" <<
+            "    testDatasetLoaderPerformance \"\" 1000 2 2000\n";
+        return EXIT_FAILURE;
+    }
+    std::string folder = argc > 1 ? argv[1] : "";
+    unsigned consumeUs = argc > 2 ? atoi(argv[2]) : 1000;
+    size_t threadNum = argc > 3 ? atoi(argv[3]) : READ_AHEAD_DEFAULT_THREAD_NUM;
+    unsigned frameNum = argc > 4 ? atoi(argv[4]) : 1000;
+
+    std::vector<std::string> files;
+    std::string tmpFolder;
+    if(folder.empty()){
+        tmpFolder = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+        files = makeDataset(tmpFolder, frameNum);
+    }
+    else{
+        files = listDataset(folder);
+    }
+    std::cout << "Frames: " << files.size() / 2 << ", consumer time per frame: " << consumeUs << " us" << std::endl;
+
+    for(size_t depth: {0, 1, 2, 4, 8, 16}){
+        run(files, depth, threadNum, consumeUs);
+    }
+
+    if(!tmpFolder.empty()){
+        boost::filesystem::remove_all(tmpFolder);
+    }
+    return EXIT_SUCCESS;
+}
@@ -125,7 +125,7 @@ class _mtestReplyListener : public baseResponseNode::EmitListener {
         if (m_pl->getState() == hva::hvaState_t::running) {
             // record results for each frame into m_frames
             m_frame.clear();
-            std::stringstream ss(res.message);
+            std::stringstream ss(res.getMessage());
             boost::property_tree::read_json(ss, m_frame);
             m_frames.push_back(std::make_pair("", m_frame));
         }
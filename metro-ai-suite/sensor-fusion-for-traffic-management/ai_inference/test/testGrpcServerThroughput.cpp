@@ -0,0 +1,180 @@
+/*
+ * INTEL CONFIDENTIAL
+ *
+ * Copyright (C) 2024 Intel Corporation.
+ *
+ * This software and the related documents are Intel copyrighted materials, and your use of
+ * them is governed by the express license under which they were provided to you (License).
+ * Unless the License provides otherwise, you may not use, modify, copy, publish, distribute,
+ * disclose or transmit this software or the related documents without Intel's prior written permission.
+ *
+ * This software and the related documents are provided as is, with no express or implied warranties,
+ * other than those that are expressly stated in the License.
+*/
+
+#include <cstdlib>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <chrono>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <algorithm>
+
+#include <inc/util/hvaUtil.hpp>
+
+#include "low_latency_client/grpcClient.hpp"
+
+using namespace hce::ai::inference;
+
+/**
+ * @brief loopback load generator for the gRPC server front end, each thread keeps its own channel and
+ * runs streaming requests back to back, the same way as lowLatencyClient does. Light pipelines with many
+ * small replies per stream, e.g. cpuLocalImageAiPipeline.json over a long media list, make the completion
+ * queues the bottleneck. Run against the server with different `HTTP.gRPCThreadCount` to compare.
+ *
+ * The gap between consecutive replies received on a stream approximates the server write latency,
+ * the server side latency of each write is also reported per completion queue at /latency as `grpc_write`.
+*/
+
+std::vector<std::size_t> g_total;
+std::vector<std::size_t> g_msgCnt;
+std::vector<uint64_t> g_gaps;    // in microseconds
+std::mutex g_mutex;
+
+void workload(const std::string& host, const std::string& port, const std::string& pipelineConfig,
+              const std::vector<std::string>& mediaUris, unsigned repeats, int replyPolicy, bool coalesce){
+    GRPCClient client{host, port};
+    std::shared_ptr<hce_ai::ai_inference::Stub> stub = client.connect();
+
+    std::size_t msgCnt = 0;
+    std::vector<uint64_t> gaps;
+
+    std::chrono::time_point<std::chrono::high_resolution_clock> a, b, last, now;
+    a = std::chrono::high_resolution_clock::now();
+    for(unsigned i = 0; i < repeats; ++i){
+        grpc::ClientContext context;
+        std::shared_ptr<grpc::ClientReaderWriter<hce_ai::AI_Request, hce_ai::AI_Response>> stream(stub->Run(&context));
+
+        hce_ai::AI_Request request;
+        request.set_pipelineconfig(pipelineConfig);
+        request.set_replypolicy((hce_ai::ReplyPolicy)replyPolicy);
+        request.set_coalescereplies(coalesce);
+        for(const auto& item: mediaUris){
+            request.add_mediauri(item);
+        }
+        stream->Write(request);
+
+        hce_ai::AI_Response reply;
+        last = std::chrono::high_resolution_clock::now();
+        while(stream->Read(&reply)){
+            now = std::chrono::high_resolution_clock::now();
+            gaps.push_back(std::chrono::duration_cast<std::chrono::microseconds>(now - last).count());
+            last = now;
+            // coalesced replies carry several results in one message
+            msgCnt += coalesce ? std::max(reply.responses_size(), 1) : 1;
+        }
+        stream->WritesDone();
+        grpc::Status status = stream->Finish();
+        if(!status.ok()){
+            std::cout << status.error_code() << ": " << status.error_message() << std::endl;
+        }
+    }
+    b = std::chrono::high_resolution_clock::now();
+
+    std::lock_guard<std::mutex> lg(g_mutex);
+    g_total.push_back(std::chrono::duration_cast<std::chrono::milliseconds>(b - a).count());
+    g_msgCnt.push_back(msgCnt);
+    g_gaps.insert(g_gaps.end(), gaps.begin(), gaps.end());
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        // Check command line arguments.
+        if(argc < 7 || argc > 9)
+        {
+            std::cerr <<
+                "Usage: testGrpcServerThroughput <host> <port> <json_file> <thread_number> <repeats> <media_list_file> "
+                "[<reply_policy: 0 lossless | 1 latest-wins>] [<coalesce: 0 | 1>]\n" <<
+                "Example:\n" <<
+                "    testGrpcServerThroughput 127.0.0.1 50052 ../../ai_inference/test/configs/cpuLocalImageAiPipeline.json 32 10 "
+                "../../ai_inference/test/media_uri_image.list\n";
+            return EXIT_FAILURE;
+        }
+        std::string host(argv[1]);
+        std::string port(argv[2]);
+        std::string jsonFile(argv[3]);
+        unsigned threadNum = atoi(argv[4]);
+        unsigned repeats = atoi(argv[5]);
+        std::string mediaListFile(argv[6]);
+        int replyPolicy = argc > 7 ? atoi(argv[7]) : 0;
+        bool coalesce = argc > 8 ? bool(atoi(argv[8])) : false;
+
+        std::ifstream in(jsonFile, std::ios::in);
+        if(!in.is_open()){
+            std::cerr << "Can not open the pipeline config: " << jsonFile << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::stringstream buffer;
+        buffer << in.rdbuf();
+        std::string pipelineConfig = buffer.str();
+
+        std::vector<std::string> mediaUris;
+        std::ifstream listIn(mediaListFile, std::ios::in);
+        std::string line;
+        while(std::getline(listIn, line)){
+            if(!line.empty()){
+                mediaUris.push_back(line);
+            }
+        }
+        if(mediaUris.empty()){
+            std::cerr << "No media uri in: " << mediaListFile << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        std::vector<std::thread> vThs;
+
+        std::chrono::time_point<std::chrono::high_resolution_clock> a, b;
+        a = std::chrono::high_resolution_clock::now();
+        for(unsigned i =0; i < threadNum; ++i){
+            std::thread t(workload, std::ref(host), std::ref(port), std::ref(pipelineConfig), std::ref(mediaUris),
+                          repeats, replyPolicy, coalesce);
+            vThs.push_back(std::move(t));
+        }
+
+        for(auto& item: vThs){
+            item.join();
+        }
+        b = std::chrono::high_resolution_clock::now();
+        float wallTime = std::chrono::duration_cast<std::chrono::milliseconds>(b - a).count();
+
+        std::lock_guard<std::mutex> lg(g_mutex);
+        std::size_t msgCnt = 0;
+        std::cout<<"Time used by each thread: " << std::endl;
+        for(unsigned i = 0; i < g_total.size(); ++i){
+            std::cout<<g_total[i]<<" ms, " << g_msgCnt[i] << " msgs" << std::endl;
+            msgCnt += g_msgCnt[i];
+        }
+        std::cout<<"Wall time: "<< wallTime<< " ms"<<std::endl;
+
+        float mps = ((float)msgCnt)/(wallTime/1000.0);
+        std::cout<<"\n msgs/s: "<<mps<<std::endl;
+
+        if(!g_gaps.empty()){
+            std::sort(g_gaps.begin(), g_gaps.end());
+            std::size_t p50 = g_gaps.size() / 2;
+            std::size_t p99 = std::min(g_gaps.size() - 1, g_gaps.size() * 99 / 100);
+            std::cout<<" reply gap p50: "<<g_gaps[p50]<<" us, p99: "<<g_gaps[p99]<<" us"<<std::endl;
+        }
+    }
+    catch(std::exception const& e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
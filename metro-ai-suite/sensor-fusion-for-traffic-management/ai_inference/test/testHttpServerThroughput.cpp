@@ -0,0 +1,127 @@
+/*
+ * INTEL CONFIDENTIAL
+ *
+ * Copyright (C) 2024 Intel Corporation.
+ *
+ * This software and the related documents are Intel copyrighted materials, and your use of
+ * them is governed by the express license under which they were provided to you (License).
+ * Unless the License provides otherwise, you may not use, modify, copy, publish, distribute,
+ * disclose or transmit this software or the related documents without Intel's prior written permission.
+ *
+ * This software and the related documents are provided as is, with no express or implied warranties,
+ * other than those that are expressly stated in the License.
+*/
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <vector>
+#include <thread>
+#include <mutex>
+
+#include <boost/asio/connect.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+
+/**
+ * @brief load generator for the RESTful server front end, each thread keeps one connection alive
+ * and sends short GET requests back to back. The target should not reach any pipeline, e.g. /latency,
+ * so that the measured requests/s reflects accept, parse, dispatch and reply of the server loops.
+ * Run against the server with different `HTTP.loopCount` to compare.
+*/
+
+std::vector<std::size_t> g_total;
+std::vector<std::size_t> g_failures;
+std::mutex g_mutex;
+
+void workload(const std::string& host, const std::string& port, const std::string& target, unsigned repeats){
+    namespace http = boost::beast::http;
+
+    boost::asio::io_context ioc;
+    boost::asio::ip::tcp::resolver resolver(ioc);
+    boost::beast::tcp_stream stream(ioc);
+    stream.connect(resolver.resolve(host, port));
+
+    http::request<http::empty_body> req{http::verb::get, target, 11};
+    req.set(http::field::host, host);
+    req.keep_alive(true);
+
+    boost::beast::flat_buffer buffer;
+    std::size_t failures = 0;
+
+    std::chrono::time_point<std::chrono::high_resolution_clock> a, b;
+    a = std::chrono::high_resolution_clock::now();
+    for(unsigned i = 0; i < repeats; ++i){
+        http::write(stream, req);
+        http::response<http::string_body> res;
+        http::read(stream, buffer, res);
+        if(res.result() != http::status::ok){
+            ++failures;
+        }
+    }
+    b = std::chrono::high_resolution_clock::now();
+
+    boost::beast::error_code ec;
+    stream.socket().shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+
+    std::lock_guard<std::mutex> lg(g_mutex);
+    g_total.push_back(std::chrono::duration_cast<std::chrono::milliseconds>(b - a).count());
+    g_failures.push_back(failures);
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        // Check command line arguments.
+        if(argc != 5 && argc != 6)
+        {
+            std::cerr <<
+                "Usage: testHttpServerThroughput <host> <port> <thread_number> <repeats> [target]\n" <<
+                "Example:\n" <<
+                "    testHttpServerThroughput 127.0.0.1 50051 16 10000 /latency\n";
+            return EXIT_FAILURE;
+        }
+        std::string host(argv[1]);
+        std::string port(argv[2]);
+        unsigned threadNum = atoi(argv[3]);
+        unsigned repeats = atoi(argv[4]);
+        std::string target = argc == 6 ? argv[5] : "/latency";
+
+        std::vector<std::thread> vThs;
+
+        std::chrono::time_point<std::chrono::high_resolution_clock> a, b;
+        a = std::chrono::high_resolution_clock::now();
+        for(unsigned i =0; i < threadNum; ++i){
+            std::thread t(workload, std::ref(host), std::ref(port), std::ref(target), repeats);
+            vThs.push_back(std::move(t));
+        }
+
+        for(auto& item: vThs){
+            item.join();
+        }
+        b = std::chrono::high_resolution_clock::now();
+        float wallTime = std::chrono::duration_cast<std::chrono::milliseconds>(b - a).count();
+
+        std::lock_guard<std::mutex> lg(g_mutex);
+        std::size_t failures = 0;
+        std::cout<<"Time used by each thread: " << std::endl;
+        for(unsigned i = 0; i < g_total.size(); ++i){
+            std::cout<<g_total[i]<<" ms" << std::endl;
+            failures += g_failures[i];
+        }
+        std::cout<<"Wall time: "<< wallTime<< " ms"<<std::endl;
+        std::cout<<"Non-ok replies: "<< failures<<std::endl;
+
+        float rps = ((float)threadNum*repeats)/(wallTime/1000.0);
+        std::cout<<"\n requests/s: "<<rps<<std::endl;
+    }
+    catch(std::exception const& e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
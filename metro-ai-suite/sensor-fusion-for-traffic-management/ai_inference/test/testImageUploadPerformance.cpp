@@ -0,0 +1,136 @@
+/*
+ * INTEL CONFIDENTIAL
+ *
+ * Copyright (C) 2024 Intel Corporation.
+ *
+ * This software and the related documents are Intel copyrighted materials, and your use of
+ * them is governed by the express license under which they were provided to you (License).
+ * Unless the License provides otherwise, you may not use, modify, copy, publish, distribute,
+ * disclose or transmit this software or the related documents without Intel's prior written permission.
+ *
+ * This software and the related documents are provided as is, with no express or implied warranties,
+ * other than those that are expressly stated in the License.
+*/
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+
+#include "modules/tools/uploader/async_uploader.hpp"
+
+/**
+ * @brief pipeline-side throughput of StorageImageUploadNode's uploading, against the file system stand-in store
+ * with a given request latency. Frames are submitted as fast as the pipeline thread can go:
+ * - sync: jpeg encoding + put on the pipeline thread, the uploading before AsyncUploader
+ * - async, block: AsyncUploader blocking the pipeline while its queue is full
+ * - async, drop: AsyncUploader dropping uploads while its queue is full
+*/
+
+using namespace hce::ai::inference::tools;
+
+struct Result{
+    double seconds;
+    AsyncUploaderStatistics stats;
+};
+
+bool encode(const cv::Mat& frame, std::string& content){
+    std::vector<unsigned char> img_encode;
+    if(!cv::imencode(".jpg", frame, img_encode)){
+        return false;
+    }
+    content.assign(img_encode.begin(), img_encode.end());
+    return true;
+}
+
+Result runSync(const cv::Mat& frame, unsigned frames, const std::string& directory, unsigned latencyMs){
+    Result result;
+    FileObjectStore store(directory, latencyMs);
+    auto a = std::chrono::steady_clock::now();
+    for(unsigned i = 0; i < frames; ++i){
+        UploadObject object;
+        store.generateURI("image", "vehicle", object.uri);
+        object.attributes = "{}";
+        result.stats.submitted ++;
+        if(encode(frame, object.content) && store.put(object)){
+            result.stats.uploaded ++;
+        }
+        else{
+            result.stats.failed ++;
+        }
+    }
+    auto b = std::chrono::steady_clock::now();
+    result.seconds = std::chrono::duration_cast<std::chrono::microseconds>(b - a).count() / 1000000.0;
+    return result;
+}
+
+Result runAsync(const cv::Mat& frame, unsigned frames, const std::string& directory, unsigned latencyMs,
+                const AsyncUploaderConfig& config){
+    Result result;
+    FileObjectStore uriStore(directory);
+    AsyncUploader uploader(config, [&](){ return std::make_shared<FileObjectStore>(directory, latencyMs); });
+    auto a = std::chrono::steady_clock::now();
+    for(unsigned i = 0; i < frames; ++i){
+        UploadJob job;
+        uriStore.generateURI("image", "vehicle", job.object.uri);
+        job.object.attributes = "{}";
+        job.encode = [&frame](std::string& content){ return encode(frame, content); };
+        uploader.submit(std::move(job));
+    }
+    auto b = std::chrono::steady_clock::now();
+    uploader.stop();
+    result.seconds = std::chrono::duration_cast<std::chrono::microseconds>(b - a).count() / 1000000.0;
+    result.stats = uploader.statistics();
+    return result;
+}
+
+void print(const std::string& name, const Result& result, unsigned frames){
+    std::cout << name << ": pipeline " << frames / result.seconds << " frames/s, uploaded " << result.stats.uploaded
+              << ", dropped " << result.stats.dropped << ", failed " << result.stats.failed << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    if(argc < 2 || argc > 6)
+    {
+        std::cerr <<
+            "Usage: testImageUploadPerformance <store_dir> [<latency_ms>] [<frames>] [<width>] [<height>]\n" <<
+            "    latency_ms: latency of each request to the store, default 50\n" <<
+            "Example:\n" <<
+            "    testImageUploadPerformance /tmp/uploads 50 200 1920 1080\n";
+        return EXIT_FAILURE;
+    }
+    std::string directory = argv[1];
+    unsigned latencyMs = argc > 2 ? atoi(argv[2]) : 50;
+    unsigned frames = argc > 3 ? atoi(argv[3]) : 200;
+    int width = argc > 4 ? atoi(argv[4]) : 1920;
+    int height = argc > 5 ? atoi(argv[5]) : 1080;
+
+    // a gradient compresses like a plain scene, unlike noise
+    cv::Mat frame(height, width, CV_8UC3);
+    for(int row = 0; row < height; ++row){
+        uint8_t* p = frame.ptr(row);
+        for(int col = 0; col < width; ++col){
+            p[col * 3] = (uint8_t)col;
+            p[col * 3 + 1] = (uint8_t)row;
+            p[col * 3 + 2] = (uint8_t)(col + row);
+        }
+    }
+
+    std::cout << "Store: " << directory << ", latency: " << latencyMs << " ms, frames: " << frames << ", size: "
+              << width << "x" << height << std::endl;
+
+    print("sync", runSync(frame, frames, directory, latencyMs), frames);
+
+    AsyncUploaderConfig config;
+    config.policy = QueueFullPolicy::Block;
+    print("async, block", runAsync(frame, frames, directory, latencyMs, config), frames);
+    config.policy = QueueFullPolicy::Drop;
+    print("async, drop", runAsync(frame, frames, directory, latencyMs, config), frames);
+    return EXIT_SUCCESS;
+}
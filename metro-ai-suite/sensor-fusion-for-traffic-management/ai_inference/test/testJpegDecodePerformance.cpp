@@ -0,0 +1,135 @@
+/*
+ * INTEL CONFIDENTIAL
+ *
+ * Copyright (C) 2024 Intel Corporation.
+ *
+ * This software and the related documents are Intel copyrighted materials, and your use of
+ * them is governed by the express license under which they were provided to you (License).
+ * Unless the License provides otherwise, you may not use, modify, copy, publish, distribute,
+ * disclose or transmit this software or the related documents without Intel's prior written permission.
+ *
+ * This software and the related documents are provided as is, with no express or implied warranties,
+ * other than those that are expressly stated in the License.
+*/
+
+#include <cstdlib>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <chrono>
+#include <vector>
+#include <functional>
+
+#include <boost/filesystem.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "modules/decode_util/scaled_jpeg_decode_helper.hpp"
+
+/**
+ * @brief decode + resize throughput of SimpleJpegDecOpenCV's decoding paths on a set of jpeg images.
+ * Every path ends with the resize to the model input that inference does anyway:
+ * - imdecode + copy: full size cv::imdecode copied into a string, the decoding before ScaledJpegDecoder
+ * - pooled, full size: ScaledJpegDecoder without a target size
+ * - pooled, scaled: ScaledJpegDecoder with the model input as target, decoding at 1/2, 1/4 or 1/8 if possible
+*/
+
+using namespace hce::ai::inference;
+
+std::vector<std::string> loadImages(const std::string& path){
+    std::vector<std::string> files;
+    if(boost::filesystem::is_directory(path)){
+        for(const auto& entry: boost::filesystem::directory_iterator(path)){
+            std::string ext = entry.path().extension().string();
+            if(ext == ".jpg" || ext == ".jpeg" || ext == ".JPG"){
+                files.push_back(entry.path().string());
+            }
+        }
+    }
+    else{
+        files.push_back(path);
+    }
+
+    std::vector<std::string> images;
+    for(const auto& file: files){
+        std::ifstream ifs(file, std::ios::binary);
+        std::stringstream ss;
+        ss << ifs.rdbuf();
+        images.push_back(ss.str());
+    }
+    return images;
+}
+
+void run(const std::string& name, const std::vector<std::string>& images, unsigned rounds, const cv::Size& target,
+         const std::function<cv::Mat(const std::string&)>& decode){
+    cv::Mat resized;
+    double pixels = 0;
+    auto a = std::chrono::high_resolution_clock::now();
+    for(unsigned i = 0; i < rounds; ++i){
+        for(const auto& image: images){
+            cv::Mat decoded = decode(image);
+            if(decoded.empty()){
+                std::cerr << name << ": failed to decode an image" << std::endl;
+                return;
+            }
+            pixels += decoded.total();
+            cv::resize(decoded, resized, target);
+        }
+    }
+    auto b = std::chrono::high_resolution_clock::now();
+    double seconds = std::chrono::duration_cast<std::chrono::microseconds>(b - a).count() / 1000000.0;
+    std::size_t frames = (std::size_t)rounds * images.size();
+    std::cout << name << ": " << frames / seconds << " frames/s, " << seconds * 1000.0 / frames << " ms/frame, "
+              << "decoded " << pixels / frames / 1000000.0 << " MPixels/frame" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    if(argc < 2 || argc > 5)
+    {
+        std::cerr <<
+            "Usage: testJpegDecodePerformance <jpeg_file_or_dir> [<target_width>] [<target_height>] [<rounds>]\n" <<
+            "Example:\n" <<
+            "    testJpegDecodePerformance ../test/demo/images 416 416 200\n";
+        return EXIT_FAILURE;
+    }
+    std::vector<std::string> images = loadImages(argv[1]);
+    unsigned targetWidth = argc > 2 ? atoi(argv[2]) : 416;
+    unsigned targetHeight = argc > 3 ? atoi(argv[3]) : 416;
+    unsigned rounds = argc > 4 ? atoi(argv[4]) : 100;
+    if(images.empty()){
+        std::cerr << "No jpeg image found in " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+
+#ifdef HAVE_TURBOJPEG
+    std::cout << "Decoder: libjpeg-turbo";
+#else
+    std::cout << "Decoder: OpenCV";
+#endif
+    std::cout << ", images: " << images.size() << ", target: " << targetWidth << "x" << targetHeight
+              << ", rounds: " << rounds << std::endl;
+    cv::Size target(targetWidth, targetHeight);
+
+    std::string toSend;
+    run("imdecode + copy", images, rounds, target, [&](const std::string& image){
+        cv::Mat rawData(1, (int)image.size(), CV_8UC1, (void*)image.data());
+        cv::Mat decodedImage = cv::imdecode(rawData, cv::IMREAD_COLOR);
+        toSend.assign((char*)decodedImage.data, decodedImage.total() * decodedImage.elemSize());
+        return cv::Mat(decodedImage.rows, decodedImage.cols, CV_8UC3, (void*)toSend.data());
+    });
+
+    for(bool scaled: {false, true}){
+        ScaledJpegDecoder decoder(scaled ? targetWidth : 0, scaled ? targetHeight : 0);
+        hva::hvaVideoFrameWithROIBuf_t::Ptr hvabuf;
+        run(scaled ? "pooled, scaled" : "pooled, full size", images, rounds, target, [&](const std::string& image){
+            // the previous frame goes back to the pool here, as downstream releasing it
+            if(!decoder.decode(image, hvabuf)){
+                return cv::Mat();
+            }
+            return cv::Mat(hvabuf->height, hvabuf->width, CV_8UC3, hvabuf->get<uint8_t*>());
+        });
+    }
+    std::cout << DecodedFramePool::getInstance()->report() << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,135 @@
+/*
+ * INTEL CONFIDENTIAL
+ *
+ * Copyright (C) 2024 Intel Corporation.
+ *
+ * This software and the related documents are Intel copyrighted materials, and your use of
+ * them is governed by the express license under which they were provided to you (License).
+ * Unless the License provides otherwise, you may not use, modify, copy, publish, distribute,
+ * disclose or transmit this software or the related documents without Intel's prior written permission.
+ *
+ * This software and the related documents are provided as is, with no express or implied warranties,
+ * other than those that are expressly stated in the License.
+*/
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <random>
+#include <memory>
+
+#include "lru_cache.h"
+
+/**
+ * @brief multi-threaded lookup throughput of ShardedLRUCache against LRUCache behind a single mutex.
+ * Worker threads look up string keys with a skewed popularity, the same way model, image and calibration
+ * lookups hit a few hot entries, and insert a value of the given size on each miss. The sharded cache is
+ * bounded by bytes, the plain one by the equivalent number of entries.
+*/
+
+using Value = std::shared_ptr<const std::string>;
+
+struct Workload{
+    unsigned threadNum;
+    unsigned opsPerThread;
+    unsigned keySpace;
+    std::size_t valueSize;
+};
+
+// keys drawn with a skewed popularity, roughly 80% of lookups on 20% of keys
+std::vector<std::string> makeKeys(const Workload& wl, unsigned seed){
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    std::vector<std::string> keys(wl.opsPerThread);
+    for(auto& key: keys){
+        double u = dist(rng);
+        unsigned idx = (unsigned)(u * u * u * wl.keySpace);
+        key = "calib/camera_" + std::to_string(idx) + ".json";
+    }
+    return keys;
+}
+
+template <typename LookupFunc>
+void run(const std::string& name, const Workload& wl, LookupFunc lookup){
+    std::vector<std::vector<std::string>> keys;
+    for(unsigned i = 0; i < wl.threadNum; ++i){
+        keys.push_back(makeKeys(wl, i));
+    }
+
+    std::atomic<uint64_t> hits{0};
+    std::vector<std::thread> vThs;
+    auto a = std::chrono::high_resolution_clock::now();
+    for(unsigned i = 0; i < wl.threadNum; ++i){
+        vThs.emplace_back([&, i](){
+            uint64_t localHits = 0;
+            for(const auto& key: keys[i]){
+                localHits += lookup(key) ? 1 : 0;
+            }
+            hits += localHits;
+        });
+    }
+    for(auto& item: vThs){
+        item.join();
+    }
+    auto b = std::chrono::high_resolution_clock::now();
+    double seconds = std::chrono::duration_cast<std::chrono::microseconds>(b - a).count() / 1000000.0;
+    uint64_t ops = (uint64_t)wl.threadNum * wl.opsPerThread;
+    std::cout << name << ": " << ops / seconds / 1000000.0 << " Mops/s, hit ratio: " << (double)hits / ops << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    if(argc > 5)
+    {
+        std::cerr <<
+            "Usage: testLruCachePerformance [<thread_number>] [<ops_per_thread>] [<key_space>] [<value_bytes>]\n" <<
+            "Example:\n" <<
+            "    testLruCachePerformance 16 1000000 100000 4096\n";
+        return EXIT_FAILURE;
+    }
+    Workload wl;
+    wl.threadNum = argc > 1 ? atoi(argv[1]) : std::max(1u, std::thread::hardware_concurrency());
+    wl.opsPerThread = argc > 2 ? atoi(argv[2]) : 1000000;
+    wl.keySpace = argc > 3 ? atoi(argv[3]) : 100000;
+    wl.valueSize = argc > 4 ? std::strtoull(argv[4], nullptr, 10) : 4096;
+    // room for a quarter of the keys
+    std::size_t entries = std::max(1u, wl.keySpace / 4);
+
+    std::cout << "Threads: " << wl.threadNum << ", ops per thread: " << wl.opsPerThread << ", keys: " << wl.keySpace
+              << ", value bytes: " << wl.valueSize << std::endl;
+
+    Value value = std::make_shared<const std::string>(wl.valueSize, 'x');
+
+    LRUCache<std::string, Value> plain(entries);
+    std::mutex plainMutex;
+    run("LRUCache + mutex", wl, [&](const std::string& key){
+        std::lock_guard<std::mutex> lg(plainMutex);
+        Value cached;
+        if(plain.try_get(key, cached)){
+            return true;
+        }
+        plain.put(key, value);
+        return false;
+    });
+
+    for(std::size_t shardCount: {1, 16, 64}){
+        ShardedLRUCache<std::string, Value> sharded(entries * wl.valueSize, shardCount,
+                [](const std::string& key, const Value& val){ return key.size() + val->size(); });
+        run("ShardedLRUCache, " + std::to_string(shardCount) + " shards", wl, [&](const std::string& key){
+            Value cached;
+            if(sharded.try_get(key, cached)){
+                return true;
+            }
+            sharded.put(key, value);
+            return false;
+        });
+        std::cout << "    entries: " << sharded.size() << ", bytes: " << sharded.cost() << " / " << sharded.capacity()
+                  << ", evictions: " << sharded.evictions() << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
@@ -63,7 +63,7 @@ public:
             
             // record results for each frame into m_frames
             boost::property_tree::ptree res_frame;
-            std::stringstream ss(res.message); 
+            std::stringstream ss(res.getMessage()); 
             boost::property_tree::read_json(ss, res_frame);
             m_frames.push_back(std::make_pair("", res_frame));
         }
@@ -0,0 +1,210 @@
+/*
+ * INTEL CONFIDENTIAL
+ *
+ * Copyright (C) 2024 Intel Corporation.
+ *
+ * This software and the related documents are Intel copyrighted materials, and your use of
+ * them is governed by the express license under which they were provided to you (License).
+ * Unless the License provides otherwise, you may not use, modify, copy, publish, distribute,
+ * disclose or transmit this software or the related documents without Intel's prior written permission.
+ *
+ * This software and the related documents are provided as is, with no express or implied warranties,
+ * other than those that are expressly stated in the License.
+*/
+
+#include <new>
+#include <set>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "nodes/base/baseResponseNode.hpp"
+
+/**
+ * @brief cost of fanning out the results of a multi-camera output node, e.g. Media4COutputNode, to its listeners:
+ * a json consumer such as the gRPC client, a json file sink and a typed consumer such as a display.
+ * - eager json: the node serializes json for every frame, each listener gets a copy of the message
+ * - shared result, lazy json: the node emits a shared result, json is serialized once on first read
+ * - shared result, typed listeners: no listener reads json, nothing is serialized
+ * Reports per frame the json copies and bytes held by listeners, heap allocations and bytes allocated.
+*/
+
+using namespace hce::ai::inference;
+
+static std::atomic<uint64_t> g_allocations(0);
+static std::atomic<uint64_t> g_allocatedBytes(0);
+
+void* operator new(std::size_t size){
+    g_allocations ++;
+    g_allocatedBytes += size;
+    if(void* p = std::malloc(size ? size : 1)){
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept{
+    std::free(p);
+}
+
+class FanOutNode : public baseResponseNode{
+public:
+    FanOutNode() : baseResponseNode(1, 0, 1) {};
+
+    virtual std::shared_ptr<hva::hvaNodeWorker_t> createNodeWorker() const override{ return nullptr; };
+
+    virtual const std::string nodeClassName() const override{ return "FanOutNode"; };
+};
+
+/**
+ * @brief records the json buffers seen by listeners of a frame, copies show as different buffers
+*/
+struct JsonCopies{
+    std::set<const char*> buffers;
+    uint64_t bytes = 0;
+
+    void add(const std::string& message){
+        if(buffers.insert(message.data()).second){
+            bytes += message.size();
+        }
+    };
+};
+
+/**
+ * @brief json consumer, records the message of each frame to the frame's JsonCopies
+*/
+class JsonListener : public baseResponseNode::EmitListener{
+public:
+    JsonListener(JsonCopies*& current) : m_current(current) {};
+
+    virtual void onEmit(baseResponseNode::Response res, const baseResponseNode* node, void* data) override{
+        m_current->add(res.getMessage());
+    };
+
+    virtual void onFinish(const baseResponseNode* node, void* data) override{};
+
+private:
+    JsonCopies*& m_current;
+};
+
+class TypedListener : public baseResponseNode::EmitListener{
+public:
+    virtual void onEmit(baseResponseNode::Response res, const baseResponseNode* node, void* data) override{
+        if(res.result){
+            m_rois += res.result->rois.size();
+        }
+    };
+
+    virtual void onFinish(const baseResponseNode* node, void* data) override{};
+
+private:
+    size_t m_rois = 0;
+};
+
+std::shared_ptr<baseResponseNode::Result> makeResult(unsigned frameId, unsigned cameras, unsigned roisPerCamera){
+    auto result = std::make_shared<baseResponseNode::Result>();
+    result->frameId = frameId;
+    result->statusCode = 0;
+    result->description = "succeeded";
+    result->latency = 35.2;
+    result->inferenceLatency = 12.7;
+    for(unsigned camera = 0; camera < cameras; ++camera){
+        result->latencies.emplace_back("inference_latency" + std::to_string(camera + 1), 12.7);
+        result->latencies.emplace_back("latency" + std::to_string(camera + 1), 35.2);
+        for(unsigned i = 0; i < roisPerCamera; ++i){
+            baseResponseNode::ResultROI roi;
+            roi.roi[0] = 100 + i;
+            roi.roi[1] = 200 + i;
+            roi.roi[2] = 64;
+            roi.roi[3] = 48;
+            roi.roiClass = "vehicle";
+            roi.roiScore = 0.87654321;
+            roi.trackId = camera * 1000 + i;
+            roi.trackStatus = "TRACKED";
+            roi.sensorSource = camera;
+            result->rois.push_back(std::move(roi));
+        }
+    }
+    return result;
+}
+
+void run(const std::string& name, unsigned frames, unsigned cameras, unsigned roisPerCamera,
+         unsigned jsonListeners, unsigned typedListeners, bool eager){
+    const unsigned fields = baseResponseNode::RESULT_JSON_SENSOR_SOURCE | baseResponseNode::RESULT_JSON_MEDIA_BIRDVIEW_ROI |
+            baseResponseNode::RESULT_JSON_FUSION_ROI | baseResponseNode::RESULT_JSON_INFERENCE_LATENCY |
+            baseResponseNode::RESULT_JSON_LATENCY;
+
+    FanOutNode node;
+    std::vector<JsonCopies> copies(frames);
+    JsonCopies* current = nullptr;
+    for(unsigned i = 0; i < jsonListeners; ++i){
+        node.registerEmitListener(std::make_shared<JsonListener>(current));
+    }
+    for(unsigned i = 0; i < typedListeners; ++i){
+        node.registerEmitListener(std::make_shared<TypedListener>());
+    }
+
+    uint64_t allocations = g_allocations;
+    uint64_t allocatedBytes = g_allocatedBytes;
+    auto a = std::chrono::high_resolution_clock::now();
+    for(unsigned frameId = 0; frameId < frames; ++frameId){
+        current = &copies[frameId];
+        auto result = makeResult(frameId, cameras, roisPerCamera);
+
+        baseResponseNode::Response res;
+        res.status = 0;
+        if(eager){
+            res.message = baseResponseNode::makeJsonMessage(*result, fields);
+        }
+        else{
+            res.result = result;
+            res.lazyMessage = std::make_shared<baseResponseNode::LazyJsonMessage>(result, fields);
+        }
+        node.emitOutput(std::move(res), &node, nullptr);
+    }
+    auto b = std::chrono::high_resolution_clock::now();
+    allocations = g_allocations - allocations;
+    allocatedBytes = g_allocatedBytes - allocatedBytes;
+
+    uint64_t jsonCopies = 0, jsonBytes = 0;
+    for(const auto& item: copies){
+        jsonCopies += item.buffers.size();
+        jsonBytes += item.bytes;
+    }
+    double us = std::chrono::duration_cast<std::chrono::microseconds>(b - a).count() / (double)frames;
+    std::cout << name << ": " << us << " us/frame, json copies/frame " << (double)jsonCopies / frames
+              << ", json bytes/frame " << jsonBytes / frames << ", allocations/frame " << allocations / frames
+              << ", bytes allocated/frame " << allocatedBytes / frames << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    if(argc > 5)
+    {
+        std::cerr <<
+            "Usage: testOutputFanOutPerformance [<cameras>] [<rois_per_camera>] [<json_listeners>] [<frames>]\n" <<
+            "Example:\n" <<
+            "    testOutputFanOutPerformance 4 20 2 2000\n";
+        return EXIT_FAILURE;
+    }
+    unsigned cameras = argc > 1 ? atoi(argv[1]) : 4;
+    unsigned roisPerCamera = argc > 2 ? atoi(argv[2]) : 20;
+    unsigned jsonListeners = argc > 3 ? atoi(argv[3]) : 2;
+    unsigned frames = argc > 4 ? atoi(argv[4]) : 2000;
+
+    std::cout << "Cameras: " << cameras << ", rois per camera: " << roisPerCamera << ", json listeners: "
+              << jsonListeners << " + 1 typed listener, frames: " << frames << std::endl;
+
+    run("eager json", frames, cameras, roisPerCamera, jsonListeners, 1, true);
+    run("shared result, lazy json", frames, cameras, roisPerCamera, jsonListeners, 1, false);
+    run("shared result, typed listeners", frames, cameras, roisPerCamera, 0, jsonListeners + 1, false);
+    return EXIT_SUCCESS;
+}
@@ -117,7 +117,7 @@ public:
             
             // record results for each frame into m_frames
             m_frame.clear();
-            std::stringstream ss(res.message); 
+            std::stringstream ss(res.getMessage()); 
             boost::property_tree::read_json(ss, m_frame);
             double latency;
 
@@ -0,0 +1,126 @@
+/*
+ * INTEL CONFIDENTIAL
+ *
+ * Copyright (C) 2024 Intel Corporation.
+ *
+ * This software and the related documents are Intel copyrighted materials, and your use of
+ * them is governed by the express license under which they were provided to you (License).
+ * Unless the License provides otherwise, you may not use, modify, copy, publish, distribute,
+ * disclose or transmit this software or the related documents without Intel's prior written permission.
+ *
+ * This software and the related documents are provided as is, with no express or implied warranties,
+ * other than those that are expressly stated in the License.
+*/
+
+#include <cstdlib>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <chrono>
+#include <vector>
+#include <thread>
+
+#include "modules/decode_util/video_decode_helper.hpp"
+
+/**
+ * @brief CPU-only software decoding throughput of VideoDecoderNode's decoder, decoding + BGR conversion of a
+ * local H.264 clip with different threading. The clip is fed in buffers of the given size, the same way
+ * LocalMediaInputNode does with ReadBufferSize, and the decoded frames are released right after, as a fast
+ * downstream would.
+*/
+
+using namespace hce::ai::inference;
+
+struct Threading{
+    std::string name;
+    int threadCount;
+    int threadType;
+};
+
+void run(const Threading& threading, const std::string& clip, std::size_t bufferSize){
+    FFmpegDecoderManager decoderManager;
+    decoderManager.init();
+    decoderManager.setThreading(threading.threadCount, threading.threadType);
+
+    std::size_t frames = 0;
+    double firstFrameMs = 0;
+    auto a = std::chrono::high_resolution_clock::now();
+    for(std::size_t offset = 0; offset < clip.size(); offset += bufferSize){
+        std::string buffer = clip.substr(offset, bufferSize);
+        bool endOfVideo = offset + bufferSize >= clip.size();
+        if(!decoderManager.startDecode(buffer, endOfVideo)){
+            std::cerr << threading.name << ": failed to start decoding" << std::endl;
+            return;
+        }
+        int status = 0;
+        while(status == 0){
+            hva::hvaVideoFrameWithROIBuf_t::Ptr hvabuf = NULL;
+            status = decoderManager.decodeNext(hvabuf);
+            if(hvabuf){
+                if(frames == 0){
+                    firstFrameMs = std::chrono::duration_cast<std::chrono::microseconds>(
+                            std::chrono::high_resolution_clock::now() - a).count() / 1000.0;
+                }
+                frames ++;
+            }
+        }
+    }
+    auto b = std::chrono::high_resolution_clock::now();
+    decoderManager.setState(decodeStatus_t::DECODER_VIDEO_EOS);
+    decoderManager.deinitDecoder();
+    decoderManager.deinit();
+
+    double seconds = std::chrono::duration_cast<std::chrono::microseconds>(b - a).count() / 1000000.0;
+    std::cout << threading.name << ": " << frames << " frames, " << frames / seconds << " frames/s, first frame after "
+              << firstFrameMs << " ms" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    if(argc < 2 || argc > 4)
+    {
+        std::cerr <<
+            "Usage: testVideoDecodePerformance <h264_clip> [<thread_number>] [<buffer_bytes>]\n" <<
+            "    thread_number: threads of the threaded runs, 0 to let FFmpeg decide, default the cores available\n" <<
+            "    buffer_bytes: bytes fed to the decoder each time, default the whole clip\n" <<
+            "Clips can be generated locally, e.g.:\n" <<
+            "    ffmpeg -f lavfi -i testsrc2=size=1920x1080:rate=30 -t 20 -c:v libx264 -pix_fmt yuv420p 1080p.mp4\n" <<
+            "    ffmpeg -f lavfi -i testsrc2=size=3840x2160:rate=30 -t 10 -c:v libx264 -pix_fmt yuv420p "
+            "-x264-params slices=4 2160p.mp4\n" <<
+            "Example:\n" <<
+            "    testVideoDecodePerformance 2160p.mp4 8\n";
+        return EXIT_FAILURE;
+    }
+    std::ifstream ifs(argv[1], std::ios::binary);
+    std::stringstream ss;
+    ss << ifs.rdbuf();
+    std::string clip = ss.str();
+    if(clip.empty()){
+        std::cerr << "Failed to read " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+    int threadNum = argc > 2 ? atoi(argv[2]) : std::max(1u, std::thread::hardware_concurrency());
+    std::size_t bufferSize = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : clip.size();
+    if(bufferSize == 0){
+        bufferSize = clip.size();
+    }
+
+    // keep the output to the results
+    av_log_set_level(AV_LOG_FATAL);
+
+    std::cout << "Clip: " << argv[1] << ", bytes: " << clip.size() << ", buffer bytes: " << bufferSize
+              << ", threads: " << threadNum << std::endl;
+
+    std::vector<Threading> threadings = {
+        {"1 thread", 1, FF_THREAD_FRAME | FF_THREAD_SLICE},
+        {"frame threads", threadNum, FF_THREAD_FRAME},
+        {"slice threads", threadNum, FF_THREAD_SLICE},
+        {"frame + slice threads", threadNum, FF_THREAD_FRAME | FF_THREAD_SLICE},
+    };
+    for(const auto& threading: threadings){
+        run(threading, clip, bufferSize);
+    }
+    std::cout << DecodedFramePool::getInstance()->report() << std::endl;
+    return EXIT_SUCCESS;
+}
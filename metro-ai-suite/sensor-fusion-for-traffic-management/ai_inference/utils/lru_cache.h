@@ -6,10 +6,17 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <list>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 template <typename Key_T, typename Value_T>
 class LRUCache {
@@ -48,12 +55,22 @@ class LRUCache {
     Value_T &get(Key_T key) {
         auto key_it = keys.find(key);
         if (key_it == keys.end())
-            throw std::runtime_error("Key " + std::to_string(key) + " is absent from LRUCache");
+            throw std::runtime_error("Key is absent from LRUCache");
 
         make_recently_used(key_it->second);
         return key_it->second->value;
     }
 
+    bool try_get(const Key_T &key, Value_T &value) {
+        auto key_it = keys.find(key);
+        if (key_it == keys.end())
+            return false;
+
+        make_recently_used(key_it->second);
+        value = key_it->second->value;
+        return true;
+    }
+
     void put(Key_T key, Value_T value = {}) {
         auto key_it = keys.find(key);
         if (key_it == keys.end()) {
@@ -76,3 +93,205 @@ class LRUCache {
         return keys.size();
     }
 };
+
+/**
+ * Thread-safe LRU cache, partitioned by key hash into shards each guarded by its own mutex, so that
+ * lookups from many threads rarely contend. Each shard runs LRU on its own over an equal part of the capacity.
+ *
+ * Capacity is in units of entry cost: by default every entry costs 1, i.e. the capacity is a number of
+ * entries; with a cost function, e.g. the size in bytes of the value, it bounds the total cost instead.
+ * The recency list is threaded through the nodes of the per-shard hash map, so each entry takes a single
+ * allocation. Values are copied out on lookup, use a shared_ptr for values that are expensive to copy.
+ */
+template <typename Key_T, typename Value_T, typename Hash_T = std::hash<Key_T>, typename KeyEqual_T = std::equal_to<Key_T>>
+class ShardedLRUCache {
+  public:
+    using CostFunction = std::function<size_t(const Key_T &, const Value_T &)>;
+
+    ShardedLRUCache(size_t capacity, size_t shard_count = 16, CostFunction cost_of = nullptr)
+        : shards(std::max<size_t>(shard_count, 1)), cost_of(std::move(cost_of)), evicted(0) {
+        const size_t shard_capacity = std::max<size_t>(capacity / shards.size(), 1);
+        for (auto &shard : shards)
+            shard.capacity = shard_capacity;
+    }
+
+    ~ShardedLRUCache() = default;
+
+    ShardedLRUCache(const ShardedLRUCache &) = delete;
+    ShardedLRUCache &operator=(const ShardedLRUCache &) = delete;
+
+    /**
+     * Copies the value of key to value and marks it most recently used.
+     * Returns false if key is absent.
+     */
+    bool try_get(const Key_T &key, Value_T &value) {
+        return try_get(key, value, [](const Value_T &) { return true; });
+    }
+
+    /**
+     * Same as above, entries for which is_valid returns false, e.g. expired ones, are removed and reported absent.
+     */
+    template <typename Pred_T>
+    bool try_get(const Key_T &key, Value_T &value, Pred_T &&is_valid) {
+        Shard &shard = shard_of(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.map.find(key);
+        if (it == shard.map.end())
+            return false;
+        if (!is_valid(it->second.value)) {
+            shard.remove(it);
+            return false;
+        }
+        shard.make_recently_used(&*it);
+        value = it->second.value;
+        return true;
+    }
+
+    /**
+     * Inserts or replaces the value of key, evicting least recently used entries of the shard until it fits.
+     * Returns false if the entry alone exceeds the capacity of a shard, it is not cached then and any previous
+     * value of key is removed, so that a stale value is never returned after a failed replacement.
+     */
+    bool put(const Key_T &key, Value_T value) {
+        const size_t cost = cost_of ? cost_of(key, value) : 1;
+        Shard &shard = shard_of(key);
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.map.find(key);
+        if (it != shard.map.end())
+            shard.remove(it);
+        if (cost > shard.capacity)
+            return false;
+        while (shard.cost + cost > shard.capacity && shard.tail) {
+            shard.remove(shard.map.find(shard.tail->first));
+            evicted.fetch_add(1, std::memory_order_relaxed);
+        }
+        it = shard.map.emplace(key, Node{std::move(value), cost, nullptr, nullptr}).first;
+        shard.cost += cost;
+        shard.link_front(&*it);
+        return true;
+    }
+
+    bool erase(const Key_T &key) {
+        Shard &shard = shard_of(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.map.find(key);
+        if (it == shard.map.end())
+            return false;
+        shard.remove(it);
+        return true;
+    }
+
+    void clear() {
+        for (auto &shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.map.clear();
+            shard.head = shard.tail = nullptr;
+            shard.cost = 0;
+        }
+    }
+
+    size_t count(const Key_T &key) {
+        Shard &shard = shard_of(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.map.count(key);
+    }
+
+    size_t size() {
+        size_t total = 0;
+        for (auto &shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            total += shard.map.size();
+        }
+        return total;
+    }
+
+    /**
+     * Total cost of the cached entries, in bytes with a byte-size cost function.
+     */
+    size_t cost() {
+        size_t total = 0;
+        for (auto &shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            total += shard.cost;
+        }
+        return total;
+    }
+
+    size_t capacity() const {
+        return shards.front().capacity * shards.size();
+    }
+
+    /**
+     * Number of entries evicted to make room since construction.
+     */
+    uint64_t evictions() const {
+        return evicted.load(std::memory_order_relaxed);
+    }
+
+  private:
+    struct Node;
+    using Map = std::unordered_map<Key_T, Node, Hash_T, KeyEqual_T>;
+    using MapEntry = typename Map::value_type;
+
+    // pointers to map entries stay valid across rehashing
+    struct Node {
+        Value_T value;
+        size_t cost;
+        MapEntry *prev; // more recently used
+        MapEntry *next; // less recently used
+    };
+
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        Map map;
+        MapEntry *head = nullptr; // most recently used
+        MapEntry *tail = nullptr; // least recently used
+        size_t cost = 0;
+        size_t capacity = 0;
+
+        void link_front(MapEntry *entry) {
+            entry->second.prev = nullptr;
+            entry->second.next = head;
+            if (head)
+                head->second.prev = entry;
+            head = entry;
+            if (!tail)
+                tail = entry;
+        }
+
+        void unlink(MapEntry *entry) {
+            if (entry->second.prev)
+                entry->second.prev->second.next = entry->second.next;
+            else
+                head = entry->second.next;
+            if (entry->second.next)
+                entry->second.next->second.prev = entry->second.prev;
+            else
+                tail = entry->second.prev;
+        }
+
+        void make_recently_used(MapEntry *entry) {
+            if (entry != head) {
+                unlink(entry);
+                link_front(entry);
+            }
+        }
+
+        void remove(typename Map::iterator it) {
+            unlink(&*it);
+            cost -= it->second.cost;
+            map.erase(it);
+        }
+    };
+
+    Shard &shard_of(const Key_T &key) {
+        // remix so that shards do not correlate with the buckets of the per-shard maps
+        uint64_t hash = static_cast<uint64_t>(Hash_T()(key)) * 0x9E3779B97F4A7C15ull;
+        return shards[(hash >> 32) % shards.size()];
+    }
+
+    std::vector<Shard> shards;
+    CostFunction cost_of;
+    std::atomic<uint64_t> evicted;
+};